@@ -0,0 +1,88 @@
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+#include <adaptive_limiter.h>
+#include <algorithm>
+#include <limits>
+
+namespace grpc_labview
+{
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    static const double kBackoffRatio = 0.9;
+    static const double kSmoothing = 0.1;
+    static const uint64_t kMinLatencyWindow = 1000;
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    AdaptiveLimiter::AdaptiveLimiter(int32_t minLimit, int32_t maxLimit, double targetDelayUs) :
+        _minLimit(std::max(1, minLimit)),
+        _maxLimit(std::max(std::max(1, minLimit), maxLimit)),
+        _targetDelayUs(targetDelayUs),
+        _minLatencyUs(std::numeric_limits<double>::max()),
+        _windowMinLatencyUs(std::numeric_limits<double>::max()),
+        _smoothedLatencyUs(0),
+        _samples(0),
+        _windowSamples(0),
+        _samplesSinceDecrease(0),
+        _decreases(0)
+    {
+        _limit = _minLimit;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    int32_t AdaptiveLimiter::AddSample(double latencyUs, int32_t inFlight)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_samples;
+        ++_samplesSinceDecrease;
+        _smoothedLatencyUs = _samples == 1 ? latencyUs : _smoothedLatencyUs + kSmoothing * (latencyUs - _smoothedLatencyUs);
+
+        // The no load latency follows the handler cost: the minimum of the last
+        // full window is used, and lower latencies are taken immediately.
+        _windowMinLatencyUs = std::min(_windowMinLatencyUs, latencyUs);
+        _minLatencyUs = std::min(_minLatencyUs, latencyUs);
+        if (++_windowSamples == kMinLatencyWindow)
+        {
+            _minLatencyUs = _windowMinLatencyUs;
+            _windowMinLatencyUs = std::numeric_limits<double>::max();
+            _windowSamples = 0;
+        }
+
+        auto queueDelayUs = _smoothedLatencyUs - _minLatencyUs;
+        if (queueDelayUs > _targetDelayUs)
+        {
+            if (_samplesSinceDecrease >= (uint64_t)_limit)
+            {
+                _limit = std::max((double)_minLimit, _limit * kBackoffRatio);
+                _samplesSinceDecrease = 0;
+                ++_decreases;
+            }
+        }
+        else if (inFlight * 2 >= (int32_t)_limit)
+        {
+            _limit = std::min((double)_maxLimit, _limit + 1 / _limit);
+        }
+        return (int32_t)_limit;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    int32_t AdaptiveLimiter::Limit()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return (int32_t)_limit;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void AdaptiveLimiter::GetStats(int32_t* limit, double* minLatencyUs, double* smoothedLatencyUs, uint64_t* samples, uint64_t* decreases)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        *limit = (int32_t)_limit;
+        *minLatencyUs = _samples == 0 ? 0 : _minLatencyUs;
+        *smoothedLatencyUs = _smoothedLatencyUs;
+        *samples = _samples;
+        *decreases = _decreases;
+    }
+}
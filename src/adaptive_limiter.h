@@ -0,0 +1,48 @@
+//---------------------------------------------------------------------
+// Concurrency limit that adapts to the measured latency of calls
+//---------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+#include <cstdint>
+#include <mutex>
+
+namespace grpc_labview
+{
+    //---------------------------------------------------------------------
+    // Additive increase, multiplicative decrease of a concurrency limit
+    // driven by queueing delay. The latency of a call without queueing is
+    // estimated as the lowest latency seen over a window of calls, anything
+    // above it is time the call spent waiting for a LabVIEW handler.
+    //
+    // While the smoothed queueing delay stays below the target and the limit
+    // is being used, the limit grows by one every limit calls. When the delay
+    // exceeds the target the limit is multiplied by the backoff ratio, at most
+    // once every limit calls so that a single slow burst is only counted once.
+    //---------------------------------------------------------------------
+    class AdaptiveLimiter
+    {
+    public:
+        AdaptiveLimiter(int32_t minLimit, int32_t maxLimit, double targetDelayUs);
+
+        // Adds the latency of a completed call and returns the new limit.
+        int32_t AddSample(double latencyUs, int32_t inFlight);
+        int32_t Limit();
+        void GetStats(int32_t* limit, double* minLatencyUs, double* smoothedLatencyUs, uint64_t* samples, uint64_t* decreases);
+
+    private:
+        std::mutex _mutex;
+        int32_t _minLimit;
+        int32_t _maxLimit;
+        double _targetDelayUs;
+        double _limit;
+        double _minLatencyUs;
+        double _windowMinLatencyUs;
+        double _smoothedLatencyUs;
+        uint64_t _samples;
+        uint64_t _windowSamples;
+        uint64_t _samplesSinceDecrease;
+        uint64_t _decreases;
+    };
+}
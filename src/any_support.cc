@@ -5,6 +5,27 @@
 #include <google/protobuf/any.pb.h>
 #include <serialization_session.h>
 #include <lv_message.h>
+#include <climits>
+
+//---------------------------------------------------------------------
+// Serializes the message straight into the LabVIEW byte array, sized
+// from the computed size of the message.
+//---------------------------------------------------------------------
+static bool SerializeToLVBuffer(const grpc_labview::LVMessage& message, grpc_labview::LV1DArrayHandle* lvBuffer)
+{
+    auto size = message.ByteSizeLong();
+    if (size > INT_MAX)
+    {
+        return false;
+    }
+    if (grpc_labview::NumericArrayResize(0x01, 1, lvBuffer, size) != 0)
+    {
+        return false;
+    }
+    (**lvBuffer)->cnt = (int)size;
+    message.SerializeWithCachedSizesToArray((**lvBuffer)->bytes<uint8_t>());
+    return true;
+}
 
 //---------------------------------------------------------------------
 //---------------------------------------------------------------------
@@ -46,16 +67,7 @@ LIBRARY_EXPORT int32_t PackToBuffer(grpc_labview::gRPCid* id, const char* messag
     {
         return e.code;
     }
-    std::string buffer;
-    if (message.SerializeToString(&buffer))
-    {
-        NumericArrayResize(0x01, 1, lvBuffer, buffer.length());
-        (**lvBuffer)->cnt = buffer.length();
-        uint8_t* elements = (**lvBuffer)->bytes<uint8_t>();
-        memcpy(elements, buffer.c_str(), buffer.length());
-        return 0;
-    }
-    return -2;
+    return SerializeToLVBuffer(message, lvBuffer) ? 0 : -2;
 }
 
 //---------------------------------------------------------------------
@@ -179,7 +191,8 @@ LIBRARY_EXPORT int32_t AnyBuilderBeginNestedMessage(grpc_labview::gRPCid* builde
 
     auto nested = std::make_shared<grpc_labview::LVMessage>(metadata);
     auto value = std::make_shared<grpc_labview::LVNestedMessageMessageValue>(protobufIndex, nested);
-    message->_values.emplace(protobufIndex, value);
+    auto element = message->_metadata->FindOrAddElement(grpc_labview::LVMessageMetadataType::MessageValue, false, protobufIndex);
+    message->_values.Set(*element, value);
     *nestedId = nested.get();
     return 0; 
 }
@@ -189,11 +202,9 @@ LIBRARY_EXPORT int32_t AnyBuilderBeginNestedMessage(grpc_labview::gRPCid* builde
 LIBRARY_EXPORT int32_t AnyBuilderBeginRepeatedNestedMessage(grpc_labview::gRPCid* builderId, int protobufIndex, grpc_labview::gRPCid** nestedId)
 {   
     auto message = builderId->CastTo<grpc_labview::LVMessage>();
-    auto metadata = std::make_shared<grpc_labview::MessageMetadata>();
-
-    auto value = std::make_shared<grpc_labview::LVRepeatedNestedMessageMessageValue>(protobufIndex);
-    message->_values.emplace(protobufIndex, value);
-    *nestedId = value.get();
+    auto element = message->_metadata->FindOrAddElement(grpc_labview::LVMessageMetadataType::MessageValue, true, protobufIndex);
+    auto value = message->_values.Repeated<grpc_labview::LVRepeatedNestedMessageMessageValue>(*element);
+    *nestedId = value;
     return 0; 
 }
 
@@ -216,16 +227,7 @@ LIBRARY_EXPORT int32_t AnyBuilderBuildToBuffer(grpc_labview::gRPCid* builderId,
 {   
     auto message = builderId->CastTo<grpc_labview::LVMessage>();
     grpc_labview::gPointerManager.UnregisterPointer(builderId);
-    std::string buffer;
-    if (message->SerializeToString(&buffer))
-    {
-        grpc_labview::NumericArrayResize(0x01, 1, lvBuffer, buffer.length());
-        (**lvBuffer)->cnt = buffer.length();
-        uint8_t* elements = (**lvBuffer)->bytes<uint8_t>();
-        memcpy(elements, buffer.c_str(), buffer.length());
-        return 0;
-    }
-    return -2;
+    return SerializeToLVBuffer(*message, lvBuffer) ? 0 : -2;
 }
 
 //---------------------------------------------------------------------
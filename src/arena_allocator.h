@@ -0,0 +1,80 @@
+//---------------------------------------------------------------------
+// Allocation of message values on a protobuf Arena
+//---------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+#include <google/protobuf/arena.h>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace grpc_labview
+{
+    //---------------------------------------------------------------------
+    // Allocator for std::allocate_shared and standard containers that takes
+    // memory from a protobuf Arena, or from the heap when the arena is null.
+    // Objects are still destroyed when their last reference goes, the memory
+    // they used is only released in bulk with the arena.
+    //---------------------------------------------------------------------
+    template <typename T>
+    class ArenaAllocator
+    {
+    public:
+        typedef T value_type;
+
+        ArenaAllocator(google::protobuf::Arena* arena) :
+            _arena(arena)
+        {
+        }
+
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U>& other) :
+            _arena(other._arena)
+        {
+        }
+
+        T* allocate(size_t n)
+        {
+            if (_arena == nullptr)
+            {
+                return static_cast<T*>(::operator new(n * sizeof(T)));
+            }
+            return static_cast<T*>(_arena->AllocateAligned(n * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T* block, size_t n)
+        {
+            if (_arena == nullptr)
+            {
+                ::operator delete(block);
+            }
+        }
+
+        template <typename U>
+        bool operator==(const ArenaAllocator<U>& other) const
+        {
+            return _arena == other._arena;
+        }
+
+        template <typename U>
+        bool operator!=(const ArenaAllocator<U>& other) const
+        {
+            return _arena != other._arena;
+        }
+
+    public:
+        google::protobuf::Arena* _arena;
+    };
+
+    //---------------------------------------------------------------------
+    // std::make_shared that places the object and its control block on the
+    // arena, or on the heap when the arena is null.
+    //---------------------------------------------------------------------
+    template <typename T, typename... TArgs>
+    std::shared_ptr<T> ArenaMakeShared(google::protobuf::Arena* arena, TArgs&&... args)
+    {
+        return std::allocate_shared<T>(ArenaAllocator<T>(arena), std::forward<TArgs>(args)...);
+    }
+}
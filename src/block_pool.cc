@@ -0,0 +1,156 @@
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+#include <block_pool.h>
+#include <cstdlib>
+#include <new>
+
+namespace grpc_labview
+{
+    //---------------------------------------------------------------------
+    // Every block starts with a header that points back to the pool that owns
+    // it, or is null for blocks that were too large for the pool.
+    //---------------------------------------------------------------------
+    struct alignas(std::max_align_t) BlockHeader
+    {
+        BlockPool* pool;
+    };
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    BlockPool::BlockPool() :
+        _blockSize(0),
+        _outstandingBlocks(0),
+        _destroyed(false),
+        _heapAllocations(0),
+        _reusedAllocations(0)
+    {
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    BlockPool::~BlockPool()
+    {
+        for (auto block : _freeBlocks)
+        {
+            free(block);
+        }
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void* BlockPool::Allocate(size_t size)
+    {
+        BlockHeader* header = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_blockSize == 0)
+            {
+                _blockSize = size;
+            }
+            if (size <= _blockSize)
+            {
+                if (!_freeBlocks.empty())
+                {
+                    header = static_cast<BlockHeader*>(_freeBlocks.back());
+                    _freeBlocks.pop_back();
+                    ++_reusedAllocations;
+                }
+                else
+                {
+                    header = static_cast<BlockHeader*>(malloc(sizeof(BlockHeader) + _blockSize));
+                    if (header == nullptr)
+                    {
+                        throw std::bad_alloc();
+                    }
+                    ++_heapAllocations;
+                    // Reserve room for the block on the free list now so that releasing it never allocates.
+                    _freeBlocks.reserve(_outstandingBlocks + 1);
+                }
+                header->pool = this;
+                ++_outstandingBlocks;
+            }
+        }
+        if (header == nullptr)
+        {
+            header = static_cast<BlockHeader*>(malloc(sizeof(BlockHeader) + size));
+            if (header == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+            header->pool = nullptr;
+            ++_heapAllocations;
+        }
+        return header + 1;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void BlockPool::Release(void* block)
+    {
+        if (block == nullptr)
+        {
+            return;
+        }
+        auto header = static_cast<BlockHeader*>(block) - 1;
+        if (header->pool == nullptr)
+        {
+            free(header);
+            return;
+        }
+        header->pool->ReleaseBlock(header);
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void BlockPool::ReleaseBlock(void* header)
+    {
+        bool deletePool = false;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            --_outstandingBlocks;
+            if (_destroyed)
+            {
+                free(header);
+                deletePool = _outstandingBlocks == 0;
+            }
+            else
+            {
+                _freeBlocks.push_back(header);
+            }
+        }
+        if (deletePool)
+        {
+            delete this;
+        }
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void BlockPool::Destroy()
+    {
+        bool deletePool = false;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _destroyed = true;
+            deletePool = _outstandingBlocks == 0;
+        }
+        if (deletePool)
+        {
+            delete this;
+        }
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    uint64_t BlockPool::HeapAllocations()
+    {
+        return _heapAllocations;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    uint64_t BlockPool::ReusedAllocations()
+    {
+        return _reusedAllocations;
+    }
+}
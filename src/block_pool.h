@@ -0,0 +1,122 @@
+//---------------------------------------------------------------------
+// Recycling pool for fixed size memory blocks
+//---------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace grpc_labview
+{
+    //---------------------------------------------------------------------
+    // Keeps released memory blocks on a free list so that objects which are
+    // created and destroyed for every call do not go back to the heap.
+    // The block size is set by the first allocation, larger requests are
+    // served from the heap. Blocks may be released from any thread and the
+    // pool stays alive until the last of its blocks is released.
+    //---------------------------------------------------------------------
+    class BlockPool
+    {
+    public:
+        BlockPool();
+        BlockPool(const BlockPool&) = delete;
+        BlockPool& operator=(const BlockPool&) = delete;
+
+        void* Allocate(size_t size);
+        static void Release(void* block);
+
+        // Frees the pooled blocks, the pool is deleted once every outstanding block is released.
+        void Destroy();
+
+        uint64_t HeapAllocations();
+        uint64_t ReusedAllocations();
+
+    private:
+        ~BlockPool();
+        void ReleaseBlock(void* header);
+
+    private:
+        std::mutex _mutex;
+        std::vector<void*> _freeBlocks;
+        size_t _blockSize;
+        size_t _outstandingBlocks;
+        bool _destroyed;
+        std::atomic<uint64_t> _heapAllocations;
+        std::atomic<uint64_t> _reusedAllocations;
+    };
+
+    //---------------------------------------------------------------------
+    // Base class for objects that are allocated from a BlockPool with
+    // new (pool) T(...) and returned to it by delete.
+    //---------------------------------------------------------------------
+    class PooledObject
+    {
+    public:
+        static void* operator new(size_t size, BlockPool* pool)
+        {
+            return pool->Allocate(size);
+        }
+
+        static void operator delete(void* block, BlockPool* pool)
+        {
+            BlockPool::Release(block);
+        }
+
+        static void operator delete(void* block)
+        {
+            BlockPool::Release(block);
+        }
+    };
+
+    //---------------------------------------------------------------------
+    // Allocator for std::allocate_shared that places the object and its
+    // control block in a BlockPool.
+    //---------------------------------------------------------------------
+    template <typename T>
+    class PoolAllocator
+    {
+    public:
+        typedef T value_type;
+
+        PoolAllocator(BlockPool* pool) :
+            _pool(pool)
+        {
+        }
+
+        template <typename U>
+        PoolAllocator(const PoolAllocator<U>& other) :
+            _pool(other._pool)
+        {
+        }
+
+        T* allocate(size_t n)
+        {
+            return static_cast<T*>(_pool->Allocate(n * sizeof(T)));
+        }
+
+        void deallocate(T* block, size_t n)
+        {
+            BlockPool::Release(block);
+        }
+
+        template <typename U>
+        bool operator==(const PoolAllocator<U>& other) const
+        {
+            return _pool == other._pool;
+        }
+
+        template <typename U>
+        bool operator!=(const PoolAllocator<U>& other) const
+        {
+            return _pool != other._pool;
+        }
+
+    public:
+        BlockPool* _pool;
+    };
+}
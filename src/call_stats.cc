@@ -0,0 +1,223 @@
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+#include <call_stats.h>
+#include <cmath>
+
+namespace grpc_labview
+{
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    static std::atomic<int> gNextShard(0);
+
+    //---------------------------------------------------------------------
+    // Index of the highest set bit, value must not be zero.
+    //---------------------------------------------------------------------
+    static int HighestBit(uint64_t value)
+    {
+        int bit = 0;
+        for (int shift = 32; shift > 0; shift >>= 1)
+        {
+            if (value >> shift)
+            {
+                value >>= shift;
+                bit += shift;
+            }
+        }
+        return bit;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    double HistogramSnapshot::Mean() const
+    {
+        return count == 0 ? 0 : (double)sum / count;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    uint64_t HistogramSnapshot::ValueAtQuantile(double quantile) const
+    {
+        if (count == 0)
+        {
+            return 0;
+        }
+        auto target = (uint64_t)std::ceil(quantile * count);
+        if (target == 0)
+        {
+            target = 1;
+        }
+        uint64_t seen = 0;
+        for (int x = 0; x < (int)buckets.size(); ++x)
+        {
+            seen += buckets[x];
+            if (seen >= target)
+            {
+                return Histogram::BucketValue(x);
+            }
+        }
+        return Histogram::BucketValue((int)buckets.size() - 1);
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    Histogram::Shard::Shard() :
+        sum(0)
+    {
+        for (auto& bucket : buckets)
+        {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    Histogram::Histogram()
+    {
+        for (auto& shard : _shards)
+        {
+            shard.store(nullptr);
+        }
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    Histogram::~Histogram()
+    {
+        for (auto& shard : _shards)
+        {
+            delete shard.load();
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Values below kSubBucketCount get a bucket each, larger values share
+    // kSubBucketCount buckets per power of two.
+    //---------------------------------------------------------------------
+    int Histogram::BucketIndex(uint64_t value)
+    {
+        if (value < kSubBucketCount)
+        {
+            return (int)value;
+        }
+        auto exponent = HighestBit(value);
+        if (exponent > kMaxExponent)
+        {
+            return kBucketCount - 1;
+        }
+        auto subBucket = (int)(value >> (exponent - kSubBucketBits)) & (kSubBucketCount - 1);
+        return (exponent - kSubBucketBits + 1) * kSubBucketCount + subBucket;
+    }
+
+    //---------------------------------------------------------------------
+    // The middle of the range of values counted by the bucket.
+    //---------------------------------------------------------------------
+    uint64_t Histogram::BucketValue(int index)
+    {
+        if (index < kSubBucketCount)
+        {
+            return index;
+        }
+        auto exponent = index / kSubBucketCount + kSubBucketBits - 1;
+        auto subBucket = (uint64_t)(index % kSubBucketCount);
+        auto width = (uint64_t)1 << (exponent - kSubBucketBits);
+        return ((kSubBucketCount + subBucket) << (exponent - kSubBucketBits)) + width / 2;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    Histogram::Shard* Histogram::GetShard()
+    {
+        static thread_local int threadShard = gNextShard++ % kShardCount;
+        auto shard = _shards[threadShard].load(std::memory_order_acquire);
+        if (shard == nullptr)
+        {
+            auto created = new Shard();
+            if (_shards[threadShard].compare_exchange_strong(shard, created))
+            {
+                shard = created;
+            }
+            else
+            {
+                // Another thread of the same shard got there first.
+                delete created;
+            }
+        }
+        return shard;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void Histogram::Record(uint64_t value)
+    {
+        auto shard = GetShard();
+        shard->buckets[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        shard->sum.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    //---------------------------------------------------------------------
+    // Values recorded while the histogram is reset may be kept or dropped.
+    //---------------------------------------------------------------------
+    void Histogram::Reset()
+    {
+        for (auto& entry : _shards)
+        {
+            auto shard = entry.load(std::memory_order_acquire);
+            if (shard == nullptr)
+            {
+                continue;
+            }
+            for (auto& bucket : shard->buckets)
+            {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+            shard->sum.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    HistogramSnapshot Histogram::Snapshot()
+    {
+        HistogramSnapshot snapshot = { 0, 0, std::vector<uint64_t>((size_t)kBucketCount, 0) };
+        for (auto& entry : _shards)
+        {
+            auto shard = entry.load(std::memory_order_acquire);
+            if (shard == nullptr)
+            {
+                continue;
+            }
+            for (int x = 0; x < kBucketCount; ++x)
+            {
+                auto count = shard->buckets[x].load(std::memory_order_relaxed);
+                snapshot.buckets[x] += count;
+                snapshot.count += count;
+            }
+            snapshot.sum += shard->sum.load(std::memory_order_relaxed);
+        }
+        return snapshot;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void MethodStats::Record(CallMetric metric, uint64_t value)
+    {
+        _metrics[(int)metric].Record(value);
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void MethodStats::Reset()
+    {
+        for (auto& metric : _metrics)
+        {
+            metric.Reset();
+        }
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    HistogramSnapshot MethodStats::Snapshot(CallMetric metric)
+    {
+        return _metrics[(int)metric].Snapshot();
+    }
+}
@@ -0,0 +1,100 @@
+//---------------------------------------------------------------------
+// Per method histograms of call phase latencies and message sizes
+//---------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace grpc_labview
+{
+    //---------------------------------------------------------------------
+    // What is recorded for every call of a method. Latencies are recorded in
+    // nanoseconds and message sizes in bytes.
+    //---------------------------------------------------------------------
+    enum class CallMetric
+    {
+        AcceptToParse,   // Call accepted until its first request is received
+        Parse,           // Parsing a request
+        PostToPickup,    // Server event posted until the first GetRequestData
+        Handling,        // First GetRequestData until CloseServerEvent
+        Serialize,       // Serializing a response
+        WriteComplete,   // Response write started until gRPC completed it
+        RequestBytes,
+        ResponseBytes,
+        Count
+    };
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    struct HistogramSnapshot
+    {
+        uint64_t count;
+        uint64_t sum;
+        std::vector<uint64_t> buckets;
+
+        double Mean() const;
+        // Value below which the given fraction of the recorded values fall.
+        uint64_t ValueAtQuantile(double quantile) const;
+    };
+
+    //---------------------------------------------------------------------
+    // Log linear histogram in the style of HdrHistogram: every power of two
+    // is split into eight buckets, so a value is known to within 12.5%.
+    //
+    // Counts are kept in shards, and a thread always records into the same
+    // shard with relaxed atomic adds, so recording takes no lock and threads
+    // rarely share a cache line. A shard is allocated the first time it is
+    // used.
+    //---------------------------------------------------------------------
+    class Histogram
+    {
+    public:
+        static const int kSubBucketBits = 3;
+        static const int kSubBucketCount = 1 << kSubBucketBits;
+        static const int kMaxExponent = 40;
+        static const int kBucketCount = (kMaxExponent - kSubBucketBits + 2) * kSubBucketCount;
+        static const int kShardCount = 8;
+
+        Histogram();
+        ~Histogram();
+        Histogram(const Histogram&) = delete;
+        Histogram& operator=(const Histogram&) = delete;
+
+        void Record(uint64_t value);
+        void Reset();
+        HistogramSnapshot Snapshot();
+
+        static int BucketIndex(uint64_t value);
+        static uint64_t BucketValue(int index);
+
+    private:
+        struct Shard
+        {
+            Shard();
+
+            std::atomic<uint64_t> buckets[kBucketCount];
+            std::atomic<uint64_t> sum;
+        };
+
+        std::atomic<Shard*> _shards[kShardCount];
+
+        Shard* GetShard();
+    };
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    class MethodStats
+    {
+    public:
+        void Record(CallMetric metric, uint64_t value);
+        void Reset();
+        HistogramSnapshot Snapshot(CallMetric metric);
+
+    private:
+        Histogram _metrics[(int)CallMetric::Count];
+    };
+}
@@ -17,68 +17,68 @@ namespace grpc_labview {
     // cluster: Pointer to the cluster created by LabVIEW
     void ClusterDataCopier::CopyToCluster(const LVMessage& message, int8_t* cluster)
     {
-        for (auto& indexAndValue : message._values)
+        for (size_t x = 0; x < message._values.size(); ++x)
         {
-            auto& value = indexAndValue.second;
-            auto it = message._metadata->_mappedElements.find(value->_protobufId);
-            if (it != message._metadata->_mappedElements.end())
+            auto& slot = message._values[x];
+            if (!slot.isSet)
             {
-                auto& fieldMetadata = it->second;
-                auto start = cluster + fieldMetadata->clusterOffset;;
-                switch (fieldMetadata->type)
-                {
-                case LVMessageMetadataType::StringValue:
-                    CopyStringToCluster(fieldMetadata, start, value);
-                    break;
-                case LVMessageMetadataType::BytesValue:
-                    CopyBytesToCluster(fieldMetadata, start, value);
-                    break;
-                case LVMessageMetadataType::BoolValue:
-                    CopyBoolToCluster(fieldMetadata, start, value);
-                    break;
-                case LVMessageMetadataType::DoubleValue:
-                    CopyDoubleToCluster(fieldMetadata, start, value);
-                    break;
-                case LVMessageMetadataType::FloatValue:
-                    CopyFloatToCluster(fieldMetadata, start, value);
-                    break;
-                case LVMessageMetadataType::Int32Value:
-                    CopyInt32ToCluster(fieldMetadata, start, value);
-                    break;
-                case LVMessageMetadataType::MessageValue:
-                    CopyMessageToCluster(fieldMetadata, start, value);
-                    break;
-                case LVMessageMetadataType::Int64Value:
-                    CopyInt64ToCluster(fieldMetadata, start, value);
-                    break;
-                case LVMessageMetadataType::UInt32Value:
-                    CopyUInt32ToCluster(fieldMetadata, start, value);
-                    break;
-                case LVMessageMetadataType::UInt64Value:
-                    CopyUInt64ToCluster(fieldMetadata, start, value);
-                    break;
-                case LVMessageMetadataType::EnumValue:
-                    CopyEnumToCluster(fieldMetadata, start, value);
-                    break;
-                case LVMessageMetadataType::SInt32Value:
-                    CopySInt32ToCluster(fieldMetadata, start, value);
-                    break;
-                case LVMessageMetadataType::SInt64Value:
-                    CopySInt64ToCluster(fieldMetadata, start, value);
-                    break;
-                case LVMessageMetadataType::Fixed32Value:
-                    CopyFixed32ToCluster(fieldMetadata, start, value);
-                    break;
-                case LVMessageMetadataType::Fixed64Value:
-                    CopyFixed64ToCluster(fieldMetadata, start, value);
-                    break;
-                case LVMessageMetadataType::SFixed32Value:
-                    CopySFixed32ToCluster(fieldMetadata, start, value);
-                    break;
-                case LVMessageMetadataType::SFixed64Value:
-                    CopySFixed64ToCluster(fieldMetadata, start, value);
-                    break;
-                }
+                continue;
+            }
+            auto& fieldMetadata = message._metadata->_elements[x];
+            auto start = cluster + fieldMetadata->clusterOffset;
+            switch (fieldMetadata->type)
+            {
+            case LVMessageMetadataType::StringValue:
+                CopyStringToCluster(fieldMetadata, start, slot);
+                break;
+            case LVMessageMetadataType::BytesValue:
+                CopyBytesToCluster(fieldMetadata, start, slot);
+                break;
+            case LVMessageMetadataType::BoolValue:
+                CopyBoolToCluster(fieldMetadata, start, slot);
+                break;
+            case LVMessageMetadataType::DoubleValue:
+                CopyDoubleToCluster(fieldMetadata, start, slot);
+                break;
+            case LVMessageMetadataType::FloatValue:
+                CopyFloatToCluster(fieldMetadata, start, slot);
+                break;
+            case LVMessageMetadataType::Int32Value:
+                CopyInt32ToCluster(fieldMetadata, start, slot);
+                break;
+            case LVMessageMetadataType::MessageValue:
+                CopyMessageToCluster(fieldMetadata, start, slot);
+                break;
+            case LVMessageMetadataType::Int64Value:
+                CopyInt64ToCluster(fieldMetadata, start, slot);
+                break;
+            case LVMessageMetadataType::UInt32Value:
+                CopyUInt32ToCluster(fieldMetadata, start, slot);
+                break;
+            case LVMessageMetadataType::UInt64Value:
+                CopyUInt64ToCluster(fieldMetadata, start, slot);
+                break;
+            case LVMessageMetadataType::EnumValue:
+                CopyEnumToCluster(fieldMetadata, start, slot);
+                break;
+            case LVMessageMetadataType::SInt32Value:
+                CopySInt32ToCluster(fieldMetadata, start, slot);
+                break;
+            case LVMessageMetadataType::SInt64Value:
+                CopySInt64ToCluster(fieldMetadata, start, slot);
+                break;
+            case LVMessageMetadataType::Fixed32Value:
+                CopyFixed32ToCluster(fieldMetadata, start, slot);
+                break;
+            case LVMessageMetadataType::Fixed64Value:
+                CopyFixed64ToCluster(fieldMetadata, start, slot);
+                break;
+            case LVMessageMetadataType::SFixed32Value:
+                CopySFixed32ToCluster(fieldMetadata, start, slot);
+                break;
+            case LVMessageMetadataType::SFixed64Value:
+                CopySFixed64ToCluster(fieldMetadata, start, slot);
+                break;
             }
         }
 
@@ -169,6 +169,7 @@ namespace grpc_labview {
                 break;
             case LVMessageMetadataType::Fixed32Value:
                 CopyFixed32FromCluster(fieldMetadata, start, message);
+                break;
             case LVMessageMetadataType::Fixed64Value:
                 CopyFixed64FromCluster(fieldMetadata, start, message);
                 break;
@@ -187,7 +188,7 @@ namespace grpc_labview {
     //---------------------------------------------------------------------
     bool ClusterDataCopier::AnyBuilderAddValue(LVMessage& message, LVMessageMetadataType valueType, bool isRepeated, int protobufIndex, int8_t* value)
     {
-        auto metadata = std::make_shared<MessageElementMetadata>(valueType, isRepeated, protobufIndex);
+        auto metadata = message._metadata->FindOrAddElement(valueType, isRepeated, protobufIndex);
 
         switch (valueType)
         {
@@ -251,11 +252,11 @@ namespace grpc_labview {
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    void ClusterDataCopier::CopyStringToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value)
+    void ClusterDataCopier::CopyStringToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot)
     {
         if (metadata->isRepeated)
         {
-            auto repeatedString = static_cast<const LVRepeatedMessageValue<std::string>&>(*value);
+            auto& repeatedString = static_cast<const LVRepeatedMessageValue<std::string>&>(*slot.value);
             if (repeatedString._value.size() != 0)
             {
                 NumericArrayResize(GetTypeCodeForSize(sizeof(LStrHandle)), 1, start, repeatedString._value.size());
@@ -273,15 +274,15 @@ namespace grpc_labview {
         }
         else
         {
-            SetLVString((LStrHandle*)start, ((LVStringMessageValue*)value.get())->_value);
+            SetLVString((LStrHandle*)start, ((LVStringMessageValue*)slot.value.get())->_value);
         }
     }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    void ClusterDataCopier::CopyBytesToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value)
+    void ClusterDataCopier::CopyBytesToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot)
     {
-        CopyStringToCluster(metadata, start, value);
+        CopyStringToCluster(metadata, start, slot);
     }
 
     //---------------------------------------------------------------------
@@ -292,21 +293,21 @@ namespace grpc_labview {
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    void ClusterDataCopier::CopyMessageToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value)
+    void ClusterDataCopier::CopyMessageToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot)
     {
         switch (metadata->wellKnownType)
         {
         case wellknown::Types::Double2DArray:
-            wellknown::Double2DArray::GetInstance().CopyFromMessageToCluster(*(metadata.get()), value, start);
+            wellknown::Double2DArray::GetInstance().CopyFromMessageToCluster(*(metadata.get()), slot.value, start);
             return;
         case wellknown::Types::String2DArray:
-            wellknown::String2DArray::GetInstance().CopyFromMessageToCluster(*(metadata.get()), value, start);
+            wellknown::String2DArray::GetInstance().CopyFromMessageToCluster(*(metadata.get()), slot.value, start);
             return;
         }
 
         if (metadata->isRepeated)
         {
-            auto repeatedNested = std::static_pointer_cast<const LVRepeatedNestedMessageMessageValue>(value);
+            auto repeatedNested = std::static_pointer_cast<const LVRepeatedNestedMessageMessageValue>(slot.value);
             if (repeatedNested->_value.size() != 0)
             {
                 auto nestedMetadata = repeatedNested->_value.front()->_metadata;
@@ -334,17 +335,17 @@ namespace grpc_labview {
         }
         else
         {
-            CopyToCluster(*((LVNestedMessageMessageValue*)value.get())->_value, start);
+            CopyToCluster(*((LVNestedMessageMessageValue*)slot.value.get())->_value, start);
         }
     }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    void ClusterDataCopier::CopyInt32ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value)
+    void ClusterDataCopier::CopyInt32ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot)
     {
         if (metadata->isRepeated)
         {
-            auto repeatedInt32 = std::static_pointer_cast<const LVRepeatedMessageValue<int>>(value);
+            auto repeatedInt32 = std::static_pointer_cast<const LVRepeatedMessageValue<int>>(slot.value);
             if (repeatedInt32->_value.size() != 0)
             {
                 NumericArrayResize(0x03, 1, start, repeatedInt32->_value.size());
@@ -356,17 +357,17 @@ namespace grpc_labview {
         }
         else
         {
-            *(int*)start = ((LVVariableMessageValue<int>*)value.get())->_value;
+            *(int*)start = slot.Scalar<int32_t>();
         }
     }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    void ClusterDataCopier::CopyUInt32ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value)
+    void ClusterDataCopier::CopyUInt32ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot)
     {
         if (metadata->isRepeated)
         {
-            auto repeatedUInt32 = std::static_pointer_cast<const LVRepeatedMessageValue<uint32_t>>(value);
+            auto repeatedUInt32 = std::static_pointer_cast<const LVRepeatedMessageValue<uint32_t>>(slot.value);
             if (repeatedUInt32->_value.size() != 0)
             {
                 NumericArrayResize(0x03, 1, start, repeatedUInt32->_value.size());
@@ -378,17 +379,17 @@ namespace grpc_labview {
         }
         else
         {
-            *(int*)start = ((LVVariableMessageValue<uint32_t>*)value.get())->_value;
+            *(int*)start = slot.Scalar<uint32_t>();
         }
     }
 
-    void ClusterDataCopier::CopyEnumToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value)
+    void ClusterDataCopier::CopyEnumToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot)
     {
         std::shared_ptr<EnumMetadata> enumMetadata = metadata->_owner->FindEnumMetadata(metadata->embeddedMessageName);
 
         if (metadata->isRepeated)
         {
-            auto repeatedEnum = std::static_pointer_cast<const LVRepeatedEnumMessageValue>(value);
+            auto repeatedEnum = std::static_pointer_cast<const LVRepeatedEnumMessageValue>(slot.value);
             int count = repeatedEnum->_value.size();
             // Map the repeatedEnum from protobuf to LV enum values.
             int32_t* mappedArray = (int32_t*)malloc(count * sizeof(int32_t));
@@ -412,18 +413,18 @@ namespace grpc_labview {
         }
         else
         {
-            auto enumValueFromPrtobuf = ((LVEnumMessageValue*)value.get())->_value;
+            auto enumValueFromPrtobuf = slot.Scalar<int32_t>();
             *(int*)start = enumMetadata->GetLVEnumValueFromProtoValue(enumValueFromPrtobuf);
         }
     }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    void ClusterDataCopier::CopyInt64ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value)
+    void ClusterDataCopier::CopyInt64ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot)
     {
         if (metadata->isRepeated)
         {
-            auto repeatedInt64 = std::static_pointer_cast<const LVRepeatedMessageValue<int64_t>>(value);
+            auto repeatedInt64 = std::static_pointer_cast<const LVRepeatedMessageValue<int64_t>>(slot.value);
             if (repeatedInt64->_value.size() != 0)
             {
                 NumericArrayResize(0x04, 1, start, repeatedInt64->_value.size());
@@ -435,17 +436,17 @@ namespace grpc_labview {
         }
         else
         {
-            *(int64_t*)start = ((LVVariableMessageValue<int64_t>*)value.get())->_value;
+            *(int64_t*)start = slot.Scalar<int64_t>();
         }
     }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    void ClusterDataCopier::CopyUInt64ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value)
+    void ClusterDataCopier::CopyUInt64ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot)
     {
         if (metadata->isRepeated)
         {
-            auto repeatedUInt64 = std::static_pointer_cast<const LVRepeatedMessageValue<uint64_t>>(value);
+            auto repeatedUInt64 = std::static_pointer_cast<const LVRepeatedMessageValue<uint64_t>>(slot.value);
             if (repeatedUInt64->_value.size() != 0)
             {
                 NumericArrayResize(0x08, 1, start, repeatedUInt64->_value.size());
@@ -457,17 +458,17 @@ namespace grpc_labview {
         }
         else
         {
-            *(uint64_t*)start = ((LVVariableMessageValue<uint64_t>*)value.get())->_value;
+            *(uint64_t*)start = slot.Scalar<uint64_t>();
         }
     }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    void ClusterDataCopier::CopyBoolToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value)
+    void ClusterDataCopier::CopyBoolToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot)
     {
         if (metadata->isRepeated)
         {
-            auto repeatedBoolean = std::static_pointer_cast<const LVRepeatedMessageValue<bool>>(value);
+            auto repeatedBoolean = std::static_pointer_cast<const LVRepeatedMessageValue<bool>>(slot.value);
             if (repeatedBoolean->_value.size() != 0)
             {
                 NumericArrayResize(0x01, 1, start, repeatedBoolean->_value.size());
@@ -479,17 +480,17 @@ namespace grpc_labview {
         }
         else
         {
-            *(bool*)start = ((LVVariableMessageValue<bool>*)value.get())->_value;
+            *(bool*)start = slot.Scalar<bool>();
         }
     }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    void ClusterDataCopier::CopyDoubleToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value)
+    void ClusterDataCopier::CopyDoubleToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot)
     {
         if (metadata->isRepeated)
         {
-            auto repeatedDouble = std::static_pointer_cast<const LVRepeatedMessageValue<double>>(value);
+            auto repeatedDouble = std::static_pointer_cast<const LVRepeatedMessageValue<double>>(slot.value);
             if (repeatedDouble->_value.size() != 0)
             {
                 auto array = *(LV1DArrayHandle*)start;
@@ -502,17 +503,17 @@ namespace grpc_labview {
         }
         else
         {
-            *(double*)start = ((LVVariableMessageValue<double>*)value.get())->_value;
+            *(double*)start = slot.Scalar<double>();
         }
     }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    void ClusterDataCopier::CopyFloatToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value)
+    void ClusterDataCopier::CopyFloatToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot)
     {
         if (metadata->isRepeated)
         {
-            auto repeatedFloat = std::static_pointer_cast<const LVRepeatedMessageValue<float>>(value);
+            auto repeatedFloat = std::static_pointer_cast<const LVRepeatedMessageValue<float>>(slot.value);
             if (repeatedFloat->_value.size() != 0)
             {
                 NumericArrayResize(0x03, 1, start, repeatedFloat->_value.size());
@@ -524,17 +525,17 @@ namespace grpc_labview {
         }
         else
         {
-            *(float*)start = ((LVVariableMessageValue<float>*)value.get())->_value;
+            *(float*)start = slot.Scalar<float>();
         }
     }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    void ClusterDataCopier::CopySInt32ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value)
+    void ClusterDataCopier::CopySInt32ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot)
     {
         if (metadata->isRepeated)
         {
-            auto repeatedSInt32 = std::static_pointer_cast<const LVRepeatedSInt32MessageValue>(value);
+            auto repeatedSInt32 = std::static_pointer_cast<const LVRepeatedSInt32MessageValue>(slot.value);
             if (repeatedSInt32->_value.size() != 0)
             {
                 NumericArrayResize(0x03, 1, start, repeatedSInt32->_value.size());
@@ -546,17 +547,17 @@ namespace grpc_labview {
         }
         else
         {
-            *(int32_t*)start = ((LVSInt32MessageValue*)value.get())->_value;
+            *(int32_t*)start = slot.Scalar<int32_t>();
         }
     }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    void ClusterDataCopier::CopySInt64ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value)
+    void ClusterDataCopier::CopySInt64ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot)
     {
         if (metadata->isRepeated)
         {
-            auto repeatedSInt64 = std::static_pointer_cast<const LVRepeatedSInt64MessageValue>(value);
+            auto repeatedSInt64 = std::static_pointer_cast<const LVRepeatedSInt64MessageValue>(slot.value);
             if (repeatedSInt64->_value.size() != 0)
             {
                 NumericArrayResize(0x04, 1, start, repeatedSInt64->_value.size());
@@ -568,17 +569,17 @@ namespace grpc_labview {
         }
         else
         {
-            *(int64_t*)start = ((LVSInt64MessageValue*)value.get())->_value;
+            *(int64_t*)start = slot.Scalar<int64_t>();
         }
     }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    void ClusterDataCopier::CopyFixed32ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value)
+    void ClusterDataCopier::CopyFixed32ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot)
     {
         if (metadata->isRepeated)
         {
-            auto repeated = std::static_pointer_cast<const LVRepeatedFixed32MessageValue>(value);
+            auto repeated = std::static_pointer_cast<const LVRepeatedFixed32MessageValue>(slot.value);
             if (repeated->_value.size() != 0)
             {
                 NumericArrayResize(0x03, 1, start, repeated->_value.size());
@@ -590,17 +591,17 @@ namespace grpc_labview {
         }
         else
         {
-            *(uint32_t*)start = ((LVFixed32MessageValue*)value.get())->_value;
+            *(uint32_t*)start = slot.Scalar<uint32_t>();
         }
     }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    void ClusterDataCopier::CopySFixed32ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value)
+    void ClusterDataCopier::CopySFixed32ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot)
     {
         if (metadata->isRepeated)
         {
-            auto repeated = std::static_pointer_cast<const LVRepeatedSFixed32MessageValue>(value);
+            auto repeated = std::static_pointer_cast<const LVRepeatedSFixed32MessageValue>(slot.value);
             if (repeated->_value.size() != 0)
             {
                 NumericArrayResize(0x03, 1, start, repeated->_value.size());
@@ -612,17 +613,17 @@ namespace grpc_labview {
         }
         else
         {
-            *(int32_t*)start = ((LVSFixed32MessageValue*)value.get())->_value;
+            *(int32_t*)start = slot.Scalar<int32_t>();
         }
     }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    void ClusterDataCopier::CopyFixed64ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value)
+    void ClusterDataCopier::CopyFixed64ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot)
     {
         if (metadata->isRepeated)
         {
-            auto repeated = std::static_pointer_cast<const LVRepeatedFixed64MessageValue>(value);
+            auto repeated = std::static_pointer_cast<const LVRepeatedFixed64MessageValue>(slot.value);
             if (repeated->_value.size() != 0)
             {
                 NumericArrayResize(0x04, 1, start, repeated->_value.size());
@@ -634,17 +635,17 @@ namespace grpc_labview {
         }
         else
         {
-            *(uint64_t*)start = ((LVFixed64MessageValue*)value.get())->_value;
+            *(uint64_t*)start = slot.Scalar<uint64_t>();
         }
     }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    void ClusterDataCopier::CopySFixed64ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value)
+    void ClusterDataCopier::CopySFixed64ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot)
     {
         if (metadata->isRepeated)
         {
-            auto repeated = std::static_pointer_cast<const LVRepeatedSFixed64MessageValue>(value);
+            auto repeated = std::static_pointer_cast<const LVRepeatedSFixed64MessageValue>(slot.value);
             if (repeated->_value.size() != 0)
             {
                 NumericArrayResize(0x04, 1, start, repeated->_value.size());
@@ -656,7 +657,7 @@ namespace grpc_labview {
         }
         else
         {
-            *(int64_t*)start = ((LVSFixed64MessageValue*)value.get())->_value;
+            *(int64_t*)start = slot.Scalar<int64_t>();
         }
     }
 
@@ -670,8 +671,7 @@ namespace grpc_labview {
             auto arraySize = (array && *array) ? (*array)->cnt : 0;
             if (arraySize != 0)
             {
-                auto repeatedStringValue = std::make_shared<LVRepeatedMessageValue<std::string>>(metadata->protobufIndex);
-                message._values.emplace(metadata->protobufIndex, repeatedStringValue);
+                auto repeatedStringValue = message._values.Repeated<LVRepeatedMessageValue<std::string>>(*metadata);
                 auto lvStr = (*array)->bytes<LStrHandle>();
                 repeatedStringValue->_value.Reserve(arraySize);
                 for (int x = 0; x < arraySize; ++x)
@@ -685,8 +685,8 @@ namespace grpc_labview {
         else
         {
             auto str = GetLVString(*(LStrHandle*)start);
-            auto stringValue = std::make_shared<LVStringMessageValue>(metadata->protobufIndex, str);
-            message._values.emplace(metadata->protobufIndex, stringValue);
+            auto stringValue = ArenaMakeShared<LVStringMessageValue>(message._values.GetArena(), metadata->protobufIndex, str);
+            message._values.Set(*metadata, stringValue);
         }
     }
 
@@ -707,8 +707,7 @@ namespace grpc_labview {
             if (array && *array && ((*array)->cnt != 0))
             {
                 auto count = (*array)->cnt;
-                auto repeatedValue = std::make_shared<LVRepeatedMessageValue<bool>>(metadata->protobufIndex);
-                message._values.emplace(metadata->protobufIndex, repeatedValue);
+                auto repeatedValue = message._values.Repeated<LVRepeatedMessageValue<bool>>(*metadata);
                 auto data = (*array)->bytes<bool>();
                 repeatedValue->_value.Reserve(count);
                 auto dest = repeatedValue->_value.AddNAlreadyReserved(count);
@@ -717,8 +716,7 @@ namespace grpc_labview {
         }
         else
         {
-            auto value = std::make_shared<LVVariableMessageValue<bool>>(metadata->protobufIndex, *(bool*)start);
-            message._values.emplace(metadata->protobufIndex, value);
+            message._values.SetScalar(*metadata, *(bool*)start);
         }
     }
 
@@ -732,8 +730,7 @@ namespace grpc_labview {
             if (array && *array && ((*array)->cnt != 0))
             {
                 auto count = (*array)->cnt;
-                auto repeatedValue = std::make_shared<LVRepeatedMessageValue<int>>(metadata->protobufIndex);
-                message._values.emplace(metadata->protobufIndex, repeatedValue);
+                auto repeatedValue = message._values.Repeated<LVRepeatedMessageValue<int>>(*metadata);
                 auto data = (*array)->bytes<int32_t>();
                 repeatedValue->_value.Reserve(count);
                 auto dest = repeatedValue->_value.AddNAlreadyReserved(count);
@@ -742,8 +739,7 @@ namespace grpc_labview {
         }
         else
         {
-            auto value = std::make_shared<LVVariableMessageValue<int>>(metadata->protobufIndex, *(int*)start);
-            message._values.emplace(metadata->protobufIndex, value);
+            message._values.SetScalar(*metadata, *(int*)start);
         }
     }
 
@@ -757,8 +753,7 @@ namespace grpc_labview {
             if (array && *array && ((*array)->cnt != 0))
             {
                 auto count = (*array)->cnt;
-                auto repeatedValue = std::make_shared<LVRepeatedMessageValue<uint32_t>>(metadata->protobufIndex);
-                message._values.emplace(metadata->protobufIndex, repeatedValue);
+                auto repeatedValue = message._values.Repeated<LVRepeatedMessageValue<uint32_t>>(*metadata);
                 auto data = (*array)->bytes<uint32_t>();
                 repeatedValue->_value.Reserve(count);
                 auto dest = repeatedValue->_value.AddNAlreadyReserved(count);
@@ -767,8 +762,7 @@ namespace grpc_labview {
         }
         else
         {
-            auto value = std::make_shared<LVVariableMessageValue<uint32_t>>(metadata->protobufIndex, *(uint32_t*)start);
-            message._values.emplace(metadata->protobufIndex, value);
+            message._values.SetScalar(*metadata, *(uint32_t*)start);
         }
     }
 
@@ -782,8 +776,7 @@ namespace grpc_labview {
             if (array && *array && ((*array)->cnt != 0))
             {
                 auto count = (*array)->cnt;
-                auto repeatedValue = std::make_shared<LVRepeatedEnumMessageValue>(metadata->protobufIndex);
-                message._values.emplace(metadata->protobufIndex, repeatedValue);
+                auto repeatedValue = message._values.Repeated<LVRepeatedEnumMessageValue>(*metadata);
                 auto data = (*array)->bytes<int32_t>();
 
                 // "data" has the array of enums sent from the LV side. Iterate this array, map each element to the equivalent proto
@@ -808,8 +801,7 @@ namespace grpc_labview {
         {
             auto enumValueFromLV = *(int32_t*)start;
             int protoValue = enumMetadata->GetProtoValueFromLVEnumValue(enumValueFromLV);
-            auto value = std::make_shared<LVEnumMessageValue>(metadata->protobufIndex, protoValue);
-            message._values.emplace(metadata->protobufIndex, value);
+            message._values.SetScalar(*metadata, protoValue);
         }
     }
 
@@ -823,8 +815,7 @@ namespace grpc_labview {
             if (array && *array && ((*array)->cnt != 0))
             {
                 auto count = (*array)->cnt;
-                auto repeatedValue = std::make_shared<LVRepeatedMessageValue<int64_t>>(metadata->protobufIndex);
-                message._values.emplace(metadata->protobufIndex, repeatedValue);
+                auto repeatedValue = message._values.Repeated<LVRepeatedMessageValue<int64_t>>(*metadata);
                 auto data = (*array)->bytes<int64_t>();
                 repeatedValue->_value.Reserve(count);
                 auto dest = repeatedValue->_value.AddNAlreadyReserved(count);
@@ -833,8 +824,7 @@ namespace grpc_labview {
         }
         else
         {
-            auto value = std::make_shared<LVVariableMessageValue<int64_t>>(metadata->protobufIndex, *(int64_t*)start);
-            message._values.emplace(metadata->protobufIndex, value);
+            message._values.SetScalar(*metadata, *(int64_t*)start);
         }
     }
 
@@ -848,8 +838,7 @@ namespace grpc_labview {
             if (array && *array && ((*array)->cnt != 0))
             {
                 auto count = (*array)->cnt;
-                auto repeatedValue = std::make_shared<LVRepeatedMessageValue<uint64_t>>(metadata->protobufIndex);
-                message._values.emplace(metadata->protobufIndex, repeatedValue);
+                auto repeatedValue = message._values.Repeated<LVRepeatedMessageValue<uint64_t>>(*metadata);
                 auto data = (*array)->bytes<uint64_t>();
                 repeatedValue->_value.Reserve(count);
                 auto dest = repeatedValue->_value.AddNAlreadyReserved(count);
@@ -858,8 +847,7 @@ namespace grpc_labview {
         }
         else
         {
-            auto value = std::make_shared<LVVariableMessageValue<uint64_t>>(metadata->protobufIndex, *(uint64_t*)start);
-            message._values.emplace(metadata->protobufIndex, value);
+            message._values.SetScalar(*metadata, *(uint64_t*)start);
         }
     }
 
@@ -873,8 +861,7 @@ namespace grpc_labview {
             if (array && *array && ((*array)->cnt != 0))
             {
                 auto count = (*array)->cnt;
-                auto repeatedValue = std::make_shared<LVRepeatedMessageValue<double>>(metadata->protobufIndex);
-                message._values.emplace(metadata->protobufIndex, repeatedValue);
+                auto repeatedValue = message._values.Repeated<LVRepeatedMessageValue<double>>(*metadata);
                 auto data = (*array)->bytes<double>();
                 repeatedValue->_value.Reserve(count);
                 auto dest = repeatedValue->_value.AddNAlreadyReserved(count);
@@ -883,8 +870,7 @@ namespace grpc_labview {
         }
         else
         {
-            auto value = std::make_shared<LVVariableMessageValue<double>>(metadata->protobufIndex, *(double*)start);
-            message._values.emplace(metadata->protobufIndex, value);
+            message._values.SetScalar(*metadata, *(double*)start);
         }
     }
 
@@ -898,8 +884,7 @@ namespace grpc_labview {
             if (array && *array && ((*array)->cnt != 0))
             {
                 auto count = (*array)->cnt;
-                auto repeatedValue = std::make_shared<LVRepeatedMessageValue<float>>(metadata->protobufIndex);
-                message._values.emplace(metadata->protobufIndex, repeatedValue);
+                auto repeatedValue = message._values.Repeated<LVRepeatedMessageValue<float>>(*metadata);
                 auto data = (*array)->bytes<float>();
                 repeatedValue->_value.Reserve(count);
                 auto dest = repeatedValue->_value.AddNAlreadyReserved(count);
@@ -908,8 +893,7 @@ namespace grpc_labview {
         }
         else
         {
-            auto value = std::make_shared<LVVariableMessageValue<float>>(metadata->protobufIndex, *(float*)start);
-            message._values.emplace(metadata->protobufIndex, value);
+            message._values.SetScalar(*metadata, *(float*)start);
         }
     }
 
@@ -936,13 +920,14 @@ namespace grpc_labview {
                 auto count = (*array)->cnt;
                 if (count != 0)
                 {
-                    auto repeatedValue = std::make_shared<LVRepeatedNestedMessageMessageValue>(metadata->protobufIndex);
-                    message._values.emplace(metadata->protobufIndex, repeatedValue);
+                    auto repeatedValue = message._values.Repeated<LVRepeatedNestedMessageMessageValue>(*metadata);
+                    auto arena = message._values.GetArena();
+                    repeatedValue->_value.reserve(repeatedValue->_value.size() + count);
 
                     for (int x = 0; x < count; ++x)
                     {
                         auto data = (LVCluster*)(*array)->bytes(nestedMetadata->clusterSize * x, nestedMetadata->alignmentRequirement);
-                        auto nested = std::make_shared<LVMessage>(nestedMetadata);
+                        auto nested = ArenaMakeShared<LVMessage>(arena, nestedMetadata, arena);
                         repeatedValue->_value.push_back(nested);
                         CopyFromCluster(*nested, (int8_t*)data);
                     }
@@ -951,10 +936,10 @@ namespace grpc_labview {
         }
         else
         {
-            auto nested = std::make_shared<LVMessage>(nestedMetadata);
+            auto arena = message._values.GetArena();
+            auto nested = ArenaMakeShared<LVMessage>(arena, nestedMetadata, arena);
             CopyFromCluster(*nested, start);
-            auto value = std::make_shared<LVNestedMessageMessageValue>(metadata->protobufIndex, nested);
-            message._values.emplace(metadata->protobufIndex, value);
+            message._values.Set(*metadata, ArenaMakeShared<LVNestedMessageMessageValue>(arena, metadata->protobufIndex, nested));
         }
     }
 
@@ -968,8 +953,7 @@ namespace grpc_labview {
             if (array && *array && ((*array)->cnt != 0))
             {
                 auto count = (*array)->cnt;
-                auto repeatedValue = std::make_shared<LVRepeatedSInt32MessageValue>(metadata->protobufIndex);
-                message._values.emplace(metadata->protobufIndex, repeatedValue);
+                auto repeatedValue = message._values.Repeated<LVRepeatedSInt32MessageValue>(*metadata);
                 auto data = (*array)->bytes<int32_t>();
                 repeatedValue->_value.Reserve(count);
                 auto dest = repeatedValue->_value.AddNAlreadyReserved(count);
@@ -978,8 +962,7 @@ namespace grpc_labview {
         }
         else
         {
-            auto value = std::make_shared<LVSInt32MessageValue>(metadata->protobufIndex, *(int*)start);
-            message._values.emplace(metadata->protobufIndex, value);
+            message._values.SetScalar(*metadata, *(int*)start);
         }
     }
 
@@ -993,8 +976,7 @@ namespace grpc_labview {
             if (array && *array && ((*array)->cnt != 0))
             {
                 auto count = (*array)->cnt;
-                auto repeatedValue = std::make_shared<LVRepeatedSInt64MessageValue>(metadata->protobufIndex);
-                message._values.emplace(metadata->protobufIndex, repeatedValue);
+                auto repeatedValue = message._values.Repeated<LVRepeatedSInt64MessageValue>(*metadata);
                 auto data = (*array)->bytes<int64_t>();
                 repeatedValue->_value.Reserve(count);
                 auto dest = repeatedValue->_value.AddNAlreadyReserved(count);
@@ -1003,8 +985,7 @@ namespace grpc_labview {
         }
         else
         {
-            auto value = std::make_shared<LVSInt64MessageValue>(metadata->protobufIndex, *(int64_t*)start);
-            message._values.emplace(metadata->protobufIndex, value);
+            message._values.SetScalar(*metadata, *(int64_t*)start);
         }
     }
 
@@ -1018,8 +999,7 @@ namespace grpc_labview {
             if (array && *array && ((*array)->cnt != 0))
             {
                 auto count = (*array)->cnt;
-                auto repeatedValue = std::make_shared<LVRepeatedFixed32MessageValue>(metadata->protobufIndex);
-                message._values.emplace(metadata->protobufIndex, repeatedValue);
+                auto repeatedValue = message._values.Repeated<LVRepeatedFixed32MessageValue>(*metadata);
                 auto data = (*array)->bytes<uint32_t>();
                 repeatedValue->_value.Reserve(count);
                 auto dest = repeatedValue->_value.AddNAlreadyReserved(count);
@@ -1028,8 +1008,7 @@ namespace grpc_labview {
         }
         else
         {
-            auto value = std::make_shared<LVFixed32MessageValue>(metadata->protobufIndex, *(uint32_t*)start);
-            message._values.emplace(metadata->protobufIndex, value);
+            message._values.SetScalar(*metadata, *(uint32_t*)start);
         }
     }
 
@@ -1043,8 +1022,7 @@ namespace grpc_labview {
             if (array && *array && ((*array)->cnt != 0))
             {
                 auto count = (*array)->cnt;
-                auto repeatedValue = std::make_shared<LVRepeatedFixed64MessageValue>(metadata->protobufIndex);
-                message._values.emplace(metadata->protobufIndex, repeatedValue);
+                auto repeatedValue = message._values.Repeated<LVRepeatedFixed64MessageValue>(*metadata);
                 auto data = (*array)->bytes<uint64_t>();
                 repeatedValue->_value.Reserve(count);
                 auto dest = repeatedValue->_value.AddNAlreadyReserved(count);
@@ -1053,8 +1031,7 @@ namespace grpc_labview {
         }
         else
         {
-            auto value = std::make_shared<LVFixed64MessageValue>(metadata->protobufIndex, *(uint64_t*)start);
-            message._values.emplace(metadata->protobufIndex, value);
+            message._values.SetScalar(*metadata, *(uint64_t*)start);
         }
     }
 
@@ -1068,8 +1045,7 @@ namespace grpc_labview {
             if (array && *array && ((*array)->cnt != 0))
             {
                 auto count = (*array)->cnt;
-                auto repeatedValue = std::make_shared<LVRepeatedSFixed32MessageValue>(metadata->protobufIndex);
-                message._values.emplace(metadata->protobufIndex, repeatedValue);
+                auto repeatedValue = message._values.Repeated<LVRepeatedSFixed32MessageValue>(*metadata);
                 auto data = (*array)->bytes<int32_t>();
                 repeatedValue->_value.Reserve(count);
                 auto dest = repeatedValue->_value.AddNAlreadyReserved(count);
@@ -1078,8 +1054,7 @@ namespace grpc_labview {
         }
         else
         {
-            auto value = std::make_shared<LVSFixed32MessageValue>(metadata->protobufIndex, *(int32_t*)start);
-            message._values.emplace(metadata->protobufIndex, value);
+            message._values.SetScalar(*metadata, *(int32_t*)start);
         }
     }
 
@@ -1093,8 +1068,7 @@ namespace grpc_labview {
             if (array && *array && ((*array)->cnt != 0))
             {
                 auto count = (*array)->cnt;
-                auto repeatedValue = std::make_shared<LVRepeatedSFixed64MessageValue>(metadata->protobufIndex);
-                message._values.emplace(metadata->protobufIndex, repeatedValue);
+                auto repeatedValue = message._values.Repeated<LVRepeatedSFixed64MessageValue>(*metadata);
                 auto data = (*array)->bytes<int64_t>();
                 repeatedValue->_value.Reserve(count);
                 auto dest = repeatedValue->_value.AddNAlreadyReserved(count);
@@ -1103,8 +1077,85 @@ namespace grpc_labview {
         }
         else
         {
-            auto value = std::make_shared<LVSFixed64MessageValue>(metadata->protobufIndex, *(int64_t*)start);
-            message._values.emplace(metadata->protobufIndex, value);
+            message._values.SetScalar(*metadata, *(int64_t*)start);
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Disposes of the string and array handles held by a cluster, including
+    // those of its nested clusters, and clears them.
+    //---------------------------------------------------------------------
+    void ClusterDataCopier::ReleaseClusterHandles(const MessageMetadata& metadata, int8_t* cluster)
+    {
+        for (auto& element : metadata._elements)
+        {
+            auto start = cluster + element->clusterOffset;
+            bool isString = element->type == LVMessageMetadataType::StringValue || element->type == LVMessageMetadataType::BytesValue;
+            bool isMessage = element->type == LVMessageMetadataType::MessageValue;
+            if (element->isRepeated)
+            {
+                auto array = *(LV1DArrayHandle*)start;
+                if (array == nullptr)
+                {
+                    continue;
+                }
+                if (*array != nullptr && isString)
+                {
+                    auto strings = (*array)->bytes<LStrHandle>();
+                    for (int x = 0; x < (*array)->cnt; ++x)
+                    {
+                        if (strings[x] != nullptr)
+                        {
+                            DSDisposeHandle(strings[x]);
+                        }
+                    }
+                }
+                else if (*array != nullptr && isMessage && element->wellKnownType == wellknown::Types::None)
+                {
+                    auto nestedMetadata = element->_owner->FindMetadata(element->embeddedMessageName);
+                    for (int x = 0; x < (*array)->cnt; ++x)
+                    {
+                        ReleaseClusterHandles(*nestedMetadata, (int8_t*)(*array)->bytes(x * nestedMetadata->clusterSize, nestedMetadata->alignmentRequirement));
+                    }
+                }
+                DSDisposeHandle(array);
+                *(LV1DArrayHandle*)start = nullptr;
+            }
+            else if (isString)
+            {
+                if (*(LStrHandle*)start != nullptr)
+                {
+                    DSDisposeHandle(*(LStrHandle*)start);
+                    *(LStrHandle*)start = nullptr;
+                }
+            }
+            else if (isMessage && element->wellKnownType != wellknown::Types::None)
+            {
+                auto array = *(LV2DArrayHandle*)start;
+                if (array == nullptr)
+                {
+                    continue;
+                }
+                if (*array != nullptr && element->wellKnownType == wellknown::Types::String2DArray)
+                {
+                    auto strings = (*array)->bytes<LStrHandle>();
+                    auto count = (*array)->dimensionSizes[0] * (*array)->dimensionSizes[1];
+                    for (int x = 0; x < count; ++x)
+                    {
+                        if (strings[x] != nullptr)
+                        {
+                            DSDisposeHandle(strings[x]);
+                        }
+                    }
+                }
+                DSDisposeHandle(array);
+                *(LV2DArrayHandle*)start = nullptr;
+            }
+            else if (isMessage)
+            {
+                auto nestedMetadata = element->_owner->FindMetadata(element->embeddedMessageName);
+                ReleaseClusterHandles(*nestedMetadata, start);
+            }
         }
     }
 }
\ No newline at end of file
@@ -25,25 +25,26 @@ namespace grpc_labview
         static void CopyToCluster(const LVMessage& message, int8_t* cluster);
         static void CopyFromCluster(LVMessage& message, int8_t* cluster);
         static bool AnyBuilderAddValue(LVMessage& message, LVMessageMetadataType valueType, bool isRepeated, int protobufIndex, int8_t* value);
+        static void ReleaseClusterHandles(const MessageMetadata& metadata, int8_t* cluster);
 
     private:
-        static void CopyStringToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value);
-        static void CopyBytesToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value);
-        static void CopyMessageToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value);
-        static void CopyInt32ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value);
-        static void CopyUInt32ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value);
-        static void CopyInt64ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value);
-        static void CopyUInt64ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value);
-        static void CopyEnumToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value);
-        static void CopyBoolToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value);
-        static void CopyDoubleToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value);
-        static void CopyFloatToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value);
-        static void CopySInt32ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value);
-        static void CopySInt64ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value);
-        static void CopyFixed32ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value);
-        static void CopyFixed64ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value);
-        static void CopySFixed32ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value);
-        static void CopySFixed64ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const std::shared_ptr<const LVMessageValue>& value);
+        static void CopyStringToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot);
+        static void CopyBytesToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot);
+        static void CopyMessageToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot);
+        static void CopyInt32ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot);
+        static void CopyUInt32ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot);
+        static void CopyInt64ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot);
+        static void CopyUInt64ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot);
+        static void CopyEnumToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot);
+        static void CopyBoolToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot);
+        static void CopyDoubleToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot);
+        static void CopyFloatToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot);
+        static void CopySInt32ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot);
+        static void CopySInt64ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot);
+        static void CopyFixed32ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot);
+        static void CopyFixed64ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot);
+        static void CopySFixed32ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot);
+        static void CopySFixed64ToCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, const LVValueSlot& slot);
 
         static void CopyStringFromCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, LVMessage& message);
         static void CopyBytesFromCluster(const std::shared_ptr<const MessageElementMetadata> metadata, int8_t* start, LVMessage& message);
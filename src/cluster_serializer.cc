@@ -0,0 +1,686 @@
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+#include <cluster_serializer.h>
+#include <enum_metadata.h>
+#include <metadata_owner.h>
+#include <well_known_messages.h>
+#include <google/protobuf/wire_format_lite.h>
+#include <grpc/slice.h>
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+using namespace google::protobuf::internal;
+using google::protobuf::uint8;
+using google::protobuf::io::EpsCopyOutputStream;
+
+namespace grpc_labview
+{
+    namespace
+    {
+        //---------------------------------------------------------------------
+        // Wire encoding of each numeric field type. Fixed width types are
+        // packed by copying the LabVIEW array as a single block, the native
+        // layout of every platform LabVIEW runs on is the little endian layout
+        // protobuf uses for packed fixed width values.
+        //---------------------------------------------------------------------
+        struct BoolWire
+        {
+            typedef bool Type;
+            static const bool isFixed = true;
+            static const WireFormatLite::WireType wireType = WireFormatLite::WIRETYPE_VARINT;
+            static size_t Size(bool value) { return WireFormatLite::kBoolSize; }
+            static uint8* Write(bool value, uint8* target) { return WireFormatLite::WriteBoolNoTagToArray(value, target); }
+        };
+
+        struct Int32Wire
+        {
+            typedef int32_t Type;
+            static const bool isFixed = false;
+            static const WireFormatLite::WireType wireType = WireFormatLite::WIRETYPE_VARINT;
+            static size_t Size(int32_t value) { return WireFormatLite::Int32Size(value); }
+            static uint8* Write(int32_t value, uint8* target) { return WireFormatLite::WriteInt32NoTagToArray(value, target); }
+        };
+
+        struct UInt32Wire
+        {
+            typedef uint32_t Type;
+            static const bool isFixed = false;
+            static const WireFormatLite::WireType wireType = WireFormatLite::WIRETYPE_VARINT;
+            static size_t Size(uint32_t value) { return WireFormatLite::UInt32Size(value); }
+            static uint8* Write(uint32_t value, uint8* target) { return WireFormatLite::WriteUInt32NoTagToArray(value, target); }
+        };
+
+        struct Int64Wire
+        {
+            typedef int64_t Type;
+            static const bool isFixed = false;
+            static const WireFormatLite::WireType wireType = WireFormatLite::WIRETYPE_VARINT;
+            static size_t Size(int64_t value) { return WireFormatLite::Int64Size(value); }
+            static uint8* Write(int64_t value, uint8* target) { return WireFormatLite::WriteInt64NoTagToArray(value, target); }
+        };
+
+        struct UInt64Wire
+        {
+            typedef uint64_t Type;
+            static const bool isFixed = false;
+            static const WireFormatLite::WireType wireType = WireFormatLite::WIRETYPE_VARINT;
+            static size_t Size(uint64_t value) { return WireFormatLite::UInt64Size(value); }
+            static uint8* Write(uint64_t value, uint8* target) { return WireFormatLite::WriteUInt64NoTagToArray(value, target); }
+        };
+
+        struct SInt32Wire
+        {
+            typedef int32_t Type;
+            static const bool isFixed = false;
+            static const WireFormatLite::WireType wireType = WireFormatLite::WIRETYPE_VARINT;
+            static size_t Size(int32_t value) { return WireFormatLite::SInt32Size(value); }
+            static uint8* Write(int32_t value, uint8* target) { return WireFormatLite::WriteSInt32NoTagToArray(value, target); }
+        };
+
+        struct SInt64Wire
+        {
+            typedef int64_t Type;
+            static const bool isFixed = false;
+            static const WireFormatLite::WireType wireType = WireFormatLite::WIRETYPE_VARINT;
+            static size_t Size(int64_t value) { return WireFormatLite::SInt64Size(value); }
+            static uint8* Write(int64_t value, uint8* target) { return WireFormatLite::WriteSInt64NoTagToArray(value, target); }
+        };
+
+        struct FloatWire
+        {
+            typedef float Type;
+            static const bool isFixed = true;
+            static const WireFormatLite::WireType wireType = WireFormatLite::WIRETYPE_FIXED32;
+            static size_t Size(float value) { return WireFormatLite::kFloatSize; }
+            static uint8* Write(float value, uint8* target) { return WireFormatLite::WriteFloatNoTagToArray(value, target); }
+        };
+
+        struct DoubleWire
+        {
+            typedef double Type;
+            static const bool isFixed = true;
+            static const WireFormatLite::WireType wireType = WireFormatLite::WIRETYPE_FIXED64;
+            static size_t Size(double value) { return WireFormatLite::kDoubleSize; }
+            static uint8* Write(double value, uint8* target) { return WireFormatLite::WriteDoubleNoTagToArray(value, target); }
+        };
+
+        struct Fixed32Wire
+        {
+            typedef uint32_t Type;
+            static const bool isFixed = true;
+            static const WireFormatLite::WireType wireType = WireFormatLite::WIRETYPE_FIXED32;
+            static size_t Size(uint32_t value) { return WireFormatLite::kFixed32Size; }
+            static uint8* Write(uint32_t value, uint8* target) { return WireFormatLite::WriteFixed32NoTagToArray(value, target); }
+        };
+
+        struct Fixed64Wire
+        {
+            typedef uint64_t Type;
+            static const bool isFixed = true;
+            static const WireFormatLite::WireType wireType = WireFormatLite::WIRETYPE_FIXED64;
+            static size_t Size(uint64_t value) { return WireFormatLite::kFixed64Size; }
+            static uint8* Write(uint64_t value, uint8* target) { return WireFormatLite::WriteFixed64NoTagToArray(value, target); }
+        };
+
+        struct SFixed32Wire
+        {
+            typedef int32_t Type;
+            static const bool isFixed = true;
+            static const WireFormatLite::WireType wireType = WireFormatLite::WIRETYPE_FIXED32;
+            static size_t Size(int32_t value) { return WireFormatLite::kSFixed32Size; }
+            static uint8* Write(int32_t value, uint8* target) { return WireFormatLite::WriteSFixed32NoTagToArray(value, target); }
+        };
+
+        struct SFixed64Wire
+        {
+            typedef int64_t Type;
+            static const bool isFixed = true;
+            static const WireFormatLite::WireType wireType = WireFormatLite::WIRETYPE_FIXED64;
+            static size_t Size(int64_t value) { return WireFormatLite::kSFixed64Size; }
+            static uint8* Write(int64_t value, uint8* target) { return WireFormatLite::WriteSFixed64NoTagToArray(value, target); }
+        };
+
+        //---------------------------------------------------------------------
+        //---------------------------------------------------------------------
+        int32_t LVStringLength(LStrHandle str)
+        {
+            return (str != nullptr && *str != nullptr) ? (*str)->cnt : 0;
+        }
+
+        //---------------------------------------------------------------------
+        //---------------------------------------------------------------------
+        int32_t LVArrayCount(LV1DArrayHandle array)
+        {
+            return (array != nullptr && *array != nullptr) ? (*array)->cnt : 0;
+        }
+
+        //---------------------------------------------------------------------
+        //---------------------------------------------------------------------
+        uint8* WriteLengthDelimitedHeader(int protobufIndex, size_t length, uint8* target, EpsCopyOutputStream* stream)
+        {
+            target = stream->EnsureSpace(target);
+            target = WireFormatLite::WriteTagToArray(protobufIndex, WireFormatLite::WIRETYPE_LENGTH_DELIMITED, target);
+            return WireFormatLite::WriteUInt32NoTagToArray(static_cast<uint32_t>(length), target);
+        }
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    ClusterSerializer::ClusterSerializer(std::shared_ptr<MessageMetadata> metadata, int8_t* cluster) :
+        _metadata(metadata),
+        _cluster(cluster),
+        _nextCachedSize(0)
+    {
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    size_t ClusterSerializer::ByteSizeLong()
+    {
+        _cachedSizes.clear();
+        _nextCachedSize = 0;
+        return MessageSize(*_metadata, _cluster);
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    uint8* ClusterSerializer::Serialize(uint8* target, EpsCopyOutputStream* stream)
+    {
+        _nextCachedSize = 0;
+        return SerializeMessage(*_metadata, _cluster, target, stream);
+    }
+
+    //---------------------------------------------------------------------
+    // Writes the message into a single slice allocated at its exact size
+    //---------------------------------------------------------------------
+    void ClusterSerializer::SerializeToByteBuffer(grpc::ByteBuffer* buffer)
+    {
+        auto size = ByteSizeLong();
+        auto slice = grpc_slice_malloc(size);
+        auto target = GRPC_SLICE_START_PTR(slice);
+        EpsCopyOutputStream stream(target, static_cast<int>(size), false);
+        Serialize(target, &stream);
+        grpc::Slice bufferSlice(slice, grpc::Slice::STEAL_REF);
+        grpc::ByteBuffer serialized(&bufferSlice, 1);
+        buffer->Swap(&serialized);
+    }
+
+    //---------------------------------------------------------------------
+    // The selected_index field of a oneof is internal book keeping and only
+    // the selected field of a oneof goes across the wire.
+    //---------------------------------------------------------------------
+    bool ClusterSerializer::IsFieldSerialized(const MessageMetadata& metadata, const MessageElementMetadata& field, int8_t* cluster)
+    {
+        if (!field.isInOneof)
+        {
+            return true;
+        }
+        if (field.protobufIndex < 0)
+        {
+            return false;
+        }
+        for (auto& element : metadata._elements)
+        {
+            if (element->isInOneof && element->protobufIndex < 0 && element->oneofContainerName == field.oneofContainerName)
+            {
+                auto selectedIndex = *(int*)(cluster + element->clusterOffset);
+                return selectedIndex == field.protobufIndex;
+            }
+        }
+        return false;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    size_t ClusterSerializer::MessageSize(const MessageMetadata& metadata, int8_t* cluster)
+    {
+        size_t totalSize = 0;
+        for (auto slot : metadata.SlotsByFieldNumber())
+        {
+            auto& field = metadata._elements[slot];
+            if (IsFieldSerialized(metadata, *field, cluster))
+            {
+                totalSize += FieldSize(*field, cluster + field->clusterOffset);
+            }
+        }
+        return totalSize;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    size_t ClusterSerializer::FieldSize(const MessageElementMetadata& field, int8_t* start)
+    {
+        size_t tagSize = WireFormatLite::TagSize(field.protobufIndex, WireFormatLite::TYPE_INT32);
+        switch (field.type)
+        {
+        case LVMessageMetadataType::StringValue:
+        case LVMessageMetadataType::BytesValue:
+            return StringFieldSize(field, tagSize, start);
+        case LVMessageMetadataType::MessageValue:
+            return MessageFieldSize(field, tagSize, start);
+        case LVMessageMetadataType::EnumValue:
+            return EnumFieldSize(field, tagSize, start);
+        case LVMessageMetadataType::BoolValue:
+            return NumericFieldSize<BoolWire>(field, tagSize, start);
+        case LVMessageMetadataType::Int32Value:
+            return NumericFieldSize<Int32Wire>(field, tagSize, start);
+        case LVMessageMetadataType::UInt32Value:
+            return NumericFieldSize<UInt32Wire>(field, tagSize, start);
+        case LVMessageMetadataType::Int64Value:
+            return NumericFieldSize<Int64Wire>(field, tagSize, start);
+        case LVMessageMetadataType::UInt64Value:
+            return NumericFieldSize<UInt64Wire>(field, tagSize, start);
+        case LVMessageMetadataType::SInt32Value:
+            return NumericFieldSize<SInt32Wire>(field, tagSize, start);
+        case LVMessageMetadataType::SInt64Value:
+            return NumericFieldSize<SInt64Wire>(field, tagSize, start);
+        case LVMessageMetadataType::FloatValue:
+            return NumericFieldSize<FloatWire>(field, tagSize, start);
+        case LVMessageMetadataType::DoubleValue:
+            return NumericFieldSize<DoubleWire>(field, tagSize, start);
+        case LVMessageMetadataType::Fixed32Value:
+            return NumericFieldSize<Fixed32Wire>(field, tagSize, start);
+        case LVMessageMetadataType::Fixed64Value:
+            return NumericFieldSize<Fixed64Wire>(field, tagSize, start);
+        case LVMessageMetadataType::SFixed32Value:
+            return NumericFieldSize<SFixed32Wire>(field, tagSize, start);
+        case LVMessageMetadataType::SFixed64Value:
+            return NumericFieldSize<SFixed64Wire>(field, tagSize, start);
+        }
+        return 0;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    size_t ClusterSerializer::StringFieldSize(const MessageElementMetadata& field, size_t tagSize, int8_t* start)
+    {
+        if (!field.isRepeated)
+        {
+            return tagSize + WireFormatLite::LengthDelimitedSize(LVStringLength(*(LStrHandle*)start));
+        }
+        auto array = *(LV1DArrayHandle*)start;
+        auto count = LVArrayCount(array);
+        if (count == 0)
+        {
+            return 0;
+        }
+        return StringsSize(tagSize, (*array)->bytes<LStrHandle>(), count);
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    size_t ClusterSerializer::StringsSize(size_t tagSize, LStrHandle* strings, int count)
+    {
+        size_t totalSize = tagSize * count;
+        for (int x = 0; x < count; ++x)
+        {
+            totalSize += WireFormatLite::LengthDelimitedSize(LVStringLength(strings[x]));
+        }
+        return totalSize;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    size_t ClusterSerializer::EnumFieldSize(const MessageElementMetadata& field, size_t tagSize, int8_t* start)
+    {
+        auto enumMetadata = field._owner->FindEnumMetadata(field.embeddedMessageName);
+        if (!field.isRepeated)
+        {
+            return tagSize + WireFormatLite::EnumSize(enumMetadata->GetProtoValueFromLVEnumValue(*(int32_t*)start));
+        }
+        auto array = *(LV1DArrayHandle*)start;
+        auto count = LVArrayCount(array);
+        if (count == 0)
+        {
+            return 0;
+        }
+        auto data = (*array)->bytes<int32_t>();
+        size_t dataSize = 0;
+        for (int x = 0; x < count; ++x)
+        {
+            dataSize += WireFormatLite::EnumSize(enumMetadata->GetProtoValueFromLVEnumValue(data[x]));
+        }
+        _cachedSizes.push_back(dataSize);
+        return tagSize + WireFormatLite::LengthDelimitedSize(dataSize);
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    size_t ClusterSerializer::MessageFieldSize(const MessageElementMetadata& field, size_t tagSize, int8_t* start)
+    {
+        if (field.wellKnownType != wellknown::Types::None)
+        {
+            return Array2DFieldSize(field, tagSize, start);
+        }
+
+        auto nestedMetadata = field._owner->FindMetadata(field.embeddedMessageName);
+        if (!field.isRepeated)
+        {
+            return tagSize + NestedMessageSize(*nestedMetadata, start);
+        }
+        auto array = *(LV1DArrayHandle*)start;
+        auto count = LVArrayCount(array);
+        size_t totalSize = tagSize * count;
+        for (int x = 0; x < count; ++x)
+        {
+            auto data = (int8_t*)(*array)->bytes(nestedMetadata->clusterSize * x, nestedMetadata->alignmentRequirement);
+            totalSize += NestedMessageSize(*nestedMetadata, data);
+        }
+        return totalSize;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    size_t ClusterSerializer::NestedMessageSize(const MessageMetadata& metadata, int8_t* cluster)
+    {
+        // Reserve the slot before the nested fields add theirs so the sizes stay in write order.
+        auto slot = _cachedSizes.size();
+        _cachedSizes.push_back(0);
+        auto messageSize = MessageSize(metadata, cluster);
+        _cachedSizes[slot] = messageSize;
+        return WireFormatLite::LengthDelimitedSize(messageSize);
+    }
+
+    //---------------------------------------------------------------------
+    // Well known 2D arrays are native LabVIEW 2D arrays in the cluster and
+    // a message with the rows, columns and flattened data on the wire.
+    //---------------------------------------------------------------------
+    size_t ClusterSerializer::Array2DFieldSize(const MessageElementMetadata& field, size_t tagSize, int8_t* start)
+    {
+        // LV doesn't support arrays of arrays so a 2D array field is never repeated.
+        assert(!field.isRepeated);
+
+        auto array = *(LV2DArrayHandle*)start;
+        if (array == nullptr || *array == nullptr)
+        {
+            return 0;
+        }
+        int rows = (*array)->dimensionSizes[0];
+        int columns = (*array)->dimensionSizes[1];
+        if (rows == 0 || columns == 0)
+        {
+            return 0;
+        }
+
+        auto slot = _cachedSizes.size();
+        _cachedSizes.push_back(0);
+        size_t messageSize = WireFormatLite::TagSize(wellknown::I2DArray::_rowsIndex, WireFormatLite::TYPE_INT32) + WireFormatLite::Int32Size(rows);
+        messageSize += WireFormatLite::TagSize(wellknown::I2DArray::_columnsIndex, WireFormatLite::TYPE_INT32) + WireFormatLite::Int32Size(columns);
+        auto dataTagSize = WireFormatLite::TagSize(wellknown::I2DArray::_dataIndex, WireFormatLite::TYPE_INT32);
+        switch (field.wellKnownType)
+        {
+        case wellknown::Types::Double2DArray:
+            messageSize += PackedFieldSize<DoubleWire>(dataTagSize, (*array)->bytes<double>(), rows * columns);
+            break;
+        case wellknown::Types::String2DArray:
+            messageSize += StringsSize(dataTagSize, (*array)->bytes<LStrHandle>(), rows * columns);
+            break;
+        default:
+            break;
+        }
+        _cachedSizes[slot] = messageSize;
+        return tagSize + WireFormatLite::LengthDelimitedSize(messageSize);
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    template <typename TWire>
+    size_t ClusterSerializer::NumericFieldSize(const MessageElementMetadata& field, size_t tagSize, int8_t* start)
+    {
+        typedef typename TWire::Type T;
+        if (!field.isRepeated)
+        {
+            return tagSize + TWire::Size(*(T*)start);
+        }
+        auto array = *(LV1DArrayHandle*)start;
+        auto count = LVArrayCount(array);
+        if (count == 0)
+        {
+            return 0;
+        }
+        return PackedFieldSize<TWire>(tagSize, (*array)->bytes<T>(), count);
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    template <typename TWire>
+    size_t ClusterSerializer::PackedFieldSize(size_t tagSize, const typename TWire::Type* data, int count)
+    {
+        size_t dataSize = 0;
+        if (TWire::isFixed)
+        {
+            dataSize = sizeof(typename TWire::Type) * count;
+        }
+        else
+        {
+            for (int x = 0; x < count; ++x)
+            {
+                dataSize += TWire::Size(data[x]);
+            }
+        }
+        _cachedSizes.push_back(dataSize);
+        return tagSize + WireFormatLite::LengthDelimitedSize(dataSize);
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    uint8* ClusterSerializer::SerializeMessage(const MessageMetadata& metadata, int8_t* cluster, uint8* target, EpsCopyOutputStream* stream)
+    {
+        // In the order of MessageSize, which the cached sizes are in
+        for (auto slot : metadata.SlotsByFieldNumber())
+        {
+            auto& field = metadata._elements[slot];
+            if (IsFieldSerialized(metadata, *field, cluster))
+            {
+                target = SerializeField(*field, cluster + field->clusterOffset, target, stream);
+            }
+        }
+        return target;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    uint8* ClusterSerializer::SerializeField(const MessageElementMetadata& field, int8_t* start, uint8* target, EpsCopyOutputStream* stream)
+    {
+        switch (field.type)
+        {
+        case LVMessageMetadataType::StringValue:
+        case LVMessageMetadataType::BytesValue:
+            return SerializeStringField(field, start, target, stream);
+        case LVMessageMetadataType::MessageValue:
+            return SerializeMessageField(field, start, target, stream);
+        case LVMessageMetadataType::EnumValue:
+            return SerializeEnumField(field, start, target, stream);
+        case LVMessageMetadataType::BoolValue:
+            return SerializeNumericField<BoolWire>(field, start, target, stream);
+        case LVMessageMetadataType::Int32Value:
+            return SerializeNumericField<Int32Wire>(field, start, target, stream);
+        case LVMessageMetadataType::UInt32Value:
+            return SerializeNumericField<UInt32Wire>(field, start, target, stream);
+        case LVMessageMetadataType::Int64Value:
+            return SerializeNumericField<Int64Wire>(field, start, target, stream);
+        case LVMessageMetadataType::UInt64Value:
+            return SerializeNumericField<UInt64Wire>(field, start, target, stream);
+        case LVMessageMetadataType::SInt32Value:
+            return SerializeNumericField<SInt32Wire>(field, start, target, stream);
+        case LVMessageMetadataType::SInt64Value:
+            return SerializeNumericField<SInt64Wire>(field, start, target, stream);
+        case LVMessageMetadataType::FloatValue:
+            return SerializeNumericField<FloatWire>(field, start, target, stream);
+        case LVMessageMetadataType::DoubleValue:
+            return SerializeNumericField<DoubleWire>(field, start, target, stream);
+        case LVMessageMetadataType::Fixed32Value:
+            return SerializeNumericField<Fixed32Wire>(field, start, target, stream);
+        case LVMessageMetadataType::Fixed64Value:
+            return SerializeNumericField<Fixed64Wire>(field, start, target, stream);
+        case LVMessageMetadataType::SFixed32Value:
+            return SerializeNumericField<SFixed32Wire>(field, start, target, stream);
+        case LVMessageMetadataType::SFixed64Value:
+            return SerializeNumericField<SFixed64Wire>(field, start, target, stream);
+        }
+        return target;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    uint8* ClusterSerializer::SerializeStringField(const MessageElementMetadata& field, int8_t* start, uint8* target, EpsCopyOutputStream* stream)
+    {
+        if (!field.isRepeated)
+        {
+            return SerializeStrings(field.protobufIndex, (LStrHandle*)start, 1, target, stream);
+        }
+        auto array = *(LV1DArrayHandle*)start;
+        auto count = LVArrayCount(array);
+        if (count == 0)
+        {
+            return target;
+        }
+        return SerializeStrings(field.protobufIndex, (*array)->bytes<LStrHandle>(), count, target, stream);
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    uint8* ClusterSerializer::SerializeStrings(int protobufIndex, LStrHandle* strings, int count, uint8* target, EpsCopyOutputStream* stream)
+    {
+        for (int x = 0; x < count; ++x)
+        {
+            auto length = LVStringLength(strings[x]);
+            target = WriteLengthDelimitedHeader(protobufIndex, length, target, stream);
+            if (length != 0)
+            {
+                target = stream->WriteRaw((*strings[x])->str, length, target);
+            }
+        }
+        return target;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    uint8* ClusterSerializer::SerializeEnumField(const MessageElementMetadata& field, int8_t* start, uint8* target, EpsCopyOutputStream* stream)
+    {
+        auto enumMetadata = field._owner->FindEnumMetadata(field.embeddedMessageName);
+        if (!field.isRepeated)
+        {
+            target = stream->EnsureSpace(target);
+            return WireFormatLite::WriteEnumToArray(field.protobufIndex, enumMetadata->GetProtoValueFromLVEnumValue(*(int32_t*)start), target);
+        }
+        auto array = *(LV1DArrayHandle*)start;
+        auto count = LVArrayCount(array);
+        if (count == 0)
+        {
+            return target;
+        }
+        auto data = (*array)->bytes<int32_t>();
+        target = WriteLengthDelimitedHeader(field.protobufIndex, _cachedSizes[_nextCachedSize++], target, stream);
+        for (int x = 0; x < count; ++x)
+        {
+            target = stream->EnsureSpace(target);
+            target = WireFormatLite::WriteEnumNoTagToArray(enumMetadata->GetProtoValueFromLVEnumValue(data[x]), target);
+        }
+        return target;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    uint8* ClusterSerializer::SerializeMessageField(const MessageElementMetadata& field, int8_t* start, uint8* target, EpsCopyOutputStream* stream)
+    {
+        if (field.wellKnownType != wellknown::Types::None)
+        {
+            return SerializeArray2DField(field, start, target, stream);
+        }
+
+        auto nestedMetadata = field._owner->FindMetadata(field.embeddedMessageName);
+        if (!field.isRepeated)
+        {
+            return SerializeNestedMessage(field.protobufIndex, *nestedMetadata, start, target, stream);
+        }
+        auto array = *(LV1DArrayHandle*)start;
+        auto count = LVArrayCount(array);
+        for (int x = 0; x < count; ++x)
+        {
+            auto data = (int8_t*)(*array)->bytes(nestedMetadata->clusterSize * x, nestedMetadata->alignmentRequirement);
+            target = SerializeNestedMessage(field.protobufIndex, *nestedMetadata, data, target, stream);
+        }
+        return target;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    uint8* ClusterSerializer::SerializeNestedMessage(int protobufIndex, const MessageMetadata& metadata, int8_t* cluster, uint8* target, EpsCopyOutputStream* stream)
+    {
+        target = WriteLengthDelimitedHeader(protobufIndex, _cachedSizes[_nextCachedSize++], target, stream);
+        return SerializeMessage(metadata, cluster, target, stream);
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    uint8* ClusterSerializer::SerializeArray2DField(const MessageElementMetadata& field, int8_t* start, uint8* target, EpsCopyOutputStream* stream)
+    {
+        auto array = *(LV2DArrayHandle*)start;
+        if (array == nullptr || *array == nullptr)
+        {
+            return target;
+        }
+        int rows = (*array)->dimensionSizes[0];
+        int columns = (*array)->dimensionSizes[1];
+        if (rows == 0 || columns == 0)
+        {
+            return target;
+        }
+
+        target = WriteLengthDelimitedHeader(field.protobufIndex, _cachedSizes[_nextCachedSize++], target, stream);
+        target = stream->EnsureSpace(target);
+        target = WireFormatLite::WriteInt32ToArray(wellknown::I2DArray::_rowsIndex, rows, target);
+        target = WireFormatLite::WriteInt32ToArray(wellknown::I2DArray::_columnsIndex, columns, target);
+        switch (field.wellKnownType)
+        {
+        case wellknown::Types::Double2DArray:
+            return SerializePackedField<DoubleWire>(wellknown::I2DArray::_dataIndex, (*array)->bytes<double>(), rows * columns, target, stream);
+        case wellknown::Types::String2DArray:
+            return SerializeStrings(wellknown::I2DArray::_dataIndex, (*array)->bytes<LStrHandle>(), rows * columns, target, stream);
+        default:
+            break;
+        }
+        return target;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    template <typename TWire>
+    uint8* ClusterSerializer::SerializeNumericField(const MessageElementMetadata& field, int8_t* start, uint8* target, EpsCopyOutputStream* stream)
+    {
+        typedef typename TWire::Type T;
+        if (!field.isRepeated)
+        {
+            target = stream->EnsureSpace(target);
+            target = WireFormatLite::WriteTagToArray(field.protobufIndex, TWire::wireType, target);
+            return TWire::Write(*(T*)start, target);
+        }
+        auto array = *(LV1DArrayHandle*)start;
+        auto count = LVArrayCount(array);
+        if (count == 0)
+        {
+            return target;
+        }
+        return SerializePackedField<TWire>(field.protobufIndex, (*array)->bytes<T>(), count, target, stream);
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    template <typename TWire>
+    uint8* ClusterSerializer::SerializePackedField(int protobufIndex, const typename TWire::Type* data, int count, uint8* target, EpsCopyOutputStream* stream)
+    {
+        auto dataSize = _cachedSizes[_nextCachedSize++];
+        target = WriteLengthDelimitedHeader(protobufIndex, dataSize, target, stream);
+        if (TWire::isFixed)
+        {
+            return stream->WriteRaw(data, static_cast<int>(dataSize), target);
+        }
+        for (int x = 0; x < count; ++x)
+        {
+            target = stream->EnsureSpace(target);
+            target = TWire::Write(data[x], target);
+        }
+        return target;
+    }
+}
@@ -0,0 +1,68 @@
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+#include <lv_interop.h>
+#include <message_metadata.h>
+#include <grpcpp/grpcpp.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <memory>
+#include <vector>
+
+namespace grpc_labview
+{
+    //---------------------------------------------------------------------
+    // Serializes a LabVIEW cluster straight to protobuf wire format using the
+    // offsets in the message metadata, without building an LVMessage first.
+    // ByteSizeLong reads the cluster to compute the size of every nested
+    // message and packed field, Serialize then writes the fields in cluster
+    // order using those sizes. The cluster must not change between the two.
+    //---------------------------------------------------------------------
+    class ClusterSerializer
+    {
+    public:
+        ClusterSerializer(std::shared_ptr<MessageMetadata> metadata, int8_t* cluster);
+
+        size_t ByteSizeLong();
+        google::protobuf::uint8* Serialize(google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream);
+        void SerializeToByteBuffer(grpc::ByteBuffer* buffer);
+
+    private:
+        static bool IsFieldSerialized(const MessageMetadata& metadata, const MessageElementMetadata& field, int8_t* cluster);
+
+        size_t MessageSize(const MessageMetadata& metadata, int8_t* cluster);
+        size_t FieldSize(const MessageElementMetadata& field, int8_t* start);
+        size_t StringFieldSize(const MessageElementMetadata& field, size_t tagSize, int8_t* start);
+        size_t StringsSize(size_t tagSize, LStrHandle* strings, int count);
+        size_t EnumFieldSize(const MessageElementMetadata& field, size_t tagSize, int8_t* start);
+        size_t MessageFieldSize(const MessageElementMetadata& field, size_t tagSize, int8_t* start);
+        size_t NestedMessageSize(const MessageMetadata& metadata, int8_t* cluster);
+        size_t Array2DFieldSize(const MessageElementMetadata& field, size_t tagSize, int8_t* start);
+        template <typename TWire>
+        size_t NumericFieldSize(const MessageElementMetadata& field, size_t tagSize, int8_t* start);
+        template <typename TWire>
+        size_t PackedFieldSize(size_t tagSize, const typename TWire::Type* data, int count);
+
+        google::protobuf::uint8* SerializeMessage(const MessageMetadata& metadata, int8_t* cluster, google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream);
+        google::protobuf::uint8* SerializeField(const MessageElementMetadata& field, int8_t* start, google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream);
+        google::protobuf::uint8* SerializeStringField(const MessageElementMetadata& field, int8_t* start, google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream);
+        google::protobuf::uint8* SerializeStrings(int protobufIndex, LStrHandle* strings, int count, google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream);
+        google::protobuf::uint8* SerializeEnumField(const MessageElementMetadata& field, int8_t* start, google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream);
+        google::protobuf::uint8* SerializeMessageField(const MessageElementMetadata& field, int8_t* start, google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream);
+        google::protobuf::uint8* SerializeNestedMessage(int protobufIndex, const MessageMetadata& metadata, int8_t* cluster, google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream);
+        google::protobuf::uint8* SerializeArray2DField(const MessageElementMetadata& field, int8_t* start, google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream);
+        template <typename TWire>
+        google::protobuf::uint8* SerializeNumericField(const MessageElementMetadata& field, int8_t* start, google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream);
+        template <typename TWire>
+        google::protobuf::uint8* SerializePackedField(int protobufIndex, const typename TWire::Type* data, int count, google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream);
+
+    private:
+        std::shared_ptr<MessageMetadata> _metadata;
+        int8_t* _cluster;
+        // Sizes of nested messages and packed fields in the order Serialize writes them.
+        std::vector<size_t> _cachedSizes;
+        size_t _nextCachedSize;
+    };
+}
@@ -2,6 +2,9 @@
 //---------------------------------------------------------------------
 #include <grpc_server.h>
 #include <lv_message.h>
+#include <lv_message_efficient.h>
+#include <cluster_copier.h>
+#include <cluster_serializer.h>
 
 //---------------------------------------------------------------------
 //---------------------------------------------------------------------
@@ -11,19 +14,48 @@ namespace grpc_labview
 {  
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    CallData::CallData(LabVIEWgRPCServer* server, grpc::AsyncGenericService *service, grpc::ServerCompletionQueue *cq) :
+    CallData::CallData(LabVIEWgRPCServer* server, grpc::AsyncGenericService *service, CompletionQueueData* queue) :
         _server(server), 
         _service(service),
-        _cq(cq),
+        _queue(queue),
+        _cq(queue->cq.get()),
+        _eventData(nullptr),
         _stream(&_ctx),
-        _status(CallStatus::Create),
-        _writeSemaphore(0),
+        _callStatus(grpc::Status::OK),
+        _readAheadTag(this),
+        _readAheadHead(0),
+        _readAheadCount(0),
+        _readInFlight(false),
+        _readsDone(false),
+        _deletePending(false),
+        _writeCompleteTag(this),
+        _nextQueuedWrite(0),
+        _writeInFlight(false),
+        _finishRequested(false),
+        _responseStarted(false),
         _requestDataReady(false),
-        _callStatus(grpc::Status::OK)
+        _parseRequestIntoCluster(false),
+        _admitted(false),
+        _pickedUp(false),
+        _compressionChosen(false),
+        _captureResponse(false),
+        _requestBytesCopied(false),
+        _singleFlightLeader(false),
+        _status(CallStatus::Create)
     {
         Proceed(true);
     }
 
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    CallData::~CallData()
+    {
+        if (_admitted)
+        {
+            _server->ReleaseCall(_eventData);
+        }
+    }
+
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     std::shared_ptr<MessageMetadata> CallData::FindMetadata(const std::string& name)
@@ -47,24 +79,293 @@ namespace grpc_labview
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    bool CallData::Write()
+    void CallData::SerializeResponse(int8_t* cluster, grpc::ByteBuffer* buffer)
+    {
+        auto start = std::chrono::steady_clock::now();
+        if (_eventData != nullptr && _eventData->responseMetadata != nullptr && _server->UseEfficientResponseCopy())
+        {
+            ClusterSerializer response(_eventData->responseMetadata, cluster);
+            response.SerializeToByteBuffer(buffer);
+        }
+        else
+        {
+            ClusterDataCopier::CopyFromCluster(*_response, cluster);
+            _response->SerializeToByteBuffer(buffer);
+        }
+        RecordTime(CallMetric::Serialize, start);
+        RecordStat(CallMetric::ResponseBytes, buffer->Length());
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    bool CallData::Write(const grpc::ByteBuffer& buffer)
+    {
+        return Write(&buffer, 1);
+    }
+
+    //---------------------------------------------------------------------
+    // Queues count responses as a whole. The write queue depth only decides
+    // whether a batch may start, a batch is never split by it.
+    //---------------------------------------------------------------------
+    bool CallData::Write(const grpc::ByteBuffer* buffers, size_t count)
     {
         if (IsCancelled())
         {
             return false;
         }
-        auto wb = _response->SerializeToByteBuffer();
+        std::unique_lock<std::mutex> lock(_writeMutex);
+        if (_status == CallStatus::PendingFinish)
+        {
+            return false;
+        }
+        if (_captureResponse)
+        {
+            // Only the response of a call that sends a single one can be reused.
+            _captureResponse = count == 1 && !_capturedResponse.Valid();
+            if (_captureResponse)
+            {
+                _capturedResponse = buffers[0];
+            }
+        }
+        size_t next = 0;
+        if (!_writeInFlight)
+        {
+            if (!_queue->BeginOperation())
+            {
+                return false;
+            }
+            _writeInFlight = true;
+            _writeStartTime = std::chrono::steady_clock::now();
+            // Cork the first response when the rest of the batch follows it. The
+            // first response of the call carries the initial metadata and is sent
+            // as soon as possible.
+            auto options = WriteOptionsFor(buffers[next]);
+            if (count > 1 && _responseStarted)
+            {
+                options.set_buffer_hint();
+            }
+            _responseStarted = true;
+            _stream.Write(buffers[next], options, &_writeCompleteTag);
+            ++next;
+            _queue->EndOperation();
+        }
+        if (next < count)
+        {
+            if (_nextQueuedWrite > 0 && _nextQueuedWrite >= _queuedWrites.size() / 2)
+            {
+                // Drop the responses already sent so the queue does not grow while it never drains.
+                _queuedWrites.erase(_queuedWrites.begin(), _queuedWrites.begin() + _nextQueuedWrite);
+                _nextQueuedWrite = 0;
+            }
+            _queuedWrites.insert(_queuedWrites.end(), buffers + next, buffers + count);
+        }
+        if (_server->WriteQueueDepth() == 0)
+        {
+            while (_writeInFlight) _writeCondition.wait(lock);
+            if (_status == CallStatus::PendingFinish || IsCancelled())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //---------------------------------------------------------------------
+    // True when the call already has as many responses waiting to be sent
+    // as the server's write queue depth allows.
+    //---------------------------------------------------------------------
+    bool CallData::IsWriteQueueFull()
+    {
+        auto depth = _server->WriteQueueDepth();
+        std::lock_guard<std::mutex> lock(_writeMutex);
+        return depth > 0 && _writeInFlight && _queuedWrites.size() - _nextQueuedWrite + 1 >= (size_t)depth;
+    }
+
+    //---------------------------------------------------------------------
+    // Called on the completion queue thread when a write completes. Starts the
+    // next queued write, and finishes the call once the queue is empty if
+    // Finish was called while writes were outstanding.
+    //---------------------------------------------------------------------
+    void CallData::WriteComplete(bool ok)
+    {
+        bool finish = false;
+        {
+            std::lock_guard<std::mutex> lock(_writeMutex);
+            if (ok)
+            {
+                RecordTime(CallMetric::WriteComplete, _writeStartTime);
+            }
+            else
+            {
+                // The stream is broken, drop whatever is still queued.
+                _queuedWrites.clear();
+                _nextQueuedWrite = 0;
+                if (_status != CallStatus::Finish)
+                {
+                    _status = CallStatus::PendingFinish;
+                }
+            }
+            if (_nextQueuedWrite < _queuedWrites.size() && _queue->BeginOperation())
+            {
+                // Let gRPC coalesce the message with the ones queued behind it, the last one is flushed.
+                auto options = WriteOptionsFor(_queuedWrites[_nextQueuedWrite]);
+                if (_nextQueuedWrite + 1 < _queuedWrites.size())
+                {
+                    options.set_buffer_hint();
+                }
+                _writeStartTime = std::chrono::steady_clock::now();
+                _stream.Write(_queuedWrites[_nextQueuedWrite], options, &_writeCompleteTag);
+                _queue->EndOperation();
+                _queuedWrites[_nextQueuedWrite++].Clear();
+                return;
+            }
+            _queuedWrites.clear();
+            _nextQueuedWrite = 0;
+            _writeInFlight = false;
+            finish = _finishRequested;
+            _writeCondition.notify_all();
+        }
+        if (finish)
+        {
+            FinishCall();
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // The algorithm is chosen with the first response, since it is sent in the
+    // initial metadata. Responses below the size threshold are sent
+    // uncompressed from then on.
+    //---------------------------------------------------------------------
+    grpc::WriteOptions CallData::WriteOptionsFor(const grpc::ByteBuffer& buffer)
+    {
+        auto& compression = _eventData != nullptr ? _eventData->compression : _server->Compression();
         grpc::WriteOptions options;
-        _status = CallStatus::Writing;
-        _stream.Write(*wb, this);
-        _writeSemaphore.wait();
-        if (IsCancelled())
+        if (!compression.IsEnabled())
+        {
+            return options;
+        }
+        if (!_compressionChosen)
         {
+            _ctx.set_compression_algorithm(compression.algorithm);
+            _compressionChosen = true;
+        }
+        if (!compression.Compresses(buffer.Length()))
+        {
+            options.set_no_compression();
+        }
+        return options;
+    }
+
+    //---------------------------------------------------------------------
+    // The serialized request, copied out of the received slices once.
+    //---------------------------------------------------------------------
+    const std::string& CallData::RequestBytes()
+    {
+        if (!_requestBytesCopied)
+        {
+            std::vector<grpc::Slice> slices;
+            _rb.Dump(&slices);
+            for (auto& slice : slices)
+            {
+                _requestBytes.append((const char*)slice.begin(), slice.size());
+            }
+            _requestBytesCopied = true;
+        }
+        return _requestBytes;
+    }
+
+    //---------------------------------------------------------------------
+    // Sends the cached response of a request received by a cached method
+    // together with the call's status, on the completion queue thread. On a
+    // miss the request is kept so the response LabVIEW gives can be cached.
+    //---------------------------------------------------------------------
+    bool CallData::AnswerFromCache()
+    {
+        if (_eventData == nullptr || _eventData->responseCache == nullptr)
+        {
+            return false;
+        }
+        grpc::ByteBuffer response;
+        if (!_eventData->responseCache->Find(RequestBytes(), &response))
+        {
+            _captureResponse = true;
             return false;
         }
+        _status = CallStatus::Finish;
+        _stream.WriteAndFinish(response, WriteOptionsFor(response), grpc::Status::OK, this);
         return true;
     }
 
+    //---------------------------------------------------------------------
+    // Attaches the call to a call of its method with the same request that is
+    // in progress. Once it returns true the call may be answered, and deleted,
+    // at any time. Otherwise this call is the one posted to LabVIEW.
+    //---------------------------------------------------------------------
+    bool CallData::JoinSingleFlight()
+    {
+        if (_eventData == nullptr || _eventData->singleFlight == nullptr)
+        {
+            return false;
+        }
+        if (_eventData->singleFlight->Join(RequestBytes(), this))
+        {
+            return true;
+        }
+        _singleFlightLeader = true;
+        _captureResponse = true;
+        return false;
+    }
+
+    //---------------------------------------------------------------------
+    // Answers the calls that waited for this one with its response and status,
+    // or posts them to LabVIEW themselves when the outcome cannot be shared.
+    //---------------------------------------------------------------------
+    void CallData::ReleaseSingleFlight(bool shareOutcome)
+    {
+        if (!_singleFlightLeader)
+        {
+            return;
+        }
+        _singleFlightLeader = false;
+        auto waiting = _eventData->singleFlight->Leave(RequestBytes());
+        for (auto call : waiting)
+        {
+            if (shareOutcome)
+            {
+                call->FinishShared(_capturedResponse.Valid() ? &_capturedResponse : nullptr, _callStatus);
+            }
+            else
+            {
+                _server->DispatchCall(call);
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Finishes a call that was never posted with the outcome of the call it
+    // waited for.
+    //---------------------------------------------------------------------
+    void CallData::FinishShared(const grpc::ByteBuffer* response, const grpc::Status& status)
+    {
+        auto queue = _queue;
+        _status = CallStatus::Finish;
+        if (!queue->BeginOperation())
+        {
+            // The server closed its queues, the call can no longer be answered.
+            Proceed(false);
+            return;
+        }
+        if (response != nullptr)
+        {
+            _stream.WriteAndFinish(*response, WriteOptionsFor(*response), status, this);
+        }
+        else
+        {
+            _stream.Finish(status, this);
+        }
+        queue->EndOperation();
+    }
+
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     void CallData::SetCallStatusError(std::string errorMessage)
@@ -83,15 +384,45 @@ namespace grpc_labview
     //---------------------------------------------------------------------
     void CallData::Finish()
     {
-        if (_status == CallStatus::PendingFinish)
+        RecordTime(CallMetric::Handling, _pickedUp ? _pickupTime : _eventSentTime);
+        _server->CallHandled(_eventData, std::chrono::steady_clock::now() - _eventSentTime);
+        if (_eventData != nullptr && _eventData->responseCache != nullptr && _captureResponse && _callStatus.ok() && _capturedResponse.Valid())
         {
-            _status = CallStatus::Finish;
-            Proceed(false);
+            _eventData->responseCache->Insert(RequestBytes(), _capturedResponse);
         }
-        else
+        // The outcome is shared only when LabVIEW answered this call, with a response or
+        // an error. A call whose client cancelled it may have neither.
+        auto shareOutcome = _captureResponse && !IsCancelled() && (_capturedResponse.Valid() || !_callStatus.ok());
+        ReleaseSingleFlight(shareOutcome);
         {
-            _status = CallStatus::Finish;
+            std::lock_guard<std::mutex> lock(_writeMutex);
+            if (_writeInFlight)
+            {
+                // Queued responses are sent before the status, WriteComplete finishes the call.
+                _finishRequested = true;
+                return;
+            }
+        }
+        FinishCall();
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void CallData::FinishCall()
+    {
+        auto queue = _queue;
+        auto pendingFinish = _status == CallStatus::PendingFinish;
+        _status = CallStatus::Finish;
+        if (!pendingFinish && queue->BeginOperation())
+        {
+            // The call may be deleted as soon as the finish is started.
             _stream.Finish(_callStatus, this);
+            queue->EndOperation();
+        }
+        else
+        {
+            // The stream is broken, or the server closed its queues, so the status cannot be sent.
+            Proceed(false);
         }
     }
 
@@ -113,21 +444,55 @@ namespace grpc_labview
     //---------------------------------------------------------------------
     bool CallData::ReadNext()
     {
+        if (!_pickedUp)
+        {
+            _pickedUp = true;
+            _pickupTime = std::chrono::steady_clock::now();
+            RecordTime(CallMetric::PostToPickup, _eventSentTime);
+        }
         if (_requestDataReady)
         {
             return true;
         }
+        if (_captureResponse)
+        {
+            // The response no longer depends on the first request alone, so it can be
+            // neither cached nor shared with the calls that sent the same first request.
+            std::lock_guard<std::mutex> lock(_writeMutex);
+            _captureResponse = false;
+        }
+        ReleaseSingleFlight(false);
         if (IsCancelled())
         {
             return false;
         }
-        auto tag = new ReadNextTag(this);
-        _stream.Read(&_rb, tag);
-        if (!tag->Wait())
+        if (_server->ReadAheadDepth() > 0)
         {
-            return false;
+            if (!ReadNextBuffered())
+            {
+                return false;
+            }
+        }
+        else
+        {
+            if (!_queue->BeginOperation())
+            {
+                return false;
+            }
+            _stream.Read(&_rb, &_readNextTag);
+            _queue->EndOperation();
+            if (!_readNextTag.Wait())
+            {
+                return false;
+            }
+        }
+        RecordStat(CallMetric::RequestBytes, _rb.Length());
+        if (!_parseRequestIntoCluster)
+        {
+            auto start = std::chrono::steady_clock::now();
+            _request->ParseFromByteBuffer(_rb);
+            RecordTime(CallMetric::Parse, start);
         }
-        _request->ParseFromByteBuffer(_rb);
         _requestDataReady = true;
         if (IsCancelled())
         {
@@ -136,6 +501,116 @@ namespace grpc_labview
         return true;
     }
 
+    //---------------------------------------------------------------------
+    // Takes the oldest request received ahead into _rb, waiting for one to
+    // arrive when none is buffered. Reading ahead starts with the first request
+    // after the one the call was started with, so unary calls never post it.
+    //---------------------------------------------------------------------
+    bool CallData::ReadNextBuffered()
+    {
+        std::unique_lock<std::mutex> lock(_readMutex);
+        if (_readAheadBuffers.empty())
+        {
+            _readAheadBuffers.resize(_server->ReadAheadDepth());
+            StartReadAhead();
+        }
+        while (_readAheadCount == 0 && !_readsDone) _readCondition.wait(lock);
+        if (_readAheadCount == 0)
+        {
+            return false;
+        }
+        _rb.Swap(&_readAheadBuffers[_readAheadHead]);
+        _readAheadBuffers[_readAheadHead].Clear();
+        _readAheadHead = (_readAheadHead + 1) % _readAheadBuffers.size();
+        --_readAheadCount;
+        if (!_readInFlight && !_readsDone)
+        {
+            // The ring was full, resume reading now that there is room.
+            StartReadAhead();
+        }
+        return true;
+    }
+
+    //---------------------------------------------------------------------
+    // Number of requests GetRequestData can take without waiting.
+    //---------------------------------------------------------------------
+    int32_t CallData::BufferedRequestCount()
+    {
+        std::lock_guard<std::mutex> lock(_readMutex);
+        return (_requestDataReady ? 1 : 0) + (int32_t)_readAheadCount;
+    }
+
+    //---------------------------------------------------------------------
+    // Must be called with _readMutex held.
+    //---------------------------------------------------------------------
+    void CallData::StartReadAhead()
+    {
+        if (!_queue->BeginOperation())
+        {
+            _readsDone = true;
+            return;
+        }
+        _readInFlight = true;
+        _stream.Read(&_readAheadTarget, &_readAheadTag);
+        _queue->EndOperation();
+    }
+
+    //---------------------------------------------------------------------
+    // Called on the completion queue thread when a read posted ahead completes.
+    // The request is added to the ring and the next read posted right away
+    // while there is room for it.
+    //---------------------------------------------------------------------
+    void CallData::ReadAheadComplete(bool ok)
+    {
+        std::unique_lock<std::mutex> lock(_readMutex);
+        _readInFlight = false;
+        if (_deletePending)
+        {
+            // The call finished while the read was outstanding.
+            lock.unlock();
+            delete this;
+            return;
+        }
+        if (!ok)
+        {
+            // The client is done writing or the call is broken.
+            _readsDone = true;
+        }
+        else
+        {
+            auto tail = (_readAheadHead + _readAheadCount) % _readAheadBuffers.size();
+            _readAheadBuffers[tail].Swap(&_readAheadTarget);
+            ++_readAheadCount;
+            if (_readAheadCount < _readAheadBuffers.size())
+            {
+                StartReadAhead();
+            }
+        }
+        _readCondition.notify_all();
+    }
+
+    //---------------------------------------------------------------------
+    // Copies the request read last into the LabVIEW cluster. When the request
+    // was not parsed yet it is parsed straight from the received buffer.
+    //---------------------------------------------------------------------
+    bool CallData::CopyRequestToCluster(int8_t* cluster)
+    {
+        if (_parseRequestIntoCluster)
+        {
+            auto start = std::chrono::steady_clock::now();
+            LVMessageEfficient request(_eventData->requestMetadata, cluster);
+            if (!request.ParseFromByteBuffer(_rb))
+            {
+                SetCallStatusError(grpc::StatusCode::INVALID_ARGUMENT, "Failed to parse the request");
+                return false;
+            }
+            RecordTime(CallMetric::Parse, start);
+            return true;
+        }
+        ClusterDataCopier::CopyToCluster(*_request, cluster);
+        return true;
+    }
+
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     void CallData::ReadComplete()
@@ -143,15 +618,89 @@ namespace grpc_labview
         _requestDataReady = false;
     }
 
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    const LVEventData* CallData::EventData()
+    {
+        return _eventData;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    std::chrono::system_clock::time_point CallData::Deadline()
+    {
+        return _ctx.deadline();
+    }
+
+    //---------------------------------------------------------------------
+    // True if the client is no longer waiting for the call, because it was
+    // cancelled or its deadline has passed.
+    //---------------------------------------------------------------------
+    bool CallData::HasExpired()
+    {
+        return IsCancelled() || _ctx.deadline() <= std::chrono::system_clock::now();
+    }
+
+    //---------------------------------------------------------------------
+    // Hands the call to LabVIEW by posting its server event.
+    //---------------------------------------------------------------------
+    void CallData::PostEvent()
+    {
+        _methodData = std::allocate_shared<GenericMethodData>(PoolAllocator<GenericMethodData>(_queue->methodDataPool), this, &_ctx, _request, _response);
+        gPointerManager.RegisterPointer(_methodData);
+        _eventSentTime = std::chrono::steady_clock::now();
+        _server->SendEvent(_eventData, _ctx.method(), static_cast<gRPCid*>(_methodData.get()));
+    }
+
+    //---------------------------------------------------------------------
+    // Finishes a call that was waiting to be dispatched without posting it.
+    //---------------------------------------------------------------------
+    void CallData::FinishUnposted(grpc::StatusCode statusCode, const std::string& errorMessage)
+    {
+        _callStatus = grpc::Status(statusCode, errorMessage);
+        // The calls waiting for this one may still be worth handling.
+        ReleaseSingleFlight(false);
+        FinishCall();
+    }
+
+    //---------------------------------------------------------------------
+    // Statistics are only kept for registered methods.
+    //---------------------------------------------------------------------
+    void CallData::RecordStat(CallMetric metric, uint64_t value)
+    {
+        if (_eventData != nullptr)
+        {
+            _eventData->stats->Record(metric, value);
+        }
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void CallData::RecordTime(CallMetric metric, std::chrono::steady_clock::time_point start)
+    {
+        if (_eventData != nullptr)
+        {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            _eventData->stats->Record(metric, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+    }
+
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     void CallData::Proceed(bool ok)
     {
         if (!ok)
         {
-            if (_status == CallStatus::Writing)
+            if (_status == CallStatus::Read || _status == CallStatus::Process)
             {
-                _writeSemaphore.notify();
+                // No client call was matched, or its request never arrived, so the call
+                // was never posted to LabVIEW and nothing else refers to it.
+                if (_status == CallStatus::Read)
+                {
+                    _queue->pendingCalls--;
+                }
+                delete this;
+                return;
             }
             if (_status != CallStatus::Finish)
             {
@@ -165,47 +714,110 @@ namespace grpc_labview
             // the tag uniquely identifying the request (so that different CallData
             // instances can serve different requests concurrently), in this case
             // the memory address of this CallData instance.
+            _queue->pendingCalls++;
             _service->RequestCall(&_ctx, &_stream, _cq, _cq, this);
-            _ctx.AsyncNotifyWhenDone(new CallFinishedData(this));
+            _ctx.AsyncNotifyWhenDone(new (_queue->callFinishedPool) CallFinishedData(this));
             _status = CallStatus::Read;
         }
         else if (_status == CallStatus::Read)
         {
             // Spawn a new CallData instance to serve new clients while we process
-            // the one for this CallData. The instance will deallocate itself as
-            // part of its FINISH state.
-            new CallData(_server, _service, _cq);
+            // the one for this CallData. The instance will return itself to the
+            // pool as part of its FINISH state.
+            _acceptedTime = std::chrono::steady_clock::now();
+            _server->CallAccepted(_queue);
+            auto queue = _queue;
+            if (!queue->BeginOperation())
+            {
+                // The server closed its queues, the call can no longer be answered.
+                delete this;
+                return;
+            }
+            if (!_server->IsStopping())
+            {
+                new (_queue->callDataPool) CallData(_server, _service, _queue);
+            }
 
-            auto name = _ctx.method();
-            if (_server->HasRegisteredServerMethod(name) || _server->HasGenericMethodEvent())
+            _eventData = _server->FindServerMethod(_ctx.method());
+            if (_server->IsStopping())
             {
-                _stream.Read(&_rb, this);
-                _status = CallStatus::Process;
+                _status = CallStatus::Finish;
+                _stream.Finish(grpc::Status(grpc::StatusCode::UNAVAILABLE, "Server is shutting down"), this);
+            }
+            else if (_eventData != nullptr || _server->HasGenericMethodEvent())
+            {
+                // Shed load before anything is read or posted to LabVIEW.
+                _admitted = _server->AdmitCall(_eventData);
+                if (_admitted)
+                {
+                    _stream.Read(&_rb, this);
+                    _status = CallStatus::Process;
+                }
+                else
+                {
+                    _status = CallStatus::Finish;
+                    _stream.Finish(grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED, "Too many calls in progress"), this);
+                }
             }
             else
             {
                 _status = CallStatus::Finish;
                 _stream.Finish(grpc::Status(grpc::StatusCode::UNIMPLEMENTED, ""), this);
             }
+            queue->EndOperation();
         }
         else if (_status == CallStatus::Process)
         {
-            auto name = _ctx.method();
-
-            LVEventData eventData;
-            if (_server->FindEventData(name, eventData) || _server->HasGenericMethodEvent())
+            auto queue = _queue;
+            if (!queue->BeginOperation())
+            {
+                // The server closed its queues, the call can no longer be answered.
+                delete this;
+                return;
+            }
+            if (HasExpired())
+            {
+                // Nobody is waiting for the response any more, do not spend a LabVIEW handler on it.
+                _server->CallExpired();
+                _status = CallStatus::Finish;
+                _stream.Finish(grpc::Status(grpc::StatusCode::DEADLINE_EXCEEDED, "Deadline expired before the call was handled"), this);
+            }
+            else if (AnswerFromCache())
             {
-                auto requestMetadata = _server->FindMetadata(eventData.requestMetadataName);
-                auto responseMetadata = _server->FindMetadata(eventData.responseMetadataName);
-                _request = std::make_shared<LVMessage>(requestMetadata);
-                _response = std::make_shared<LVMessage>(responseMetadata);
+                RecordStat(CallMetric::RequestBytes, _rb.Length());
+            }
+            else if (_eventData != nullptr || _server->HasGenericMethodEvent())
+            {
+                RecordTime(CallMetric::AcceptToParse, _acceptedTime);
+                RecordStat(CallMetric::RequestBytes, _rb.Length());
+                std::shared_ptr<MessageMetadata> requestMetadata;
+                std::shared_ptr<MessageMetadata> responseMetadata;
+                if (_eventData != nullptr)
+                {
+                    requestMetadata = _eventData->requestMetadata;
+                    responseMetadata = _eventData->responseMetadata;
+                }
+                _request = std::allocate_shared<LVMessage>(PoolAllocator<LVMessage>(_queue->messagePool), requestMetadata);
+                _response = std::allocate_shared<LVMessage>(PoolAllocator<LVMessage>(_queue->messagePool), responseMetadata);
+                _request->UseOwnArena();
+                _response->UseOwnArena();
 
-                if (_request->ParseFromByteBuffer(_rb))
+                // The request is parsed by GetRequestData directly into the LabVIEW cluster when possible.
+                _parseRequestIntoCluster = requestMetadata != nullptr && _server->UseEfficientMessageCopy();
+                auto parsed = _parseRequestIntoCluster;
+                if (!parsed)
+                {
+                    auto start = std::chrono::steady_clock::now();
+                    parsed = _request->ParseFromByteBuffer(_rb);
+                    RecordTime(CallMetric::Parse, start);
+                }
+                if (parsed)
                 {
                     _requestDataReady = true;
-                    _methodData = std::make_shared<GenericMethodData>(this, &_ctx, _request, _response);
-                    gPointerManager.RegisterPointer(_methodData);
-                    _server->SendEvent(name, static_cast<gRPCid*>(_methodData.get()));
+                    if (!JoinSingleFlight())
+                    {
+                        _server->DispatchCall(this);
+                    }
                 }
                 else
                 {
@@ -218,10 +830,7 @@ namespace grpc_labview
                 _status = CallStatus::Finish;
                 _stream.Finish(grpc::Status(grpc::StatusCode::UNIMPLEMENTED, ""), this);
             }
-        }
-        else if (_status == CallStatus::Writing)
-        {
-            _writeSemaphore.notify();
+            queue->EndOperation();
         }
         else if (_status == CallStatus::PendingFinish)
         {        
@@ -229,13 +838,22 @@ namespace grpc_labview
         else
         {
             assert(_status == CallStatus::Finish);
+            {
+                std::lock_guard<std::mutex> lock(_readMutex);
+                if (_readInFlight)
+                {
+                    // ReadAheadComplete deletes the call once the outstanding read completes.
+                    _deletePending = true;
+                    return;
+                }
+            }
             delete this;
         }
     }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    ReadNextTag::ReadNextTag(CallData* callData) :
+    ReadNextTag::ReadNextTag() :
         _readCompleteSemaphore(0),
         _success(false)
     {
@@ -257,6 +875,34 @@ namespace grpc_labview
         return _success;
     }
 
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    ReadAheadTag::ReadAheadTag(CallData* call) :
+        _call(call)
+    {
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void ReadAheadTag::Proceed(bool ok)
+    {
+        _call->ReadAheadComplete(ok);
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    WriteCompleteTag::WriteCompleteTag(CallData* call) :
+        _call(call)
+    {
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void WriteCompleteTag::Proceed(bool ok)
+    {
+        _call->WriteComplete(ok);
+    }
+
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     EventData::EventData(ServerContext *_context) :
@@ -12,6 +12,11 @@ namespace grpc_labview {
         FeatureConfig() {
             featureFlags["gRPC"] = true; // Enable gRPC by default as an example, this will never be overridden by config file
             featureFlags["data_EfficientMessageCopy"] = true;
+            // Opt-in: malformed requests are only rejected once GetRequestData parses them
+            featureFlags["data_EfficientServerMessageCopy"] = false;
+            // Server responses and client requests are encoded by ClusterSerializer instead of through an LVMessage
+            featureFlags["data_EfficientServerResponseCopy"] = true;
+            featureFlags["data_EfficientClientRequestCopy"] = true;
             featureFlags["data_useOccurrence"] = true;
         }
 
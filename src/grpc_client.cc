@@ -1,10 +1,12 @@
 //---------------------------------------------------------------------
 //---------------------------------------------------------------------
 #include <grpc_client.h>
+#include <grpc_server.h>
 #include <lv_interop.h>
 #include <lv_message.h>
 #include <lv_message_efficient.h>
 #include <cluster_copier.h>
+#include <cluster_serializer.h>
 #include <grpcpp/create_channel.h>
 #include <grpcpp/impl/codegen/client_context.h>
 #include <grpcpp/impl/codegen/client_unary_call.h>
@@ -28,6 +30,11 @@ namespace grpc_labview
     static bool IsLoopbackAddress(const char* address)
     {
         std::string hostname(address);
+        if (hostname.compare(0, 5, "unix:") == 0 || hostname.compare(0, 14, "unix-abstract:") == 0)
+        {
+            // Unix domain sockets only reach processes on the same machine.
+            return true;
+        }
 
         std::regex hostFromUriRegex(R"(^\w+://([^/?#:]+))");
         std::smatch match;
@@ -86,6 +93,13 @@ namespace grpc_labview
         Channel = grpc::CreateCustomChannel(address, creds, args);
     }
 
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCClient::ConnectInProcess(std::shared_ptr<grpc::Channel> channel)
+    {
+        Channel = channel;
+    }
+
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     ClientCall::~ClientCall()
@@ -106,6 +120,37 @@ namespace grpc_labview
         _cancelled = true;
     }
 
+    //---------------------------------------------------------------------
+    // Serializes the request cluster while LabVIEW still owns it, either
+    // directly when efficient client request copies are enabled or through
+    // an LVMessage.
+    //---------------------------------------------------------------------
+    void ClientCall::SerializeRequest(int8_t* requestCluster, grpc::ByteBuffer* buffer)
+    {
+        if (FeatureConfig::getInstance().isFeatureEnabled("data_EfficientClientRequestCopy"))
+        {
+            ClusterSerializer request(_request->_metadata, requestCluster);
+            request.SerializeToByteBuffer(buffer);
+            return;
+        }
+        ClusterDataCopier::CopyFromCluster(*_request, requestCluster);
+        _request->SerializeToByteBuffer(buffer);
+    }
+
+    //---------------------------------------------------------------------
+    // Streaming calls choose their algorithm when they start, so a message
+    // below the size threshold has to be excluded when it is written.
+    //---------------------------------------------------------------------
+    grpc::WriteOptions ClientCall::StreamWriteOptions(const grpc::ByteBuffer& message)
+    {
+        grpc::WriteOptions options;
+        if (_context->compression.IsEnabled() && !_context->compression.Compresses(message.Length()))
+        {
+            options.set_no_compression();
+        }
+        return options;
+    }
+
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     ServerStreamingClientCall::~ServerStreamingClientCall()
@@ -154,9 +199,9 @@ namespace grpc_labview
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    bool ClientStreamingClientCall::Write(LVMessage *message)
+    bool ClientStreamingClientCall::Write(const grpc::ByteBuffer& message)
     {
-        return _writer->Write(*message);
+        return _writer->Write(message, StreamWriteOptions(message));
     }
 
     //---------------------------------------------------------------------
@@ -193,9 +238,9 @@ namespace grpc_labview
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    bool BidiStreamingClientCall::Write(LVMessage *message)
+    bool BidiStreamingClientCall::Write(const grpc::ByteBuffer& message)
     {
-        return _readerWriter->Write(*message);
+        return _readerWriter->Write(message, StreamWriteOptions(message));
     }
 
     void ClientContext::set_deadline(int32_t timeoutMs)
@@ -226,6 +271,32 @@ LIBRARY_EXPORT int32_t CreateClient(const char *address, const char *certificate
     return 0;
 }
 
+//---------------------------------------------------------------------
+// Creates a client of a server running in the same process. Its calls are
+// passed to the server without going through the network, and it is used
+// like a client created with CreateClient.
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t CreateInProcessClient(grpc_labview::gRPCid** serverId, grpc_labview::gRPCid** clientId)
+{
+    auto server = (*serverId)->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    if (server == nullptr)
+    {
+        return -1;
+    }
+    auto channel = server->InProcessChannel();
+    if (channel == nullptr)
+    {
+        return -2;
+    }
+    grpc_labview::InitCallbacks();
+
+    auto client = new grpc_labview::LabVIEWgRPCClient();
+    client->ConnectInProcess(channel);
+    *clientId = grpc_labview::gPointerManager.RegisterPointer(client);
+    grpc_labview::RegisterCleanupProc(ClientCleanUpProc, client);
+    return 0;
+}
+
 //---------------------------------------------------------------------
 //---------------------------------------------------------------------
 int32_t CloseClient(grpc_labview::LabVIEWgRPCClient* client)
@@ -296,6 +367,25 @@ LIBRARY_EXPORT int32_t CreateClientContext(grpc_labview::gRPCid** contextId)
     return 0;
 }
 
+//---------------------------------------------------------------------
+// Compresses the requests of the call made with the context that are at
+// least minBytes long, with 0 none, 1 deflate or 2 gzip. Returns -2 for an
+// unknown algorithm.
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t SetClientContextCompression(grpc_labview::gRPCid* contextId, int32_t algorithm, int32_t minBytes)
+{
+    auto clientContext = contextId->CastTo<grpc_labview::ClientContext>();
+    if (!clientContext)
+    {
+        return -1;
+    }
+    if (!clientContext->compression.Set(algorithm, minBytes))
+    {
+        return -2;
+    }
+    return 0;
+}
+
 //---------------------------------------------------------------------
 //---------------------------------------------------------------------
 LIBRARY_EXPORT int32_t CloseClientContext(grpc_labview::gRPCid* contextId)
@@ -373,32 +463,37 @@ LIBRARY_EXPORT int32_t ClientUnaryCall2(
         clientCall->_useLVEfficientMessage = true;
     }
 
+    clientCall->_request = std::make_shared<grpc_labview::LVMessage>(requestMetadata);
     if (clientCall->_useLVEfficientMessage)
     {
-        clientCall->_request = std::make_shared<grpc_labview::LVMessageEfficient>(requestMetadata, requestCluster);
         clientCall->_response = std::make_shared<grpc_labview::LVMessageEfficient>(responseMetadata, responseCluster);
     }
     else
     {
-        clientCall->_request = std::make_shared<grpc_labview::LVMessage>(requestMetadata);
         clientCall->_response = std::make_shared<grpc_labview::LVMessage>(responseMetadata);
     }
+    clientCall->_request->UseOwnArena();
+    clientCall->_response->UseOwnArena();
 
     try
     {
-        grpc_labview::ClusterDataCopier::CopyFromCluster(*clientCall->_request.get(), requestCluster);
+        clientCall->SerializeRequest(requestCluster, &clientCall->_requestBuffer);
     }
     catch (grpc_labview::InvalidEnumValueException& e)
     {
         return e.code;
     }
+    if (clientContext->compression.Compresses(clientCall->_requestBuffer.Length()))
+    {
+        clientContext->gRPCClientContext.set_compression_algorithm(clientContext->compression.algorithm);
+    }
 
     clientCall->_runFuture = std::async(
         std::launch::async,
         [clientCall]()
         {
             grpc::internal::RpcMethod method(clientCall->_methodName.c_str(), grpc::internal::RpcMethod::NORMAL_RPC);
-            clientCall->_status = grpc::internal::BlockingUnaryCall(clientCall->_client->Channel.get(), method, &(clientCall->_context.get()->gRPCClientContext), *clientCall->_request.get(), clientCall->_response.get());
+            clientCall->_status = grpc::internal::BlockingUnaryCall(clientCall->_client->Channel.get(), method, &(clientCall->_context.get()->gRPCClientContext), clientCall->_requestBuffer, clientCall->_response.get());
             if (clientCall->_occurrence != 0)
             {
                 CheckActiveAndSignalOccurenceForClientCall(clientCall);
@@ -535,11 +630,18 @@ LIBRARY_EXPORT int32_t ClientBeginClientStreamingCall(
     clientCall->_client = client;
     clientCall->_request = std::make_shared<grpc_labview::LVMessage>(requestMetadata);
     clientCall->_response = std::make_shared<grpc_labview::LVMessage>(responseMetadata);
+    clientCall->_request->UseOwnArena();
+    clientCall->_response->UseOwnArena();
     clientCall->_context = clientContext;
 
+    if (clientContext->compression.IsEnabled())
+    {
+        // Messages below the size threshold are written uncompressed, see StreamWriteOptions.
+        clientContext->gRPCClientContext.set_compression_algorithm(clientContext->compression.algorithm);
+    }
     grpc::internal::RpcMethod method(methodName, grpc::internal::RpcMethod::CLIENT_STREAMING);
-    auto writer = grpc::internal::ClientWriterFactory<grpc_labview::LVMessage>::Create(client->Channel.get(), method, &(clientCall->_context.get()->gRPCClientContext), clientCall->_response.get());
-    clientCall->_writer = std::shared_ptr<grpc::ClientWriterInterface<grpc_labview::LVMessage>>(writer);
+    auto writer = grpc::internal::ClientWriterFactory<grpc::ByteBuffer>::Create(client->Channel.get(), method, &(clientCall->_context.get()->gRPCClientContext), clientCall->_response.get());
+    clientCall->_writer = std::shared_ptr<grpc::ClientWriterInterface<grpc::ByteBuffer>>(writer);
 
     return 0;
 }
@@ -590,19 +692,26 @@ LIBRARY_EXPORT int32_t ClientBeginServerStreamingCall(
     clientCall->_client = client;
     clientCall->_request = std::make_shared<grpc_labview::LVMessage>(requestMetadata);
     clientCall->_response = std::make_shared<grpc_labview::LVMessage>(responseMetadata);
+    clientCall->_request->UseOwnArena();
+    clientCall->_response->UseOwnArena();
     clientCall->_context = clientContext;
 
+    grpc::ByteBuffer request;
     try
     {
-        grpc_labview::ClusterDataCopier::CopyFromCluster(*clientCall->_request.get(), requestCluster);
+        clientCall->SerializeRequest(requestCluster, &request);
     }
     catch (grpc_labview::InvalidEnumValueException& e)
     {
         return e.code;
     }
+    if (clientContext->compression.Compresses(request.Length()))
+    {
+        clientContext->gRPCClientContext.set_compression_algorithm(clientContext->compression.algorithm);
+    }
 
     grpc::internal::RpcMethod method(methodName, grpc::internal::RpcMethod::SERVER_STREAMING);
-    auto reader = grpc::internal::ClientReaderFactory<grpc_labview::LVMessage>::Create<grpc_labview::LVMessage>(client->Channel.get(), method, &(clientCall->_context.get()->gRPCClientContext), *clientCall->_request.get());
+    auto reader = grpc::internal::ClientReaderFactory<grpc_labview::LVMessage>::Create<grpc::ByteBuffer>(client->Channel.get(), method, &(clientCall->_context.get()->gRPCClientContext), request);
     clientCall->_reader = std::shared_ptr<grpc::ClientReader<grpc_labview::LVMessage>>(reader);
 
     return 0;
@@ -653,11 +762,17 @@ LIBRARY_EXPORT int32_t ClientBeginBidiStreamingCall(
     clientCall->_client = client;
     clientCall->_request = std::make_shared<grpc_labview::LVMessage>(requestMetadata);
     clientCall->_response = std::make_shared<grpc_labview::LVMessage>(responseMetadata);
+    clientCall->_request->UseOwnArena();
+    clientCall->_response->UseOwnArena();
     clientCall->_context = clientContext;
 
+    if (clientContext->compression.IsEnabled())
+    {
+        clientContext->gRPCClientContext.set_compression_algorithm(clientContext->compression.algorithm);
+    }
     grpc::internal::RpcMethod method(methodName, grpc::internal::RpcMethod::BIDI_STREAMING);
-    auto readerWriter = grpc::internal::ClientReaderWriterFactory<grpc_labview::LVMessage, grpc_labview::LVMessage>::Create(client->Channel.get(), method, &(clientCall->_context.get()->gRPCClientContext));
-    clientCall->_readerWriter = std::shared_ptr<grpc::ClientReaderWriterInterface<grpc_labview::LVMessage, grpc_labview::LVMessage>>(readerWriter);
+    auto readerWriter = grpc::internal::ClientReaderWriterFactory<grpc::ByteBuffer, grpc_labview::LVMessage>::Create(client->Channel.get(), method, &(clientCall->_context.get()->gRPCClientContext));
+    clientCall->_readerWriter = std::shared_ptr<grpc::ClientReaderWriterInterface<grpc::ByteBuffer, grpc_labview::LVMessage>>(readerWriter);
 
     return 0;
 }
@@ -741,15 +856,16 @@ LIBRARY_EXPORT int32_t ClientWriteToStream(grpc_labview::gRPCid* callId, int8_t*
     {
         return -2;
     }
+    grpc::ByteBuffer request;
     try
     {
-        grpc_labview::ClusterDataCopier::CopyFromCluster(*clientCall->_request.get(), requestCluster);
+        clientCall->SerializeRequest(requestCluster, &request);
     }
     catch (grpc_labview::InvalidEnumValueException& e)
     {
         return e.code;
     }
-    *success = writer->Write(clientCall->_request.get());
+    *success = writer->Write(request);
     return 0;
 }
 
@@ -8,6 +8,7 @@
 #include <metadata_owner.h>
 #include <grpcpp/grpcpp.h>
 #include <lv_message.h>
+#include <message_compression.h>
 #include <grpcpp/impl/codegen/sync_stream.h>
 #include <future>
 #include <unordered_map>
@@ -26,6 +27,7 @@ namespace grpc_labview
     public:
         LabVIEWgRPCClient();
         void Connect(const char *address, const std::string &certificatePath);
+        void ConnectInProcess(std::shared_ptr<grpc::Channel> channel);
 
     public:
         std::shared_ptr<grpc::Channel> Channel;
@@ -41,6 +43,7 @@ namespace grpc_labview
         void Cancel();
         void set_deadline(int32_t timeoutMs);
         grpc::ClientContext gRPCClientContext;
+        CompressionSettings compression;
     };
 
     //---------------------------------------------------------------------
@@ -51,6 +54,8 @@ namespace grpc_labview
         virtual ~ClientCall();
         virtual void Finish();
         void Cancel();
+        void SerializeRequest(int8_t* requestCluster, grpc::ByteBuffer* buffer);
+        grpc::WriteOptions StreamWriteOptions(const grpc::ByteBuffer& message);
 
     public:
         std::shared_ptr<grpc_labview::LabVIEWgRPCClient> _client;
@@ -58,6 +63,7 @@ namespace grpc_labview
         MagicCookie _occurrence;
         std::shared_ptr<ClientContext> _context;
         std::shared_ptr<LVMessage> _request;
+        grpc::ByteBuffer _requestBuffer;
         std::shared_ptr<LVMessage> _response;
         grpc::Status _status;
         std::future<int> _runFuture;
@@ -70,7 +76,7 @@ namespace grpc_labview
     class StreamWriter
     {
     public:
-        virtual bool Write(LVMessage *message) = 0;
+        virtual bool Write(const grpc::ByteBuffer& message) = 0;
         virtual void WritesComplete() = 0;
     };
 
@@ -106,11 +112,11 @@ namespace grpc_labview
         ClientStreamingClientCall() { _writesComplete = false; }
         ~ClientStreamingClientCall();
         void Finish() override;
-        bool Write(LVMessage *message) override;
+        bool Write(const grpc::ByteBuffer& message) override;
         void WritesComplete() override;
 
     public:
-        std::shared_ptr<grpc::ClientWriterInterface<grpc_labview::LVMessage>> _writer;
+        std::shared_ptr<grpc::ClientWriterInterface<grpc::ByteBuffer>> _writer;
 
     private:
         bool _writesComplete;
@@ -126,10 +132,10 @@ namespace grpc_labview
         void Finish() override;
         void WritesComplete() override;
         bool Read(LVMessage *message) override;
-        bool Write(LVMessage *message) override;
+        bool Write(const grpc::ByteBuffer& message) override;
 
     public:
-        std::shared_ptr<grpc::ClientReaderWriterInterface<grpc_labview::LVMessage, grpc_labview::LVMessage>> _readerWriter;
+        std::shared_ptr<grpc::ClientReaderWriterInterface<grpc::ByteBuffer, grpc_labview::LVMessage>> _readerWriter;
 
     private:
         bool _writesComplete;
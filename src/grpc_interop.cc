@@ -3,8 +3,10 @@
 #include <grpc_server.h>
 #include <cluster_copier.h>
 #include <lv_interop.h>
+#include <lv_message.h>
 #include <iostream>
 #include <memory>
+#include <cstring>
 #include <string>
 #include <map>
 #include <mutex>
@@ -171,6 +173,461 @@ LIBRARY_EXPORT int32_t LVGetServerListeningPort(grpc_labview::gRPCid** id, int*
     return 0;
 }
 
+//---------------------------------------------------------------------
+// Adds a listener, such as unix:/path or unix-abstract:name, to a server
+// that is not started yet.
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t LVAddServerListeningAddress(grpc_labview::gRPCid** id, const char* address)
+{
+    auto server = (*id)->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    if (server == nullptr)
+    {
+        return -1;
+    }
+    server->AddListeningAddress(address);
+    return 0;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t LVSetServerCompletionQueueCount(grpc_labview::gRPCid** id, int32_t completionQueueCount)
+{
+    auto server = (*id)->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    if (server == nullptr)
+    {
+        return -1;
+    }
+    server->SetCompletionQueueCount(completionQueueCount);
+    return 0;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t LVSetServerPendingCallCount(grpc_labview::gRPCid** id, int32_t pendingCallCount)
+{
+    auto server = (*id)->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    if (server == nullptr)
+    {
+        return -1;
+    }
+    server->SetPendingCallCount(pendingCallCount);
+    return 0;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t LVSetServerWriteQueueDepth(grpc_labview::gRPCid** id, int32_t writeQueueDepth)
+{
+    auto server = (*id)->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    if (server == nullptr)
+    {
+        return -1;
+    }
+    server->SetWriteQueueDepth(writeQueueDepth);
+    return 0;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t LVSetServerReadAheadDepth(grpc_labview::gRPCid** id, int32_t readAheadDepth)
+{
+    auto server = (*id)->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    if (server == nullptr)
+    {
+        return -1;
+    }
+    server->SetReadAheadDepth(readAheadDepth);
+    return 0;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t LVGetServerPendingCallStats(grpc_labview::gRPCid** id, int32_t* pendingCalls, uint64_t* acceptedCalls, uint64_t* pendingCallsExhausted)
+{
+    auto server = (*id)->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    if (server == nullptr)
+    {
+        return -1;
+    }
+    server->GetPendingCallStats(pendingCalls, acceptedCalls, pendingCallsExhausted);
+    return 0;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t LVSetServerConcurrencyLimit(grpc_labview::gRPCid** id, int32_t limit)
+{
+    auto server = (*id)->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    if (server == nullptr)
+    {
+        return -1;
+    }
+    server->SetConcurrencyLimit(limit);
+    return 0;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t LVSetServerMethodConcurrencyLimit(grpc_labview::gRPCid** id, const char* methodName, int32_t limit)
+{
+    auto server = (*id)->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    if (server == nullptr)
+    {
+        return -1;
+    }
+    server->SetMethodConcurrencyLimit(methodName, limit);
+    return 0;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t LVGetServerConcurrencyStats(grpc_labview::gRPCid** id, int32_t* inFlight, uint64_t* rejected)
+{
+    auto server = (*id)->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    if (server == nullptr)
+    {
+        return -1;
+    }
+    server->GetConcurrencyStats(inFlight, rejected);
+    return 0;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t LVGetServerMethodConcurrencyStats(grpc_labview::gRPCid** id, const char* methodName, int32_t* inFlight, uint64_t* rejected)
+{
+    auto server = (*id)->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    if (server == nullptr)
+    {
+        return -1;
+    }
+    if (!server->GetMethodConcurrencyStats(methodName, inFlight, rejected))
+    {
+        return -2;
+    }
+    return 0;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t LVSetServerMethodAdaptiveConcurrency(grpc_labview::gRPCid** id, const char* methodName, int32_t minLimit, int32_t maxLimit, double targetDelayMs)
+{
+    auto server = (*id)->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    if (server == nullptr)
+    {
+        return -1;
+    }
+    server->SetMethodAdaptiveConcurrency(methodName, minLimit, maxLimit, targetDelayMs * 1000);
+    return 0;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t LVGetServerMethodAdaptiveConcurrencyStats(grpc_labview::gRPCid** id, const char* methodName, int32_t* limit, double* minLatencyMs, double* smoothedLatencyMs, uint64_t* samples, uint64_t* decreases)
+{
+    auto server = (*id)->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    if (server == nullptr)
+    {
+        return -1;
+    }
+    double minLatencyUs;
+    double smoothedLatencyUs;
+    if (!server->GetMethodAdaptiveConcurrencyStats(methodName, limit, &minLatencyUs, &smoothedLatencyUs, samples, decreases))
+    {
+        return -2;
+    }
+    *minLatencyMs = minLatencyUs / 1000;
+    *smoothedLatencyMs = smoothedLatencyUs / 1000;
+    return 0;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t LVSetServerDispatchLimit(grpc_labview::gRPCid** id, int32_t limit)
+{
+    auto server = (*id)->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    if (server == nullptr)
+    {
+        return -1;
+    }
+    server->SetDispatchLimit(limit);
+    return 0;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t LVSetServerMethodPriority(grpc_labview::gRPCid** id, const char* methodName, int32_t priority)
+{
+    auto server = (*id)->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    if (server == nullptr)
+    {
+        return -1;
+    }
+    server->SetMethodPriority(methodName, priority);
+    return 0;
+}
+
+//---------------------------------------------------------------------
+// Compresses responses of at least minBytes with the given algorithm,
+// 0 none, 1 deflate or 2 gzip. Returns -2 for an unknown algorithm.
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t LVSetServerCompression(grpc_labview::gRPCid** id, int32_t algorithm, int32_t minBytes)
+{
+    auto server = (*id)->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    if (server == nullptr)
+    {
+        return -1;
+    }
+    grpc_labview::CompressionSettings compression;
+    if (!compression.Set(algorithm, minBytes))
+    {
+        return -2;
+    }
+    server->SetCompression(compression);
+    return 0;
+}
+
+//---------------------------------------------------------------------
+// Same as LVSetServerCompression for the responses of one method.
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t LVSetServerMethodCompression(grpc_labview::gRPCid** id, const char* methodName, int32_t algorithm, int32_t minBytes)
+{
+    auto server = (*id)->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    if (server == nullptr)
+    {
+        return -1;
+    }
+    grpc_labview::CompressionSettings compression;
+    if (!compression.Set(algorithm, minBytes))
+    {
+        return -2;
+    }
+    server->SetMethodCompression(methodName, compression);
+    return 0;
+}
+
+//---------------------------------------------------------------------
+// Caches up to maxBytes of the responses of a unary method whose response
+// only depends on its request, for timeToLiveMs each (0 keeps them until
+// they are evicted). A size of 0 or less stops caching the method.
+// Responses are keyed by the serialized request message alone. The request
+// metadata, including any credentials, is not part of the key, so a cached
+// response is returned to every client that sends the same request. Calls
+// that read more than one request are never cached.
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t LVSetServerMethodResponseCache(grpc_labview::gRPCid** id, const char* methodName, int32_t maxBytes, int32_t timeToLiveMs)
+{
+    auto server = (*id)->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    if (server == nullptr)
+    {
+        return -1;
+    }
+    server->SetMethodResponseCache(methodName, (size_t)std::max(0, maxBytes), timeToLiveMs);
+    return 0;
+}
+
+//---------------------------------------------------------------------
+// Returns -2 if the method is not cached by the running server.
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t LVGetServerMethodResponseCacheStats(grpc_labview::gRPCid** id, const char* methodName, uint64_t* hits, uint64_t* misses, int32_t* entries, uint64_t* bytes)
+{
+    auto server = (*id)->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    if (server == nullptr)
+    {
+        return -1;
+    }
+    auto cache = server->GetMethodResponseCache(methodName);
+    if (cache == nullptr)
+    {
+        return -2;
+    }
+    cache->GetStats(hits, misses, entries, bytes);
+    return 0;
+}
+
+//---------------------------------------------------------------------
+// Drops the cached responses of a method, for example after the data its
+// responses are computed from changed. Returns -2 if the method is not
+// cached by the running server.
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t LVClearServerMethodResponseCache(grpc_labview::gRPCid** id, const char* methodName)
+{
+    auto server = (*id)->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    if (server == nullptr)
+    {
+        return -1;
+    }
+    auto cache = server->GetMethodResponseCache(methodName);
+    if (cache == nullptr)
+    {
+        return -2;
+    }
+    cache->Clear();
+    return 0;
+}
+
+//---------------------------------------------------------------------
+// Coalesces calls of a unary method with the same request as a call in
+// progress, they are answered with its response. When the call in progress
+// reads more than its first request, the calls that waited for it are
+// posted to LabVIEW themselves.
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t LVSetServerMethodSingleFlight(grpc_labview::gRPCid** id, const char* methodName, int32_t enabled)
+{
+    auto server = (*id)->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    if (server == nullptr)
+    {
+        return -1;
+    }
+    server->SetMethodSingleFlight(methodName, enabled != 0);
+    return 0;
+}
+
+//---------------------------------------------------------------------
+// Returns -2 if the method's calls are not coalesced by the running server.
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t LVGetServerMethodSingleFlightStats(grpc_labview::gRPCid** id, const char* methodName, uint64_t* handledCalls, uint64_t* coalescedCalls)
+{
+    auto server = (*id)->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    if (server == nullptr)
+    {
+        return -1;
+    }
+    auto singleFlight = server->GetMethodSingleFlight(methodName);
+    if (singleFlight == nullptr)
+    {
+        return -2;
+    }
+    singleFlight->GetStats(handledCalls, coalescedCalls);
+    return 0;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t LVGetServerDispatchStats(grpc_labview::gRPCid** id, int32_t* queuedCalls, uint64_t* expiredCalls)
+{
+    auto server = (*id)->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    if (server == nullptr)
+    {
+        return -1;
+    }
+    server->GetDispatchStats(queuedCalls, expiredCalls);
+    return 0;
+}
+
+//---------------------------------------------------------------------
+// Latency metrics are returned in microseconds, message sizes in bytes.
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t LVGetServerMethodStats(grpc_labview::gRPCid** id, const char* methodName, int32_t metric, uint64_t* count, double* mean, double* p50, double* p90, double* p99, double* p999, double* max)
+{
+    auto server = (*id)->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    if (server == nullptr)
+    {
+        return -1;
+    }
+    auto stats = server->GetMethodStats(methodName);
+    if (stats == nullptr || metric < 0 || metric >= (int32_t)grpc_labview::CallMetric::Count)
+    {
+        return -2;
+    }
+    auto callMetric = (grpc_labview::CallMetric)metric;
+    auto scale = callMetric < grpc_labview::CallMetric::RequestBytes ? 1000.0 : 1.0;
+    auto snapshot = stats->Snapshot(callMetric);
+    *count = snapshot.count;
+    *mean = snapshot.Mean() / scale;
+    *p50 = snapshot.ValueAtQuantile(0.5) / scale;
+    *p90 = snapshot.ValueAtQuantile(0.9) / scale;
+    *p99 = snapshot.ValueAtQuantile(0.99) / scale;
+    *p999 = snapshot.ValueAtQuantile(0.999) / scale;
+    *max = snapshot.ValueAtQuantile(1) / scale;
+    return 0;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t LVResetServerMethodStats(grpc_labview::gRPCid** id, const char* methodName)
+{
+    auto server = (*id)->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    if (server == nullptr)
+    {
+        return -1;
+    }
+    auto stats = server->GetMethodStats(methodName);
+    if (stats == nullptr)
+    {
+        return -2;
+    }
+    stats->Reset();
+    return 0;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t LVResetServerStats(grpc_labview::gRPCid** id)
+{
+    auto server = (*id)->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    if (server == nullptr)
+    {
+        return -1;
+    }
+    server->ResetStats();
+    return 0;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t LVSetServerStatsServiceEnabled(grpc_labview::gRPCid** id, int32_t enabled)
+{
+    auto server = (*id)->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    if (server == nullptr)
+    {
+        return -1;
+    }
+    server->SetStatsServiceEnabled(enabled != 0);
+    return 0;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t LVGetServerCallPoolStats(grpc_labview::gRPCid** id, uint64_t* heapAllocations, uint64_t* reusedAllocations)
+{
+    auto server = (*id)->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    if (server == nullptr)
+    {
+        return -1;
+    }
+    server->GetCallPoolStats(heapAllocations, reusedAllocations);
+    return 0;
+}
+
+//---------------------------------------------------------------------
+// How long LVStopServer waits for the calls in progress before it cancels
+// them, can be changed until the server is stopped.
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t LVSetServerDrainTimeout(grpc_labview::gRPCid** id, int32_t timeoutMs)
+{
+    auto server = (*id)->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    if (server == nullptr)
+    {
+        return -1;
+    }
+    server->SetDrainTimeout(timeoutMs);
+    return 0;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t LVSetServerDrainEvent(grpc_labview::gRPCid** id, grpc_labview::LVUserEventRef* item)
+{
+    auto server = (*id)->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    if (server == nullptr)
+    {
+        return -1;
+    }
+    server->SetDrainEvent(*item);
+    return 0;
+}
+
 //---------------------------------------------------------------------
 //---------------------------------------------------------------------
 LIBRARY_EXPORT int32_t LVStopServer(grpc_labview::gRPCid** id)
@@ -181,6 +638,7 @@ LIBRARY_EXPORT int32_t LVStopServer(grpc_labview::gRPCid** id)
         return -1;
     }
     server->StopServer();
+    server->ReleaseWhenCallsClosed(server);
 
     grpc_labview::DeregisterCleanupProc(ServerCleanupProc, *id);
     grpc_labview::gPointerManager.UnregisterPointer(server.get());
@@ -320,9 +778,10 @@ LIBRARY_EXPORT int32_t GetRequestData(grpc_labview::gRPCid** id, int8_t* lvReque
     }
     if (data->_call->IsActive() && data->_call->ReadNext())
     {
+        bool copied;
         try
         {
-            grpc_labview::ClusterDataCopier::CopyToCluster(*data->_request, lvRequest);
+            copied = data->_call->CopyRequestToCluster(lvRequest);
         }
         catch (grpc_labview::InvalidEnumValueException& e)
         {
@@ -331,7 +790,7 @@ LIBRARY_EXPORT int32_t GetRequestData(grpc_labview::gRPCid** id, int8_t* lvReque
             return e.code;
         }
         data->_call->ReadComplete();
-        return 0;
+        return copied ? 0 : -2;
     }
     return -2;
 }
@@ -345,9 +804,162 @@ LIBRARY_EXPORT int32_t SetResponseData(grpc_labview::gRPCid** id, int8_t* lvRequ
     {
         return -1;
     }
+    if (data->_call->IsCancelled())
+    {
+        return -(1000 + grpc::StatusCode::CANCELLED);
+    }
+    if (data->_call->IsWriteQueueFull())
+    {
+        // Back-pressure, the response was not sent and may be set again once the queue drains.
+        return -(1000 + grpc::StatusCode::RESOURCE_EXHAUSTED);
+    }
+    grpc::ByteBuffer response;
+    try
+    {
+        data->_call->SerializeResponse(lvRequest, &response);
+    }
+    catch (grpc_labview::InvalidEnumValueException& e)
+    {
+        return e.code;
+    }
+    if (data->_call->IsCancelled())
+    {
+        return -(1000 + grpc::StatusCode::CANCELLED);
+    }
+    if (!data->_call->IsActive() || !data->_call->Write(response))
+    {
+        return -2;
+    }
+    return 0;
+}
+
+//---------------------------------------------------------------------
+// Shortens an array of clusters to count. LabVIEW only disposes of the
+// clusters it counts, so the handles of the dropped ones are released first.
+//---------------------------------------------------------------------
+static void TruncateClusterArray(grpc_labview::LV1DArrayHandle array, const grpc_labview::MessageMetadata& metadata, int32_t count)
+{
+    for (int32_t x = count; x < (*array)->cnt; ++x)
+    {
+        grpc_labview::ClusterDataCopier::ReleaseClusterHandles(metadata, (int8_t*)(*array)->bytes(x * metadata.clusterSize, metadata.alignmentRequirement));
+    }
+    (*array)->cnt = count;
+}
+
+//---------------------------------------------------------------------
+// Copies up to maxCount requests of a streaming call into an array of request
+// clusters. Waits for the first request like GetRequestData, the others are
+// only taken when they were already received (see LVSetServerReadAheadDepth).
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t GetRequestDataBatch(grpc_labview::gRPCid** id, grpc_labview::LV1DArrayHandle* lvRequests, int32_t maxCount, int32_t* count)
+{
+    auto data = (*id)->CastTo<grpc_labview::GenericMethodData>();
+    if (data == nullptr || data->_request->_metadata == nullptr)
+    {
+        return -1;
+    }
+    *count = 0;
+    if (data->_call->IsCancelled())
+    {
+        return -(1000 + grpc::StatusCode::CANCELLED);
+    }
+    if (!data->_call->IsActive() || !data->_call->ReadNext())
+    {
+        return -2;
+    }
+    auto batchCount = std::max(1, std::min(maxCount, data->_call->BufferedRequestCount()));
+
+    auto metadata = data->_request->_metadata;
+    auto clusterSize = metadata->clusterSize;
+    auto alignment = metadata->alignmentRequirement;
+    auto byteSize = batchCount * clusterSize;
+    auto alignedElementSize = byteSize / alignment;
+    if (byteSize % alignment != 0)
+    {
+        alignedElementSize++;
+    }
+    int32_t previousCount = (*lvRequests != nullptr && **lvRequests != nullptr) ? (**lvRequests)->cnt : 0;
+    if (batchCount < previousCount)
+    {
+        TruncateClusterArray(*lvRequests, *metadata, batchCount);
+    }
+    if (grpc_labview::NumericArrayResize(grpc_labview::GetTypeCodeForSize(alignment), 1, lvRequests, alignedElementSize) != 0)
+    {
+        data->_call->ReadComplete();
+        return -2;
+    }
+    auto array = *lvRequests;
+    if (previousCount < batchCount)
+    {
+        // Clusters past the previous end of the array are uninitialized.
+        memset((*array)->bytes(previousCount * clusterSize, alignment), 0, (batchCount - previousCount) * clusterSize);
+    }
+    (*array)->cnt = batchCount;
+
+    for (int32_t x = 0; x < batchCount; ++x)
+    {
+        if (x > 0 && !data->_call->ReadNext())
+        {
+            break;
+        }
+        bool copied;
+        try
+        {
+            copied = data->_call->CopyRequestToCluster((int8_t*)(*array)->bytes(x * clusterSize, alignment));
+        }
+        catch (grpc_labview::InvalidEnumValueException& e)
+        {
+            // Before returning, set the call to complete, otherwise the server hangs waiting for the call.
+            data->_call->ReadComplete();
+            TruncateClusterArray(array, *metadata, *count);
+            return e.code;
+        }
+        data->_call->ReadComplete();
+        if (!copied)
+        {
+            TruncateClusterArray(array, *metadata, *count);
+            return -2;
+        }
+        *count = x + 1;
+    }
+    TruncateClusterArray(array, *metadata, *count);
+    return 0;
+}
+
+//---------------------------------------------------------------------
+// Sends every response cluster in the array, the responses are queued as one
+// batch so that gRPC can coalesce them into as few frames as possible.
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t SetResponseDataBatch(grpc_labview::gRPCid** id, grpc_labview::LV1DArrayHandle* lvResponses)
+{
+    auto data = (*id)->CastTo<grpc_labview::GenericMethodData>();
+    if (data == nullptr || data->_response->_metadata == nullptr)
+    {
+        return -1;
+    }
+    if (data->_call->IsCancelled())
+    {
+        return -(1000 + grpc::StatusCode::CANCELLED);
+    }
+    auto array = *lvResponses;
+    if (array == nullptr || *array == nullptr || (*array)->cnt == 0)
+    {
+        return 0;
+    }
+    if (data->_call->IsWriteQueueFull())
+    {
+        // Back-pressure, none of the responses were sent and the batch may be set again once the queue drains.
+        return -(1000 + grpc::StatusCode::RESOURCE_EXHAUSTED);
+    }
+    auto clusterSize = data->_response->_metadata->clusterSize;
+    auto alignment = data->_response->_metadata->alignmentRequirement;
+    std::vector<grpc::ByteBuffer> responses((*array)->cnt);
     try
     {
-        grpc_labview::ClusterDataCopier::CopyFromCluster(*data->_response, lvRequest);
+        for (int32_t x = 0; x < (*array)->cnt; ++x)
+        {
+            data->_call->SerializeResponse((int8_t*)(*array)->bytes(x * clusterSize, alignment), &responses[x]);
+        }
     }
     catch (grpc_labview::InvalidEnumValueException& e)
     {
@@ -357,7 +969,7 @@ LIBRARY_EXPORT int32_t SetResponseData(grpc_labview::gRPCid** id, int8_t* lvRequ
     {
         return -(1000 + grpc::StatusCode::CANCELLED);
     }
-    if (!data->_call->IsActive() || !data->_call->Write())
+    if (!data->_call->IsActive() || !data->_call->Write(responses.data(), responses.size()))
     {
         return -2;
     }
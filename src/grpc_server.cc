@@ -1,12 +1,15 @@
 //---------------------------------------------------------------------
 //---------------------------------------------------------------------
 #include <grpc_server.h>
+#include <feature_toggles.h>
+#include <server_stats_service.h>
 #include <grpcpp/ext/proto_server_reflection_plugin.h>
 #include <thread>
 #include <sstream>
 #include <fstream>
 #include <iostream>
 #include <future>
+#include <algorithm>
 #include <grpcpp/impl/server_initializer.h>
 #include "lv_proto_server_reflection_plugin.h"
 
@@ -20,12 +23,679 @@ using grpc::ServerInitializer;
 
 namespace grpc_labview
 {
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    CompletionQueueData::CompletionQueueData() :
+        pendingCalls(0),
+        activeOperations(0),
+        closed(false),
+        callDataPool(new BlockPool()),
+        callFinishedPool(new BlockPool()),
+        methodDataPool(new BlockPool()),
+        messagePool(new BlockPool())
+    {
+    }
+
+    //---------------------------------------------------------------------
+    // Calls that are still in progress keep their pools alive until they
+    // are released.
+    //---------------------------------------------------------------------
+    CompletionQueueData::~CompletionQueueData()
+    {
+        callDataPool->Destroy();
+        callFinishedPool->Destroy();
+        methodDataPool->Destroy();
+        messagePool->Destroy();
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    bool CompletionQueueData::BeginOperation()
+    {
+        ++activeOperations;
+        if (closed)
+        {
+            EndOperation();
+            return false;
+        }
+        return true;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void CompletionQueueData::EndOperation()
+    {
+        if (--activeOperations == 0 && closed)
+        {
+            std::lock_guard<std::mutex> lock(operationMutex);
+            operationsEnded.notify_all();
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Waits for the operations being started to be started.
+    //---------------------------------------------------------------------
+    void CompletionQueueData::Close()
+    {
+        closed = true;
+        std::unique_lock<std::mutex> lock(operationMutex);
+        operationsEnded.wait(lock, [this]() { return activeOperations == 0; });
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    CallLimit::CallLimit() :
+        limit(0),
+        inFlight(0),
+        rejected(0)
+    {
+    }
+
+    //---------------------------------------------------------------------
+    // Counts a call as in progress unless the limit is already reached.
+    //---------------------------------------------------------------------
+    bool CallLimit::TryAcquire()
+    {
+        auto current = inFlight.load();
+        do
+        {
+            auto max = limit.load();
+            if (max > 0 && current >= max)
+            {
+                rejected++;
+                return false;
+            }
+        } while (!inFlight.compare_exchange_weak(current, current + 1));
+        return true;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void CallLimit::Release()
+    {
+        inFlight--;
+    }
+
+    //---------------------------------------------------------------------
+    // Orders the dispatch queue so that its top is the call to post next.
+    //---------------------------------------------------------------------
+    bool QueuedDispatch::operator<(const QueuedDispatch& other) const
+    {
+        if (priority != other.priority)
+        {
+            return priority < other.priority;
+        }
+        if (deadline != other.deadline)
+        {
+            return deadline > other.deadline;
+        }
+        return sequence > other.sequence;
+    }
+
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     LabVIEWgRPCServer::LabVIEWgRPCServer() :
-        _shutdown(false),
-        _genericMethodEvent(0)
+        _genericMethodEvent(0),
+        _pendingCallCount(1),
+        _writeQueueDepth(0),
+        _readAheadDepth(0),
+        _efficientMessageCopy(false),
+        _efficientResponseCopy(false),
+        _statsServiceEnabled(false),
+        _acceptedCalls(0),
+        _pendingCallsExhausted(0),
+        _dispatchLimit(0),
+        _dispatchedCalls(0),
+        _dispatchSequence(0),
+        _expiredCalls(0),
+        _drainTimeoutMs(0),
+        _drainEvent(0),
+        _stopping(false),
+        _shutdown(false)
+    {
+        SetCompletionQueueCount(0);
+    }
+
+    //---------------------------------------------------------------------
+    // Sets the number of completion queues, each polled by its own thread, used to
+    // serve calls. A count of zero or less uses one queue per hardware core.
+    // Must be called before Run.
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::SetCompletionQueueCount(int count)
+    {
+        if (count <= 0)
+        {
+            count = std::max(1u, std::thread::hardware_concurrency());
+        }
+        _completionQueueCount = count;
+    }
+
+    //---------------------------------------------------------------------
+    // Sets the number of calls posted to each completion queue ahead of time.
+    // Every accepted call is immediately replaced by a new one so that bursts
+    // of incoming calls do not wait for a call to be posted. Must be called before Run.
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::SetPendingCallCount(int count)
+    {
+        _pendingCallCount = std::max(1, count);
+    }
+
+    //---------------------------------------------------------------------
+    // Sets the number of responses a call may have written but not yet sent.
+    // With a depth of zero SetResponseData waits for every response to be sent,
+    // otherwise responses are queued and sent back to back as each write completes.
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::SetWriteQueueDepth(int depth)
+    {
+        _writeQueueDepth = std::max(0, depth);
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    int LabVIEWgRPCServer::WriteQueueDepth()
+    {
+        return _writeQueueDepth;
+    }
+
+    //---------------------------------------------------------------------
+    // Sets the number of requests a streaming call receives ahead of GetRequestData.
+    // With a depth of zero every request is read when GetRequestData asks for it,
+    // otherwise the next request is read as soon as the previous one arrives.
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::SetReadAheadDepth(int depth)
+    {
+        _readAheadDepth = std::max(0, depth);
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    int LabVIEWgRPCServer::ReadAheadDepth()
+    {
+        return _readAheadDepth;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::GetPendingCallStats(int32_t* pendingCalls, uint64_t* acceptedCalls, uint64_t* pendingCallsExhausted)
+    {
+        int32_t pending = 0;
+        for (auto& queue : _cqs)
+        {
+            pending += queue->pendingCalls;
+        }
+        *pendingCalls = pending;
+        *acceptedCalls = _acceptedCalls;
+        *pendingCallsExhausted = _pendingCallsExhausted;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::GetCallPoolStats(uint64_t* heapAllocations, uint64_t* reusedAllocations)
+    {
+        *heapAllocations = 0;
+        *reusedAllocations = 0;
+        for (auto& queue : _cqs)
+        {
+            for (auto pool : { queue->callDataPool, queue->callFinishedPool, queue->methodDataPool, queue->messagePool })
+            {
+                *heapAllocations += pool->HeapAllocations();
+                *reusedAllocations += pool->ReusedAllocations();
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Sets the number of calls the server serves at the same time, over all
+    // methods. Calls over the limit are rejected with RESOURCE_EXHAUSTED.
+    // Zero or less removes the limit.
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::SetConcurrencyLimit(int limit)
+    {
+        _callLimit.limit = limit;
+    }
+
+    //---------------------------------------------------------------------
+    // Sets the number of calls of one method the server serves at the same time.
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::SetMethodConcurrencyLimit(const std::string& methodName, int limit)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _methodConcurrencyLimits[methodName] = limit;
+        auto method = _serverMethods.find(methodName);
+        if (method != _serverMethods.end())
+        {
+            method->second.callLimit->limit = limit;
+        }
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::GetConcurrencyStats(int32_t* inFlight, uint64_t* rejected)
+    {
+        *inFlight = _callLimit.inFlight;
+        *rejected = _callLimit.rejected;
+    }
+
+    //---------------------------------------------------------------------
+    // Returns false if the method is not served by the running server.
+    //---------------------------------------------------------------------
+    bool LabVIEWgRPCServer::GetMethodConcurrencyStats(const std::string& methodName, int32_t* inFlight, uint64_t* rejected)
+    {
+        auto method = FindServerMethod(methodName);
+        if (method == nullptr)
+        {
+            return false;
+        }
+        *inFlight = method->callLimit->inFlight;
+        *rejected = method->callLimit->rejected;
+        return true;
+    }
+
+    //---------------------------------------------------------------------
+    // Lets the limit of a method follow the time LabVIEW takes to handle its
+    // calls, from posting the server event to closing it, keeping the delay
+    // above the fastest calls near targetDelayUs. Must be called before Run.
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::SetMethodAdaptiveConcurrency(const std::string& methodName, int32_t minLimit, int32_t maxLimit, double targetDelayUs)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _methodAdaptiveLimits[methodName] = { minLimit, maxLimit, targetDelayUs };
+    }
+
+    //---------------------------------------------------------------------
+    // Returns false if the method is not served by the running server or its limit is not adaptive.
+    //---------------------------------------------------------------------
+    bool LabVIEWgRPCServer::GetMethodAdaptiveConcurrencyStats(const std::string& methodName, int32_t* limit, double* minLatencyUs, double* smoothedLatencyUs, uint64_t* samples, uint64_t* decreases)
+    {
+        auto method = FindServerMethod(methodName);
+        if (method == nullptr || method->callLimit->adaptiveLimiter == nullptr)
+        {
+            return false;
+        }
+        method->callLimit->adaptiveLimiter->GetStats(limit, minLatencyUs, smoothedLatencyUs, samples, decreases);
+        return true;
+    }
+
+    //---------------------------------------------------------------------
+    // Called when LabVIEW closes the server event of a call.
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::CallHandled(const LVEventData* eventData, std::chrono::steady_clock::duration latency)
+    {
+        if (eventData != nullptr && eventData->callLimit->adaptiveLimiter != nullptr)
+        {
+            auto latencyUs = std::chrono::duration<double, std::micro>(latency).count();
+            auto& callLimit = *eventData->callLimit;
+            callLimit.limit = callLimit.adaptiveLimiter->AddSample(latencyUs, callLimit.inFlight);
+        }
+        if (_dispatchLimit <= 0)
+        {
+            return;
+        }
+
+        // The handled call's slot passes to the next queued call that is still worth handling.
+        while (true)
+        {
+            CallData* next;
+            {
+                std::lock_guard<std::mutex> lock(_dispatchMutex);
+                if (_dispatchQueue.empty())
+                {
+                    --_dispatchedCalls;
+                    return;
+                }
+                next = _dispatchQueue.top().call;
+                _dispatchQueue.pop();
+            }
+            if (!next->HasExpired())
+            {
+                next->PostEvent();
+                return;
+            }
+            CallExpired();
+            next->FinishUnposted(grpc::StatusCode::DEADLINE_EXCEEDED, "Deadline expired before the call was handled");
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Sets how many calls may be posted to LabVIEW and not yet closed. Further
+    // calls wait in the server, ordered by method priority and deadline, instead
+    // of in the LabVIEW event queue. A limit of zero or less, the default, posts
+    // every call as soon as its request is read. Must be called before Run.
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::SetDispatchLimit(int limit)
+    {
+        _dispatchLimit = std::max(0, limit);
+    }
+
+    //---------------------------------------------------------------------
+    // Sets the priority class of a method, calls of a higher class are posted
+    // first when calls wait for a dispatch slot. Must be called before Run.
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::SetMethodPriority(const std::string& methodName, int priority)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _methodPriorities[methodName] = priority;
+    }
+
+    //---------------------------------------------------------------------
+    // Sets how the responses of methods without their own compression
+    // settings are compressed. Must be called before Run.
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::SetCompression(const CompressionSettings& compression)
+    {
+        _compression = compression;
+    }
+
+    //---------------------------------------------------------------------
+    // Must be called before Run.
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::SetMethodCompression(const std::string& methodName, const CompressionSettings& compression)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _methodCompression[methodName] = compression;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    const CompressionSettings& LabVIEWgRPCServer::Compression()
+    {
+        return _compression;
+    }
+
+    //---------------------------------------------------------------------
+    // Answers repeated requests of a unary method with the response LabVIEW
+    // gave for the same request bytes, without posting the server event.
+    // A size of zero or less stops caching the method. Must be called before Run.
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::SetMethodResponseCache(const std::string& methodName, size_t maxBytes, int32_t timeToLiveMs)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (maxBytes == 0)
+        {
+            _methodResponseCaches.erase(methodName);
+            return;
+        }
+        _methodResponseCaches[methodName] = { maxBytes, timeToLiveMs };
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    std::shared_ptr<ResponseCache> LabVIEWgRPCServer::GetMethodResponseCache(const std::string& methodName)
+    {
+        auto method = FindServerMethod(methodName);
+        return method != nullptr ? method->responseCache : nullptr;
+    }
+
+    //---------------------------------------------------------------------
+    // Lets calls of a unary method whose request is identical to a call in
+    // progress wait for that call and share its response, instead of each
+    // being posted to LabVIEW. Must be called before Run.
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::SetMethodSingleFlight(const std::string& methodName, bool enabled)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (enabled)
+        {
+            _singleFlightMethods.insert(methodName);
+        }
+        else
+        {
+            _singleFlightMethods.erase(methodName);
+        }
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    std::shared_ptr<SingleFlight> LabVIEWgRPCServer::GetMethodSingleFlight(const std::string& methodName)
+    {
+        auto method = FindServerMethod(methodName);
+        return method != nullptr ? method->singleFlight : nullptr;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::GetDispatchStats(int32_t* queuedCalls, uint64_t* expiredCalls)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_dispatchMutex);
+            *queuedCalls = (int32_t)_dispatchQueue.size();
+        }
+        *expiredCalls = _expiredCalls;
+    }
+
+    //---------------------------------------------------------------------
+    // Posts the call to LabVIEW, or queues it until a dispatch slot is free.
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::DispatchCall(CallData* call)
+    {
+        if (_dispatchLimit > 0)
+        {
+            std::unique_lock<std::mutex> lock(_dispatchMutex);
+            if (_shutdown)
+            {
+                // The queue was already cancelled by StopServer.
+                lock.unlock();
+                call->FinishUnposted(grpc::StatusCode::UNAVAILABLE, "Server is shutting down");
+                return;
+            }
+            if (_dispatchedCalls >= _dispatchLimit)
+            {
+                auto eventData = call->EventData();
+                _dispatchQueue.push({ eventData != nullptr ? eventData->priority : 0, call->Deadline(), _dispatchSequence++, call });
+                return;
+            }
+            ++_dispatchedCalls;
+        }
+        call->PostEvent();
+    }
+
+    //---------------------------------------------------------------------
+    // Counts a call that was finished with DEADLINE_EXCEEDED instead of being posted.
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::CallExpired()
+    {
+        _expiredCalls++;
+    }
+
+    //---------------------------------------------------------------------
+    // Returns the statistics of a method of the running server, or null if the
+    // method is not served.
+    //---------------------------------------------------------------------
+    std::shared_ptr<MethodStats> LabVIEWgRPCServer::GetMethodStats(const std::string& methodName)
+    {
+        auto method = FindServerMethod(methodName);
+        return method != nullptr ? method->stats : nullptr;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::ResetStats()
+    {
+        for (auto& method : _serverMethods)
+        {
+            method.second.stats->Reset();
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Serves the grpc_labview.stats.ServerStats service next to the LabVIEW
+    // methods, so the statistics can be read by any gRPC client.
+    // Must be called before Run.
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::SetStatsServiceEnabled(bool enabled)
+    {
+        _statsServiceEnabled = enabled;
+    }
+
+    //---------------------------------------------------------------------
+    // Names of the methods served by the running server.
+    //---------------------------------------------------------------------
+    std::vector<std::string> LabVIEWgRPCServer::ServerMethodNames()
+    {
+        std::vector<std::string> names;
+        for (auto& method : _serverMethods)
+        {
+            names.push_back(method.first);
+        }
+        std::sort(names.begin(), names.end());
+        return names;
+    }
+
+    //---------------------------------------------------------------------
+    // Sets how long StopServer lets the calls in progress finish before it
+    // cancels them. With the default of zero or less they are cancelled at once.
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::SetDrainTimeout(int timeoutMs)
+    {
+        _drainTimeoutMs = std::max(0, timeoutMs);
+    }
+
+    //---------------------------------------------------------------------
+    // Sets the user event StopServer posts its progress to, see DrainProgress.
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::SetDrainEvent(LVUserEventRef event)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _drainEvent = event;
+    }
+
+    //---------------------------------------------------------------------
+    // True once StopServer started, new calls are refused from then on.
+    //---------------------------------------------------------------------
+    bool LabVIEWgRPCServer::IsStopping()
+    {
+        return _stopping;
+    }
+
+    //---------------------------------------------------------------------
+    // True once gRPC cancelled the calls that were left when StopServer
+    // shut the server down.
+    //---------------------------------------------------------------------
+    bool LabVIEWgRPCServer::IsShutdown()
+    {
+        return _shutdown;
+    }
+
+    //---------------------------------------------------------------------
+    // Called with the last reference to a stopped server. Calls that were
+    // cancelled while LabVIEW held them still refer to the server, so it is
+    // deleted when the last of them is closed instead of now.
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::ReleaseWhenCallsClosed(std::shared_ptr<LabVIEWgRPCServer> self)
+    {
+        std::lock_guard<std::mutex> lock(_drainMutex);
+        if (_callLimit.inFlight > 0)
+        {
+            _keepAlive = self;
+        }
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::ReportDrainProgress(DrainPhase phase)
+    {
+        LVUserEventRef event;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            event = _drainEvent;
+        }
+        if (event != 0)
+        {
+            DrainProgress progress = { (int32_t)phase, _callLimit.inFlight.load() };
+            PostUserEvent(event, &progress);
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Finishes the calls still waiting for a dispatch slot when the server stops.
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::CancelQueuedDispatches()
     {
+        std::vector<CallData*> calls;
+        {
+            std::lock_guard<std::mutex> lock(_dispatchMutex);
+            while (!_dispatchQueue.empty())
+            {
+                calls.push_back(_dispatchQueue.top().call);
+                _dispatchQueue.pop();
+            }
+        }
+        for (auto call : calls)
+        {
+            call->FinishUnposted(grpc::StatusCode::UNAVAILABLE, "Server is shutting down");
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Counts an accepted call against the server and method limits. Returns
+    // false, without counting it, if either limit is already reached.
+    //---------------------------------------------------------------------
+    bool LabVIEWgRPCServer::AdmitCall(const LVEventData* eventData)
+    {
+        if (!_callLimit.TryAcquire())
+        {
+            return false;
+        }
+        if (eventData != nullptr && !eventData->callLimit->TryAcquire())
+        {
+            // Kept until the function returns, after its last use of the server.
+            auto self = ReleaseServerCallSlot();
+            return false;
+        }
+        return true;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::ReleaseCall(const LVEventData* eventData)
+    {
+        if (eventData != nullptr)
+        {
+            eventData->callLimit->Release();
+        }
+        // Kept until the function returns, after its last use of the server.
+        auto self = ReleaseServerCallSlot();
+    }
+
+    //---------------------------------------------------------------------
+    // Releases a call from the server limit. The count is decremented and
+    // the server kept alive for the calls of a stopped server is handed off
+    // in one step under _drainMutex, so ReleaseWhenCallsClosed either sees
+    // the call in flight or sees none and keeps nothing alive. Returns the
+    // last reference to a stopped server once its last call is released.
+    //---------------------------------------------------------------------
+    std::shared_ptr<LabVIEWgRPCServer> LabVIEWgRPCServer::ReleaseServerCallSlot()
+    {
+        std::shared_ptr<LabVIEWgRPCServer> self;
+        std::lock_guard<std::mutex> lock(_drainMutex);
+        _callLimit.Release();
+        if (_stopping)
+        {
+            if (_drainTimeoutMs > 0 && !_shutdown)
+            {
+                // StopServer is waiting in Shutdown for the calls in progress.
+                ReportDrainProgress(DrainPhase::Draining);
+            }
+            if (_callLimit.inFlight == 0)
+            {
+                self.swap(_keepAlive);
+            }
+        }
+        return self;
+    }
+
+    //---------------------------------------------------------------------
+    // Called when one of the posted calls of the queue is matched with a client
+    // call, before it is replaced. If it was the last posted call of the queue
+    // then incoming calls had to wait and the pool was exhausted.
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::CallAccepted(CompletionQueueData* queue)
+    {
+        _acceptedCalls++;
+        if (--queue->pendingCalls == 0)
+        {
+            _pendingCallsExhausted++;
+        }
     }
 
     //---------------------------------------------------------------------
@@ -48,38 +718,76 @@ namespace grpc_labview
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    void LabVIEWgRPCServer::SendEvent(std::string name, gRPCid* data)
+    void LabVIEWgRPCServer::SendEvent(const LVEventData* eventData, const std::string& name, gRPCid* data)
     {
         if (HasGenericMethodEvent())
         {
             OccurServerEvent(_genericMethodEvent, data, name);
         }
-        else
+        else if (eventData != nullptr)
         {
-            auto eventData = _registeredServerMethods.find(name);
-            if (eventData != _registeredServerMethods.end())
-            {
-                OccurServerEvent(eventData->second.event, data);
-            }
+            OccurServerEvent(eventData->event, data);
         }
     }
 
     //---------------------------------------------------------------------
+    // Returns the registered method for the method path, or null if the method
+    // is not registered. The method table does not change while the server is
+    // running so no lock is needed.
     //---------------------------------------------------------------------
-    bool LabVIEWgRPCServer::FindEventData(std::string name, LVEventData& data)
+    const LVEventData* LabVIEWgRPCServer::FindServerMethod(const std::string& methodName)
     {
-        auto eventData = _registeredServerMethods.find(name);
-        if (eventData != _registeredServerMethods.end())
+        auto eventData = _serverMethods.find(methodName);
+        if (eventData != _serverMethods.end())
         {
-            data = eventData->second;
-            return true;
+            return &eventData->second;
         }
-        return false;
+        return nullptr;
     }
 
-    bool LabVIEWgRPCServer::HasRegisteredServerMethod(std::string methodName)
+    //---------------------------------------------------------------------
+    // Copies the registered methods into the table used by the running server
+    // and resolves their request and response metadata.
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::FreezeServerMethods()
     {
-        return _registeredServerMethods.find(methodName) != _registeredServerMethods.end();
+        std::lock_guard<std::mutex> lock(_mutex);
+        _serverMethods.clear();
+        _serverMethods.reserve(_registeredServerMethods.size());
+        for (auto& method : _registeredServerMethods)
+        {
+            auto eventData = method.second;
+            eventData.requestMetadata = FindMetadata(eventData.requestMetadataName);
+            eventData.responseMetadata = FindMetadata(eventData.responseMetadataName);
+            eventData.callLimit = std::make_shared<CallLimit>();
+            eventData.stats = std::make_shared<MethodStats>();
+            auto limit = _methodConcurrencyLimits.find(method.first);
+            if (limit != _methodConcurrencyLimits.end())
+            {
+                eventData.callLimit->limit = limit->second;
+            }
+            auto priority = _methodPriorities.find(method.first);
+            eventData.priority = priority != _methodPriorities.end() ? priority->second : 0;
+            auto compression = _methodCompression.find(method.first);
+            eventData.compression = compression != _methodCompression.end() ? compression->second : _compression;
+            auto responseCache = _methodResponseCaches.find(method.first);
+            if (responseCache != _methodResponseCaches.end())
+            {
+                eventData.responseCache = std::make_shared<ResponseCache>(responseCache->second.maxBytes, responseCache->second.timeToLiveMs);
+            }
+            if (_singleFlightMethods.count(method.first) != 0)
+            {
+                eventData.singleFlight = std::make_shared<SingleFlight>();
+            }
+            auto adaptiveLimit = _methodAdaptiveLimits.find(method.first);
+            if (adaptiveLimit != _methodAdaptiveLimits.end())
+            {
+                auto& settings = adaptiveLimit->second;
+                eventData.callLimit->adaptiveLimiter = std::make_unique<AdaptiveLimiter>(settings.minLimit, settings.maxLimit, settings.targetDelayUs);
+                eventData.callLimit->limit = eventData.callLimit->adaptiveLimiter->Limit();
+            }
+            _serverMethods.emplace(method.first, eventData);
+        }
     }
 
     //---------------------------------------------------------------------
@@ -89,6 +797,23 @@ namespace grpc_labview
         return _genericMethodEvent != 0;
     }
 
+    //---------------------------------------------------------------------
+    // True if requests are kept serialized until LabVIEW asks for them and then
+    // parsed directly into the LabVIEW cluster.
+    //---------------------------------------------------------------------
+    bool LabVIEWgRPCServer::UseEfficientMessageCopy()
+    {
+        return _efficientMessageCopy;
+    }
+
+    //---------------------------------------------------------------------
+    // True if responses are serialized directly from the LabVIEW cluster.
+    //---------------------------------------------------------------------
+    bool LabVIEWgRPCServer::UseEfficientResponseCopy()
+    {
+        return _efficientResponseCopy;
+    }
+
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     int LabVIEWgRPCServer::ListeningPort()
@@ -96,11 +821,44 @@ namespace grpc_labview
         return _listeningPort;
     }
 
+    //---------------------------------------------------------------------
+    // Adds a listener in addition to the address given to Run, for example a
+    // unix: or unix-abstract: address for clients on the same machine. Every
+    // listener uses the credentials given to Run. Must be called before Run.
+    //---------------------------------------------------------------------
+    void LabVIEWgRPCServer::AddListeningAddress(const std::string& address)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _listeningAddresses.push_back(address);
+    }
+
+    //---------------------------------------------------------------------
+    // Channel to the running server for clients in the same process. Calls
+    // on it are passed to the server directly, without sockets or HTTP/2
+    // framing. Null if the server is not running. Holds _mutex so that
+    // StopServer cannot release the server while the channel is created.
+    //---------------------------------------------------------------------
+    std::shared_ptr<grpc::Channel> LabVIEWgRPCServer::InProcessChannel()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_server == nullptr || _stopping)
+        {
+            return nullptr;
+        }
+        grpc::ChannelArguments args;
+        args.SetMaxReceiveMessageSize(-1);
+        args.SetMaxSendMessageSize(-1);
+        return _server->InProcessChannel(args);
+    }
+
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     int LabVIEWgRPCServer::Run(std::string address, std::string serverCertificatePath, std::string serverKeyPath)
     {
         FinalizeMetadata();
+        FreezeServerMethods();
+        _efficientMessageCopy = FeatureConfig::getInstance().isFeatureEnabled("data_EfficientServerMessageCopy");
+        _efficientResponseCopy = FeatureConfig::getInstance().isFeatureEnabled("data_EfficientServerResponseCopy");
 
         auto serverStarted = new ServerStartEventData;
         _runThread = std::make_unique<std::thread>(StaticRunServer, this, address, serverCertificatePath, serverKeyPath, serverStarted);
@@ -137,23 +895,23 @@ namespace grpc_labview
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    void LabVIEWgRPCServer::HandleRpcs(grpc::ServerCompletionQueue *cq)
+    void LabVIEWgRPCServer::HandleRpcs(CompletionQueueData* queue)
     {
-        // Spawn a new CallData instance to serve new clients.
-        new CallData(this, _rpcService.get(), cq);
+        // Spawn new CallData instances to serve new clients.
+        for (int x = 0; x < _pendingCallCount; ++x)
+        {
+            new (queue->callDataPool) CallData(this, _rpcService.get(), queue);
+        }
+        auto cq = queue->cq.get();
         void *tag; // uniquely identifies a request.
         bool ok;
-        while (true)
+        // Block waiting to read the next event from the completion queue. The
+        // event is uniquely identified by its tag, which in this case is the
+        // memory address of a CallData instance. Events keep being processed
+        // after the server is shut down, so every call sees its operations
+        // fail, until the queue is shut down and empty.
+        while (cq->Next(&tag, &ok))
         {
-            if (_shutdown)
-            {
-                break;
-            }
-
-            // Block waiting to read the next event from the completion queue. The
-            // event is uniquely identified by its tag, which in this case is the
-            // memory address of a CallData instance.
-            cq->Next(&tag, &ok);
             static_cast<CallDataBase*>(tag)->Proceed(ok);
         }
     }
@@ -214,20 +972,48 @@ namespace grpc_labview
             creds = grpc::InsecureServerCredentials();
         }
         builder.AddListeningPort(server_address, creds, &_listeningPort);
+        for (auto& listeningAddress : _listeningAddresses)
+        {
+            builder.AddListeningPort(listeningAddress, creds);
+        }
         builder.SetMaxSendMessageSize(-1);
         builder.SetMaxReceiveMessageSize(-1);
 
         _rpcService = std::unique_ptr<grpc::AsyncGenericService>(new grpc::AsyncGenericService());
         builder.RegisterAsyncGenericService(_rpcService.get());
-        _cq = builder.AddCompletionQueue();
+        if (_statsServiceEnabled)
+        {
+            _statsService = std::unique_ptr<grpc::Service>(new ServerStatsService(this));
+            builder.RegisterService(_statsService.get());
+        }
+        for (int x = 0; x < _completionQueueCount; ++x)
+        {
+            auto queue = std::make_unique<CompletionQueueData>();
+            queue->cq = builder.AddCompletionQueue();
+            _cqs.push_back(std::move(queue));
+        }
 
-        _server = builder.BuildAndStart();
+        auto server = builder.BuildAndStart();
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _server = std::move(server);
+        }
         if (_server != nullptr)
         {
             std::cout << "Server listening on " << server_address << std::endl;
+            for (auto& listeningAddress : _listeningAddresses)
+            {
+                std::cout << "Server listening on " << listeningAddress << std::endl;
+            }
             serverStarted->NotifyComplete();
 
-            HandleRpcs(_cq.get());
+            // The first completion queue is serviced by this thread, every other queue gets
+            // its own thread. Calls are spread across the queues by gRPC.
+            for (size_t x = 1; x < _cqs.size(); ++x)
+            {
+                _cqThreads.emplace_back(&LabVIEWgRPCServer::HandleRpcs, this, _cqs[x].get());
+            }
+            HandleRpcs(_cqs[0].get());
             _server->Wait();
         }
         else
@@ -241,34 +1027,58 @@ namespace grpc_labview
     //---------------------------------------------------------------------
     void LabVIEWgRPCServer::StopServer()
     {
-        _shutdown = true;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
         if (_server != nullptr)
         {
-            // We need shutdown passing a deadline so that any RPC calls in progress are terminated as well.
-            _server->Shutdown(std::chrono::system_clock::now());
+            // gRPC stops accepting calls and sends GOAWAY to the clients, so they
+            // move to another server, then waits for the calls in progress until
+            // the drain timeout and cancels the ones left.
+            if (_drainTimeoutMs > 0)
+            {
+                ReportDrainProgress(DrainPhase::Draining);
+            }
+            _server->Shutdown(std::chrono::system_clock::now() + std::chrono::milliseconds(_drainTimeoutMs));
             _server->Wait();
 
-            // Always shutdown the completion queue after the server.
-            if (_cq != nullptr)
+            _shutdown = true;
+            if (_callLimit.inFlight > 0)
             {
-                _cq->Shutdown();
+                ReportDrainProgress(DrainPhase::Cancelling);
             }
+            CancelQueuedDispatches();
 
+            // Always shutdown the completion queues after the server. Calls that LabVIEW
+            // closes from now on are freed without starting another operation.
+            for (auto& queue : _cqs)
+            {
+                queue->Close();
+                queue->cq->Shutdown();
+            }
+
+            // Each thread returns once its queue is empty, so every outstanding event
+            // has been processed when they are joined.
             if (_runThread->joinable())
             {
                 _runThread->join();
             }
-
-            // Drain the complete queue before deleting the server.
-            // Otherwise, server might fail on the assertion that the completion queue must be empty.
-            if (_cq != nullptr)
+            for (auto& thread : _cqThreads)
+            {
+                if (thread.joinable())
+                {
+                    thread.join();
+                }
+            }
+            _cqThreads.clear();
             {
-                void *tag;
-                bool ok;
-                while (_cq->Next(&tag, &ok)) {}
+                std::lock_guard<std::mutex> lock(_mutex);
+                _server = nullptr;
             }
 
-            _server = nullptr;
+            // The queues are kept until the server is deleted, calls still held by LabVIEW refer to them.
+            ReportDrainProgress(DrainPhase::Stopped);
         }
         grpc_labview::ProtoDescriptorString::getInstance()->deleteInstance();
     }
@@ -22,12 +22,25 @@
 #include <grpcpp/impl/codegen/server_callback_handlers.h>
 #include <grpcpp/impl/codegen/server_context.h>
 #include <lv_interop.h>
+#include <adaptive_limiter.h>
+#include <call_stats.h>
+#include <message_compression.h>
+#include <response_cache.h>
+#include <single_flight.h>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <future>
 #include <map>
+#include <queue>
+#include <set>
+#include <unordered_map>
+#include <thread>
+#include <vector>
 #include <event_data.h>
 #include <metadata_owner.h>
 #include <semaphore.h>
+#include <block_pool.h>
 
 //---------------------------------------------------------------------
 //---------------------------------------------------------------------
@@ -74,6 +87,41 @@ namespace grpc_labview
         std::shared_ptr<LVMessage> _response;
     };
 
+    //---------------------------------------------------------------------
+    // Limit on the number of calls in progress, for one method or for the
+    // whole server, together with the number of calls it rejected.
+    // A limit of zero or less admits every call.
+    //---------------------------------------------------------------------
+    struct CallLimit
+    {
+        CallLimit();
+        bool TryAcquire();
+        void Release();
+
+        std::atomic<int32_t> limit;
+        std::atomic<int32_t> inFlight;
+        std::atomic<uint64_t> rejected;
+        // Set when the limit follows the latency of the calls instead of being fixed
+        std::unique_ptr<AdaptiveLimiter> adaptiveLimiter;
+    };
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    struct AdaptiveLimitSettings
+    {
+        int32_t minLimit;
+        int32_t maxLimit;
+        double targetDelayUs;
+    };
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    struct ResponseCacheSettings
+    {
+        size_t maxBytes;
+        int32_t timeToLiveMs;
+    };
+
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     struct LVEventData
@@ -81,6 +129,82 @@ namespace grpc_labview
         LVUserEventRef event;
         std::string requestMetadataName;
         std::string responseMetadataName;
+
+        // Resolved from the metadata names when the server is started
+        std::shared_ptr<MessageMetadata> requestMetadata = nullptr;
+        std::shared_ptr<MessageMetadata> responseMetadata = nullptr;
+        std::shared_ptr<CallLimit> callLimit = nullptr;
+        int32_t priority = 0;
+        std::shared_ptr<MethodStats> stats = nullptr;
+        CompressionSettings compression = CompressionSettings();
+        // Set for methods whose responses are cached
+        std::shared_ptr<ResponseCache> responseCache = nullptr;
+        // Set for methods whose identical calls in progress are coalesced
+        std::shared_ptr<SingleFlight> singleFlight = nullptr;
+    };
+
+    //---------------------------------------------------------------------
+    // A call waiting for a free dispatch slot. Calls of a higher priority class
+    // are posted first, then calls with the earliest deadline, then the oldest.
+    //---------------------------------------------------------------------
+    struct QueuedDispatch
+    {
+        int32_t priority;
+        std::chrono::system_clock::time_point deadline;
+        uint64_t sequence;
+        CallData* call;
+
+        bool operator<(const QueuedDispatch& other) const;
+    };
+
+    //---------------------------------------------------------------------
+    // Phase of StopServer reported to the drain event.
+    //---------------------------------------------------------------------
+    enum class DrainPhase
+    {
+        Draining = 0,   // New calls are refused, calls in progress may finish
+        Cancelling = 1, // The drain timeout passed, the remaining calls were cancelled
+        Stopped = 2     // The server is stopped
+    };
+
+    //---------------------------------------------------------------------
+    // LabVIEW cluster posted to the drain event.
+    //---------------------------------------------------------------------
+    struct DrainProgress
+    {
+        int32_t phase;
+        int32_t callsInProgress;
+    };
+
+    //---------------------------------------------------------------------
+    // A server completion queue together with the number of calls that are
+    // currently posted to it and waiting for a client.
+    //---------------------------------------------------------------------
+    struct CompletionQueueData
+    {
+        CompletionQueueData();
+        ~CompletionQueueData();
+
+        // Every gRPC operation of a call is started between BeginOperation and
+        // EndOperation. Once Close returns BeginOperation fails, so the queue can
+        // be shut down without an operation being started on it afterwards.
+        bool BeginOperation();
+        void EndOperation();
+        void Close();
+
+        std::unique_ptr<grpc::ServerCompletionQueue> cq;
+        std::atomic<int32_t> pendingCalls;
+        std::atomic<int32_t> activeOperations;
+        std::atomic<bool> closed;
+        // Signalled when the last operation ends after Close
+        std::mutex operationMutex;
+        std::condition_variable operationsEnded;
+
+        // Recycled memory for the objects created for every call served by the queue
+        BlockPool* callDataPool;
+        BlockPool* callFinishedPool;
+        BlockPool* methodDataPool;
+        BlockPool* messagePool;
     };
 
     //---------------------------------------------------------------------
@@ -91,29 +215,111 @@ namespace grpc_labview
         LabVIEWgRPCServer();
         int Run(std::string address, std::string serverCertificatePath, std::string serverKeyPath);
         int ListeningPort();
+        void AddListeningAddress(const std::string& address);
+        std::shared_ptr<grpc::Channel> InProcessChannel();
+        void SetCompletionQueueCount(int count);
+        void SetPendingCallCount(int count);
+        void SetWriteQueueDepth(int depth);
+        int WriteQueueDepth();
+        void SetReadAheadDepth(int depth);
+        int ReadAheadDepth();
+        void GetPendingCallStats(int32_t* pendingCalls, uint64_t* acceptedCalls, uint64_t* pendingCallsExhausted);
+        void GetCallPoolStats(uint64_t* heapAllocations, uint64_t* reusedAllocations);
+        void SetConcurrencyLimit(int limit);
+        void SetMethodConcurrencyLimit(const std::string& methodName, int limit);
+        void GetConcurrencyStats(int32_t* inFlight, uint64_t* rejected);
+        bool GetMethodConcurrencyStats(const std::string& methodName, int32_t* inFlight, uint64_t* rejected);
+        void SetMethodAdaptiveConcurrency(const std::string& methodName, int32_t minLimit, int32_t maxLimit, double targetDelayUs);
+        bool GetMethodAdaptiveConcurrencyStats(const std::string& methodName, int32_t* limit, double* minLatencyUs, double* smoothedLatencyUs, uint64_t* samples, uint64_t* decreases);
+        void CallHandled(const LVEventData* eventData, std::chrono::steady_clock::duration latency);
+        void SetDispatchLimit(int limit);
+        void SetMethodPriority(const std::string& methodName, int priority);
+        void GetDispatchStats(int32_t* queuedCalls, uint64_t* expiredCalls);
+        void SetCompression(const CompressionSettings& compression);
+        void SetMethodCompression(const std::string& methodName, const CompressionSettings& compression);
+        const CompressionSettings& Compression();
+        void SetMethodResponseCache(const std::string& methodName, size_t maxBytes, int32_t timeToLiveMs);
+        std::shared_ptr<ResponseCache> GetMethodResponseCache(const std::string& methodName);
+        void SetMethodSingleFlight(const std::string& methodName, bool enabled);
+        std::shared_ptr<SingleFlight> GetMethodSingleFlight(const std::string& methodName);
+        void DispatchCall(CallData* call);
+        void CallExpired();
+        std::shared_ptr<MethodStats> GetMethodStats(const std::string& methodName);
+        void ResetStats();
+        void SetStatsServiceEnabled(bool enabled);
+        std::vector<std::string> ServerMethodNames();
+        void SetDrainTimeout(int timeoutMs);
+        void SetDrainEvent(LVUserEventRef event);
+        bool IsStopping();
+        bool IsShutdown();
+        void ReleaseWhenCallsClosed(std::shared_ptr<LabVIEWgRPCServer> self);
+        bool AdmitCall(const LVEventData* eventData);
+        void ReleaseCall(const LVEventData* eventData);
+        void CallAccepted(CompletionQueueData* queue);
         void StopServer();
         void RegisterEvent(std::string eventName, LVUserEventRef reference, std::string requestMessageName, std::string responseMessageName);
         void RegisterGenericMethodEvent(LVUserEventRef item);
-        void SendEvent(std::string name, gRPCid* data);
+        void SendEvent(const LVEventData* eventData, const std::string& name, gRPCid* data);
 
-        bool FindEventData(std::string name, LVEventData& data);
+        const LVEventData* FindServerMethod(const std::string& methodName);
         bool HasGenericMethodEvent();
-        bool HasRegisteredServerMethod(std::string methodName);
+        bool UseEfficientMessageCopy();
+        bool UseEfficientResponseCopy();
 
     private:
         std::mutex _mutex;
         std::unique_ptr<Server> _server;
-        std::unique_ptr<grpc::ServerCompletionQueue> _cq;
+        std::vector<std::unique_ptr<CompletionQueueData>> _cqs;
         std::map<std::string, LVEventData> _registeredServerMethods;
+        // Read only copy of the registered methods used while the server is running
+        std::unordered_map<std::string, LVEventData> _serverMethods;
         LVUserEventRef _genericMethodEvent;
         std::unique_ptr<grpc::AsyncGenericService> _rpcService;
+        std::unique_ptr<grpc::Service> _statsService;
         std::unique_ptr<std::thread> _runThread;
-        bool _shutdown;
+        std::vector<std::thread> _cqThreads;
+        int _completionQueueCount;
+        int _pendingCallCount;
+        int _writeQueueDepth;
+        int _readAheadDepth;
+        bool _efficientMessageCopy;
+        bool _efficientResponseCopy;
+        bool _statsServiceEnabled;
+        std::atomic<uint64_t> _acceptedCalls;
+        std::atomic<uint64_t> _pendingCallsExhausted;
+        CallLimit _callLimit;
+        std::map<std::string, int> _methodConcurrencyLimits;
+        std::map<std::string, AdaptiveLimitSettings> _methodAdaptiveLimits;
+        std::map<std::string, int> _methodPriorities;
+        CompressionSettings _compression;
+        std::map<std::string, CompressionSettings> _methodCompression;
+        std::map<std::string, ResponseCacheSettings> _methodResponseCaches;
+        std::set<std::string> _singleFlightMethods;
+        int _dispatchLimit;
+        std::mutex _dispatchMutex;
+        std::priority_queue<QueuedDispatch> _dispatchQueue;
+        int _dispatchedCalls;
+        uint64_t _dispatchSequence;
+        std::atomic<uint64_t> _expiredCalls;
+        int _drainTimeoutMs;
+        LVUserEventRef _drainEvent;
+        std::mutex _drainMutex;
+        // Keeps a stopped server alive until LabVIEW closed the calls it still holds
+        std::shared_ptr<LabVIEWgRPCServer> _keepAlive;
+        // Set when StopServer starts refusing calls, and once gRPC cancelled the calls left
+        std::atomic<bool> _stopping;
+        std::atomic<bool> _shutdown;
         int _listeningPort;
+        // Listeners in addition to the address given to Run
+        std::vector<std::string> _listeningAddresses;
 
     private:
         void RunServer(std::string address, std::string serverCertificatePath, std::string serverKeyPath, ServerStartEventData* serverStarted);
-        void HandleRpcs(grpc::ServerCompletionQueue *cq);
+        void HandleRpcs(CompletionQueueData* queue);
+        void FreezeServerMethods();
+        void CancelQueuedDispatches();
+        void ReportDrainProgress(DrainPhase phase);
+        std::shared_ptr<LabVIEWgRPCServer> ReleaseServerCallSlot();
 
     private:
         static void StaticRunServer(LabVIEWgRPCServer* server, std::string address, std::string serverCertificatePath, std::string serverKeyPath, ServerStartEventData* serverStarted);
@@ -129,7 +335,48 @@ namespace grpc_labview
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    class CallFinishedData : CallDataBase
+    class ReadNextTag : public CallDataBase
+    {
+    public:
+        ReadNextTag();
+        void Proceed(bool ok) override;
+        bool Wait();
+
+    private:
+        Semaphore _readCompleteSemaphore;
+        bool _success;
+    };
+
+    //---------------------------------------------------------------------
+    // Completion tag for the reads a call posts ahead of GetRequestData.
+    //---------------------------------------------------------------------
+    class ReadAheadTag : public CallDataBase
+    {
+    public:
+        ReadAheadTag(CallData* call);
+        void Proceed(bool ok) override;
+
+    private:
+        CallData* _call;
+    };
+
+    //---------------------------------------------------------------------
+    // Completion tag for the writes of a call, kept apart from the call's own
+    // tag so that queued writes complete independently of its state.
+    //---------------------------------------------------------------------
+    class WriteCompleteTag : public CallDataBase
+    {
+    public:
+        WriteCompleteTag(CallData* call);
+        void Proceed(bool ok) override;
+
+    private:
+        CallData* _call;
+    };
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    class CallFinishedData : CallDataBase, public PooledObject
     {
     public:
         CallFinishedData(CallData* callData);
@@ -141,65 +388,114 @@ namespace grpc_labview
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    class CallData : public CallDataBase, public IMessageElementMetadataOwner
+    class CallData : public CallDataBase, public IMessageElementMetadataOwner, public PooledObject
     {
     public:
-        CallData(LabVIEWgRPCServer* server, grpc::AsyncGenericService* service, grpc::ServerCompletionQueue* cq);
+        CallData(LabVIEWgRPCServer* server, grpc::AsyncGenericService* service, CompletionQueueData* queue);
+        ~CallData();
         std::shared_ptr<MessageMetadata> FindMetadata(const std::string& name) override;
         std::shared_ptr<EnumMetadata> FindEnumMetadata(const std::string& name) {
             return nullptr;
         }
         void Proceed(bool ok) override;
-        bool Write();
+        void SerializeResponse(int8_t* cluster, grpc::ByteBuffer* buffer);
+        bool Write(const grpc::ByteBuffer& buffer);
+        bool Write(const grpc::ByteBuffer* buffers, size_t count);
+        bool IsWriteQueueFull();
+        void WriteComplete(bool ok);
         void Finish();
         bool IsCancelled();
         bool IsActive();
         bool ReadNext();
         void ReadComplete();
+        void ReadAheadComplete(bool ok);
+        int32_t BufferedRequestCount();
+        const LVEventData* EventData();
+        std::chrono::system_clock::time_point Deadline();
+        bool HasExpired();
+        void PostEvent();
+        void FinishUnposted(grpc::StatusCode statusCode, const std::string& errorMessage);
+        void RecordStat(CallMetric metric, uint64_t value);
+        void RecordTime(CallMetric metric, std::chrono::steady_clock::time_point start);
+        bool CopyRequestToCluster(int8_t* cluster);
         void SetCallStatusError(std::string errorMessage);
         void SetCallStatusError(grpc::StatusCode statusCode, std::string errorMessage);
 
     private:
         LabVIEWgRPCServer* _server;
         grpc::AsyncGenericService* _service;
+        CompletionQueueData* _queue;
         grpc::ServerCompletionQueue* _cq;
+        const LVEventData* _eventData;
         grpc::GenericServerContext _ctx;
         grpc::GenericServerAsyncReaderWriter _stream;
         grpc::ByteBuffer _rb;
         grpc::Status _callStatus;
 
-        Semaphore _writeSemaphore;
+        ReadNextTag _readNextTag;
+        ReadAheadTag _readAheadTag;
+        std::mutex _readMutex;
+        std::condition_variable _readCondition;
+        // Ring of requests received ahead of GetRequestData, _readAheadCount of them starting at _readAheadHead.
+        std::vector<grpc::ByteBuffer> _readAheadBuffers;
+        grpc::ByteBuffer _readAheadTarget;
+        size_t _readAheadHead;
+        size_t _readAheadCount;
+        bool _readInFlight;
+        bool _readsDone;
+        bool _deletePending;
+        WriteCompleteTag _writeCompleteTag;
+        std::mutex _writeMutex;
+        std::condition_variable _writeCondition;
+        // Responses waiting for the write in flight to complete, sent from _nextQueuedWrite on.
+        // A vector rather than a deque so that calls which never queue a write do not allocate.
+        std::vector<grpc::ByteBuffer> _queuedWrites;
+        size_t _nextQueuedWrite;
+        bool _writeInFlight;
+        bool _finishRequested;
+        bool _responseStarted;
         std::shared_ptr<GenericMethodData> _methodData;
         std::shared_ptr<LVMessage> _request;
         std::shared_ptr<LVMessage> _response;
 
         bool _requestDataReady;
+        bool _parseRequestIntoCluster;
+        bool _admitted;
+        std::chrono::steady_clock::time_point _acceptedTime;
+        std::chrono::steady_clock::time_point _eventSentTime;
+        std::chrono::steady_clock::time_point _pickupTime;
+        std::chrono::steady_clock::time_point _writeStartTime;
+        bool _pickedUp;
+        bool _compressionChosen;
+        // The response of a call missed by its method's response cache, or whose
+        // request other calls wait for, while it sent no more than one response
+        // and read no more than the request it started with.
+        bool _captureResponse;
+        grpc::ByteBuffer _capturedResponse;
+        bool _requestBytesCopied;
+        std::string _requestBytes;
+        bool _singleFlightLeader;
 
         enum class CallStatus
         {
             Create,
             Read,
-            Writing,
             Process,
             PendingFinish,
             Finish
         };
         CallStatus _status;
-    };
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    class ReadNextTag : CallDataBase
-    {
-    public:
-        ReadNextTag(CallData* callData);
-        void Proceed(bool ok) override;
-        bool Wait();
 
     private:
-        Semaphore _readCompleteSemaphore;
-        CallData* _callData;
-        bool _success;
+        void FinishCall();
+        grpc::WriteOptions WriteOptionsFor(const grpc::ByteBuffer& buffer);
+        const std::string& RequestBytes();
+        bool AnswerFromCache();
+        bool JoinSingleFlight();
+        void ReleaseSingleFlight(bool shareOutcome);
+        void FinishShared(const grpc::ByteBuffer* response, const grpc::Status& status);
+        bool ReadNextBuffered();
+        void StartReadAhead();
     };
 
     //---------------------------------------------------------------------
@@ -2,6 +2,7 @@
 //---------------------------------------------------------------------
 #include <grpc_server.h>
 #include <lv_message.h>
+#include <grpcpp/impl/codegen/proto_buffer_reader.h>
 #include <sstream>
 
 //---------------------------------------------------------------------
@@ -12,10 +13,23 @@ namespace grpc_labview
 {
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    LVMessage::LVMessage(std::shared_ptr<MessageMetadata> metadata) : _metadata(metadata)
+    LVMessage::LVMessage(std::shared_ptr<MessageMetadata> metadata, google::protobuf::Arena* arena) :
+        _values(metadata != nullptr ? metadata->_elements.size() : 0, arena),
+        _metadata(metadata),
+        _fieldParse(&FieldParser::parse)
     {
     }
 
+    //---------------------------------------------------------------------
+    // For the request and response of a call: their values and nested
+    // messages go to an arena that is released in bulk each time the message
+    // is cleared for the next streamed message, and when it is destroyed.
+    //---------------------------------------------------------------------
+    void LVMessage::UseOwnArena()
+    {
+        _values.UseOwnArena();
+    }
+
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     LVMessage::~LVMessage()
@@ -34,34 +48,36 @@ namespace grpc_labview
     bool LVMessage::ParseFromByteBuffer(const grpc::ByteBuffer &buffer)
     {
         Clear();
-
-        std::vector<grpc::Slice> slices;
-        buffer.Dump(&slices);
-        std::string buf;
-        buf.reserve(buffer.Length());
-        for (auto s = slices.begin(); s != slices.end(); s++)
+        if (!buffer.Valid())
         {
-            buf.append(reinterpret_cast<const char *>(s->begin()), s->size());
+            // Nothing was received, parsed the same as an empty message.
+            return ParseFromArray(nullptr, 0);
         }
-        return ParseFromString(buf);
+
+        // Parse straight from the slices the message was received in, large
+        // messages are never copied into one contiguous buffer first.
+        grpc::ProtoBufferReader reader(const_cast<grpc::ByteBuffer*>(&buffer));
+        return reader.status().ok() && ParseFromBoundedZeroCopyStream(&reader, (int)buffer.Length());
     }
 
     //---------------------------------------------------------------------
+    // Writes the message into a single slice allocated at its exact size
     //---------------------------------------------------------------------
-    std::unique_ptr<grpc::ByteBuffer> LVMessage::SerializeToByteBuffer()
+    void LVMessage::SerializeToByteBuffer(grpc::ByteBuffer* buffer)
     {
-        std::string buf;
-        SerializeToString(&buf);
-        grpc::Slice slice(buf);
-        return std::unique_ptr<grpc::ByteBuffer>(new grpc::ByteBuffer(&slice, 1));
+        auto size = ByteSizeLong();
+        auto slice = grpc_slice_malloc(size);
+        SerializeWithCachedSizesToArray(GRPC_SLICE_START_PTR(slice));
+        grpc::Slice bufferSlice(slice, grpc::Slice::STEAL_REF);
+        grpc::ByteBuffer serialized(&bufferSlice, 1);
+        buffer->Swap(&serialized);
     }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     google::protobuf::Message *LVMessage::New(google::protobuf::Arena *arena) const
     {
-        assert(false); // not expected to be called
-        return nullptr;
+        return google::protobuf::Arena::Create<LVMessage>(arena, _metadata, arena);
     }
 
     //---------------------------------------------------------------------
@@ -78,11 +94,23 @@ namespace grpc_labview
         return _cached_size_.Get();
     }
 
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    const LVValueSlot* LVMessage::FindValue(int protobufIndex) const
+    {
+        if (_metadata == nullptr)
+        {
+            return nullptr;
+        }
+        auto it = _metadata->_mappedElements.find(protobufIndex);
+        return it != _metadata->_mappedElements.end() ? _values.Find(*it->second) : nullptr;
+    }
+
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     void LVMessage::Clear()
     {
-        _values.clear();
+        _values.Clear();
         _oneofContainerToSelectedIndexMap.clear();
     }
 
@@ -91,24 +119,48 @@ namespace grpc_labview
     const char *LVMessage::_InternalParse(const char *ptr, ParseContext *ctx)
     {
         assert(ptr != nullptr);
+        // Registered messages look their fields up in the table compiled when
+        // their metadata was finalized, messages built field by field in the map.
+        bool compiled = _metadata != nullptr && _metadata->FieldParsersCompiled();
+        const FieldParser* previousParser = nullptr;
+        FieldParser uncompiledParser;
         while (!ctx->Done(&ptr))
         {
             google::protobuf::uint32 tag;
             ptr = ReadTag(ptr, &tag);
+            if (ptr == nullptr)
+            {
+                return nullptr;
+            }
             auto index = (tag >> 3);
             if (_metadata == nullptr)
             {
                 ptr = UnknownFieldParse(tag, &_unknownFields, ptr, ctx);
-                assert(ptr != nullptr);
             }
             else
             {
-                auto fieldIt = _metadata->_mappedElements.find(index);
-                if (fieldIt != _metadata->_mappedElements.end())
+                const FieldParser* parser = nullptr;
+                if (compiled)
                 {
-                    auto& fieldInfo = (*fieldIt).second;
-                    LVMessageMetadataType dataType = fieldInfo->type;
-
+                    parser = _metadata->FindFieldParser(index, previousParser);
+                    if (parser != nullptr)
+                    {
+                        previousParser = parser;
+                    }
+                }
+                else
+                {
+                    auto fieldIt = _metadata->_mappedElements.find(index);
+                    if (fieldIt != _metadata->_mappedElements.end())
+                    {
+                        uncompiledParser = MessageMetadata::CompileFieldParser(*fieldIt->second);
+                        parser = &uncompiledParser;
+                    }
+                }
+                auto parse = parser != nullptr ? parser->*_fieldParse : nullptr;
+                if (parse != nullptr)
+                {
+                    auto fieldInfo = parser->field;
                     if (fieldInfo->isInOneof)
                     {
                         // set the map of the selected index for the "oneofContainer" to this protobuf Index
@@ -116,61 +168,7 @@ namespace grpc_labview
                         _oneofContainerToSelectedIndexMap.insert({ fieldInfo->oneofContainerName, fieldInfo->protobufIndex });
                     }
 
-                    switch (dataType)
-                    {
-                    case LVMessageMetadataType::Int32Value:
-                        ptr = ParseInt32(*fieldInfo, index, ptr, ctx);
-                        break;
-                    case LVMessageMetadataType::FloatValue:
-                        ptr = ParseFloat(*fieldInfo, index, ptr, ctx);
-                        break;
-                    case LVMessageMetadataType::DoubleValue:
-                        ptr = ParseDouble(*fieldInfo, index, ptr, ctx);
-                        break;
-                    case LVMessageMetadataType::BoolValue:
-                        ptr = ParseBoolean(*fieldInfo, index, ptr, ctx);
-                        break;
-                    case LVMessageMetadataType::StringValue:
-                        ptr = ParseString(tag, *fieldInfo, index, ptr, ctx);
-                        break;
-                    case LVMessageMetadataType::BytesValue:
-                        ptr = ParseBytes(tag, *fieldInfo, index, ptr, ctx);
-                        break;
-                    case LVMessageMetadataType::MessageValue:
-                        ptr = ParseNestedMessage(tag, *fieldInfo, index, ptr, ctx);
-                        break;
-                    case LVMessageMetadataType::Int64Value:
-                        ptr = ParseInt64(*fieldInfo, index, ptr, ctx);
-                        break;
-                    case LVMessageMetadataType::UInt32Value:
-                        ptr = ParseUInt32(*fieldInfo, index, ptr, ctx);
-                        break;
-                    case LVMessageMetadataType::UInt64Value:
-                        ptr = ParseUInt64(*fieldInfo, index, ptr, ctx);
-                        break;
-                    case LVMessageMetadataType::EnumValue:
-                        ptr = ParseEnum(*fieldInfo, index, ptr, ctx);
-                        break;
-                    case LVMessageMetadataType::SInt32Value:
-                        ptr = ParseSInt32(*fieldInfo, index, ptr, ctx);
-                        break;
-                    case LVMessageMetadataType::SInt64Value:
-                        ptr = ParseSInt64(*fieldInfo, index, ptr, ctx);
-                        break;
-                    case LVMessageMetadataType::Fixed32Value:
-                        ptr = ParseFixed32(*fieldInfo, index, ptr, ctx);
-                        break;
-                    case LVMessageMetadataType::Fixed64Value:
-                        ptr = ParseFixed64(*fieldInfo, index, ptr, ctx);
-                        break;
-                    case LVMessageMetadataType::SFixed32Value:
-                        ptr = ParseSFixed32(*fieldInfo, index, ptr, ctx);
-                        break;
-                    case LVMessageMetadataType::SFixed64Value:
-                        ptr = ParseSFixed64(*fieldInfo, index, ptr, ctx);
-                        break;
-                    }
-                    assert(ptr != nullptr);
+                    ptr = parse(*this, tag, *parser, ptr, ctx);
                 }
                 else
                 {
@@ -180,30 +178,92 @@ namespace grpc_labview
                         return ptr;
                     }
                     ptr = UnknownFieldParse(tag, &_unknownFields, ptr, ctx);
-                    assert(ptr != nullptr);
                 }
             }
+            if (ptr == nullptr)
+            {
+                // The message is malformed, the parse fails.
+                return nullptr;
+            }
         }
         PostInteralParseAction();
         return ptr;
     }
 
+    //---------------------------------------------------------------------
+    // The parsers call the Parse function of LVMessage by name, so a field
+    // is parsed without a virtual call.
+    //---------------------------------------------------------------------
+#define LV_FIELD_PARSER(Parse) \
+    [](LVMessage& message, google::protobuf::uint32 tag, const FieldParser& parser, const char* ptr, ParseContext* ctx) \
+    { return message.LVMessage::Parse(*parser.field, tag >> 3, ptr, ctx); }
+#define LV_TAGGED_FIELD_PARSER(Parse) \
+    [](LVMessage& message, google::protobuf::uint32 tag, const FieldParser& parser, const char* ptr, ParseContext* ctx) \
+    { return message.LVMessage::Parse(tag, *parser.field, tag >> 3, ptr, ctx); }
+#define LV_NESTED_FIELD_PARSER(Parse) \
+    [](LVMessage& message, google::protobuf::uint32 tag, const FieldParser& parser, const char* ptr, ParseContext* ctx) \
+    { return message.LVMessage::Parse(tag, parser, tag >> 3, ptr, ctx); }
+
+    FieldParseFunction LVMessage::FieldParserFor(const MessageElementMetadata& field)
+    {
+        switch (field.type)
+        {
+        case LVMessageMetadataType::Int32Value:
+            return LV_FIELD_PARSER(ParseInt32);
+        case LVMessageMetadataType::FloatValue:
+            return LV_FIELD_PARSER(ParseFloat);
+        case LVMessageMetadataType::DoubleValue:
+            return LV_FIELD_PARSER(ParseDouble);
+        case LVMessageMetadataType::BoolValue:
+            return LV_FIELD_PARSER(ParseBoolean);
+        case LVMessageMetadataType::StringValue:
+            return LV_TAGGED_FIELD_PARSER(ParseString);
+        case LVMessageMetadataType::BytesValue:
+            return LV_TAGGED_FIELD_PARSER(ParseBytes);
+        case LVMessageMetadataType::MessageValue:
+            return LV_NESTED_FIELD_PARSER(ParseNestedMessage);
+        case LVMessageMetadataType::Int64Value:
+            return LV_FIELD_PARSER(ParseInt64);
+        case LVMessageMetadataType::UInt32Value:
+            return LV_FIELD_PARSER(ParseUInt32);
+        case LVMessageMetadataType::UInt64Value:
+            return LV_FIELD_PARSER(ParseUInt64);
+        case LVMessageMetadataType::EnumValue:
+            return LV_FIELD_PARSER(ParseEnum);
+        case LVMessageMetadataType::SInt32Value:
+            return LV_FIELD_PARSER(ParseSInt32);
+        case LVMessageMetadataType::SInt64Value:
+            return LV_FIELD_PARSER(ParseSInt64);
+        case LVMessageMetadataType::Fixed32Value:
+            return LV_FIELD_PARSER(ParseFixed32);
+        case LVMessageMetadataType::Fixed64Value:
+            return LV_FIELD_PARSER(ParseFixed64);
+        case LVMessageMetadataType::SFixed32Value:
+            return LV_FIELD_PARSER(ParseSFixed32);
+        case LVMessageMetadataType::SFixed64Value:
+            return LV_FIELD_PARSER(ParseSFixed64);
+        }
+        return nullptr;
+    }
+
+#undef LV_FIELD_PARSER
+#undef LV_TAGGED_FIELD_PARSER
+#undef LV_NESTED_FIELD_PARSER
+
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     const char *LVMessage::ParseBoolean(const MessageElementMetadata &fieldInfo, uint32_t index, const char *ptr, ParseContext *ctx)
     {
         if (fieldInfo.isRepeated)
         {
-            auto v = std::make_shared<LVRepeatedMessageValue<bool>>(index);
+            auto v = _values.Repeated<LVRepeatedMessageValue<bool>>(fieldInfo);
             ptr = PackedBoolParser(&(v->_value), ptr, ctx);
-            _values.emplace(index, v);
         }
         else
         {
             bool result;
             ptr = ReadBOOL(ptr, &result);
-            auto v = std::make_shared<LVVariableMessageValue<bool>>(index, result);
-            _values.emplace(index, v);
+            _values.SetScalar(fieldInfo, result);
         }
         return ptr;
     }
@@ -214,16 +274,14 @@ namespace grpc_labview
     {
         if (fieldInfo.isRepeated)
         {
-            auto v = std::make_shared<LVRepeatedMessageValue<int>>(index);
+            auto v = _values.Repeated<LVRepeatedMessageValue<int>>(fieldInfo);
             ptr = PackedInt32Parser(&(v->_value), ptr, ctx);
-            _values.emplace(index, v);
         }
         else
         {
             int32_t result;
             ptr = ReadINT32(ptr, &result);
-            auto v = std::make_shared<LVVariableMessageValue<int>>(index, result);
-            _values.emplace(index, v);
+            _values.SetScalar(fieldInfo, result);
         }
         return ptr;
     }
@@ -234,16 +292,14 @@ namespace grpc_labview
     {
         if (fieldInfo.isRepeated)
         {
-            auto v = std::make_shared<LVRepeatedMessageValue<uint32_t>>(index);
+            auto v = _values.Repeated<LVRepeatedMessageValue<uint32_t>>(fieldInfo);
             ptr = PackedUInt32Parser(&(v->_value), ptr, ctx);
-            _values.emplace(index, v);
         }
         else
         {
             uint32_t result;
             ptr = ReadUINT32(ptr, &result);
-            auto v = std::make_shared<LVVariableMessageValue<uint32_t>>(index, result);
-            _values.emplace(index, v);
+            _values.SetScalar(fieldInfo, result);
         }
         return ptr;
     }
@@ -254,16 +310,14 @@ namespace grpc_labview
     {
         if (fieldInfo.isRepeated)
         {
-            auto v = std::make_shared<LVRepeatedEnumMessageValue>(index);
+            auto v = _values.Repeated<LVRepeatedEnumMessageValue>(fieldInfo);
             ptr = PackedEnumParser(&(v->_value), ptr, ctx);
-            _values.emplace(index, v);
         }
         else
         {
             int32_t result;
             ptr = ReadENUM(ptr, &result);
-            auto v = std::make_shared<LVEnumMessageValue>(index, result);
-            _values.emplace(index, v);
+            _values.SetScalar(fieldInfo, result);
         }
         return ptr;
     }
@@ -274,16 +328,14 @@ namespace grpc_labview
     {
         if (fieldInfo.isRepeated)
         {
-            auto v = std::make_shared<LVRepeatedMessageValue<int64_t>>(index);
+            auto v = _values.Repeated<LVRepeatedMessageValue<int64_t>>(fieldInfo);
             ptr = PackedInt64Parser(&(v->_value), ptr, ctx);
-            _values.emplace(index, v);
         }
         else
         {
             int64_t result;
             ptr = ReadINT64(ptr, &result);
-            auto v = std::make_shared<LVVariableMessageValue<int64_t>>(index, result);
-            _values.emplace(index, v);
+            _values.SetScalar(fieldInfo, result);
         }
         return ptr;
     }
@@ -294,16 +346,14 @@ namespace grpc_labview
     {
         if (fieldInfo.isRepeated)
         {
-            auto v = std::make_shared<LVRepeatedMessageValue<uint64_t>>(index);
+            auto v = _values.Repeated<LVRepeatedMessageValue<uint64_t>>(fieldInfo);
             ptr = PackedUInt64Parser(&(v->_value), ptr, ctx);
-            _values.emplace(index, v);
         }
         else
         {
             uint64_t result;
             ptr = ReadUINT64(ptr, &result);
-            auto v = std::make_shared<LVVariableMessageValue<uint64_t>>(index, result);
-            _values.emplace(index, v);
+            _values.SetScalar(fieldInfo, result);
         }
         return ptr;
     }
@@ -314,16 +364,15 @@ namespace grpc_labview
     {
         if (fieldInfo.isRepeated)
         {
-            auto v = std::make_shared<LVRepeatedMessageValue<float>>(index);
+            auto v = _values.Repeated<LVRepeatedMessageValue<float>>(fieldInfo);
+            ReservePackedFixed(&(v->_value), ptr, ctx);
             ptr = PackedFloatParser(&(v->_value), ptr, ctx);
-            _values.emplace(index, v);
         }
         else
         {
             float result;
             ptr = ReadFLOAT(ptr, &result);
-            auto v = std::make_shared<LVVariableMessageValue<float>>(index, result);
-            _values.emplace(index, v);
+            _values.SetScalar(fieldInfo, result);
         }
         return ptr;
     }
@@ -334,16 +383,15 @@ namespace grpc_labview
     {
         if (fieldInfo.isRepeated)
         {
-            auto v = std::make_shared<LVRepeatedMessageValue<double>>(index);
+            auto v = _values.Repeated<LVRepeatedMessageValue<double>>(fieldInfo);
+            ReservePackedFixed(&(v->_value), ptr, ctx);
             ptr = PackedDoubleParser(&(v->_value), ptr, ctx);
-            _values.emplace(index, v);
         }
         else
         {
             double result;
             ptr = ReadDOUBLE(ptr, &result);
-            auto v = std::make_shared<LVVariableMessageValue<double>>(index, result);
-            _values.emplace(index, v);
+            _values.SetScalar(fieldInfo, result);
         }
         return ptr;
     }
@@ -354,17 +402,7 @@ namespace grpc_labview
     {
         if (fieldInfo.isRepeated)
         {
-            std::shared_ptr<LVRepeatedMessageValue<std::string>> v;
-            auto it = _values.find(index);
-            if (it == _values.end())
-            {
-                v = std::make_shared<LVRepeatedMessageValue<std::string>>(index);
-                _values.emplace(index, v);
-            }
-            else
-            {
-                v = std::static_pointer_cast<LVRepeatedMessageValue<std::string>>((*it).second);
-            }
+            auto v = _values.Repeated<LVRepeatedMessageValue<std::string>>(fieldInfo);
 
             auto tagSize = CalculateTagWireSize(tag);
             protobuf_ptr -= tagSize;
@@ -373,7 +411,7 @@ namespace grpc_labview
                 protobuf_ptr += tagSize;
                 auto str = v->_value.Add();
                 protobuf_ptr = InlineGreedyStringParser(str, protobuf_ptr, ctx);
-                if (!ctx->DataAvailable(protobuf_ptr))
+                if (protobuf_ptr == nullptr || !ctx->DataAvailable(protobuf_ptr))
                 {
                     break;
                 }
@@ -382,9 +420,9 @@ namespace grpc_labview
         else
         {
             auto str = std::string();
-            protobuf_ptr = InlineGreedyStringParser(&str, protobuf_ptr, ctx);
-            auto v = std::make_shared<LVStringMessageValue>(index, str);
-            _values.emplace(index, v);
+            auto value = ArenaMakeShared<LVStringMessageValue>(_values.GetArena(), index, str);
+            protobuf_ptr = InlineGreedyStringParser(&value->_value, protobuf_ptr, ctx);
+            _values.Set(fieldInfo, value);
         }
         return protobuf_ptr;
     }
@@ -428,16 +466,14 @@ namespace grpc_labview
     {
         if (fieldInfo.isRepeated)
         {
-            auto v = std::make_shared<LVRepeatedSInt32MessageValue>(index);
+            auto v = _values.Repeated<LVRepeatedSInt32MessageValue>(fieldInfo);
             ptr = PackedSInt32Parser(&(v->_value), ptr, ctx);
-            _values.emplace(index, v);
         }
         else
         {
             int32_t result;
             ptr = ReadSINT32(ptr, &result);
-            auto v = std::make_shared<LVSInt32MessageValue>(index, result);
-            _values.emplace(index, v);
+            _values.SetScalar(fieldInfo, result);
         }
         return ptr;
     }
@@ -448,16 +484,14 @@ namespace grpc_labview
     {
         if (fieldInfo.isRepeated)
         {
-            auto v = std::make_shared<LVRepeatedSInt64MessageValue>(index);
+            auto v = _values.Repeated<LVRepeatedSInt64MessageValue>(fieldInfo);
             ptr = PackedSInt64Parser(&(v->_value), ptr, ctx);
-            _values.emplace(index, v);
         }
         else
         {
             int64_t result;
             ptr = ReadSINT64(ptr, &result);
-            auto v = std::make_shared<LVSInt64MessageValue>(index, result);
-            _values.emplace(index, v);
+            _values.SetScalar(fieldInfo, result);
         }
         return ptr;
     }
@@ -468,16 +502,15 @@ namespace grpc_labview
     {
         if (fieldInfo.isRepeated)
         {
-            auto v = std::make_shared<LVRepeatedFixed32MessageValue>(index);
+            auto v = _values.Repeated<LVRepeatedFixed32MessageValue>(fieldInfo);
+            ReservePackedFixed(&(v->_value), ptr, ctx);
             ptr = PackedFixed32Parser(&(v->_value), ptr, ctx);
-            _values.emplace(index, v);
         }
         else
         {
             uint32_t result;
             ptr = ReadFIXED32(ptr, &result);
-            auto v = std::make_shared<LVFixed32MessageValue>(index, result);
-            _values.emplace(index, v);
+            _values.SetScalar(fieldInfo, result);
         }
         return ptr;
     }
@@ -488,16 +521,15 @@ namespace grpc_labview
     {
         if (fieldInfo.isRepeated)
         {
-            auto v = std::make_shared<LVRepeatedFixed64MessageValue>(index);
+            auto v = _values.Repeated<LVRepeatedFixed64MessageValue>(fieldInfo);
+            ReservePackedFixed(&(v->_value), ptr, ctx);
             ptr = PackedFixed64Parser(&(v->_value), ptr, ctx);
-            _values.emplace(index, v);
         }
         else
         {
             uint64_t result;
             ptr = ReadFIXED64(ptr, &result);
-            auto v = std::make_shared<LVFixed64MessageValue>(index, result);
-            _values.emplace(index, v);
+            _values.SetScalar(fieldInfo, result);
         }
         return ptr;
     }
@@ -508,16 +540,15 @@ namespace grpc_labview
     {
         if (fieldInfo.isRepeated)
         {
-            auto v = std::make_shared<LVRepeatedSFixed32MessageValue>(index);
+            auto v = _values.Repeated<LVRepeatedSFixed32MessageValue>(fieldInfo);
+            ReservePackedFixed(&(v->_value), ptr, ctx);
             ptr = PackedSFixed32Parser(&(v->_value), ptr, ctx);
-            _values.emplace(index, v);
         }
         else
         {
             int32_t result;
             ptr = ReadSFIXED32(ptr, &result);
-            auto v = std::make_shared<LVSFixed32MessageValue>(index, result);
-            _values.emplace(index, v);
+            _values.SetScalar(fieldInfo, result);
         }
         return ptr;
     }
@@ -528,48 +559,39 @@ namespace grpc_labview
     {
         if (fieldInfo.isRepeated)
         {
-            auto v = std::make_shared<LVRepeatedSFixed64MessageValue>(index);
+            auto v = _values.Repeated<LVRepeatedSFixed64MessageValue>(fieldInfo);
+            ReservePackedFixed(&(v->_value), ptr, ctx);
             ptr = PackedSFixed64Parser(&(v->_value), ptr, ctx);
-            _values.emplace(index, v);
         }
         else
         {
             int64_t result;
             ptr = ReadSFIXED64(ptr, &result);
-            auto v = std::make_shared<LVSFixed64MessageValue>(index, result);
-            _values.emplace(index, v);
+            _values.SetScalar(fieldInfo, result);
         }
         return ptr;
     }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    const char *LVMessage::ParseNestedMessage(google::protobuf::uint32 tag, const MessageElementMetadata &fieldInfo, uint32_t index, const char *protobuf_ptr, ParseContext *ctx)
+    const char *LVMessage::ParseNestedMessage(google::protobuf::uint32 tag, const FieldParser& parser, uint32_t index, const char *protobuf_ptr, ParseContext *ctx)
     {
-        auto metadata = fieldInfo._owner->FindMetadata(fieldInfo.embeddedMessageName);
+        auto& fieldInfo = *parser.field;
+        auto metadata = parser.nestedMetadata.lock();
         if (fieldInfo.isRepeated)
         {
-            std::shared_ptr<LVRepeatedNestedMessageMessageValue> v;
-            auto it = _values.find(index);
-            if (it == _values.end())
-            {
-                v = std::make_shared<LVRepeatedNestedMessageMessageValue>(index);
-                _values.emplace(index, v);
-            }
-            else
-            {
-                v = std::static_pointer_cast<LVRepeatedNestedMessageMessageValue>((*it).second);
-            }
+            auto v = _values.Repeated<LVRepeatedNestedMessageMessageValue>(fieldInfo);
+            auto arena = _values.GetArena();
 
             auto tagSize = CalculateTagWireSize(tag);
             protobuf_ptr -= tagSize;
             do
             {
                 protobuf_ptr += tagSize;
-                auto nestedMessage = std::make_shared<LVMessage>(metadata);
+                auto nestedMessage = ArenaMakeShared<LVMessage>(arena, metadata, arena);
                 protobuf_ptr = ctx->ParseMessage(nestedMessage.get(), protobuf_ptr);
                 v->_value.push_back(nestedMessage);
-                if (!ctx->DataAvailable(protobuf_ptr))
+                if (protobuf_ptr == nullptr || !ctx->DataAvailable(protobuf_ptr))
                 {
                     break;
                 }
@@ -577,10 +599,10 @@ namespace grpc_labview
         }
         else
         {
-            auto nestedMessage = std::make_shared<LVMessage>(metadata);
+            auto arena = _values.GetArena();
+            auto nestedMessage = ArenaMakeShared<LVMessage>(arena, metadata, arena);
             protobuf_ptr = ctx->ParseMessage(nestedMessage.get(), protobuf_ptr);
-            auto v = std::make_shared<LVNestedMessageMessageValue>(index, nestedMessage);
-            _values.emplace(index, v);
+            _values.Set(fieldInfo, ArenaMakeShared<LVNestedMessageMessageValue>(arena, index, nestedMessage));
         }
         return protobuf_ptr;
     }
@@ -589,23 +611,18 @@ namespace grpc_labview
     //---------------------------------------------------------------------
     google::protobuf::uint8 *LVMessage::_InternalSerialize(google::protobuf::uint8 *target, google::protobuf::io::EpsCopyOutputStream *stream) const
     {
-        for (auto e : _values)
+        if (_metadata == nullptr)
         {
-            target = e.second->Serialize(target, stream);
+            return target;
         }
-        return target;
+        return _values.Serialize(*_metadata, target, stream);
     }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     size_t LVMessage::ByteSizeLong() const
     {
-        size_t totalSize = 0;
-
-        for (auto e : _values)
-        {
-            totalSize += e.second->ByteSizeLong();
-        }
+        size_t totalSize = _metadata != nullptr ? _values.ByteSizeLong(*_metadata) : 0;
         int cachedSize = ToCachedSize(totalSize);
         SetCachedSize(cachedSize);
         return totalSize;
@@ -636,14 +653,19 @@ namespace grpc_labview
     //---------------------------------------------------------------------
     void LVMessage::ArenaDtor(void *object)
     {
-        assert(false); // not expected to be called
+        static_cast<LVMessage*>(object)->~LVMessage();
     }
 
     //---------------------------------------------------------------------
+    // For a message constructed in memory taken from the arena, which then
+    // destroys it with the arena.
     //---------------------------------------------------------------------
-    void LVMessage::RegisterArenaDtor(google::protobuf::Arena *)
+    void LVMessage::RegisterArenaDtor(google::protobuf::Arena *arena)
     {
-        assert(false); // not expected to be called
+        if (arena != nullptr)
+        {
+            arena->OwnCustomDestructor(this, &LVMessage::ArenaDtor);
+        }
     }
 
     //---------------------------------------------------------------------
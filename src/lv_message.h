@@ -12,20 +12,44 @@ using namespace google::protobuf::internal;
 
 namespace grpc_labview
 {
+    //---------------------------------------------------------------------
+    // Reserves the elements of a packed field of fixed size values before it
+    // is read. Otherwise a field spanning many slices of a received message
+    // is grown once per slice. A size running past the end of the message is
+    // not reserved, the parser rejects it.
+    //---------------------------------------------------------------------
+    template <typename T>
+    void ReservePackedFixed(google::protobuf::RepeatedField<T>* field, const char* ptr, ParseContext* ctx)
+    {
+        auto sizePtr = ptr;
+        auto size = ReadSize(&sizePtr);
+        if (sizePtr == nullptr)
+        {
+            return;
+        }
+        auto bytesLeft = ctx->BytesUntilLimit(sizePtr);
+        if (bytesLeft >= 0 && size <= (uint32_t)bytesLeft)
+        {
+            field->Reserve(field->size() + (int)(size / (uint32_t)sizeof(T)));
+        }
+    }
+
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     class LVMessage : public google::protobuf::Message, public gRPCid
     {
     public:
-        LVMessage(std::shared_ptr<MessageMetadata> metadata);
+        LVMessage(std::shared_ptr<MessageMetadata> metadata, google::protobuf::Arena* arena = nullptr);
         ~LVMessage();
 
+        void UseOwnArena();
+
         google::protobuf::UnknownFieldSet& UnknownFields();
 
         Message* New(google::protobuf::Arena* arena) const override;
         void SharedCtor();
         void SharedDtor();
-        void ArenaDtor(void* object);
+        static void ArenaDtor(void* object);
         void RegisterArenaDtor(google::protobuf::Arena*);
 
         void Clear()  final;
@@ -47,9 +71,15 @@ namespace grpc_labview
         google::protobuf::Metadata GetMetadata() const final;
 
         bool ParseFromByteBuffer(const grpc::ByteBuffer& buffer);
-        std::unique_ptr<grpc::ByteBuffer> SerializeToByteBuffer();
+        void SerializeToByteBuffer(grpc::ByteBuffer* buffer);
+
+        const LVValueSlot* FindValue(int protobufIndex) const;
 
-        std::map<int, std::shared_ptr<LVMessageValue>> _values;
+        // The parser of a field for its type, compiled into the field parsers of its message metadata.
+        // Fields of a type without a parser are skipped as unknown fields.
+        static FieldParseFunction FieldParserFor(const MessageElementMetadata& field);
+
+        LVMessageValues _values;
         std::shared_ptr<MessageMetadata> _metadata;
         std::map<std::string, int> _oneofContainerToSelectedIndexMap;
 
@@ -73,8 +103,11 @@ namespace grpc_labview
         virtual const char* ParseSFixed64(const MessageElementMetadata& fieldInfo, uint32_t index, const char* ptr, google::protobuf::internal::ParseContext* ctx);
         virtual const char *ParseString(unsigned int tag, const MessageElementMetadata& fieldInfo, uint32_t index, const char *ptr, google::protobuf::internal::ParseContext *ctx);
         virtual const char *ParseBytes(unsigned int tag, const MessageElementMetadata& fieldInfo, uint32_t index, const char *ptr, google::protobuf::internal::ParseContext *ctx);
-        virtual const char *ParseNestedMessage(google::protobuf::uint32 tag, const MessageElementMetadata& fieldInfo, uint32_t index, const char *ptr, google::protobuf::internal::ParseContext *ctx);
+        virtual const char *ParseNestedMessage(google::protobuf::uint32 tag, const FieldParser& parser, uint32_t index, const char *ptr, google::protobuf::internal::ParseContext *ctx);
         bool ExpectTag(google::protobuf::uint32 tag, const char* ptr);
         int CalculateTagWireSize(google::protobuf::uint32 tag);
+
+        // The column of the field parsers used by this kind of message.
+        FieldParseFunction FieldParser::* _fieldParse;
     };
 }
@@ -19,6 +19,66 @@ namespace grpc_labview
         return nullptr;
     }
 
+    //---------------------------------------------------------------------
+    // The parsers call the Parse function of LVMessageEfficient by name, so a
+    // field is parsed without a virtual call.
+    //---------------------------------------------------------------------
+#define LV_FIELD_PARSER(Parse) \
+    [](LVMessage& message, google::protobuf::uint32 tag, const FieldParser& parser, const char* ptr, ParseContext* ctx) \
+    { return static_cast<LVMessageEfficient&>(message).LVMessageEfficient::Parse(*parser.field, tag >> 3, ptr, ctx); }
+#define LV_TAGGED_FIELD_PARSER(Parse) \
+    [](LVMessage& message, google::protobuf::uint32 tag, const FieldParser& parser, const char* ptr, ParseContext* ctx) \
+    { return static_cast<LVMessageEfficient&>(message).LVMessageEfficient::Parse(tag, *parser.field, tag >> 3, ptr, ctx); }
+#define LV_NESTED_FIELD_PARSER(Parse) \
+    [](LVMessage& message, google::protobuf::uint32 tag, const FieldParser& parser, const char* ptr, ParseContext* ctx) \
+    { return static_cast<LVMessageEfficient&>(message).LVMessageEfficient::Parse(tag, parser, tag >> 3, ptr, ctx); }
+
+    FieldParseFunction LVMessageEfficient::FieldParserFor(const MessageElementMetadata& field)
+    {
+        switch (field.type)
+        {
+        case LVMessageMetadataType::Int32Value:
+            return LV_FIELD_PARSER(ParseInt32);
+        case LVMessageMetadataType::FloatValue:
+            return LV_FIELD_PARSER(ParseFloat);
+        case LVMessageMetadataType::DoubleValue:
+            return LV_FIELD_PARSER(ParseDouble);
+        case LVMessageMetadataType::BoolValue:
+            return LV_FIELD_PARSER(ParseBoolean);
+        case LVMessageMetadataType::StringValue:
+            return LV_TAGGED_FIELD_PARSER(ParseString);
+        case LVMessageMetadataType::BytesValue:
+            return LV_TAGGED_FIELD_PARSER(ParseBytes);
+        case LVMessageMetadataType::MessageValue:
+            return LV_NESTED_FIELD_PARSER(ParseNestedMessage);
+        case LVMessageMetadataType::Int64Value:
+            return LV_FIELD_PARSER(ParseInt64);
+        case LVMessageMetadataType::UInt32Value:
+            return LV_FIELD_PARSER(ParseUInt32);
+        case LVMessageMetadataType::UInt64Value:
+            return LV_FIELD_PARSER(ParseUInt64);
+        case LVMessageMetadataType::EnumValue:
+            return LV_FIELD_PARSER(ParseEnum);
+        case LVMessageMetadataType::SInt32Value:
+            return LV_FIELD_PARSER(ParseSInt32);
+        case LVMessageMetadataType::SInt64Value:
+            return LV_FIELD_PARSER(ParseSInt64);
+        case LVMessageMetadataType::Fixed32Value:
+            return LV_FIELD_PARSER(ParseFixed32);
+        case LVMessageMetadataType::Fixed64Value:
+            return LV_FIELD_PARSER(ParseFixed64);
+        case LVMessageMetadataType::SFixed32Value:
+            return LV_FIELD_PARSER(ParseSFixed32);
+        case LVMessageMetadataType::SFixed64Value:
+            return LV_FIELD_PARSER(ParseSFixed64);
+        }
+        return nullptr;
+    }
+
+#undef LV_FIELD_PARSER
+#undef LV_TAGGED_FIELD_PARSER
+#undef LV_NESTED_FIELD_PARSER
+
 #define DEFINE_PARSE_FUNCTION(Type, TypeName, ReadType, ParserType) \
     const char *LVMessageEfficient::Parse##TypeName(const MessageElementMetadata& fieldInfo, uint32_t index, const char *ptr, ParseContext *ctx) \
     { \
@@ -123,7 +183,7 @@ namespace grpc_labview
                 protobuf_ptr += tagSize;
                 auto str = repeatedString.Add();
                 protobuf_ptr = InlineGreedyStringParser(str, protobuf_ptr, ctx);
-                if (!ctx->DataAvailable(protobuf_ptr))
+                if (protobuf_ptr == nullptr || !ctx->DataAvailable(protobuf_ptr))
                 {
                     break;
                 }
@@ -148,17 +208,18 @@ namespace grpc_labview
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    const char* LVMessageEfficient::ParseNestedMessage(google::protobuf::uint32 tag, const MessageElementMetadata& fieldInfo, uint32_t index, const char* protobuf_ptr, ParseContext* ctx)
+    const char* LVMessageEfficient::ParseNestedMessage(google::protobuf::uint32 tag, const FieldParser& parser, uint32_t index, const char* protobuf_ptr, ParseContext* ctx)
     {
+        auto& fieldInfo = *parser.field;
         switch (fieldInfo.wellKnownType)
         {
         case wellknown::Types::Double2DArray:
-            return ParseDouble2DArrayMessage(fieldInfo, index, protobuf_ptr, ctx);
+            return ParseDouble2DArrayMessage(parser, index, protobuf_ptr, ctx);
         case wellknown::Types::String2DArray:
-            return ParseString2DArrayMessage(fieldInfo, index, protobuf_ptr, ctx);
+            return ParseString2DArrayMessage(parser, index, protobuf_ptr, ctx);
         }
 
-        auto metadata = fieldInfo._owner->FindMetadata(fieldInfo.embeddedMessageName);
+        auto metadata = parser.nestedMetadata.lock();
         if (fieldInfo.isRepeated)
         {
             // if the array is not big enough, resize it to 2x the size
@@ -172,7 +233,7 @@ namespace grpc_labview
             auto repeatedMessageValuesIt = _repeatedMessageValuesMap.find(fieldInfo.fieldName);
             if (repeatedMessageValuesIt == _repeatedMessageValuesMap.end())
             {
-                auto m_val = std::make_shared<RepeatedMessageValue>(fieldInfo, google::protobuf::RepeatedField<char>());
+                auto m_val = std::make_shared<RepeatedMessageValue>(fieldInfo, metadata, google::protobuf::RepeatedField<char>());
                 repeatedMessageValuesIt = _repeatedMessageValuesMap.emplace(fieldInfo.fieldName, m_val).first;
                 repeatedMessageValuesIt->second.get()->_buffer.Resize(arraySize, _fillData);
             }
@@ -206,7 +267,7 @@ namespace grpc_labview
 
                 elementIndex++;
 
-                if (!ctx->DataAvailable(protobuf_ptr))
+                if (protobuf_ptr == nullptr || !ctx->DataAvailable(protobuf_ptr))
                 {
                     break;
                 }
@@ -216,7 +277,7 @@ namespace grpc_labview
         }
         else
         {
-            auto nestedClusterPtr = _LVClusterHandle + fieldInfo.clusterOffset;
+            auto nestedClusterPtr = _LVClusterHandle + parser.clusterOffset;
             LVMessageEfficient nestedMessage(metadata, nestedClusterPtr);
             protobuf_ptr = ctx->ParseMessage(&nestedMessage, protobuf_ptr);
         }
@@ -225,29 +286,29 @@ namespace grpc_labview
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    const char* LVMessageEfficient::Parse2DArrayMessage(const MessageElementMetadata& fieldInfo, uint32_t index, const char* protobuf_ptr, ParseContext* ctx, wellknown::I2DArray& array)
+    const char* LVMessageEfficient::Parse2DArrayMessage(const FieldParser& parser, uint32_t index, const char* protobuf_ptr, ParseContext* ctx, wellknown::I2DArray& array)
     {
-        auto metadata = fieldInfo._owner->FindMetadata(fieldInfo.embeddedMessageName);
+        auto metadata = parser.nestedMetadata.lock();
         auto nestedMessage = std::make_shared<LVMessage>(metadata);
         protobuf_ptr = ctx->ParseMessage(nestedMessage.get(), protobuf_ptr);
-        auto nestedClusterPtr = _LVClusterHandle + fieldInfo.clusterOffset;
+        auto nestedClusterPtr = _LVClusterHandle + parser.clusterOffset;
         auto nestedMessageValue = std::make_shared<LVNestedMessageMessageValue>(index, nestedMessage);
-        array.CopyFromMessageToCluster(fieldInfo, nestedMessageValue, nestedClusterPtr);
+        array.CopyFromMessageToCluster(*parser.field, nestedMessageValue, nestedClusterPtr);
         return protobuf_ptr;
     }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    const char* LVMessageEfficient::ParseDouble2DArrayMessage(const MessageElementMetadata& fieldInfo, uint32_t index, const char* protobuf_ptr, ParseContext* ctx)
+    const char* LVMessageEfficient::ParseDouble2DArrayMessage(const FieldParser& parser, uint32_t index, const char* protobuf_ptr, ParseContext* ctx)
     {
-        return Parse2DArrayMessage(fieldInfo, index, protobuf_ptr, ctx, wellknown::Double2DArray::GetInstance());
+        return Parse2DArrayMessage(parser, index, protobuf_ptr, ctx, wellknown::Double2DArray::GetInstance());
     }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    const char* LVMessageEfficient::ParseString2DArrayMessage(const MessageElementMetadata& fieldInfo, uint32_t index, const char* protobuf_ptr, ParseContext* ctx)
+    const char* LVMessageEfficient::ParseString2DArrayMessage(const FieldParser& parser, uint32_t index, const char* protobuf_ptr, ParseContext* ctx)
     {
-        return Parse2DArrayMessage(fieldInfo, index, protobuf_ptr, ctx, wellknown::String2DArray::GetInstance());
+        return Parse2DArrayMessage(parser, index, protobuf_ptr, ctx, wellknown::String2DArray::GetInstance());
     }
 
     //---------------------------------------------------------------------
@@ -262,7 +323,7 @@ namespace grpc_labview
             auto& buffer = nestedMessage.second.get()->_buffer;
             auto numClusters = nestedMessage.second.get()->_numElements;
 
-            auto metadata = fieldInfo._owner->FindMetadata(fieldInfo.embeddedMessageName);
+            auto& metadata = nestedMessage.second.get()->_metadata;
             auto lv_ptr = _LVClusterHandle + fieldInfo.clusterOffset;
             auto clusterSize = metadata->clusterSize;
             auto alignment = metadata->alignmentRequirement;
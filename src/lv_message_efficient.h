@@ -9,6 +9,7 @@
 #include <google/protobuf/message.h>
 #include <lv_message.h>
 #include <well_known_messages.h>
+#include <type_traits>
 
 using namespace google::protobuf::internal;
 
@@ -19,9 +20,15 @@ namespace grpc_labview
     class LVMessageEfficient : public LVMessage
     {
     public:
-        LVMessageEfficient(std::shared_ptr<MessageMetadata> metadata, int8_t* cluster) : LVMessage(metadata), _LVClusterHandle(cluster) {}
+        LVMessageEfficient(std::shared_ptr<MessageMetadata> metadata, int8_t* cluster) : LVMessage(metadata), _LVClusterHandle(cluster)
+        {
+            _fieldParse = &FieldParser::parseIntoCluster;
+        }
         ~LVMessageEfficient() {}
 
+        // The parser of a field for its type that copies it into the cluster.
+        static FieldParseFunction FieldParserFor(const MessageElementMetadata& field);
+
         Message* New(google::protobuf::Arena* arena) const override;
         void PostInteralParseAction() override;
         int8_t* GetLVClusterHandle() { return _LVClusterHandle; };
@@ -29,11 +36,12 @@ namespace grpc_labview
     protected:
         struct RepeatedMessageValue {
             const MessageElementMetadata& _fieldInfo;
+            std::shared_ptr<MessageMetadata> _metadata;
             google::protobuf::RepeatedField<char> _buffer;
             uint64_t _numElements = 0;
 
-            RepeatedMessageValue(const MessageElementMetadata& fieldInfo, google::protobuf::RepeatedField<char> buffer) :
-                _fieldInfo(fieldInfo), _buffer(buffer) {}
+            RepeatedMessageValue(const MessageElementMetadata& fieldInfo, std::shared_ptr<MessageMetadata> metadata, google::protobuf::RepeatedField<char> buffer) :
+                _fieldInfo(fieldInfo), _metadata(metadata), _buffer(buffer) {}
         };
 
         struct RepeatedStringValue {
@@ -67,12 +75,12 @@ namespace grpc_labview
         const char* ParseSFixed64(const MessageElementMetadata& fieldInfo, uint32_t index, const char* ptr, google::protobuf::internal::ParseContext* ctx) override;
         const char* ParseString(unsigned int tag, const MessageElementMetadata& fieldInfo, uint32_t index, const char* ptr, google::protobuf::internal::ParseContext* ctx) override;
         const char* ParseBytes(unsigned int tag, const MessageElementMetadata& fieldInfo, uint32_t index, const char* ptr, google::protobuf::internal::ParseContext* ctx) override;
-        const char* ParseNestedMessage(google::protobuf::uint32 tag, const MessageElementMetadata& fieldInfo, uint32_t index, const char* ptr, google::protobuf::internal::ParseContext* ctx) override;
-        const char* ParseDouble2DArrayMessage(const MessageElementMetadata& fieldInfo, uint32_t index, const char* ptr, google::protobuf::internal::ParseContext* ctx);
-        const char* ParseString2DArrayMessage(const MessageElementMetadata& fieldInfo, uint32_t index, const char* ptr, google::protobuf::internal::ParseContext* ctx);
+        const char* ParseNestedMessage(google::protobuf::uint32 tag, const FieldParser& parser, uint32_t index, const char* ptr, google::protobuf::internal::ParseContext* ctx) override;
+        const char* ParseDouble2DArrayMessage(const FieldParser& parser, uint32_t index, const char* ptr, google::protobuf::internal::ParseContext* ctx);
+        const char* ParseString2DArrayMessage(const FieldParser& parser, uint32_t index, const char* ptr, google::protobuf::internal::ParseContext* ctx);
 
     private:
-        const char* Parse2DArrayMessage(const MessageElementMetadata& fieldInfo, uint32_t index, const char* protobuf_ptr, ParseContext* ctx, wellknown::I2DArray& array);
+        const char* Parse2DArrayMessage(const FieldParser& parser, uint32_t index, const char* protobuf_ptr, ParseContext* ctx, wellknown::I2DArray& array);
     };
 
     template <typename MessageType, const char* (*ReadFunc)(const char*, MessageType*), const char* (*PackedFunc)(void*, const char*, google::protobuf::internal::ParseContext*)>
@@ -114,6 +122,11 @@ namespace grpc_labview
 
         const char* PackedMessageType(const char* ptr, ParseContext* ctx, google::protobuf::RepeatedField<MessageType>* value)
         {
+            if (std::is_floating_point<MessageType>::value)
+            {
+                // Floats and doubles are the fixed size types parsed this way.
+                ReservePackedFixed(value, ptr, ctx);
+            }
             return PackedFunc(value, ptr, ctx);
         }
 
@@ -42,8 +42,9 @@ namespace grpc_labview
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    LVRepeatedNestedMessageMessageValue::LVRepeatedNestedMessageMessageValue(int protobufId) :
-        LVMessageValue(protobufId)
+    LVRepeatedNestedMessageMessageValue::LVRepeatedNestedMessageMessageValue(int protobufId, google::protobuf::Arena* arena) :
+        LVMessageValue(protobufId),
+        _value(ArenaAllocator<std::shared_ptr<LVMessage>>(arena))
     {
     }
 
@@ -122,31 +123,6 @@ namespace grpc_labview
         return target;
     }
 
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    /*LVVariableMessageValue<bool>::LVVariableMessageValue(int protobufId, bool value) :
-        LVMessageValue(protobufId),
-        _value(value)
-    {
-    }*/
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    template <>
-    size_t LVVariableMessageValue<bool>::ByteSizeLong()
-    {
-        return WireFormatLite::TagSize(_protobufId, WireFormatLite::TYPE_BOOL) + WireFormatLite::kBoolSize;
-    }
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    template <>
-    google::protobuf::uint8* LVVariableMessageValue<bool>::Serialize(google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream) const
-    {
-        target = stream->EnsureSpace(target);
-        return WireFormatLite::WriteBoolToArray(_protobufId, _value, target);
-    }
-
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     /*LVRepeatedMessageValue<bool>::LVRepeatedMessageValue(int protobufId) :
@@ -183,129 +159,6 @@ namespace grpc_labview
         return target;
     }
 
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    /*LVVariableMessageValue<int>::LVVariableMessageValue(int protobufId, int value) :
-        LVMessageValue(protobufId),
-        _value(value)
-    {
-    }*/
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    template <>
-    size_t LVVariableMessageValue<int>::ByteSizeLong()
-    {
-        return WireFormatLite::TagSize(_protobufId, WireFormatLite::FieldType::TYPE_INT32) +  WireFormatLite::Int32Size(_value);
-    }
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    template <>
-    google::protobuf::uint8* LVVariableMessageValue<int>::Serialize(google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream) const
-    {
-        target = stream->EnsureSpace(target);
-        return WireFormatLite::WriteInt32ToArray(_protobufId, _value, target);
-    }
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    /*LVVariableMessageValue<uint32_t>::LVVariableMessageValue(int protobufId, uint32_t value) :
-        LVMessageValue(protobufId),
-        _value(value)
-    {
-    }*/
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    template <>
-    size_t LVVariableMessageValue<uint32_t>::ByteSizeLong()
-    {
-        return WireFormatLite::TagSize(_protobufId, WireFormatLite::FieldType::TYPE_UINT32) +  WireFormatLite::UInt32Size(_value);
-    }
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    template <>
-    google::protobuf::uint8* LVVariableMessageValue<uint32_t>::Serialize(google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream) const
-    {
-        target = stream->EnsureSpace(target);
-        return WireFormatLite::WriteUInt32ToArray(_protobufId, _value, target);
-    }
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    LVEnumMessageValue::LVEnumMessageValue(int protobufId, int value) :
-        LVMessageValue(protobufId),
-        _value(value)
-    {
-    }
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    size_t LVEnumMessageValue::ByteSizeLong()
-    {
-        return WireFormatLite::TagSize(_protobufId, WireFormatLite::FieldType::TYPE_ENUM) +  WireFormatLite::EnumSize(_value);
-    }
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    google::protobuf::uint8* LVEnumMessageValue::Serialize(google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream) const
-    {
-        target = stream->EnsureSpace(target);
-        return WireFormatLite::WriteEnumToArray(_protobufId, _value, target);
-    }
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    /*LVVariableMessageValue<int64_t>::LVVariableMessageValue(int protobufId, int64_t value) :
-        LVMessageValue(protobufId),
-        _value(value)
-    {
-    }*/
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    template <>
-    size_t LVVariableMessageValue<int64_t>::ByteSizeLong()
-    {
-        return WireFormatLite::TagSize(_protobufId, WireFormatLite::FieldType::TYPE_INT64) + WireFormatLite::Int64Size(_value);
-    }
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    template <>
-    google::protobuf::uint8* LVVariableMessageValue<int64_t>::Serialize(google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream) const
-    {
-        target = stream->EnsureSpace(target);
-        return WireFormatLite::WriteInt64ToArray(_protobufId, _value, target);
-    }
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    /*LVVariableMessageValue<uint64_t>::LVVariableMessageValue(int protobufId, uint64_t value) :
-        LVMessageValue(protobufId),
-        _value(value)
-    {
-    }*/
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    template <>
-    size_t LVVariableMessageValue<uint64_t>::ByteSizeLong()
-    {
-        return WireFormatLite::TagSize(_protobufId, WireFormatLite::FieldType::TYPE_UINT64) +  WireFormatLite::UInt64Size(_value);
-    }
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    template <>
-    google::protobuf::uint8* LVVariableMessageValue<uint64_t>::Serialize(google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream) const
-    {
-        target = stream->EnsureSpace(target);
-        return WireFormatLite::WriteUInt64ToArray(_protobufId, _value, target);
-    }
-
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     /*LVRepeatedMessageValue<int>::LVRepeatedMessageValue(int protobufId) :
@@ -380,8 +233,9 @@ namespace grpc_labview
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    LVRepeatedEnumMessageValue::LVRepeatedEnumMessageValue(int protobufId) :
-        LVRepeatedMessageValue<int>(protobufId)
+    LVRepeatedEnumMessageValue::LVRepeatedEnumMessageValue(int protobufId, google::protobuf::Arena* arena) :
+        LVRepeatedMessageValue<int>(protobufId, arena),
+        _value(arena)
     {
     }
 
@@ -484,31 +338,6 @@ namespace grpc_labview
         return target;
     }
 
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    /*LVVariableMessageValue<float>::LVVariableMessageValue(int protobufId, float value) :
-        LVMessageValue(protobufId),
-        _value(value)
-    {
-    }*/
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    template <>
-    size_t LVVariableMessageValue<float>::ByteSizeLong()
-    {
-        return WireFormatLite::TagSize(_protobufId, WireFormatLite::TYPE_STRING) + WireFormatLite::kFloatSize;
-    }
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    template <>
-    google::protobuf::uint8* LVVariableMessageValue<float>::Serialize(google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream) const
-    {
-        target = stream->EnsureSpace(target);
-        return WireFormatLite::WriteFloatToArray(_protobufId, _value, target);
-    }
-
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     /*LVRepeatedMessageValue<float>::LVRepeatedMessageValue(int protobufId) :
@@ -546,31 +375,6 @@ namespace grpc_labview
     }
 
 
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    /*LVVariableMessageValue<double>::LVVariableMessageValue(int protobufId, double value) :
-        LVMessageValue(protobufId),
-        _value(value)
-    {
-    }*/
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    template <>
-    size_t LVVariableMessageValue<double>::ByteSizeLong()
-    {
-        return WireFormatLite::TagSize(_protobufId, WireFormatLite::FieldType::TYPE_DOUBLE) +  WireFormatLite::kDoubleSize;
-    }
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    template <>
-    google::protobuf::uint8* LVVariableMessageValue<double>::Serialize(google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream) const
-    {
-        target = stream->EnsureSpace(target);
-        return WireFormatLite::WriteDoubleToArray(_protobufId, _value, target);
-    }
-
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     /*LVRepeatedMessageValue<double>::LVRepeatedMessageValue(int protobufId) :
@@ -609,31 +413,9 @@ namespace grpc_labview
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    LVSInt32MessageValue::LVSInt32MessageValue(int protobufId, int32_t value) :
+    LVRepeatedSInt32MessageValue::LVRepeatedSInt32MessageValue(int protobufId, google::protobuf::Arena* arena) :
         LVMessageValue(protobufId),
-        _value(value)
-    {
-    }
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    size_t LVSInt32MessageValue::ByteSizeLong()
-    {
-        return WireFormatLite::TagSize(_protobufId, WireFormatLite::TYPE_SINT32) + WireFormatLite::SInt32Size(_value);
-    }
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    google::protobuf::uint8* LVSInt32MessageValue::Serialize(google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream) const
-    {
-        target = stream->EnsureSpace(target);
-        return WireFormatLite::WriteSInt32ToArray(_protobufId, _value, target);
-    }
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    LVRepeatedSInt32MessageValue::LVRepeatedSInt32MessageValue(int protobufId) :
-        LVMessageValue(protobufId)
+        _value(arena)
     {
     }
 
@@ -663,33 +445,12 @@ namespace grpc_labview
         }
         return target;
     }
-    //---------------------------------------------------------------------
-     //---------------------------------------------------------------------
-    LVSInt64MessageValue::LVSInt64MessageValue(int protobufId, int64_t value) :
-        LVMessageValue(protobufId),
-        _value(value)
-    {
-    }
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    size_t LVSInt64MessageValue::ByteSizeLong()
-    {
-        return WireFormatLite::TagSize(_protobufId, WireFormatLite::TYPE_SINT64) + WireFormatLite::SInt64Size(_value);
-    }
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    google::protobuf::uint8* LVSInt64MessageValue::Serialize(google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream) const
-    {
-        target = stream->EnsureSpace(target);
-        return WireFormatLite::WriteSInt64ToArray(_protobufId, _value, target);
-    }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    LVRepeatedSInt64MessageValue::LVRepeatedSInt64MessageValue(int protobufId) :
-        LVMessageValue(protobufId)
+    LVRepeatedSInt64MessageValue::LVRepeatedSInt64MessageValue(int protobufId, google::protobuf::Arena* arena) :
+        LVMessageValue(protobufId),
+        _value(arena)
     {
     }
 
@@ -722,31 +483,9 @@ namespace grpc_labview
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    LVFixed32MessageValue::LVFixed32MessageValue(int protobufId, uint32_t value) :
+    LVRepeatedFixed32MessageValue::LVRepeatedFixed32MessageValue(int protobufId, google::protobuf::Arena* arena) :
         LVMessageValue(protobufId),
-        _value(value)
-    {
-    }
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    size_t LVFixed32MessageValue::ByteSizeLong()
-    {
-        return WireFormatLite::TagSize(_protobufId, WireFormatLite::TYPE_FIXED32) + WireFormatLite::kFixed32Size;
-    }
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    google::protobuf::uint8* LVFixed32MessageValue::Serialize(google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream) const
-    {
-        target = stream->EnsureSpace(target);
-        return WireFormatLite::WriteFixed32ToArray(_protobufId, _value, target);
-    }
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    LVRepeatedFixed32MessageValue::LVRepeatedFixed32MessageValue(int protobufId) :
-        LVMessageValue(protobufId)
+        _value(arena)
     {
     }
 
@@ -779,31 +518,9 @@ namespace grpc_labview
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    LVFixed64MessageValue::LVFixed64MessageValue(int protobufId, uint64_t value) :
+    LVRepeatedFixed64MessageValue::LVRepeatedFixed64MessageValue(int protobufId, google::protobuf::Arena* arena) :
         LVMessageValue(protobufId),
-        _value(value)
-    {
-    }
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    size_t LVFixed64MessageValue::ByteSizeLong()
-    {
-        return WireFormatLite::TagSize(_protobufId, WireFormatLite::TYPE_FIXED64) + WireFormatLite::kFixed64Size;
-    }
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    google::protobuf::uint8* LVFixed64MessageValue::Serialize(google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream) const
-    {
-        target = stream->EnsureSpace(target);
-        return WireFormatLite::WriteFixed64ToArray(_protobufId, _value, target);
-    }
-
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    LVRepeatedFixed64MessageValue::LVRepeatedFixed64MessageValue(int protobufId) :
-        LVMessageValue(protobufId)
+        _value(arena)
     {
     }
 
@@ -836,45 +553,58 @@ namespace grpc_labview
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    LVSFixed32MessageValue::LVSFixed32MessageValue(int protobufId, int32_t value) :
+    LVRepeatedSFixed32MessageValue::LVRepeatedSFixed32MessageValue(int protobufId, google::protobuf::Arena* arena) :
         LVMessageValue(protobufId),
-        _value(value)
+        _value(arena)
     {
     }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    size_t LVSFixed32MessageValue::ByteSizeLong()
+    size_t LVRepeatedSFixed32MessageValue::ByteSizeLong()
     {
-        return WireFormatLite::TagSize(_protobufId, WireFormatLite::TYPE_SFIXED32) + WireFormatLite::kSFixed32Size;
+        size_t totalSize = 0;
+        unsigned int count = static_cast<unsigned int>(_value.size());
+        size_t dataSize = WireFormatLite::kSFixed32Size * count;
+        if (dataSize > 0)
+        {
+            // passing 2 as type to TagSize because that is what WriteLengthDelim passes during serialize
+            totalSize += WireFormatLite::TagSize(_protobufId, (WireFormatLite::FieldType)2) + WireFormatLite::Int32Size(static_cast<google::protobuf::int32>(dataSize));
+        }
+        totalSize += dataSize;
+        return totalSize;
     }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    google::protobuf::uint8* LVSFixed32MessageValue::Serialize(google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream) const
+    google::protobuf::uint8* LVRepeatedSFixed32MessageValue::Serialize(google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream) const
     {
-        target = stream->EnsureSpace(target);
-        return WireFormatLite::WriteSFixed32ToArray(_protobufId, _value, target);
+        if (_value.size() > 0)
+        {
+            target = stream->WriteFixedPacked(_protobufId, _value, target);
+        }
+        return target;
     }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    LVRepeatedSFixed32MessageValue::LVRepeatedSFixed32MessageValue(int protobufId) :
-        LVMessageValue(protobufId)
+    LVRepeatedSFixed64MessageValue::LVRepeatedSFixed64MessageValue(int protobufId, google::protobuf::Arena* arena) :
+        LVMessageValue(protobufId),
+        _value(arena)
     {
     }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    size_t LVRepeatedSFixed32MessageValue::ByteSizeLong()
+    size_t LVRepeatedSFixed64MessageValue::ByteSizeLong()
     {
         size_t totalSize = 0;
         unsigned int count = static_cast<unsigned int>(_value.size());
-        size_t dataSize = WireFormatLite::kSFixed32Size * count;
+        size_t dataSize = WireFormatLite::kSFixed64Size * count;
         if (dataSize > 0)
         {
             // passing 2 as type to TagSize because that is what WriteLengthDelim passes during serialize
-            totalSize += WireFormatLite::TagSize(_protobufId, (WireFormatLite::FieldType)2) + WireFormatLite::Int32Size(static_cast<google::protobuf::int32>(dataSize));
+            totalSize += WireFormatLite::TagSize(_protobufId, (WireFormatLite::FieldType)2) + WireFormatLite::Int64Size(static_cast<google::protobuf::int32>(dataSize));
         }
         totalSize += dataSize;
         return totalSize;
@@ -882,7 +612,7 @@ namespace grpc_labview
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    google::protobuf::uint8* LVRepeatedSFixed32MessageValue::Serialize(google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream) const
+    google::protobuf::uint8* LVRepeatedSFixed64MessageValue::Serialize(google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream) const
     {
         if (_value.size() > 0)
         {
@@ -893,58 +623,197 @@ namespace grpc_labview
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    LVSFixed64MessageValue::LVSFixed64MessageValue(int protobufId, int64_t value) :
-        LVMessageValue(protobufId),
-        _value(value)
+    void LVMessageValues::UseOwnArena()
     {
+        assert(_arena == nullptr);
+        _useOwnArena = true;
     }
 
     //---------------------------------------------------------------------
+    // The own arena is created by the first value that is not a scalar, so
+    // messages of scalars only never allocate one.
     //---------------------------------------------------------------------
-    size_t LVSFixed64MessageValue::ByteSizeLong()
+    google::protobuf::Arena* LVMessageValues::GetArena()
     {
-        return WireFormatLite::TagSize(_protobufId, WireFormatLite::TYPE_SFIXED64) + WireFormatLite::kSFixed64Size;
+        if (_arena == nullptr && _useOwnArena)
+        {
+            _ownArena.reset(new google::protobuf::Arena());
+            _arena = _ownArena.get();
+        }
+        return _arena;
     }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    google::protobuf::uint8* LVSFixed64MessageValue::Serialize(google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream) const
+    void LVMessageValues::Clear()
     {
-        target = stream->EnsureSpace(target);
-        return WireFormatLite::WriteSFixed64ToArray(_protobufId, _value, target);
+        for (auto& slot : _slots)
+        {
+            if (slot.isSet)
+            {
+                slot.isSet = false;
+                slot.value.reset();
+            }
+        }
+        if (_ownArena != nullptr)
+        {
+            // Nothing refers to the values any more, release them all at once.
+            _ownArena->Reset();
+        }
     }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    LVRepeatedSFixed64MessageValue::LVRepeatedSFixed64MessageValue(int protobufId) :
-        LVMessageValue(protobufId)
+    const LVValueSlot* LVMessageValues::Find(const MessageElementMetadata& field) const
     {
+        if (field.slot < 0 || field.slot >= (int)_slots.size() || !_slots[field.slot].isSet)
+        {
+            return nullptr;
+        }
+        return &_slots[field.slot];
     }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    size_t LVRepeatedSFixed64MessageValue::ByteSizeLong()
+    void LVMessageValues::Set(const MessageElementMetadata& field, std::shared_ptr<LVMessageValue> value)
     {
-        size_t totalSize = 0;
-        unsigned int count = static_cast<unsigned int>(_value.size());
-        size_t dataSize = WireFormatLite::kSFixed64Size * count;
-        if (dataSize > 0)
+        auto& slot = SlotFor(field);
+        slot.value = std::move(value);
+        slot.isSet = true;
+    }
+
+    //---------------------------------------------------------------------
+    // Fields added to the metadata after the message was created, by the
+    // Any builder, grow the slots.
+    //---------------------------------------------------------------------
+    LVValueSlot& LVMessageValues::SlotFor(const MessageElementMetadata& field)
+    {
+        assert(field.slot >= 0);
+        if (field.slot >= (int)_slots.size())
         {
-            // passing 2 as type to TagSize because that is what WriteLengthDelim passes during serialize
-            totalSize += WireFormatLite::TagSize(_protobufId, (WireFormatLite::FieldType)2) + WireFormatLite::Int64Size(static_cast<google::protobuf::int32>(dataSize));
+            _slots.resize(field.slot + 1);
+        }
+        return _slots[field.slot];
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    size_t LVMessageValues::ByteSizeLong(const MessageMetadata& metadata) const
+    {
+        size_t totalSize = 0;
+        for (auto x : metadata.SlotsByFieldNumber())
+        {
+            if (x >= (int)_slots.size())
+            {
+                continue;
+            }
+            auto& slot = _slots[x];
+            if (slot.isSet)
+            {
+                totalSize += slot.value != nullptr ? slot.value->ByteSizeLong() : ScalarByteSize(*metadata._elements[x], slot);
+            }
         }
-        totalSize += dataSize;
         return totalSize;
     }
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    google::protobuf::uint8* LVRepeatedSFixed64MessageValue::Serialize(google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream) const
+    google::protobuf::uint8* LVMessageValues::Serialize(const MessageMetadata& metadata, google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream) const
     {
-        if (_value.size() > 0)
+        // In ascending field number, as the fields of generated messages are
+        for (auto x : metadata.SlotsByFieldNumber())
         {
-            target = stream->WriteFixedPacked(_protobufId, _value, target);
+            if (x >= (int)_slots.size())
+            {
+                continue;
+            }
+            auto& slot = _slots[x];
+            if (slot.isSet)
+            {
+                target = slot.value != nullptr ? slot.value->Serialize(target, stream) : SerializeScalar(*metadata._elements[x], slot, target, stream);
+            }
         }
         return target;
     }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    size_t LVMessageValues::ScalarByteSize(const MessageElementMetadata& field, const LVValueSlot& slot)
+    {
+        auto tagSize = WireFormatLite::TagSize(field.protobufIndex, WireFormatLite::TYPE_INT32);
+        switch (field.type)
+        {
+        case LVMessageMetadataType::BoolValue:
+            return tagSize + WireFormatLite::kBoolSize;
+        case LVMessageMetadataType::Int32Value:
+            return tagSize + WireFormatLite::Int32Size(slot.Scalar<int32_t>());
+        case LVMessageMetadataType::UInt32Value:
+            return tagSize + WireFormatLite::UInt32Size(slot.Scalar<uint32_t>());
+        case LVMessageMetadataType::EnumValue:
+            return tagSize + WireFormatLite::EnumSize(slot.Scalar<int32_t>());
+        case LVMessageMetadataType::Int64Value:
+            return tagSize + WireFormatLite::Int64Size(slot.Scalar<int64_t>());
+        case LVMessageMetadataType::UInt64Value:
+            return tagSize + WireFormatLite::UInt64Size(slot.Scalar<uint64_t>());
+        case LVMessageMetadataType::FloatValue:
+            return tagSize + WireFormatLite::kFloatSize;
+        case LVMessageMetadataType::DoubleValue:
+            return tagSize + WireFormatLite::kDoubleSize;
+        case LVMessageMetadataType::SInt32Value:
+            return tagSize + WireFormatLite::SInt32Size(slot.Scalar<int32_t>());
+        case LVMessageMetadataType::SInt64Value:
+            return tagSize + WireFormatLite::SInt64Size(slot.Scalar<int64_t>());
+        case LVMessageMetadataType::Fixed32Value:
+            return tagSize + WireFormatLite::kFixed32Size;
+        case LVMessageMetadataType::Fixed64Value:
+            return tagSize + WireFormatLite::kFixed64Size;
+        case LVMessageMetadataType::SFixed32Value:
+            return tagSize + WireFormatLite::kSFixed32Size;
+        case LVMessageMetadataType::SFixed64Value:
+            return tagSize + WireFormatLite::kSFixed64Size;
+        default:
+            return 0;
+        }
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    google::protobuf::uint8* LVMessageValues::SerializeScalar(const MessageElementMetadata& field, const LVValueSlot& slot, google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream)
+    {
+        auto index = field.protobufIndex;
+        target = stream->EnsureSpace(target);
+        switch (field.type)
+        {
+        case LVMessageMetadataType::BoolValue:
+            return WireFormatLite::WriteBoolToArray(index, slot.Scalar<bool>(), target);
+        case LVMessageMetadataType::Int32Value:
+            return WireFormatLite::WriteInt32ToArray(index, slot.Scalar<int32_t>(), target);
+        case LVMessageMetadataType::UInt32Value:
+            return WireFormatLite::WriteUInt32ToArray(index, slot.Scalar<uint32_t>(), target);
+        case LVMessageMetadataType::EnumValue:
+            return WireFormatLite::WriteEnumToArray(index, slot.Scalar<int32_t>(), target);
+        case LVMessageMetadataType::Int64Value:
+            return WireFormatLite::WriteInt64ToArray(index, slot.Scalar<int64_t>(), target);
+        case LVMessageMetadataType::UInt64Value:
+            return WireFormatLite::WriteUInt64ToArray(index, slot.Scalar<uint64_t>(), target);
+        case LVMessageMetadataType::FloatValue:
+            return WireFormatLite::WriteFloatToArray(index, slot.Scalar<float>(), target);
+        case LVMessageMetadataType::DoubleValue:
+            return WireFormatLite::WriteDoubleToArray(index, slot.Scalar<double>(), target);
+        case LVMessageMetadataType::SInt32Value:
+            return WireFormatLite::WriteSInt32ToArray(index, slot.Scalar<int32_t>(), target);
+        case LVMessageMetadataType::SInt64Value:
+            return WireFormatLite::WriteSInt64ToArray(index, slot.Scalar<int64_t>(), target);
+        case LVMessageMetadataType::Fixed32Value:
+            return WireFormatLite::WriteFixed32ToArray(index, slot.Scalar<uint32_t>(), target);
+        case LVMessageMetadataType::Fixed64Value:
+            return WireFormatLite::WriteFixed64ToArray(index, slot.Scalar<uint64_t>(), target);
+        case LVMessageMetadataType::SFixed32Value:
+            return WireFormatLite::WriteSFixed32ToArray(index, slot.Scalar<int32_t>(), target);
+        case LVMessageMetadataType::SFixed64Value:
+            return WireFormatLite::WriteSFixed64ToArray(index, slot.Scalar<int64_t>(), target);
+        default:
+            return target;
+        }
+    }
 }
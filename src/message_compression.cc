@@ -0,0 +1,51 @@
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+#include <message_compression.h>
+#include <algorithm>
+
+namespace grpc_labview
+{
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    CompressionSettings::CompressionSettings() :
+        algorithm(GRPC_COMPRESS_NONE),
+        minBytes(0)
+    {
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    bool CompressionSettings::Set(int32_t lvAlgorithm, int32_t minimumBytes)
+    {
+        switch (lvAlgorithm)
+        {
+        case 0:
+            algorithm = GRPC_COMPRESS_NONE;
+            break;
+        case 1:
+            algorithm = GRPC_COMPRESS_DEFLATE;
+            break;
+        case 2:
+            algorithm = GRPC_COMPRESS_GZIP;
+            break;
+        default:
+            return false;
+        }
+        minBytes = std::max(0, minimumBytes);
+        return true;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    bool CompressionSettings::IsEnabled() const
+    {
+        return algorithm != GRPC_COMPRESS_NONE;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    bool CompressionSettings::Compresses(size_t messageSize) const
+    {
+        return IsEnabled() && messageSize >= (size_t)minBytes;
+    }
+}
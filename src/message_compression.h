@@ -0,0 +1,32 @@
+//---------------------------------------------------------------------
+// Compression of the messages sent by servers and clients
+//---------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+#include <grpc/compression.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace grpc_labview
+{
+    //---------------------------------------------------------------------
+    // Algorithm the messages of a call are compressed with. Messages smaller
+    // than minBytes are sent uncompressed, compressing them costs more time
+    // than it saves on the wire.
+    //---------------------------------------------------------------------
+    struct CompressionSettings
+    {
+        CompressionSettings();
+
+        // Algorithm numbers as LabVIEW passes them: 0 none, 1 deflate and 2 gzip.
+        // Returns false, and changes nothing, for an unknown algorithm.
+        bool Set(int32_t algorithm, int32_t minimumBytes);
+        bool IsEnabled() const;
+        bool Compresses(size_t messageSize) const;
+
+        grpc_compression_algorithm algorithm;
+        int32_t minBytes;
+    };
+}
@@ -201,6 +201,7 @@ namespace grpc_labview {
         for (auto& metadata : _registeredMessageMetadata)
         {
             UpdateMetadataClusterLayout(metadata.second);
+            metadata.second->CompileFieldParsers();
         }
     }
 }
@@ -3,6 +3,7 @@
 #include "message_metadata.h"
 #include "lv_interop.h"
 #include "well_known_messages.h"
+#include "lv_message_efficient.h"
 
 namespace grpc_labview
 {
@@ -42,6 +43,7 @@ namespace grpc_labview
     {
         _owner = nullptr;
         clusterOffset = 0;
+        slot = -1;
         this->isRepeated = isRepeated;
         this->protobufIndex = protobufIndex;
         type = valueType;
@@ -55,6 +57,7 @@ namespace grpc_labview
     {
         _owner = owner;
         clusterOffset = 0;
+        slot = -1;
         embeddedMessageName = GetLVString(lvElement->embeddedMessageName);
         isRepeated = lvElement->isRepeated;
         protobufIndex = lvElement->protobufIndex;
@@ -85,7 +88,9 @@ namespace grpc_labview
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    MessageMetadata::MessageMetadata(IMessageElementMetadataOwner* metadataOwner, LVMessageMetadata* lvMetadata)
+    MessageMetadata::MessageMetadata(IMessageElementMetadataOwner* metadataOwner, LVMessageMetadata* lvMetadata) :
+        _denseFieldParsers(false),
+        _fieldParsersCompiled(false)
     {
         auto name = GetLVString(lvMetadata->messageName);
         messageName = name;
@@ -104,7 +109,9 @@ namespace grpc_labview
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    MessageMetadata::MessageMetadata(IMessageElementMetadataOwner* metadataOwner, LVMessageMetadata2* lvMetadata)
+    MessageMetadata::MessageMetadata(IMessageElementMetadataOwner* metadataOwner, LVMessageMetadata2* lvMetadata) :
+        _denseFieldParsers(false),
+        _fieldParsersCompiled(false)
     {
         auto name = GetLVString(lvMetadata->messageName);
         messageName = name;
@@ -128,8 +135,107 @@ namespace grpc_labview
         for (int i = 0; i < elementCount; i++, lvElement++)
         {
             auto element = std::make_shared<MessageElementMetadata>(metadataOwner, lvElement, metadataVersion);
-            _elements.push_back(element);
-            _mappedElements.emplace(element->protobufIndex, element);
+            AddElement(element);
         }
     }
-}
\ No newline at end of file
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void MessageMetadata::AddElement(std::shared_ptr<MessageElementMetadata> element)
+    {
+        element->slot = (int)_elements.size();
+        _elements.push_back(element);
+        _mappedElements.emplace(element->protobufIndex, element);
+        auto position = std::upper_bound(_slotsByFieldNumber.begin(), _slotsByFieldNumber.end(), element->protobufIndex,
+            [this](int protobufIndex, int slot) { return protobufIndex < _elements[slot]->protobufIndex; });
+        _slotsByFieldNumber.insert(position, element->slot);
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    std::shared_ptr<MessageElementMetadata> MessageMetadata::FindOrAddElement(LVMessageMetadataType valueType, bool isRepeated, int protobufIndex)
+    {
+        auto it = _mappedElements.find(protobufIndex);
+        if (it != _mappedElements.end())
+        {
+            return it->second;
+        }
+        auto element = std::make_shared<MessageElementMetadata>(valueType, isRepeated, protobufIndex);
+        AddElement(element);
+        return element;
+    }
+
+    //---------------------------------------------------------------------
+    // Resolves the metadata of a nested message here, so that parsing one
+    // does not look it up by name.
+    //---------------------------------------------------------------------
+    FieldParser MessageMetadata::CompileFieldParser(const MessageElementMetadata& element)
+    {
+        FieldParser parser = { (google::protobuf::uint32)element.protobufIndex, &element, element.clusterOffset, {},
+            LVMessage::FieldParserFor(element), LVMessageEfficient::FieldParserFor(element) };
+        if (element.type == LVMessageMetadataType::MessageValue && element._owner != nullptr)
+        {
+            parser.nestedMetadata = element._owner->FindMetadata(element.embeddedMessageName);
+        }
+        return parser;
+    }
+
+    //---------------------------------------------------------------------
+    // A table indexed by field number costs one entry per number up to the
+    // largest, it is used unless the numbers are spread far apart.
+    //---------------------------------------------------------------------
+    void MessageMetadata::CompileFieldParsers()
+    {
+        if (FieldParsersCompiled())
+        {
+            return;
+        }
+
+        google::protobuf::uint32 maxIndex = 0;
+        size_t fieldCount = 0;
+        for (auto& element : _elements)
+        {
+            // Oneof selected index elements have no field number
+            if (element->protobufIndex > 0)
+            {
+                maxIndex = std::max(maxIndex, (google::protobuf::uint32)element->protobufIndex);
+                ++fieldCount;
+            }
+        }
+
+        _denseFieldParsers = maxIndex < 64 || maxIndex <= 4 * fieldCount;
+        _fieldParsers.clear();
+        if (_denseFieldParsers)
+        {
+            _fieldParsers.resize(maxIndex + 1, FieldParser{ 0, nullptr, 0, {}, nullptr, nullptr });
+        }
+        for (auto& element : _elements)
+        {
+            if (element->protobufIndex <= 0)
+            {
+                continue;
+            }
+            // The first element with a field number is the one parsed, as for _mappedElements
+            auto parser = CompileFieldParser(*element);
+            if (_denseFieldParsers)
+            {
+                if (_fieldParsers[parser.protobufIndex].field == nullptr)
+                {
+                    _fieldParsers[parser.protobufIndex] = parser;
+                }
+            }
+            else
+            {
+                _fieldParsers.push_back(parser);
+            }
+        }
+        if (!_denseFieldParsers)
+        {
+            auto byIndex = [](const FieldParser& a, const FieldParser& b) { return a.protobufIndex < b.protobufIndex; };
+            std::stable_sort(_fieldParsers.begin(), _fieldParsers.end(), byIndex);
+            auto sameIndex = [](const FieldParser& a, const FieldParser& b) { return a.protobufIndex == b.protobufIndex; };
+            _fieldParsers.erase(std::unique(_fieldParsers.begin(), _fieldParsers.end(), sameIndex), _fieldParsers.end());
+        }
+        _fieldParsersCompiled.store(true, std::memory_order_release);
+    }
+}
@@ -6,6 +6,8 @@
 //---------------------------------------------------------------------
 #include <string>
 #include <lv_interop.h>
+#include <algorithm>
+#include <atomic>
 #include <vector>
 #include <map>
 #include <unordered_map>
@@ -17,6 +19,9 @@ namespace grpc_labview
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     class IMessageElementMetadataOwner;
+    class LVMessage;
+    struct MessageMetadata;
+    struct FieldParser;
 
     //---------------------------------------------------------------------
     // Enum equivalent to this on the LabVIEW side: Message Element Type.ctl
@@ -83,6 +88,9 @@ namespace grpc_labview
         std::string embeddedMessageName;
         int protobufIndex;
         int clusterOffset;
+        // Position of the field in the elements of its message and in the
+        // value slots of an LVMessage of that message, -1 until it is added.
+        int slot;
         LVMessageMetadataType type;
         bool isRepeated;
         bool isInOneof;
@@ -98,6 +106,28 @@ namespace grpc_labview
     using LVMessageMetadataMap = std::unordered_map<google::protobuf::uint32, std::shared_ptr<MessageElementMetadata>>;
     using LVMessageMetadataList = std::vector<std::shared_ptr<MessageElementMetadata>>;
 
+    //---------------------------------------------------------------------
+    // Parses a field read from the wire into an LVMessage
+    //---------------------------------------------------------------------
+    using FieldParseFunction = const char* (*)(LVMessage& message, google::protobuf::uint32 tag, const FieldParser& parser, const char* ptr, google::protobuf::internal::ParseContext* ctx);
+
+    //---------------------------------------------------------------------
+    // What parsing a field needs, resolved once when the parsers of its
+    // message are compiled.
+    //---------------------------------------------------------------------
+    struct FieldParser
+    {
+        google::protobuf::uint32 protobufIndex;
+        const MessageElementMetadata* field;
+        int clusterOffset;
+        // The metadata of a nested message field. Weak since a message can
+        // nest itself, the metadata owner keeps it alive.
+        std::weak_ptr<MessageMetadata> nestedMetadata;
+        // For an LVMessage and for an LVMessageEfficient, which parses into a cluster.
+        FieldParseFunction parse;
+        FieldParseFunction parseIntoCluster;
+    };
+
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     struct LVMessageMetadata
@@ -129,13 +159,30 @@ namespace grpc_labview
     struct MessageMetadata
     {
     public:
-        MessageMetadata() : clusterSize(0) {}
+        MessageMetadata() : clusterSize(0), _denseFieldParsers(false), _fieldParsersCompiled(false) {}
         MessageMetadata(IMessageElementMetadataOwner* metadataOwner, LVMessageMetadata* lvMetadata);
         MessageMetadata(IMessageElementMetadataOwner* metadataOwner, LVMessageMetadata2* lvMetadata);
 
     private:
         void InitializeElements(IMessageElementMetadataOwner* metadataOwner, LVMessageElementMetadata* lvElement, int elementCount, int metadataVersion);
 
+    public:
+        void AddElement(std::shared_ptr<MessageElementMetadata> element);
+        // Used by messages built field by field, such as the Any builder.
+        std::shared_ptr<MessageElementMetadata> FindOrAddElement(LVMessageMetadataType valueType, bool isRepeated, int protobufIndex);
+        // Compiles the table of the parsers of the fields once the elements are
+        // complete. Messages built field by field are never compiled.
+        void CompileFieldParsers();
+        // The parser of one field, also used for the fields of messages that are not compiled.
+        static FieldParser CompileFieldParser(const MessageElementMetadata& element);
+        bool FieldParsersCompiled() const { return _fieldParsersCompiled.load(std::memory_order_acquire); }
+        // Returns the parser of a field number, null if the message has no such field.
+        // Fields usually arrive in order, so the parser found for the previous field is
+        // tried with the one after it before searching a sparse table.
+        const FieldParser* FindFieldParser(google::protobuf::uint32 protobufIndex, const FieldParser* previous = nullptr) const;
+        // The slots of the elements in ascending field number, the order fields are serialized in.
+        const std::vector<int>& SlotsByFieldNumber() const { return _slotsByFieldNumber; }
+
     public:
         std::string messageName;
         std::string typeUrl;
@@ -143,5 +190,41 @@ namespace grpc_labview
         int alignmentRequirement;
         LVMessageMetadataList _elements;
         LVMessageMetadataMap _mappedElements;
+
+    private:
+        // Indexed by field number when the numbers are dense, sorted by field number otherwise.
+        std::vector<FieldParser> _fieldParsers;
+        bool _denseFieldParsers;
+        std::atomic<bool> _fieldParsersCompiled;
+        // Kept in order as elements are added, elements with the same number in the order they were added.
+        std::vector<int> _slotsByFieldNumber;
     };
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    inline const FieldParser* MessageMetadata::FindFieldParser(google::protobuf::uint32 protobufIndex, const FieldParser* previous) const
+    {
+        if (_denseFieldParsers)
+        {
+            if (protobufIndex < _fieldParsers.size() && _fieldParsers[protobufIndex].field != nullptr)
+            {
+                return &_fieldParsers[protobufIndex];
+            }
+            return nullptr;
+        }
+        if (previous != nullptr)
+        {
+            if (previous->protobufIndex == protobufIndex)
+            {
+                return previous;
+            }
+            if (previous + 1 != _fieldParsers.data() + _fieldParsers.size() && previous[1].protobufIndex == protobufIndex)
+            {
+                return previous + 1;
+            }
+        }
+        auto it = std::lower_bound(_fieldParsers.begin(), _fieldParsers.end(), protobufIndex,
+            [](const FieldParser& parser, google::protobuf::uint32 index) { return parser.protobufIndex < index; });
+        return (it != _fieldParsers.end() && it->protobufIndex == protobufIndex) ? &*it : nullptr;
+    }
 }
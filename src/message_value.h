@@ -5,6 +5,11 @@
 //---------------------------------------------------------------------
 //---------------------------------------------------------------------
 #include <grpc_server.h>
+#include <message_metadata.h>
+#include <arena_allocator.h>
+#include <cstring>
+#include <memory>
+#include <vector>
 
 namespace grpc_labview
 {
@@ -56,8 +61,9 @@ namespace grpc_labview
     class LVRepeatedMessageValue : public LVMessageValue
     {
     public:
-        LVRepeatedMessageValue(int protobufId) :
-            LVMessageValue(protobufId)
+        LVRepeatedMessageValue(int protobufId, google::protobuf::Arena* arena = nullptr) :
+            LVMessageValue(protobufId),
+            _value(arena)
         {
         }
 
@@ -71,24 +77,6 @@ namespace grpc_labview
         int _cachedSize;
     };
 
-    template <typename T>
-    class LVVariableMessageValue : public LVMessageValue
-    {
-    public:
-        LVVariableMessageValue(int protobufId, T value) :
-            LVMessageValue(protobufId),
-            _value(value)
-        {
-        }
-
-    public:
-        T _value;
-
-        void* RawValue() override { return &_value; };
-        size_t ByteSizeLong() override;
-        google::protobuf::uint8* Serialize(google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream) const override;
-    };
-
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     class LVNestedMessageMessageValue : public LVMessageValue
@@ -110,10 +98,10 @@ namespace grpc_labview
     class LVRepeatedNestedMessageMessageValue : public LVMessageValue, public gRPCid
     {
     public:
-        LVRepeatedNestedMessageMessageValue(int protobufId);
+        LVRepeatedNestedMessageMessageValue(int protobufId, google::protobuf::Arena* arena = nullptr);
 
     public:
-        std::vector<std::shared_ptr<LVMessage>> _value;
+        std::vector<std::shared_ptr<LVMessage>, ArenaAllocator<std::shared_ptr<LVMessage>>> _value;
 
     public:
         void* RawValue() override { return &_value; };
@@ -138,28 +126,12 @@ namespace grpc_labview
     };
 
 
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    class LVEnumMessageValue : public LVMessageValue
-    {
-    public:
-        LVEnumMessageValue(int protobufId, int _value);
-
-    public:
-        int _value;
-
-        void* RawValue() override { return &_value; };
-        size_t ByteSizeLong() override;
-        google::protobuf::uint8* Serialize(google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream) const override;
-    };
-
-
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     class LVRepeatedEnumMessageValue : public LVRepeatedMessageValue<int>
     {
         public:
-            LVRepeatedEnumMessageValue(int protobufId);
+            LVRepeatedEnumMessageValue(int protobufId, google::protobuf::Arena* arena = nullptr);
 
             google::protobuf::RepeatedField<int> _value;
 
@@ -168,29 +140,12 @@ namespace grpc_labview
             google::protobuf::uint8* Serialize(google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream) const override;
     };
 
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    class LVSInt32MessageValue : public LVMessageValue
-    {
-    public:
-        LVSInt32MessageValue(int protobufId, int32_t value);
-
-    public:
-        int32_t _value;
-
-    public:
-        void* RawValue() override { return &_value; };
-        size_t ByteSizeLong() override;
-        google::protobuf::uint8* Serialize(google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream) const override;
-    };
-
-
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     class LVRepeatedSInt32MessageValue : public LVMessageValue
     {
     public:
-        LVRepeatedSInt32MessageValue(int protobufId);
+        LVRepeatedSInt32MessageValue(int protobufId, google::protobuf::Arena* arena = nullptr);
 
     public:
         google::protobuf::RepeatedField<int32_t> _value;
@@ -205,28 +160,12 @@ namespace grpc_labview
     };
 
 
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    class LVSInt64MessageValue : public LVMessageValue
-    {
-    public:
-        LVSInt64MessageValue(int protobufId, int64_t value);
-
-    public:
-        int64_t _value;
-
-    public:
-        void* RawValue() override { return &_value; };
-        size_t ByteSizeLong() override;
-        google::protobuf::uint8* Serialize(google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream) const override;
-    };
-
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     class LVRepeatedSInt64MessageValue : public LVMessageValue
     {
     public:
-        LVRepeatedSInt64MessageValue(int protobufId);
+        LVRepeatedSInt64MessageValue(int protobufId, google::protobuf::Arena* arena = nullptr);
 
     public:
         google::protobuf::RepeatedField<int64_t> _value;
@@ -240,28 +179,12 @@ namespace grpc_labview
         int _cachedSize;
     };
 
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    class LVFixed32MessageValue : public LVMessageValue
-    {
-    public:
-        LVFixed32MessageValue(int protobufId, uint32_t value);
-
-    public:
-        uint32_t _value;
-
-    public:
-        void* RawValue() override { return &_value; };
-        size_t ByteSizeLong() override;
-        google::protobuf::uint8* Serialize(google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream) const override;
-    };
-
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     class LVRepeatedFixed32MessageValue : public LVMessageValue
     {
     public:
-        LVRepeatedFixed32MessageValue(int protobufId);
+        LVRepeatedFixed32MessageValue(int protobufId, google::protobuf::Arena* arena = nullptr);
 
     public:
         google::protobuf::RepeatedField<uint32_t> _value;
@@ -272,28 +195,12 @@ namespace grpc_labview
         google::protobuf::uint8* Serialize(google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream) const override;
     };
 
-    //---------------------------------------------------------------------
-    //---------------------------------------------------------------------
-    class LVFixed64MessageValue : public LVMessageValue
-    {
-    public:
-        LVFixed64MessageValue(int protobufId, uint64_t value);
-
-    public:
-        uint64_t _value;
-
-    public:
-        void* RawValue() override { return &_value; };
-        size_t ByteSizeLong() override;
-        google::protobuf::uint8* Serialize(google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream) const override;
-    };
-
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     class LVRepeatedFixed64MessageValue : public LVMessageValue
     {
     public:
-        LVRepeatedFixed64MessageValue(int protobufId);
+        LVRepeatedFixed64MessageValue(int protobufId, google::protobuf::Arena* arena = nullptr);
 
     public:
         google::protobuf::RepeatedField<uint64_t> _value;
@@ -306,13 +213,13 @@ namespace grpc_labview
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    class LVSFixed32MessageValue : public LVMessageValue
+    class LVRepeatedSFixed32MessageValue : public LVMessageValue
     {
     public:
-        LVSFixed32MessageValue(int protobufId, int32_t value);
+        LVRepeatedSFixed32MessageValue(int protobufId, google::protobuf::Arena* arena = nullptr);
 
     public:
-        int32_t _value;
+        google::protobuf::RepeatedField<int32_t> _value;
 
     public:
         void* RawValue() override { return &_value; };
@@ -322,13 +229,13 @@ namespace grpc_labview
 
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
-    class LVRepeatedSFixed32MessageValue : public LVMessageValue
+    class LVRepeatedSFixed64MessageValue : public LVMessageValue
     {
     public:
-        LVRepeatedSFixed32MessageValue(int protobufId);
+        LVRepeatedSFixed64MessageValue(int protobufId, google::protobuf::Arena* arena = nullptr);
 
     public:
-        google::protobuf::RepeatedField<int32_t> _value;
+        google::protobuf::RepeatedField<int64_t> _value;
 
     public:
         void* RawValue() override { return &_value; };
@@ -337,34 +244,91 @@ namespace grpc_labview
     };
 
     //---------------------------------------------------------------------
+    // Value of one field of an LVMessage. Scalars are stored in the slot,
+    // strings, repeated fields and nested messages in an LVMessageValue.
     //---------------------------------------------------------------------
-    class LVSFixed64MessageValue : public LVMessageValue
+    struct LVValueSlot
     {
-    public:
-        LVSFixed64MessageValue(int protobufId, int64_t value);
+        LVValueSlot() : isSet(false), scalar(0) {}
 
-    public:
-        int64_t _value;
+        template <typename T>
+        T Scalar() const
+        {
+            T value;
+            memcpy(&value, &scalar, sizeof(T));
+            return value;
+        }
 
-    public:
-        void* RawValue() override { return &_value; };
-        size_t ByteSizeLong() override;
-        google::protobuf::uint8* Serialize(google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream) const override;
+        template <typename T>
+        void SetScalar(T value)
+        {
+            memcpy(&scalar, &value, sizeof(T));
+            isSet = true;
+        }
+
+        bool isSet;
+        uint64_t scalar;
+        std::shared_ptr<LVMessageValue> value;
     };
 
     //---------------------------------------------------------------------
+    // Field values of an LVMessage, one slot per element of its metadata
+    // indexed by MessageElementMetadata::slot. Clear keeps the slots so a
+    // reused message sets its scalars without allocating.
+    //
+    // Values and nested messages are allocated on the arena the values are
+    // given, or on one of their own with UseOwnArena, which Clear releases
+    // in bulk.
     //---------------------------------------------------------------------
-    class LVRepeatedSFixed64MessageValue : public LVMessageValue
+    class LVMessageValues
     {
     public:
-        LVRepeatedSFixed64MessageValue(int protobufId);
+        LVMessageValues(size_t slotCount, google::protobuf::Arena* arena) :
+            _arena(arena),
+            _useOwnArena(false),
+            _slots(slotCount, LVValueSlot(), ArenaAllocator<LVValueSlot>(arena))
+        {
+        }
 
-    public:
-        google::protobuf::RepeatedField<int64_t> _value;
+        // Values added from now on are allocated on an arena created on first use.
+        void UseOwnArena();
+        // The arena to allocate values and nested messages on, null for the heap.
+        google::protobuf::Arena* GetArena();
+
+        void Clear();
+        const LVValueSlot* Find(const MessageElementMetadata& field) const;
+        template <typename T>
+        void SetScalar(const MessageElementMetadata& field, T value) { SlotFor(field).SetScalar(value); }
+        void Set(const MessageElementMetadata& field, std::shared_ptr<LVMessageValue> value);
+        // Returns the value of a repeated field, adding it if the field is not set.
+        template <typename TValue>
+        TValue* Repeated(const MessageElementMetadata& field)
+        {
+            auto& slot = SlotFor(field);
+            if (!slot.isSet)
+            {
+                auto arena = GetArena();
+                slot.value = ArenaMakeShared<TValue>(arena, field.protobufIndex, arena);
+                slot.isSet = true;
+            }
+            return static_cast<TValue*>(slot.value.get());
+        }
 
-    public:
-        void* RawValue() override { return &_value; };
-        size_t ByteSizeLong() override;
-        google::protobuf::uint8* Serialize(google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream) const override;
+        size_t size() const { return _slots.size(); }
+        const LVValueSlot& operator[](size_t slot) const { return _slots[slot]; }
+
+        size_t ByteSizeLong(const MessageMetadata& metadata) const;
+        google::protobuf::uint8* Serialize(const MessageMetadata& metadata, google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream) const;
+
+    private:
+        LVValueSlot& SlotFor(const MessageElementMetadata& field);
+        static size_t ScalarByteSize(const MessageElementMetadata& field, const LVValueSlot& slot);
+        static google::protobuf::uint8* SerializeScalar(const MessageElementMetadata& field, const LVValueSlot& slot, google::protobuf::uint8* target, google::protobuf::io::EpsCopyOutputStream* stream);
+
+        // Declared before the slots so the values are destroyed before their arena.
+        std::unique_ptr<google::protobuf::Arena> _ownArena;
+        google::protobuf::Arena* _arena;
+        bool _useOwnArena;
+        std::vector<LVValueSlot, ArenaAllocator<LVValueSlot>> _slots;
     };
 }
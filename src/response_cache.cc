@@ -0,0 +1,130 @@
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+#include <response_cache.h>
+#include <functional>
+#include <iterator>
+
+namespace grpc_labview
+{
+    //---------------------------------------------------------------------
+    // Approximate cost of an entry besides the request and response bytes.
+    //---------------------------------------------------------------------
+    static const size_t kEntryOverhead = 128;
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    ResponseCache::ResponseCache(size_t maxBytes, int32_t timeToLiveMs) :
+        _maxBytes(maxBytes),
+        _timeToLive(timeToLiveMs > 0 ? std::chrono::steady_clock::duration(std::chrono::milliseconds(timeToLiveMs)) : std::chrono::steady_clock::duration::max()),
+        _bytes(0),
+        _hits(0),
+        _misses(0)
+    {
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    bool ResponseCache::Find(const std::string& request, grpc::ByteBuffer* response)
+    {
+        auto hash = std::hash<std::string>()(request);
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto entry = FindEntry(hash, request);
+        if (entry != _entries.end() && entry->expires <= now)
+        {
+            Remove(entry);
+            entry = _entries.end();
+        }
+        if (entry == _entries.end())
+        {
+            ++_misses;
+            return false;
+        }
+        ++_hits;
+        _entries.splice(_entries.begin(), _entries, entry);
+        *response = entry->response;
+        return true;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void ResponseCache::Insert(const std::string& request, const grpc::ByteBuffer& response)
+    {
+        auto bytes = request.size() + response.Length() + kEntryOverhead;
+        if (bytes > _maxBytes)
+        {
+            return;
+        }
+        auto hash = std::hash<std::string>()(request);
+        auto now = std::chrono::steady_clock::now();
+        auto expires = _timeToLive == std::chrono::steady_clock::duration::max() ? std::chrono::steady_clock::time_point::max() : now + _timeToLive;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto existing = FindEntry(hash, request);
+        if (existing != _entries.end())
+        {
+            // Another call with the same request finished first.
+            Remove(existing);
+        }
+        while (_bytes + bytes > _maxBytes)
+        {
+            Remove(std::prev(_entries.end()));
+        }
+        _entries.push_front({ hash, request, response, bytes, expires });
+        _index.emplace(hash, _entries.begin());
+        _bytes += bytes;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void ResponseCache::Clear()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _index.clear();
+        _entries.clear();
+        _bytes = 0;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void ResponseCache::GetStats(uint64_t* hits, uint64_t* misses, int32_t* entries, uint64_t* bytes)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        *hits = _hits;
+        *misses = _misses;
+        *entries = (int32_t)_index.size();
+        *bytes = _bytes;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    ResponseCache::EntryList::iterator ResponseCache::FindEntry(size_t hash, const std::string& request)
+    {
+        auto range = _index.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (it->second->request == request)
+            {
+                return it->second;
+            }
+        }
+        return _entries.end();
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void ResponseCache::Remove(EntryList::iterator entry)
+    {
+        auto range = _index.equal_range(entry->hash);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (it->second == entry)
+            {
+                _index.erase(it);
+                break;
+            }
+        }
+        _bytes -= entry->bytes;
+        _entries.erase(entry);
+    }
+}
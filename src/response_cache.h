@@ -0,0 +1,65 @@
+//---------------------------------------------------------------------
+// Cache of serialized responses for methods whose response only depends
+// on their request
+//---------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+#include <grpcpp/support/byte_buffer.h>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace grpc_labview
+{
+    //---------------------------------------------------------------------
+    // Responses of a unary method keyed by a hash of the serialized request.
+    // The request bytes are kept with the response and compared on every
+    // lookup, so two requests with the same hash never share a response.
+    //
+    // Entries expire timeToLiveMs after they were added, a time to live of
+    // zero or less keeps them until they are evicted. When the requests and
+    // responses held exceed maxBytes the least recently used entries are
+    // evicted.
+    //---------------------------------------------------------------------
+    class ResponseCache
+    {
+    public:
+        ResponseCache(size_t maxBytes, int32_t timeToLiveMs);
+
+        // Copies the response cached for the request into response, the
+        // buffer shares the cached slices so nothing is copied.
+        bool Find(const std::string& request, grpc::ByteBuffer* response);
+        void Insert(const std::string& request, const grpc::ByteBuffer& response);
+        void Clear();
+        void GetStats(uint64_t* hits, uint64_t* misses, int32_t* entries, uint64_t* bytes);
+
+    private:
+        struct Entry
+        {
+            size_t hash;
+            std::string request;
+            grpc::ByteBuffer response;
+            size_t bytes;
+            std::chrono::steady_clock::time_point expires;
+        };
+        using EntryList = std::list<Entry>;
+
+        EntryList::iterator FindEntry(size_t hash, const std::string& request);
+        void Remove(EntryList::iterator entry);
+
+        std::mutex _mutex;
+        size_t _maxBytes;
+        std::chrono::steady_clock::duration _timeToLive;
+        // Most recently used first
+        EntryList _entries;
+        std::unordered_multimap<size_t, EntryList::iterator> _index;
+        size_t _bytes;
+        uint64_t _hits;
+        uint64_t _misses;
+    };
+}
@@ -0,0 +1,125 @@
+//---------------------------------------------------------------------
+// Prints the runtime statistics of a LabVIEW gRPC server that serves the
+// stats service (LVSetServerStatsServiceEnabled).
+//
+// Usage: server_stats_client [--target=address] [--interval=seconds]
+//
+// With an interval the statistics are printed again every interval seconds
+// until the client is stopped.
+//---------------------------------------------------------------------
+#include <grpcpp/grpcpp.h>
+#include <server_stats.grpc.pb.h>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+using grpc::ClientContext;
+using grpc::Status;
+using namespace grpc_labview::stats;
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void PrintDistribution(const std::string& name, const Distribution& distribution, const char* unit)
+{
+    std::cout << "    " << std::left << std::setw(18) << name
+        << std::right << std::setw(10) << distribution.count()
+        << std::fixed << std::setprecision(1)
+        << std::setw(12) << distribution.mean()
+        << std::setw(12) << distribution.p50()
+        << std::setw(12) << distribution.p90()
+        << std::setw(12) << distribution.p99()
+        << std::setw(12) << distribution.p999()
+        << std::setw(12) << distribution.max()
+        << "  " << unit << std::endl;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void PrintStats(const GetServerStatsResponse& stats)
+{
+    std::cout << "calls in flight: " << stats.in_flight()
+        << ", rejected: " << stats.rejected()
+        << ", accepted: " << stats.accepted_calls() << std::endl;
+    std::cout << "pending calls: " << stats.pending_calls()
+        << ", pending calls exhausted: " << stats.pending_calls_exhausted() << std::endl;
+    std::cout << "queued dispatches: " << stats.queued_dispatches()
+        << ", expired before posting: " << stats.expired_calls() << std::endl;
+    std::cout << "call pool heap allocations: " << stats.heap_allocations()
+        << ", reused: " << stats.reused_allocations() << std::endl;
+
+    for (auto& method : stats.methods())
+    {
+        std::cout << std::endl << method.name()
+            << "  in flight: " << method.in_flight()
+            << ", rejected: " << method.rejected();
+        if (method.adaptive_limit() != 0)
+        {
+            std::cout << ", adaptive limit: " << method.adaptive_limit();
+        }
+        std::cout << ", bytes in: " << (uint64_t)method.request_bytes().sum()
+            << ", bytes out: " << (uint64_t)method.response_bytes().sum() << std::endl;
+        std::cout << "    " << std::left << std::setw(18) << ""
+            << std::right << std::setw(10) << "count" << std::setw(12) << "mean" << std::setw(12) << "p50"
+            << std::setw(12) << "p90" << std::setw(12) << "p99" << std::setw(12) << "p99.9" << std::setw(12) << "max" << std::endl;
+        PrintDistribution("accept to parse", method.accept_to_parse(), "us");
+        PrintDistribution("parse", method.parse(), "us");
+        PrintDistribution("post to pickup", method.post_to_pickup(), "us");
+        PrintDistribution("handling", method.handling(), "us");
+        PrintDistribution("serialize", method.serialize(), "us");
+        PrintDistribution("write complete", method.write_complete(), "us");
+        PrintDistribution("request size", method.request_bytes(), "bytes");
+        PrintDistribution("response size", method.response_bytes(), "bytes");
+    }
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    std::string target = "localhost:50051";
+    int intervalSeconds = 0;
+    for (int x = 1; x < argc; ++x)
+    {
+        std::string arg = argv[x];
+        if (arg.find("--target=") == 0)
+        {
+            target = arg.substr(9);
+        }
+        else if (arg.find("--interval=") == 0)
+        {
+            intervalSeconds = atoi(arg.substr(11).c_str());
+        }
+        else
+        {
+            std::cout << "Usage: server_stats_client [--target=address] [--interval=seconds]" << std::endl;
+            return 1;
+        }
+    }
+
+    auto stub = ServerStats::NewStub(grpc::CreateChannel(target, grpc::InsecureChannelCredentials()));
+    while (true)
+    {
+        GetServerStatsRequest request;
+        GetServerStatsResponse response;
+        ClientContext context;
+        context.set_deadline(std::chrono::system_clock::now() + std::chrono::seconds(5));
+        Status status = stub->GetServerStats(&context, request, &response);
+        if (!status.ok())
+        {
+            std::cout << status.error_code() << ": " << status.error_message() << std::endl;
+            return 1;
+        }
+        PrintStats(response);
+        if (intervalSeconds <= 0)
+        {
+            return 0;
+        }
+        std::this_thread::sleep_for(std::chrono::seconds(intervalSeconds));
+        std::cout << std::endl;
+    }
+}
@@ -0,0 +1,92 @@
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+#include <server_stats_service.h>
+#include <grpc_server.h>
+
+namespace grpc_labview
+{
+    //---------------------------------------------------------------------
+    // Latencies are recorded in nanoseconds and reported in microseconds.
+    //---------------------------------------------------------------------
+    static void FillDistribution(MethodStats& methodStats, CallMetric metric, stats::Distribution* distribution)
+    {
+        auto scale = metric < CallMetric::RequestBytes ? 1000.0 : 1.0;
+        auto snapshot = methodStats.Snapshot(metric);
+        distribution->set_count(snapshot.count);
+        distribution->set_sum(snapshot.sum / scale);
+        distribution->set_mean(snapshot.Mean() / scale);
+        distribution->set_p50(snapshot.ValueAtQuantile(0.5) / scale);
+        distribution->set_p90(snapshot.ValueAtQuantile(0.9) / scale);
+        distribution->set_p99(snapshot.ValueAtQuantile(0.99) / scale);
+        distribution->set_p999(snapshot.ValueAtQuantile(0.999) / scale);
+        distribution->set_max(snapshot.ValueAtQuantile(1) / scale);
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    ServerStatsService::ServerStatsService(LabVIEWgRPCServer* server) :
+        _server(server)
+    {
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    grpc::Status ServerStatsService::GetServerStats(grpc::ServerContext* context, const stats::GetServerStatsRequest* request, stats::GetServerStatsResponse* response)
+    {
+        int32_t inFlight;
+        uint64_t rejected;
+        _server->GetConcurrencyStats(&inFlight, &rejected);
+        response->set_in_flight(inFlight);
+        response->set_rejected(rejected);
+
+        int32_t pendingCalls;
+        uint64_t acceptedCalls;
+        uint64_t pendingCallsExhausted;
+        _server->GetPendingCallStats(&pendingCalls, &acceptedCalls, &pendingCallsExhausted);
+        response->set_pending_calls(pendingCalls);
+        response->set_accepted_calls(acceptedCalls);
+        response->set_pending_calls_exhausted(pendingCallsExhausted);
+
+        int32_t queuedCalls;
+        uint64_t expiredCalls;
+        _server->GetDispatchStats(&queuedCalls, &expiredCalls);
+        response->set_queued_dispatches(queuedCalls);
+        response->set_expired_calls(expiredCalls);
+
+        uint64_t heapAllocations;
+        uint64_t reusedAllocations;
+        _server->GetCallPoolStats(&heapAllocations, &reusedAllocations);
+        response->set_heap_allocations(heapAllocations);
+        response->set_reused_allocations(reusedAllocations);
+
+        for (auto& name : _server->ServerMethodNames())
+        {
+            auto method = response->add_methods();
+            method->set_name(name);
+            _server->GetMethodConcurrencyStats(name, &inFlight, &rejected);
+            method->set_in_flight(inFlight);
+            method->set_rejected(rejected);
+
+            int32_t limit;
+            double minLatencyUs;
+            double smoothedLatencyUs;
+            uint64_t samples;
+            uint64_t decreases;
+            if (_server->GetMethodAdaptiveConcurrencyStats(name, &limit, &minLatencyUs, &smoothedLatencyUs, &samples, &decreases))
+            {
+                method->set_adaptive_limit(limit);
+            }
+
+            auto methodStats = _server->GetMethodStats(name);
+            FillDistribution(*methodStats, CallMetric::AcceptToParse, method->mutable_accept_to_parse());
+            FillDistribution(*methodStats, CallMetric::Parse, method->mutable_parse());
+            FillDistribution(*methodStats, CallMetric::PostToPickup, method->mutable_post_to_pickup());
+            FillDistribution(*methodStats, CallMetric::Handling, method->mutable_handling());
+            FillDistribution(*methodStats, CallMetric::Serialize, method->mutable_serialize());
+            FillDistribution(*methodStats, CallMetric::WriteComplete, method->mutable_write_complete());
+            FillDistribution(*methodStats, CallMetric::RequestBytes, method->mutable_request_bytes());
+            FillDistribution(*methodStats, CallMetric::ResponseBytes, method->mutable_response_bytes());
+        }
+        return grpc::Status::OK;
+    }
+}
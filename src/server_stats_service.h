@@ -0,0 +1,29 @@
+//---------------------------------------------------------------------
+// gRPC service that reports the runtime statistics of the server
+//---------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+#include <server_stats.grpc.pb.h>
+
+namespace grpc_labview
+{
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    class LabVIEWgRPCServer;
+
+    //---------------------------------------------------------------------
+    // Served by gRPC's own threads next to the LabVIEW methods, so the stats
+    // can be read while every LabVIEW handler is busy.
+    //---------------------------------------------------------------------
+    class ServerStatsService final : public stats::ServerStats::Service
+    {
+    public:
+        ServerStatsService(LabVIEWgRPCServer* server);
+        grpc::Status GetServerStats(grpc::ServerContext* context, const stats::GetServerStatsRequest* request, stats::GetServerStatsResponse* response) override;
+
+    private:
+        LabVIEWgRPCServer* _server;
+    };
+}
@@ -0,0 +1,55 @@
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+#include <single_flight.h>
+
+namespace grpc_labview
+{
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    SingleFlight::SingleFlight() :
+        _handled(0),
+        _coalesced(0)
+    {
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    bool SingleFlight::Join(const std::string& request, CallData* call)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto inProgress = _waiting.find(request);
+        if (inProgress == _waiting.end())
+        {
+            _waiting.emplace(request, std::vector<CallData*>());
+            ++_handled;
+            return false;
+        }
+        inProgress->second.push_back(call);
+        ++_coalesced;
+        return true;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    std::vector<CallData*> SingleFlight::Leave(const std::string& request)
+    {
+        std::vector<CallData*> waiting;
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto inProgress = _waiting.find(request);
+        if (inProgress != _waiting.end())
+        {
+            waiting.swap(inProgress->second);
+            _waiting.erase(inProgress);
+        }
+        return waiting;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void SingleFlight::GetStats(uint64_t* handled, uint64_t* coalesced)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        *handled = _handled;
+        *coalesced = _coalesced;
+    }
+}
@@ -0,0 +1,42 @@
+//---------------------------------------------------------------------
+// Coalescing of identical calls of a method that are in progress at the
+// same time
+//---------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace grpc_labview
+{
+    class CallData;
+
+    //---------------------------------------------------------------------
+    // Calls of one method with byte identical requests. The first call is
+    // posted to LabVIEW, the calls with the same request that arrive before
+    // it finishes wait for it and are answered with its response.
+    //---------------------------------------------------------------------
+    class SingleFlight
+    {
+    public:
+        SingleFlight();
+
+        // Returns true if call waits for a call already in progress, false if
+        // it is the call to post.
+        bool Join(const std::string& request, CallData* call);
+        // Ends the call in progress for the request and returns the calls that waited for it.
+        std::vector<CallData*> Leave(const std::string& request);
+        void GetStats(uint64_t* handled, uint64_t* coalesced);
+
+    private:
+        std::mutex _mutex;
+        std::unordered_map<std::string, std::vector<CallData*>> _waiting;
+        uint64_t _handled;
+        uint64_t _coalesced;
+    };
+}
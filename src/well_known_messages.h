@@ -48,7 +48,7 @@ namespace grpc_labview
             virtual std::shared_ptr<MessageMetadata> GetMetadata(IMessageElementMetadataOwner* metadataOwner) = 0;
             virtual ~I2DArray() = default;
 
-        protected:
+        public:
             static const int _rowsIndex = 1;
             static const int _columnsIndex = 2;
             static const int _dataIndex = 3;
@@ -71,24 +71,24 @@ namespace grpc_labview
                 auto& my2DArrayMessage = ((LVNestedMessageMessageValue*)value.get())->_value;
 
                 int rows = 0;
-                auto it = my2DArrayMessage->_values.find(_rowsIndex);
-                if (it != my2DArrayMessage->_values.end())
+                auto slot = my2DArrayMessage->FindValue(_rowsIndex);
+                if (slot != nullptr)
                 {
-                    rows = std::static_pointer_cast<LVVariableMessageValue<int>>(it->second)->_value;
+                    rows = slot->Scalar<int32_t>();
                 }
 
                 int columns = 0;
-                it = my2DArrayMessage->_values.find(_columnsIndex);
-                if (it != my2DArrayMessage->_values.end())
+                slot = my2DArrayMessage->FindValue(_columnsIndex);
+                if (slot != nullptr)
                 {
-                    columns = std::static_pointer_cast<LVVariableMessageValue<int>>(it->second)->_value;
+                    columns = slot->Scalar<int32_t>();
                 }
 
                 std::shared_ptr<LVRepeatedMessageValue<TRepeatedType>> dataValue = nullptr;
-                it = my2DArrayMessage->_values.find(_dataIndex);
-                if (it != my2DArrayMessage->_values.end())
+                slot = my2DArrayMessage->FindValue(_dataIndex);
+                if (slot != nullptr)
                 {
-                    dataValue = std::static_pointer_cast<LVRepeatedMessageValue<TRepeatedType>>(it->second);
+                    dataValue = std::static_pointer_cast<LVRepeatedMessageValue<TRepeatedType>>(slot->value);
                 }
 
                 auto elementCount = rows * columns;
@@ -119,20 +119,20 @@ namespace grpc_labview
 
                 // Convert from native 2D array in LV to equivalent of protobuf message on the wire
                 auto arrayMetadata = metadata->_owner->FindMetadata(metadata->embeddedMessageName);
-                auto arrayMessage = std::make_shared<LVMessage>(arrayMetadata);
+                auto arena = message._values.GetArena();
+                auto arrayMessage = ArenaMakeShared<LVMessage>(arena, arrayMetadata, arena);
 
                 // Add field values to message
-                auto rowsValue = std::make_shared<LVVariableMessageValue<int>>(_rowsIndex, rows);
-                arrayMessage->_values.emplace(_rowsIndex, rowsValue);
-                auto columnsValue = std::make_shared<LVVariableMessageValue<int>>(_columnsIndex, columns);
-                arrayMessage->_values.emplace(_columnsIndex, columnsValue);
-                auto dataValue = std::make_shared<LVRepeatedMessageValue<TRepeatedType>>(_dataIndex);
-                arrayMessage->_values.emplace(_dataIndex, dataValue);
+                auto& elements = arrayMetadata->_mappedElements;
+                arrayMessage->_values.SetScalar(*elements.at(_rowsIndex), (int32_t)rows);
+                arrayMessage->_values.SetScalar(*elements.at(_columnsIndex), (int32_t)columns);
+                auto dataValue = ArenaMakeShared<LVRepeatedMessageValue<TRepeatedType>>(arena, _dataIndex, arena);
+                arrayMessage->_values.Set(*elements.at(_dataIndex), dataValue);
 
                 CopyArrayFromClusterToMessage(rows * columns, array, dataValue);
 
-                auto messageValue = std::make_shared<LVNestedMessageMessageValue>(metadata->protobufIndex, arrayMessage);
-                message._values.emplace(metadata->protobufIndex, messageValue);
+                auto messageValue = ArenaMakeShared<LVNestedMessageMessageValue>(arena, metadata->protobufIndex, arrayMessage);
+                message._values.Set(*metadata, messageValue);
             }
 
             virtual std::shared_ptr<MessageMetadata> GetMetadata(IMessageElementMetadataOwner* metadataOwner)
@@ -151,12 +151,9 @@ namespace grpc_labview
                 dataMetadata->fieldName = "data";
                 dataMetadata->_owner = metadataOwner;
 
-                messageMetadata->_elements.push_back(rowsMetadata);
-                messageMetadata->_elements.push_back(columnsMetadata);
-                messageMetadata->_elements.push_back(dataMetadata);
-                messageMetadata->_mappedElements.emplace(rowsMetadata->protobufIndex, rowsMetadata);
-                messageMetadata->_mappedElements.emplace(columnsMetadata->protobufIndex, columnsMetadata);
-                messageMetadata->_mappedElements.emplace(dataMetadata->protobufIndex, dataMetadata);
+                messageMetadata->AddElement(rowsMetadata);
+                messageMetadata->AddElement(columnsMetadata);
+                messageMetadata->AddElement(dataMetadata);
 
                 return messageMetadata;
             }
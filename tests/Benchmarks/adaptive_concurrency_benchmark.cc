@@ -0,0 +1,201 @@
+//---------------------------------------------------------------------
+// Simulation of the adaptive concurrency limiter against synthetic
+// LabVIEW handlers.
+//
+// Calls arrive at a fixed mean rate and are handled by a fixed number of
+// handlers, standing in for the LabVIEW event loops, in arrival order.
+// The cost of a call changes between phases: normal load, a phase in
+// which handlers are twice as slow and the server is overloaded, and
+// normal load again. Each phase is run without a limit, with a fixed
+// limit and with the AdaptiveLimiter, in simulated time.
+//
+// Usage: adaptive_concurrency_benchmark [handlers] [calls per second] [seconds per phase] [target delay (ms)] [fixed limit]
+//---------------------------------------------------------------------
+#include "benchmark_harness.h"
+#include <adaptive_limiter.h>
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+struct Phase
+{
+    std::string name;
+    double handlerCostUs;
+};
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+struct PhaseResult
+{
+    uint64_t handled;
+    uint64_t rejected;
+    std::vector<double> latenciesUs;
+    double limitSum;
+    uint64_t limitSamples;
+};
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+struct SimulationEvent
+{
+    double timeUs;
+    bool isArrival;
+    double admittedUs;
+
+    bool operator>(const SimulationEvent& other) const
+    {
+        return timeUs > other.timeUs;
+    }
+};
+
+//---------------------------------------------------------------------
+// Runs all phases back to back. limitFor returns the limit to apply after
+// a call completes, given its latency and the calls in flight, or zero for
+// no limit.
+//---------------------------------------------------------------------
+static std::vector<PhaseResult> Simulate(
+    const std::vector<Phase>& phases,
+    int handlers,
+    double callsPerSecond,
+    double secondsPerPhase,
+    int32_t initialLimit,
+    const std::function<int32_t(double latencyUs, int32_t inFlight)>& limitFor)
+{
+    std::mt19937_64 random(42);
+    std::exponential_distribution<double> interArrivalUs(callsPerSecond / 1e6);
+    std::uniform_real_distribution<double> jitter(0.8, 1.2);
+
+    std::vector<PhaseResult> results(phases.size());
+    std::priority_queue<SimulationEvent, std::vector<SimulationEvent>, std::greater<SimulationEvent>> events;
+    std::deque<double> waiting;
+    int busyHandlers = 0;
+    int32_t inFlight = 0;
+    int32_t limit = initialLimit;
+    auto phaseUs = secondsPerPhase * 1e6;
+    auto endUs = phaseUs * phases.size();
+
+    auto startHandler = [&](double nowUs, double admittedUs)
+    {
+        auto& phase = phases[std::min(phases.size() - 1, (size_t)(nowUs / phaseUs))];
+        ++busyHandlers;
+        events.push({ nowUs + phase.handlerCostUs * jitter(random), false, admittedUs });
+    };
+
+    events.push({ interArrivalUs(random), true, 0 });
+    while (!events.empty())
+    {
+        auto event = events.top();
+        events.pop();
+        auto& result = results[std::min(phases.size() - 1, (size_t)(event.timeUs / phaseUs))];
+        if (event.isArrival)
+        {
+            if (event.timeUs < endUs)
+            {
+                events.push({ event.timeUs + interArrivalUs(random), true, 0 });
+            }
+            if (limit > 0 && inFlight >= limit)
+            {
+                ++result.rejected;
+                continue;
+            }
+            ++inFlight;
+            if (busyHandlers < handlers)
+            {
+                startHandler(event.timeUs, event.timeUs);
+            }
+            else
+            {
+                waiting.push_back(event.timeUs);
+            }
+        }
+        else
+        {
+            auto latencyUs = event.timeUs - event.admittedUs;
+            ++result.handled;
+            result.latenciesUs.push_back(latencyUs);
+            limit = limitFor(latencyUs, inFlight);
+            result.limitSum += limit;
+            ++result.limitSamples;
+            --inFlight;
+            --busyHandlers;
+            if (!waiting.empty())
+            {
+                startHandler(event.timeUs, waiting.front());
+                waiting.pop_front();
+            }
+        }
+    }
+    return results;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void Report(const std::string& policy, const std::vector<Phase>& phases, std::vector<PhaseResult>& results, double secondsPerPhase)
+{
+    for (size_t x = 0; x < phases.size(); ++x)
+    {
+        auto& result = results[x];
+        auto total = result.handled + result.rejected;
+        std::cout << std::left << std::setw(12) << policy
+            << std::setw(12) << phases[x].name
+            << std::right << std::setw(12) << (uint64_t)(result.handled / secondsPerPhase)
+            << std::setw(12) << std::fixed << std::setprecision(1) << (total == 0 ? 0 : 100.0 * result.rejected / total)
+            << std::setw(12) << std::setprecision(2) << lvbench::Percentile(result.latenciesUs, 0.5) / 1000
+            << std::setw(12) << lvbench::Percentile(result.latenciesUs, 0.99) / 1000;
+        if (result.limitSamples != 0 && result.limitSum != 0)
+        {
+            std::cout << std::setw(12) << std::setprecision(1) << result.limitSum / result.limitSamples;
+        }
+        else
+        {
+            std::cout << std::setw(12) << "-";
+        }
+        std::cout << std::endl;
+    }
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    int handlers = argc > 1 ? atoi(argv[1]) : 4;
+    double callsPerSecond = argc > 2 ? atof(argv[2]) : 3000;
+    double secondsPerPhase = argc > 3 ? atof(argv[3]) : 20;
+    double targetDelayMs = argc > 4 ? atof(argv[4]) : 2;
+    int32_t fixedLimit = argc > 5 ? atoi(argv[5]) : 64;
+
+    std::vector<Phase> phases = {
+        { "normal", 1000 },
+        { "slow", 2000 },
+        { "recovered", 1000 } };
+
+    std::cout << "handlers: " << handlers << ", calls/s: " << callsPerSecond << ", seconds per phase: " << secondsPerPhase
+        << ", target delay: " << targetDelayMs << "ms, fixed limit: " << fixedLimit << std::endl;
+    std::cout << std::left << std::setw(12) << "policy" << std::setw(12) << "phase"
+        << std::right << std::setw(12) << "handled/s" << std::setw(12) << "rejected %"
+        << std::setw(12) << "p50 (ms)" << std::setw(12) << "p99 (ms)" << std::setw(12) << "mean limit" << std::endl;
+
+    auto unlimited = Simulate(phases, handlers, callsPerSecond, secondsPerPhase, 0, [](double, int32_t) { return 0; });
+    Report("none", phases, unlimited, secondsPerPhase);
+
+    auto fixed = Simulate(phases, handlers, callsPerSecond, secondsPerPhase, fixedLimit, [&](double, int32_t) { return fixedLimit; });
+    Report("fixed", phases, fixed, secondsPerPhase);
+
+    grpc_labview::AdaptiveLimiter limiter(1, 1000, targetDelayMs * 1000);
+    auto adaptive = Simulate(phases, handlers, callsPerSecond, secondsPerPhase, limiter.Limit(), [&](double latencyUs, int32_t inFlight)
+    {
+        return limiter.AddSample(latencyUs, inFlight);
+    });
+    Report("adaptive", phases, adaptive, secondsPerPhase);
+    return 0;
+}
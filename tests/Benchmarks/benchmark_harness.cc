@@ -0,0 +1,287 @@
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+#include "benchmark_harness.h"
+#include "lv_runtime_stub.h"
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+    std::atomic<int> gFailedChecks(0);
+}
+
+namespace lvbench
+{
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void AppendVarint(std::string& buffer, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            buffer.push_back((char)(value | 0x80));
+            value >>= 7;
+        }
+        buffer.push_back((char)value);
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void AppendTag(std::string& buffer, int protobufIndex, int wireType)
+    {
+        AppendVarint(buffer, ((uint64_t)protobufIndex << 3) | wireType);
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void AppendLengthDelimited(std::string& buffer, int protobufIndex, const std::string& value)
+    {
+        AppendTag(buffer, protobufIndex, 2);
+        AppendVarint(buffer, value.size());
+        buffer.append(value);
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    uint64_t ReadVarint(const std::string& buffer, size_t& offset)
+    {
+        uint64_t value = 0;
+        for (int shift = 0; offset < buffer.size() && shift < 64; shift += 7)
+        {
+            auto byte = (uint8_t)buffer[offset++];
+            value |= (uint64_t)(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                break;
+            }
+        }
+        return value;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    grpc::ByteBuffer CreateByteBuffer(const std::string& bytes)
+    {
+        grpc::Slice slice(bytes);
+        return grpc::ByteBuffer(&slice, 1);
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    std::string Flatten(const grpc::ByteBuffer& buffer)
+    {
+        std::vector<grpc::Slice> slices;
+        buffer.Dump(&slices);
+        std::string result;
+        result.reserve(buffer.Length());
+        for (auto& slice : slices)
+        {
+            result.append((const char*)slice.begin(), slice.size());
+        }
+        return result;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    double Measure(double seconds, const std::function<void()>& operation)
+    {
+        uint64_t count = 0;
+        auto start = std::chrono::steady_clock::now();
+        auto end = start + std::chrono::duration<double>(seconds);
+        auto now = start;
+        do
+        {
+            operation();
+            ++count;
+            now = std::chrono::steady_clock::now();
+        } while (now < end);
+        return std::chrono::duration<double, std::micro>(now - start).count() / count;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    double Percentile(std::vector<double>& values, double percentile)
+    {
+        if (values.empty())
+        {
+            return 0;
+        }
+        auto index = std::min(values.size() - 1, (size_t)(values.size() * percentile));
+        std::nth_element(values.begin(), values.begin() + index, values.end());
+        return values[index];
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    std::string StartLocalServer(grpc_labview::gRPCid** server)
+    {
+        std::string address = "127.0.0.1:0";
+        std::string empty;
+        if (LVStartServer(&address[0], &empty[0], &empty[0], server) != 0)
+        {
+            return std::string();
+        }
+        int port = 0;
+        LVGetServerListeningPort(server, &port);
+        return "127.0.0.1:" + std::to_string(port);
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    std::shared_ptr<grpc::Channel> CreateClientChannel(const std::string& address)
+    {
+        grpc::ChannelArguments args;
+        args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
+        return grpc::CreateCustomChannel(address, grpc::InsecureChannelCredentials(), args);
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    grpc::Status UnaryCall(grpc::GenericStub& stub, grpc::CompletionQueue& cq, const std::string& method, const grpc::ByteBuffer& request, grpc::ByteBuffer* response, std::chrono::milliseconds timeout)
+    {
+        grpc::ClientContext context;
+        if (timeout.count() > 0)
+        {
+            context.set_deadline(std::chrono::system_clock::now() + timeout);
+        }
+        grpc::ByteBuffer ignored;
+        grpc::Status status;
+        auto call = stub.PrepareUnaryCall(&context, method, request, &cq);
+        call->StartCall();
+        call->Finish(response == nullptr ? &ignored : response, &status, (void*)1);
+        void* tag;
+        bool ok;
+        if (!cq.Next(&tag, &ok) || !ok)
+        {
+            return grpc::Status(grpc::StatusCode::UNKNOWN, "the call did not complete");
+        }
+        return status;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    grpc::Status ClientStreamingCall(grpc::GenericStub& stub, grpc::CompletionQueue& cq, const std::string& method, const std::vector<grpc::ByteBuffer>& requests, grpc::ByteBuffer* response)
+    {
+        grpc::ClientContext context;
+        void* tag;
+        bool ok;
+        auto call = stub.PrepareCall(&context, method, &cq);
+        call->StartCall((void*)1);
+        cq.Next(&tag, &ok);
+        for (auto& request : requests)
+        {
+            call->Write(request, (void*)2);
+            if (!cq.Next(&tag, &ok) || !ok)
+            {
+                break;
+            }
+        }
+        call->WritesDone((void*)3);
+        cq.Next(&tag, &ok);
+        call->Read(response, (void*)4);
+        cq.Next(&tag, &ok);
+        grpc::Status status;
+        call->Finish(&status, (void*)5);
+        if (!cq.Next(&tag, &ok) || !ok)
+        {
+            return grpc::Status(grpc::StatusCode::UNKNOWN, "the call did not complete");
+        }
+        return status;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void ShutdownCompletionQueue(grpc::CompletionQueue& cq)
+    {
+        cq.Shutdown();
+        void* tag;
+        bool ok;
+        while (cq.Next(&tag, &ok)) {}
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    LoadResult RunClients(const std::string& address, int clientCount, double seconds, const std::string& method, const RequestGenerator& request)
+    {
+        std::atomic<uint64_t> failures(0);
+        std::atomic<bool> done(false);
+        std::mutex latencyMutex;
+        std::vector<double> latenciesUs;
+
+        std::vector<std::thread> clients;
+        for (int x = 0; x < clientCount; ++x)
+        {
+            clients.emplace_back([&, x]()
+            {
+                grpc::GenericStub stub(CreateClientChannel(address));
+                grpc::CompletionQueue cq;
+                std::vector<double> clientLatenciesUs;
+                for (uint64_t call = 0; !done; ++call)
+                {
+                    auto requestBuffer = request(x, call);
+                    auto start = std::chrono::steady_clock::now();
+                    if (UnaryCall(stub, cq, method, requestBuffer).ok())
+                    {
+                        clientLatenciesUs.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+                    }
+                    else
+                    {
+                        ++failures;
+                    }
+                }
+                ShutdownCompletionQueue(cq);
+
+                std::lock_guard<std::mutex> lock(latencyMutex);
+                latenciesUs.insert(latenciesUs.end(), clientLatenciesUs.begin(), clientLatenciesUs.end());
+            });
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        done = true;
+        for (auto& client : clients)
+        {
+            client.join();
+        }
+
+        LoadResult result = { latenciesUs.size(), failures, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), 0, 0, 0 };
+        if (!latenciesUs.empty())
+        {
+            double totalUs = 0;
+            for (auto latencyUs : latenciesUs)
+            {
+                totalUs += latencyUs;
+            }
+            result.meanUs = totalUs / latenciesUs.size();
+            result.p50Us = Percentile(latenciesUs, 0.5);
+            result.p99Us = Percentile(latenciesUs, 0.99);
+        }
+        return result;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    bool Check(bool passed, const char* condition, const char* file, int line)
+    {
+        if (!passed)
+        {
+            ++gFailedChecks;
+            std::cerr << file << ":" << line << ": check failed: " << condition << std::endl;
+        }
+        return passed;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    int TestResult()
+    {
+        if (gFailedChecks != 0)
+        {
+            std::cerr << gFailedChecks << " check(s) failed" << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+}
@@ -0,0 +1,83 @@
+//---------------------------------------------------------------------
+// Client side helpers shared by the benchmarks and tests.
+//
+// Encoding of protocol buffer wire format by hand, unary calls through the
+// generic stub, closed loop clients and the checks the tests report their
+// failures with.
+//---------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+#include <grpcpp/grpcpp.h>
+#include <grpcpp/generic/generic_stub.h>
+#include <lv_interop.h>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+//---------------------------------------------------------------------
+// Reports the failed condition and continues, main returns lvbench::TestResult().
+//---------------------------------------------------------------------
+#define LVBENCH_CHECK(condition) lvbench::Check((condition), #condition, __FILE__, __LINE__)
+
+namespace lvbench
+{
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void AppendVarint(std::string& buffer, uint64_t value);
+    void AppendTag(std::string& buffer, int protobufIndex, int wireType);
+    void AppendLengthDelimited(std::string& buffer, int protobufIndex, const std::string& value);
+    // Reads the varint at offset and moves offset past it.
+    uint64_t ReadVarint(const std::string& buffer, size_t& offset);
+
+    grpc::ByteBuffer CreateByteBuffer(const std::string& bytes);
+    std::string Flatten(const grpc::ByteBuffer& buffer);
+
+    // Returns the mean time in microseconds of one call to operation, called for the given time.
+    double Measure(double seconds, const std::function<void()>& operation);
+
+    // Value at the given fraction of the values, which are partially reordered.
+    double Percentile(std::vector<double>& values, double percentile);
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    // Starts the server on a free port of 127.0.0.1 and returns the address to call, empty if it did not start.
+    std::string StartLocalServer(grpc_labview::gRPCid** server);
+
+    // Channel with a connection of its own so calls arrive the way they would from independent clients.
+    std::shared_ptr<grpc::Channel> CreateClientChannel(const std::string& address);
+
+    // Calls method and waits for it to complete, no deadline is set for a zero timeout.
+    grpc::Status UnaryCall(grpc::GenericStub& stub, grpc::CompletionQueue& cq, const std::string& method, const grpc::ByteBuffer& request, grpc::ByteBuffer* response = nullptr, std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+    // Sends the requests on a client streaming call of method and waits for its response.
+    grpc::Status ClientStreamingCall(grpc::GenericStub& stub, grpc::CompletionQueue& cq, const std::string& method, const std::vector<grpc::ByteBuffer>& requests, grpc::ByteBuffer* response);
+    void ShutdownCompletionQueue(grpc::CompletionQueue& cq);
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    struct LoadResult
+    {
+        uint64_t calls;
+        uint64_t failures;
+        double seconds;
+        double meanUs;
+        double p50Us;
+        double p99Us;
+    };
+
+    // Request of the given call of a client.
+    using RequestGenerator = std::function<grpc::ByteBuffer(int client, uint64_t call)>;
+
+    // Runs clientCount threads, each calling method back to back on its own connection for the given time.
+    LoadResult RunClients(const std::string& address, int clientCount, double seconds, const std::string& method, const RequestGenerator& request);
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    bool Check(bool passed, const char* condition, const char* file, int line);
+    // Exit code of a test, non zero if any check failed.
+    int TestResult();
+}
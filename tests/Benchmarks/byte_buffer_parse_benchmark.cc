@@ -0,0 +1,135 @@
+//---------------------------------------------------------------------
+// Parse throughput of received messages against their size, comparing
+// LVMessage::ParseFromByteBuffer, which parses straight from the slices of
+// the grpc::ByteBuffer, with flattening the slices into one string and
+// parsing that. Each case checks that both parse the same message.
+//
+// The message is split into slices the size gRPC typically receives them
+// in, so large messages span many slices.
+//
+// Usage: byte_buffer_parse_benchmark [seconds per case] [slice size] [message sizes...]
+//---------------------------------------------------------------------
+#include "benchmark_harness.h"
+#include "lv_runtime_stub.h"
+#include <grpc_server.h>
+#include <lv_message.h>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+using grpc_labview::LVMessageMetadataType;
+
+//---------------------------------------------------------------------
+// Wire format of benchmark.Waveform with about size bytes of samples and
+// a short label.
+//---------------------------------------------------------------------
+static std::string EncodeWaveform(size_t size)
+{
+    std::vector<double> samples(std::max<size_t>(1, size / sizeof(double)));
+    for (size_t x = 0; x < samples.size(); ++x)
+    {
+        samples[x] = x * 0.001;
+    }
+    std::string label = "channel 0";
+    std::string encoded;
+    encoded.push_back(0x0A);
+    lvbench::AppendVarint(encoded, samples.size() * sizeof(double));
+    encoded.append((const char*)samples.data(), samples.size() * sizeof(double));
+    encoded.push_back(0x12);
+    lvbench::AppendVarint(encoded, label.size());
+    encoded.append(label);
+    return encoded;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static grpc::ByteBuffer SplitIntoSlices(const std::string& encoded, size_t sliceSize)
+{
+    std::vector<grpc::Slice> slices;
+    for (size_t offset = 0; offset < encoded.size(); offset += sliceSize)
+    {
+        slices.emplace_back(encoded.data() + offset, std::min(sliceSize, encoded.size() - offset));
+    }
+    return grpc::ByteBuffer(slices.data(), slices.size());
+}
+
+//---------------------------------------------------------------------
+// How requests were parsed before, kept to compare against.
+//---------------------------------------------------------------------
+static bool ParseFlattened(grpc_labview::LVMessage& message, const grpc::ByteBuffer& buffer)
+{
+    message.Clear();
+    return message.ParseFromString(lvbench::Flatten(buffer));
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static bool RunCase(std::shared_ptr<grpc_labview::MessageMetadata> metadata, size_t size, size_t sliceSize, double seconds)
+{
+    auto encoded = EncodeWaveform(size);
+    auto buffer = SplitIntoSlices(encoded, sliceSize);
+
+    grpc_labview::LVMessage flattenedMessage(metadata);
+    grpc_labview::LVMessage slicesMessage(metadata);
+    bool parsed = ParseFlattened(flattenedMessage, buffer) && slicesMessage.ParseFromByteBuffer(buffer);
+    bool identical = parsed && flattenedMessage.SerializeAsString() == encoded && slicesMessage.SerializeAsString() == encoded;
+
+    auto flattenedTime = lvbench::Measure(seconds, [&]() { ParseFlattened(flattenedMessage, buffer); });
+    auto slicesTime = lvbench::Measure(seconds, [&]() { slicesMessage.ParseFromByteBuffer(buffer); });
+
+    std::cout << std::right << std::setw(12) << encoded.size()
+        << std::setw(10) << (encoded.size() + sliceSize - 1) / sliceSize
+        << std::setw(16) << std::fixed << std::setprecision(2) << flattenedTime
+        << std::setw(14) << slicesTime
+        << std::setw(10) << std::setprecision(2) << flattenedTime / slicesTime << "x"
+        << std::setw(14) << std::setprecision(0) << encoded.size() / flattenedTime << " MB/s"
+        << std::setw(14) << encoded.size() / slicesTime << " MB/s"
+        << (identical ? "" : "  PARSE DIFFERS") << std::endl;
+    return identical;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    double seconds = argc > 1 ? atof(argv[1]) : 1.0;
+    size_t sliceSize = argc > 2 ? (size_t)atoi(argv[2]) : 16384;
+    std::vector<size_t> sizes;
+    for (int x = 3; x < argc; ++x)
+    {
+        sizes.push_back((size_t)atoll(argv[x]));
+    }
+    if (sizes.empty())
+    {
+        sizes = { 1024, 16 * 1024, 256 * 1024, 1024 * 1024, 8 * 1024 * 1024, 32 * 1024 * 1024 };
+    }
+
+    grpc_labview::gRPCid* serverId = nullptr;
+    LVCreateServer(&serverId);
+    lvstub::RegisterMessage(&serverId, "benchmark.Waveform", {
+        { "samples", 1, (int)LVMessageMetadataType::DoubleValue, true, "" },
+        { "label", 2, (int)LVMessageMetadataType::StringValue, false, "" }
+    });
+    CompleteMetadataRegistration(&serverId);
+    auto metadata = serverId->CastTo<grpc_labview::LabVIEWgRPCServer>()->FindMetadata("benchmark.Waveform");
+
+    std::cout << "slice size: " << sliceSize << " bytes" << std::endl;
+    std::cout << std::right << std::setw(12) << "bytes"
+        << std::setw(10) << "slices"
+        << std::setw(16) << "flatten (us)"
+        << std::setw(14) << "slices (us)"
+        << std::setw(11) << "speedup"
+        << std::setw(19) << "flatten rate"
+        << std::setw(19) << "slices rate" << std::endl;
+
+    bool identical = true;
+    for (auto size : sizes)
+    {
+        identical &= RunCase(metadata, size, sliceSize, seconds);
+    }
+    return identical ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+//---------------------------------------------------------------------
+// Heap allocations made by labview_grpc_server for every unary call.
+//
+// Global operator new is replaced to count every allocation made by the
+// process, so the totals include the gRPC core and the benchmark client.
+// The call pool counters show the allocations made for the server call
+// bookkeeping (CallData, GenericMethodData, request and response messages)
+// which should stop growing once the pools are warm.
+//
+// Usage: call_allocation_benchmark [warmup calls] [measured calls]
+//---------------------------------------------------------------------
+#include "benchmark_harness.h"
+#include "lv_runtime_stub.h"
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static std::atomic<uint64_t> gAllocations(0);
+
+void* operator new(size_t size)
+{
+    ++gAllocations;
+    auto block = malloc(size == 0 ? 1 : size);
+    if (block == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+void operator delete(void* block) noexcept
+{
+    free(block);
+}
+
+void operator delete(void* block, size_t size) noexcept
+{
+    free(block);
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static const char* kEchoMethod = "/benchmark.Benchmark/Echo";
+static const char* kEchoMessage = "benchmark.EchoMessage";
+
+//---------------------------------------------------------------------
+// LabVIEW cluster for benchmark.EchoMessage
+//---------------------------------------------------------------------
+struct EchoCluster
+{
+    int32_t id;
+    grpc_labview::LStrHandle payload;
+};
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void HandleEcho(grpc_labview::gRPCid* id)
+{
+    EchoCluster cluster = { 0, nullptr };
+    if (GetRequestData(&id, (int8_t*)&cluster) == 0)
+    {
+        SetResponseData(&id, (int8_t*)&cluster);
+    }
+    CloseServerEvent(&id);
+    lvstub::DisposeLVString(cluster.payload);
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    int warmupCalls = argc > 1 ? atoi(argv[1]) : 1000;
+    int measuredCalls = argc > 2 ? atoi(argv[2]) : 10000;
+
+    auto echoEvent = lvstub::CreateUserEvent(HandleEcho);
+    lvstub::StartEventLoop(1);
+
+    grpc_labview::gRPCid* server = nullptr;
+    LVCreateServer(&server);
+    LVSetServerCompletionQueueCount(&server, 1);
+    lvstub::RegisterMessage(&server, kEchoMessage, {
+        { "id", 1, (int)grpc_labview::LVMessageMetadataType::Int32Value, false, "" },
+        { "payload", 2, (int)grpc_labview::LVMessageMetadataType::StringValue, false, "" }
+    });
+    CompleteMetadataRegistration(&server);
+    RegisterServerEvent(&server, kEchoMethod, &echoEvent, kEchoMessage, kEchoMessage);
+
+    auto address = lvbench::StartLocalServer(&server);
+    if (address.empty())
+    {
+        std::cerr << "Failed to start the server" << std::endl;
+        return 1;
+    }
+
+    auto request = lvbench::CreateByteBuffer("\x08\x2A\x12\x05hello");
+    auto channel = grpc::CreateChannel(address, grpc::InsecureChannelCredentials());
+    grpc::GenericStub stub(channel);
+    grpc::CompletionQueue cq;
+
+    int failures = 0;
+    for (int x = 0; x < warmupCalls; ++x)
+    {
+        failures += lvbench::UnaryCall(stub, cq, kEchoMethod, request).ok() ? 0 : 1;
+    }
+
+    uint64_t poolHeapStart, poolReusedStart;
+    LVGetServerCallPoolStats(&server, &poolHeapStart, &poolReusedStart);
+    uint64_t allocationsStart = gAllocations;
+    for (int x = 0; x < measuredCalls; ++x)
+    {
+        failures += lvbench::UnaryCall(stub, cq, kEchoMethod, request).ok() ? 0 : 1;
+    }
+    uint64_t allocations = gAllocations - allocationsStart;
+    uint64_t poolHeapEnd, poolReusedEnd;
+    LVGetServerCallPoolStats(&server, &poolHeapEnd, &poolReusedEnd);
+
+    std::cout << "calls: " << measuredCalls << ", failures: " << failures << std::endl;
+    std::cout << "process allocations per call: " << (double)allocations / measuredCalls << std::endl;
+    std::cout << "call pool heap allocations per call: " << (double)(poolHeapEnd - poolHeapStart) / measuredCalls << std::endl;
+    std::cout << "call pool reused allocations per call: " << (double)(poolReusedEnd - poolReusedStart) / measuredCalls << std::endl;
+
+    lvbench::ShutdownCompletionQueue(cq);
+    LVStopServer(&server);
+    lvstub::StopEventLoop();
+    return 0;
+}
@@ -0,0 +1,172 @@
+//---------------------------------------------------------------------
+// Serialization of a LabVIEW cluster to protobuf wire format, comparing
+// the copy into an LVMessage followed by SerializeToByteBuffer with the
+// ClusterSerializer which writes the wire format straight from the
+// cluster. Each case checks that both paths produce the same bytes.
+//
+// Usage: cluster_serialization_benchmark [seconds per case] [wide message fields] [array elements]
+//---------------------------------------------------------------------
+#include "benchmark_harness.h"
+#include "lv_runtime_stub.h"
+#include <cluster_copier.h>
+#include <cluster_serializer.h>
+#include <grpc_server.h>
+#include <lv_message.h>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+using grpc_labview::LVMessageMetadataType;
+
+//---------------------------------------------------------------------
+// Fills every field of the cluster with a value that depends on the field
+// so that varints of different lengths are exercised.
+//---------------------------------------------------------------------
+static void FillCluster(const grpc_labview::MessageMetadata& metadata, int8_t* cluster, int arrayElements)
+{
+    for (auto& element : metadata._elements)
+    {
+        auto start = cluster + element->clusterOffset;
+        auto index = element->protobufIndex;
+        if (element->isRepeated)
+        {
+            switch (element->type)
+            {
+            case LVMessageMetadataType::DoubleValue:
+                {
+                    grpc_labview::NumericArrayResize(grpc_labview::GetTypeCodeForSize(sizeof(double)), 1, start, arrayElements);
+                    auto array = *(grpc_labview::LV1DArrayHandle*)start;
+                    (*array)->cnt = arrayElements;
+                    auto data = (*array)->bytes<double>();
+                    for (int x = 0; x < arrayElements; ++x)
+                    {
+                        data[x] = x * 0.25;
+                    }
+                }
+                break;
+            case LVMessageMetadataType::Int32Value:
+                {
+                    grpc_labview::NumericArrayResize(grpc_labview::GetTypeCodeForSize(sizeof(int32_t)), 1, start, arrayElements);
+                    auto array = *(grpc_labview::LV1DArrayHandle*)start;
+                    (*array)->cnt = arrayElements;
+                    auto data = (*array)->bytes<int32_t>();
+                    for (int x = 0; x < arrayElements; ++x)
+                    {
+                        data[x] = x * 37;
+                    }
+                }
+                break;
+            default:
+                break;
+            }
+            continue;
+        }
+        switch (element->type)
+        {
+        case LVMessageMetadataType::Int32Value:
+            *(int32_t*)start = index * 1000;
+            break;
+        case LVMessageMetadataType::Int64Value:
+            *(int64_t*)start = (int64_t)index << 33;
+            break;
+        case LVMessageMetadataType::DoubleValue:
+            *(double*)start = index * 1.25;
+            break;
+        case LVMessageMetadataType::BoolValue:
+            *(bool*)start = (index % 2) == 0;
+            break;
+        case LVMessageMetadataType::StringValue:
+            *(grpc_labview::LStrHandle*)start = lvstub::CreateLVString("field value " + std::to_string(index));
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static bool RunCase(const std::string& name, std::shared_ptr<grpc_labview::MessageMetadata> metadata, int arrayElements, double seconds)
+{
+    std::vector<uint64_t> storage(metadata->clusterSize / sizeof(uint64_t) + 1, 0);
+    auto cluster = (int8_t*)storage.data();
+    FillCluster(*metadata, cluster, arrayElements);
+
+    auto copyAndSerialize = [&]()
+    {
+        grpc_labview::LVMessage message(metadata);
+        grpc_labview::ClusterDataCopier::CopyFromCluster(message, cluster);
+        grpc::ByteBuffer buffer;
+        message.SerializeToByteBuffer(&buffer);
+        return buffer;
+    };
+    auto serializeDirect = [&]()
+    {
+        grpc_labview::ClusterSerializer serializer(metadata, cluster);
+        grpc::ByteBuffer buffer;
+        serializer.SerializeToByteBuffer(&buffer);
+        return buffer;
+    };
+
+    auto expected = lvbench::Flatten(copyAndSerialize());
+    auto actual = lvbench::Flatten(serializeDirect());
+    bool identical = expected == actual;
+
+    auto copyTime = lvbench::Measure(seconds, [&]() { copyAndSerialize(); });
+    auto directTime = lvbench::Measure(seconds, [&]() { serializeDirect(); });
+
+    std::cout << std::left << std::setw(28) << name
+        << std::right << std::setw(12) << expected.size()
+        << std::setw(16) << std::fixed << std::setprecision(2) << copyTime
+        << std::setw(14) << directTime
+        << std::setw(10) << std::setprecision(2) << copyTime / directTime << "x"
+        << std::setw(12) << std::setprecision(0) << expected.size() / directTime << " MB/s"
+        << (identical ? "" : "  OUTPUT DIFFERS") << std::endl;
+    return identical;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    double seconds = argc > 1 ? atof(argv[1]) : 2.0;
+    int wideFields = argc > 2 ? atoi(argv[2]) : 100;
+    int arrayElements = argc > 3 ? atoi(argv[3]) : 1000000;
+
+    grpc_labview::gRPCid* serverId = nullptr;
+    LVCreateServer(&serverId);
+
+    const int wideTypes[] = {
+        (int)LVMessageMetadataType::Int32Value,
+        (int)LVMessageMetadataType::DoubleValue,
+        (int)LVMessageMetadataType::StringValue,
+        (int)LVMessageMetadataType::Int64Value,
+        (int)LVMessageMetadataType::BoolValue };
+    std::vector<lvstub::ElementDescription> wideElements;
+    for (int x = 0; x < wideFields; ++x)
+    {
+        wideElements.push_back({ "field" + std::to_string(x + 1), x + 1, wideTypes[x % 5], false, "" });
+    }
+    lvstub::RegisterMessage(&serverId, "benchmark.WideMessage", wideElements);
+    lvstub::RegisterMessage(&serverId, "benchmark.DoubleArray", { { "values", 1, (int)LVMessageMetadataType::DoubleValue, true, "" } });
+    lvstub::RegisterMessage(&serverId, "benchmark.Int32Array", { { "values", 1, (int)LVMessageMetadataType::Int32Value, true, "" } });
+    CompleteMetadataRegistration(&serverId);
+
+    auto server = serverId->CastTo<grpc_labview::LabVIEWgRPCServer>();
+    std::cout << std::left << std::setw(28) << "case"
+        << std::right << std::setw(12) << "bytes"
+        << std::setw(16) << "copy (us)"
+        << std::setw(14) << "direct (us)"
+        << std::setw(11) << "speedup"
+        << std::setw(17) << "direct rate" << std::endl;
+
+    bool identical = true;
+    identical &= RunCase("wide (" + std::to_string(wideFields) + " fields)", server->FindMetadata("benchmark.WideMessage"), 0, seconds);
+    identical &= RunCase("double[" + std::to_string(arrayElements) + "]", server->FindMetadata("benchmark.DoubleArray"), arrayElements, seconds);
+    identical &= RunCase("int32[" + std::to_string(arrayElements) + "]", server->FindMetadata("benchmark.Int32Array"), arrayElements, seconds);
+    return identical ? 0 : 1;
+}
@@ -0,0 +1,339 @@
+//---------------------------------------------------------------------
+// Bandwidth and CPU trade-off of message compression in
+// labview_grpc_server for a waveform sent as a Double2DArray style
+// message and for log text.
+//
+// For every payload the message is first compressed with zlib directly to
+// show the size on the wire and the CPU time per message, then the library
+// client echoes it through the server without compression, with deflate
+// and with gzip. Both sides compress messages of 1024 bytes or more.
+//
+// Usage: compression_benchmark [seconds] [samples per channel] [channels]
+//---------------------------------------------------------------------
+#include "benchmark_harness.h"
+#include "lv_runtime_stub.h"
+#include <zlib.h>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static const char* kEchoMethod = "/benchmark.Benchmark/Echo";
+static const char* kPayloadMessage = "benchmark.Payload";
+static const int32_t kMinCompressedBytes = 1024;
+
+//---------------------------------------------------------------------
+// LabVIEW cluster for benchmark.Payload, rows, columns and data are laid
+// out the same way as ni.protobuf.types.Double2DArray on the wire.
+//---------------------------------------------------------------------
+struct PayloadCluster
+{
+    int32_t rows;
+    int32_t columns;
+    grpc_labview::LV1DArrayHandle data;
+    grpc_labview::LStrHandle text;
+};
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void DisposePayload(PayloadCluster& cluster)
+{
+    if (cluster.data != nullptr)
+    {
+        lvstub::DisposeLVArray(cluster.data);
+        cluster.data = nullptr;
+    }
+    if (cluster.text != nullptr)
+    {
+        lvstub::DisposeLVString(cluster.text);
+        cluster.text = nullptr;
+    }
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void RegisterPayload(grpc_labview::gRPCid** owner)
+{
+    lvstub::RegisterMessage(owner, kPayloadMessage, {
+        { "rows", 1, (int)grpc_labview::LVMessageMetadataType::Int32Value, false, "" },
+        { "columns", 2, (int)grpc_labview::LVMessageMetadataType::Int32Value, false, "" },
+        { "data", 3, (int)grpc_labview::LVMessageMetadataType::DoubleValue, true, "" },
+        { "text", 4, (int)grpc_labview::LVMessageMetadataType::StringValue, false, "" }
+    });
+    CompleteMetadataRegistration(owner);
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void HandleEcho(grpc_labview::gRPCid* id)
+{
+    PayloadCluster cluster = { 0 };
+    if (GetRequestData(&id, (int8_t*)&cluster) == 0)
+    {
+        SetResponseData(&id, (int8_t*)&cluster);
+    }
+    CloseServerEvent(&id);
+    DisposePayload(cluster);
+}
+
+//---------------------------------------------------------------------
+// A payload with the protobuf encoding of the same message, used to
+// measure compression on its own.
+//---------------------------------------------------------------------
+struct Payload
+{
+    std::string name;
+    std::vector<double> data;
+    int32_t rows;
+    int32_t columns;
+    std::string text;
+    std::string encoded;
+};
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void EncodePayload(Payload& payload)
+{
+    payload.encoded.clear();
+    if (payload.rows != 0)
+    {
+        payload.encoded.push_back(0x08);
+        lvbench::AppendVarint(payload.encoded, payload.rows);
+    }
+    if (payload.columns != 0)
+    {
+        payload.encoded.push_back(0x10);
+        lvbench::AppendVarint(payload.encoded, payload.columns);
+    }
+    if (!payload.data.empty())
+    {
+        payload.encoded.push_back(0x1A);
+        lvbench::AppendVarint(payload.encoded, payload.data.size() * sizeof(double));
+        payload.encoded.append((const char*)payload.data.data(), payload.data.size() * sizeof(double));
+    }
+    if (!payload.text.empty())
+    {
+        payload.encoded.push_back(0x22);
+        lvbench::AppendVarint(payload.encoded, payload.text.size());
+        payload.encoded.append(payload.text);
+    }
+}
+
+//---------------------------------------------------------------------
+// Samples of a 16 bit digitizer scaled to volts: a sine with noise of a
+// few codes on every channel.
+//---------------------------------------------------------------------
+static Payload CreateWaveform(int samples, int channels)
+{
+    Payload payload;
+    payload.name = "waveform";
+    payload.rows = channels;
+    payload.columns = samples;
+    std::mt19937 random(1);
+    std::normal_distribution<double> noise(0.0, 3.0);
+    const double voltsPerCode = 20.0 / 65536;
+    for (int channel = 0; channel < channels; ++channel)
+    {
+        for (int sample = 0; sample < samples; ++sample)
+        {
+            auto value = 12000 * std::sin(2 * 3.14159265358979 * (channel + 1) * sample / 1000.0) + noise(random);
+            payload.data.push_back(std::round(value) * voltsPerCode);
+        }
+    }
+    EncodePayload(payload);
+    return payload;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static Payload CreateLogText(size_t bytes)
+{
+    static const char* levels[] = { "INFO", "INFO", "INFO", "DEBUG", "WARN" };
+    static const char* messages[] = {
+        "Acquisition started on channel",
+        "Acquisition complete on channel",
+        "Temperature within limits for channel",
+        "Buffer level reported by channel",
+        "Retrying trigger configuration for channel"
+    };
+    Payload payload;
+    payload.name = "log text";
+    payload.rows = 0;
+    payload.columns = 0;
+    std::mt19937 random(1);
+    for (int line = 0; payload.text.size() < bytes; ++line)
+    {
+        payload.text += "2024-05-01T12:" + std::to_string(10 + line / 6000 % 50) + ":" + std::to_string(10 + line / 100 % 50) + "." + std::to_string(100 + line % 900);
+        payload.text += std::string(" [") + levels[random() % 5] + "] " + messages[random() % 5] + " " + std::to_string(random() % 32);
+        payload.text += " value=" + std::to_string(random() % 100000) + "\n";
+    }
+    EncodePayload(payload);
+    return payload;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void FillCluster(const Payload& payload, PayloadCluster& cluster)
+{
+    cluster.rows = payload.rows;
+    cluster.columns = payload.columns;
+    cluster.data = nullptr;
+    cluster.text = nullptr;
+    if (!payload.data.empty())
+    {
+        lvstub::ResizeLVClusterArray(&cluster.data, (int32_t)payload.data.size(), sizeof(double), sizeof(double));
+        memcpy(lvstub::GetLVClusterArrayElement(cluster.data, 0, sizeof(double), sizeof(double)), payload.data.data(), payload.data.size() * sizeof(double));
+    }
+    cluster.text = lvstub::CreateLVString(payload.text);
+}
+
+//---------------------------------------------------------------------
+// Compresses the message the way gRPC does for the algorithm
+// (1 deflate, 2 gzip), returns the compressed size and the CPU time per
+// message.
+//---------------------------------------------------------------------
+static size_t Compress(const std::string& message, int algorithm, double& microseconds)
+{
+    std::vector<Bytef> output(compressBound((uLong)message.size()) + 32);
+    size_t compressedSize = 0;
+    int iterations = 0;
+    auto start = std::chrono::steady_clock::now();
+    do
+    {
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, algorithm == 2 ? 15 | 16 : 15, 8, Z_DEFAULT_STRATEGY);
+        stream.next_in = (Bytef*)message.data();
+        stream.avail_in = (uInt)message.size();
+        stream.next_out = output.data();
+        stream.avail_out = (uInt)output.size();
+        deflate(&stream, Z_FINISH);
+        compressedSize = stream.total_out;
+        deflateEnd(&stream);
+        ++iterations;
+    } while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(200));
+    microseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / iterations;
+    return compressedSize;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+struct BenchmarkResult
+{
+    uint64_t calls;
+    uint64_t failures;
+    double seconds;
+    double p50Us;
+};
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static BenchmarkResult RunClient(const std::string& address, int algorithm, const Payload& payload, int seconds)
+{
+    grpc_labview::gRPCid* client = nullptr;
+    CreateClient(address.c_str(), "", &client);
+    RegisterPayload(&client);
+
+    PayloadCluster request;
+    FillCluster(payload, request);
+    std::vector<double> latenciesUs;
+    uint64_t failures = 0;
+    grpc_labview::MagicCookie occurrence = 0;
+    auto start = std::chrono::steady_clock::now();
+    auto end = start + std::chrono::seconds(seconds);
+    while (std::chrono::steady_clock::now() < end)
+    {
+        auto callStart = std::chrono::steady_clock::now();
+        PayloadCluster response = { 0 };
+        grpc_labview::gRPCid* context = nullptr;
+        CreateClientContext(&context);
+        SetClientContextCompression(context, algorithm, kMinCompressedBytes);
+        grpc_labview::gRPCid* call = nullptr;
+        auto result = ClientUnaryCall(client, &occurrence, kEchoMethod, kPayloadMessage, kPayloadMessage, (int8_t*)&request, &call, 10000, context);
+        if (result == 0)
+        {
+            result = CompleteClientUnaryCall2(call, (int8_t*)&response, nullptr, nullptr);
+        }
+        CloseClientContext(context);
+        if (result == 0 && response.rows == request.rows && lvstub::GetLVString(response.text).size() == payload.text.size())
+        {
+            latenciesUs.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - callStart).count());
+        }
+        else
+        {
+            ++failures;
+        }
+        DisposePayload(response);
+    }
+    BenchmarkResult result = { latenciesUs.size(), failures, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), lvbench::Percentile(latenciesUs, 0.5) };
+    DisposePayload(request);
+    CloseClient(client);
+    return result;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static BenchmarkResult RunBenchmark(int algorithm, const Payload& payload, int seconds, grpc_labview::LVUserEventRef echoEvent)
+{
+    grpc_labview::gRPCid* server = nullptr;
+    LVCreateServer(&server);
+    RegisterPayload(&server);
+    RegisterServerEvent(&server, kEchoMethod, &echoEvent, kPayloadMessage, kPayloadMessage);
+    LVSetServerCompression(&server, algorithm, kMinCompressedBytes);
+
+    BenchmarkResult result = { 0, 0, 1, 0 };
+    auto address = lvbench::StartLocalServer(&server);
+    if (!address.empty())
+    {
+        result = RunClient(address, algorithm, payload, seconds);
+    }
+    LVStopServer(&server);
+    return result;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    int seconds = argc > 1 ? atoi(argv[1]) : 3;
+    int samples = argc > 2 ? atoi(argv[2]) : 8192;
+    int channels = argc > 3 ? atoi(argv[3]) : 4;
+
+    auto echoEvent = lvstub::CreateUserEvent(HandleEcho);
+    lvstub::StartEventLoop(1);
+
+    std::vector<Payload> payloads = { CreateWaveform(samples, channels), CreateLogText(samples * channels * sizeof(double) / 4) };
+    const char* algorithmNames[] = { "none", "deflate", "gzip" };
+
+    std::cout << "duration: " << seconds << "s, compression threshold: " << kMinCompressedBytes << " bytes" << std::endl;
+    std::cout << std::left << std::setw(12) << "payload" << std::setw(10) << "algorithm" << std::right << std::setw(12) << "bytes"
+        << std::setw(12) << "ratio" << std::setw(16) << "compress (us)" << std::setw(12) << "calls/s"
+        << std::setw(12) << "p50 (us)" << std::setw(12) << "failures" << std::endl;
+    for (auto& payload : payloads)
+    {
+        for (int algorithm = 0; algorithm < 3; ++algorithm)
+        {
+            size_t bytes = payload.encoded.size();
+            double compressUs = 0;
+            if (algorithm != 0)
+            {
+                bytes = Compress(payload.encoded, algorithm, compressUs);
+            }
+            auto result = RunBenchmark(algorithm, payload, seconds, echoEvent);
+            std::cout << std::left << std::setw(12) << payload.name << std::setw(10) << algorithmNames[algorithm] << std::right << std::setw(12) << bytes
+                << std::fixed << std::setprecision(2) << std::setw(12) << (double)payload.encoded.size() / bytes
+                << std::setprecision(1) << std::setw(16) << compressUs << std::setw(12) << result.calls / result.seconds
+                << std::setw(12) << result.p50Us << std::setw(12) << result.failures << std::endl;
+        }
+    }
+    lvstub::StopEventLoop();
+    return 0;
+}
@@ -0,0 +1,223 @@
+//---------------------------------------------------------------------
+// Latency of urgent control calls while a single LabVIEW handler is
+// overloaded with bulk upload calls, for different dispatch limits.
+//
+// Bulk clients call Upload back to back with a short deadline, and the
+// handler takes a fixed time for each of them. One control client calls
+// Control, a method of a higher priority class, at a fixed interval. With
+// a dispatch limit of 0 every call is posted to LabVIEW when it arrives,
+// so control calls wait behind every queued upload. With a limit the
+// server keeps the calls and posts control calls first, and uploads whose
+// deadline expired while they waited are never posted.
+//
+// Usage: dispatch_priority_benchmark [seconds] [bulk clients] [upload work (us)] [upload deadline (ms)] [dispatch limits...]
+//---------------------------------------------------------------------
+#include "benchmark_harness.h"
+#include "lv_runtime_stub.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static const char* kUploadMethod = "/benchmark.Benchmark/Upload";
+static const char* kControlMethod = "/benchmark.Benchmark/Control";
+static const char* kBenchmarkMessage = "benchmark.BenchmarkMessage";
+
+//---------------------------------------------------------------------
+// LabVIEW cluster for benchmark.BenchmarkMessage
+//---------------------------------------------------------------------
+struct BenchmarkCluster
+{
+    int32_t id;
+    grpc_labview::LStrHandle payload;
+};
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static int gUploadWorkUs;
+static std::atomic<uint64_t> gUploadsHandled(0);
+
+//---------------------------------------------------------------------
+// The handler sleeps rather than spins so that the client threads are not
+// starved on machines with few cores.
+//---------------------------------------------------------------------
+static void HandleCall(grpc_labview::gRPCid* id, int workUs)
+{
+    BenchmarkCluster cluster = { 0, nullptr };
+    if (GetRequestData(&id, (int8_t*)&cluster) == 0)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(workUs));
+        SetResponseData(&id, (int8_t*)&cluster);
+    }
+    CloseServerEvent(&id);
+    lvstub::DisposeLVString(cluster.payload);
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+struct BenchmarkResult
+{
+    uint64_t uploadsSucceeded;
+    uint64_t uploadsExpired;
+    uint64_t uploadsHandled;
+    uint64_t expiredBeforePosting;
+    uint64_t controlCalls;
+    uint64_t controlFailures;
+    double controlP50Ms;
+    double controlP99Ms;
+};
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void RunClients(const std::string& address, int bulkClients, int uploadDeadlineMs, int seconds, BenchmarkResult& result)
+{
+    std::atomic<uint64_t> uploadsSucceeded(0);
+    std::atomic<uint64_t> uploadsExpired(0);
+    std::atomic<bool> done(false);
+
+    auto channel = grpc::CreateChannel(address, grpc::InsecureChannelCredentials());
+    auto request = lvbench::CreateByteBuffer(std::string("\x08\x01", 2));
+    std::vector<std::thread> clients;
+    for (int x = 0; x < bulkClients; ++x)
+    {
+        clients.emplace_back([&]()
+        {
+            grpc::GenericStub stub(channel);
+            grpc::CompletionQueue cq;
+            while (!done)
+            {
+                auto status = lvbench::UnaryCall(stub, cq, kUploadMethod, request, nullptr, std::chrono::milliseconds(uploadDeadlineMs));
+                if (status.ok())
+                {
+                    ++uploadsSucceeded;
+                }
+                else if (status.error_code() == grpc::StatusCode::DEADLINE_EXCEEDED)
+                {
+                    ++uploadsExpired;
+                }
+            }
+            lvbench::ShutdownCompletionQueue(cq);
+        });
+    }
+
+    std::vector<double> controlLatenciesMs;
+    grpc::GenericStub stub(channel);
+    grpc::CompletionQueue cq;
+    auto end = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+    while (std::chrono::steady_clock::now() < end)
+    {
+        auto start = std::chrono::steady_clock::now();
+        auto status = lvbench::UnaryCall(stub, cq, kControlMethod, request, nullptr, std::chrono::seconds(10));
+        if (status.ok())
+        {
+            controlLatenciesMs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        else
+        {
+            ++result.controlFailures;
+        }
+        std::this_thread::sleep_until(start + std::chrono::milliseconds(10));
+    }
+    lvbench::ShutdownCompletionQueue(cq);
+
+    done = true;
+    for (auto& client : clients)
+    {
+        client.join();
+    }
+
+    result.uploadsSucceeded = uploadsSucceeded;
+    result.uploadsExpired = uploadsExpired;
+    result.controlCalls = controlLatenciesMs.size();
+    result.controlP50Ms = lvbench::Percentile(controlLatenciesMs, 0.5);
+    result.controlP99Ms = lvbench::Percentile(controlLatenciesMs, 0.99);
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static BenchmarkResult RunBenchmark(int dispatchLimit, int bulkClients, int uploadDeadlineMs, int seconds, grpc_labview::LVUserEventRef uploadEvent, grpc_labview::LVUserEventRef controlEvent)
+{
+    grpc_labview::gRPCid* server = nullptr;
+    LVCreateServer(&server);
+    LVSetServerDispatchLimit(&server, dispatchLimit);
+    LVSetServerMethodPriority(&server, kControlMethod, 1);
+    lvstub::RegisterMessage(&server, kBenchmarkMessage, {
+        { "id", 1, (int)grpc_labview::LVMessageMetadataType::Int32Value, false, "" },
+        { "payload", 2, (int)grpc_labview::LVMessageMetadataType::StringValue, false, "" }
+    });
+    CompleteMetadataRegistration(&server);
+    RegisterServerEvent(&server, kUploadMethod, &uploadEvent, kBenchmarkMessage, kBenchmarkMessage);
+    RegisterServerEvent(&server, kControlMethod, &controlEvent, kBenchmarkMessage, kBenchmarkMessage);
+
+    BenchmarkResult result = { 0, 0, 0, 0, 0, 0, 0, 0 };
+    auto address = lvbench::StartLocalServer(&server);
+    if (!address.empty())
+    {
+        gUploadsHandled = 0;
+        RunClients(address, bulkClients, uploadDeadlineMs, seconds, result);
+        result.uploadsHandled = gUploadsHandled;
+
+        int32_t queuedCalls;
+        LVGetServerDispatchStats(&server, &queuedCalls, &result.expiredBeforePosting);
+
+        // Let the handler work off the uploads already posted before the server stops.
+        LVSetServerDrainTimeout(&server, 10000);
+    }
+    LVStopServer(&server);
+    return result;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    int seconds = argc > 1 ? atoi(argv[1]) : 5;
+    int bulkClients = argc > 2 ? atoi(argv[2]) : 16;
+    gUploadWorkUs = argc > 3 ? atoi(argv[3]) : 1000;
+    int uploadDeadlineMs = argc > 4 ? atoi(argv[4]) : 10;
+    std::vector<int> limits;
+    for (int x = 5; x < argc; ++x)
+    {
+        limits.push_back(atoi(argv[x]));
+    }
+    if (limits.empty())
+    {
+        limits = { 0, 1, 2 };
+    }
+
+    auto uploadEvent = lvstub::CreateUserEvent([](grpc_labview::gRPCid* id)
+    {
+        HandleCall(id, gUploadWorkUs);
+        ++gUploadsHandled;
+    });
+    auto controlEvent = lvstub::CreateUserEvent([](grpc_labview::gRPCid* id) { HandleCall(id, 100); });
+    lvstub::StartEventLoop(1);
+
+    std::cout << "bulk clients: " << bulkClients << ", upload work: " << gUploadWorkUs << "us, upload deadline: " << uploadDeadlineMs << "ms" << std::endl;
+    std::cout << std::left << std::setw(8) << "limit"
+        << std::right << std::setw(12) << "uploads ok" << std::setw(12) << "timed out" << std::setw(12) << "handled"
+        << std::setw(12) << "not posted" << std::setw(14) << "control p50" << std::setw(14) << "control p99" << std::endl;
+    bool succeeded = true;
+    for (auto limit : limits)
+    {
+        auto result = RunBenchmark(limit, bulkClients, uploadDeadlineMs, seconds, uploadEvent, controlEvent);
+        succeeded &= result.controlFailures == 0 && result.controlCalls > 0;
+        std::cout << std::left << std::setw(8) << limit
+            << std::right << std::setw(12) << result.uploadsSucceeded
+            << std::setw(12) << result.uploadsExpired
+            << std::setw(12) << result.uploadsHandled
+            << std::setw(12) << result.expiredBeforePosting
+            << std::setw(11) << std::fixed << std::setprecision(2) << result.controlP50Ms << " ms"
+            << std::setw(11) << result.controlP99Ms << " ms"
+            << (result.controlFailures == 0 ? "" : "  " + std::to_string(result.controlFailures) + " CONTROL CALLS FAILED") << std::endl;
+    }
+
+    lvstub::StopEventLoop();
+    return succeeded ? 0 : 1;
+}
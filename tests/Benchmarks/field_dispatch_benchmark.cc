@@ -0,0 +1,168 @@
+//---------------------------------------------------------------------
+// Parse time of messages of different shapes, comparing the table of field
+// parsers compiled when the metadata is finalized with looking each field
+// up in the map of elements and switching on its type.
+//
+// The same messages are registered on two servers, only one of which
+// completes its metadata registration, so the messages of the other are
+// parsed through the map. Each case checks that both parse the same message.
+//
+// Usage: field_dispatch_benchmark [seconds per case]
+//---------------------------------------------------------------------
+#include "benchmark_harness.h"
+#include "lv_runtime_stub.h"
+#include <grpc_server.h>
+#include <lv_message.h>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+using grpc_labview::LVMessageMetadataType;
+
+//---------------------------------------------------------------------
+// Wire format of a message with a value for each of its fields, in the
+// order LVMessage serializes them.
+//---------------------------------------------------------------------
+static std::string EncodeMessage(const std::vector<lvstub::ElementDescription>& elements, const std::string& nested, int nestedCount)
+{
+    std::string encoded;
+    for (auto& element : elements)
+    {
+        switch ((LVMessageMetadataType)element.valueType)
+        {
+        case LVMessageMetadataType::Int32Value:
+            lvbench::AppendTag(encoded, element.protobufIndex, 0);
+            lvbench::AppendVarint(encoded, 1000 + element.protobufIndex % 1000);
+            break;
+        case LVMessageMetadataType::BoolValue:
+            lvbench::AppendTag(encoded, element.protobufIndex, 0);
+            lvbench::AppendVarint(encoded, 1);
+            break;
+        case LVMessageMetadataType::DoubleValue:
+        {
+            double value = element.protobufIndex * 0.25;
+            lvbench::AppendTag(encoded, element.protobufIndex, 1);
+            encoded.append((const char*)&value, sizeof(value));
+            break;
+        }
+        case LVMessageMetadataType::StringValue:
+            lvbench::AppendTag(encoded, element.protobufIndex, 2);
+            lvbench::AppendVarint(encoded, element.fieldName.size());
+            encoded.append(element.fieldName);
+            break;
+        case LVMessageMetadataType::MessageValue:
+            for (int x = 0; x < nestedCount; ++x)
+            {
+                lvbench::AppendTag(encoded, element.protobufIndex, 2);
+                lvbench::AppendVarint(encoded, nested.size());
+                encoded.append(nested);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    return encoded;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+struct MessageShape
+{
+    std::string description;
+    std::string messageName;
+    std::string encoded;
+};
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static bool RunCase(const MessageShape& shape, grpc_labview::gRPCid* mappedServer, grpc_labview::gRPCid* compiledServer, double seconds)
+{
+    auto mappedMetadata = mappedServer->CastTo<grpc_labview::LabVIEWgRPCServer>()->FindMetadata(shape.messageName);
+    auto compiledMetadata = compiledServer->CastTo<grpc_labview::LabVIEWgRPCServer>()->FindMetadata(shape.messageName);
+
+    grpc_labview::LVMessage mappedMessage(mappedMetadata);
+    grpc_labview::LVMessage compiledMessage(compiledMetadata);
+    bool parsed = !mappedMetadata->FieldParsersCompiled() && compiledMetadata->FieldParsersCompiled()
+        && mappedMessage.ParseFromString(shape.encoded) && compiledMessage.ParseFromString(shape.encoded);
+    bool identical = parsed && mappedMessage.SerializeAsString() == shape.encoded && compiledMessage.SerializeAsString() == shape.encoded;
+
+    auto mappedTime = lvbench::Measure(seconds, [&]() { mappedMessage.Clear(); mappedMessage.ParseFromString(shape.encoded); });
+    auto compiledTime = lvbench::Measure(seconds, [&]() { compiledMessage.Clear(); compiledMessage.ParseFromString(shape.encoded); });
+
+    std::cout << std::left << std::setw(28) << shape.description
+        << std::right << std::setw(10) << shape.encoded.size()
+        << std::setw(14) << std::fixed << std::setprecision(3) << mappedTime
+        << std::setw(16) << compiledTime
+        << std::setw(10) << std::setprecision(2) << mappedTime / compiledTime << "x"
+        << (identical ? "" : "  PARSE DIFFERS") << std::endl;
+    return identical;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    double seconds = argc > 1 ? atof(argv[1]) : 1.0;
+
+    std::vector<lvstub::ElementDescription> small = {
+        { "channel", 1, (int)LVMessageMetadataType::Int32Value, false, "" },
+        { "value", 2, (int)LVMessageMetadataType::DoubleValue, false, "" },
+        { "unit", 3, (int)LVMessageMetadataType::StringValue, false, "" },
+        { "valid", 4, (int)LVMessageMetadataType::BoolValue, false, "" }
+    };
+    std::vector<lvstub::ElementDescription> wide;
+    const LVMessageMetadataType wideTypes[] = { LVMessageMetadataType::Int32Value, LVMessageMetadataType::DoubleValue, LVMessageMetadataType::BoolValue, LVMessageMetadataType::StringValue };
+    for (int x = 1; x <= 100; ++x)
+    {
+        wide.push_back({ "field" + std::to_string(x), x, (int)wideTypes[x % 4], false, "" });
+    }
+    std::vector<lvstub::ElementDescription> sparse;
+    for (int x = 0; x < 16; ++x)
+    {
+        sparse.push_back({ "field" + std::to_string(x), 1 + x * 10000, (int)wideTypes[x % 4], false, "" });
+    }
+    std::vector<lvstub::ElementDescription> batch = {
+        { "readings", 1, (int)LVMessageMetadataType::MessageValue, true, "benchmark.Small" },
+        { "source", 2, (int)LVMessageMetadataType::StringValue, false, "" }
+    };
+
+    grpc_labview::gRPCid* mappedServer = nullptr;
+    grpc_labview::gRPCid* compiledServer = nullptr;
+    LVCreateServer(&mappedServer);
+    LVCreateServer(&compiledServer);
+    for (auto server : { &mappedServer, &compiledServer })
+    {
+        lvstub::RegisterMessage(server, "benchmark.Small", small);
+        lvstub::RegisterMessage(server, "benchmark.Wide", wide);
+        lvstub::RegisterMessage(server, "benchmark.Sparse", sparse);
+        lvstub::RegisterMessage(server, "benchmark.Batch", batch);
+    }
+    CompleteMetadataRegistration(&compiledServer);
+
+    auto encodedSmall = EncodeMessage(small, "", 0);
+    std::vector<MessageShape> shapes = {
+        { "small (4 fields)", "benchmark.Small", encodedSmall },
+        { "wide (100 fields)", "benchmark.Wide", EncodeMessage(wide, "", 0) },
+        { "sparse (16 fields)", "benchmark.Sparse", EncodeMessage(sparse, "", 0) },
+        { "nested (100 x 4 fields)", "benchmark.Batch", EncodeMessage(batch, encodedSmall, 100) }
+    };
+
+    std::cout << std::left << std::setw(28) << "message"
+        << std::right << std::setw(10) << "bytes"
+        << std::setw(14) << "map (us)"
+        << std::setw(16) << "table (us)"
+        << std::setw(11) << "speedup" << std::endl;
+
+    bool identical = true;
+    for (auto& shape : shapes)
+    {
+        identical &= RunCase(shape, mappedServer, compiledServer, seconds);
+    }
+    return identical ? 0 : 1;
+}
@@ -0,0 +1,176 @@
+//---------------------------------------------------------------------
+// Unary calls from a labview_grpc_server client to a server in the same
+// process, over loopback TCP, a unix domain socket and an in-process
+// channel (CreateInProcessClient).
+//
+// Both sides are driven through the exported functions the generated VIs
+// use, so the numbers include the cost of the client library itself.
+//
+// Usage: in_process_client_benchmark [seconds] [client threads]
+//---------------------------------------------------------------------
+#include "benchmark_harness.h"
+#include "lv_runtime_stub.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static const char* kEchoMethod = "/benchmark.Benchmark/Echo";
+static const char* kEchoMessage = "benchmark.EchoMessage";
+
+//---------------------------------------------------------------------
+// LabVIEW cluster for benchmark.EchoMessage
+//---------------------------------------------------------------------
+struct EchoCluster
+{
+    int32_t id;
+};
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void HandleEcho(grpc_labview::gRPCid* id)
+{
+    EchoCluster cluster = { 0 };
+    if (GetRequestData(&id, (int8_t*)&cluster) == 0)
+    {
+        SetResponseData(&id, (int8_t*)&cluster);
+    }
+    CloseServerEvent(&id);
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+struct BenchmarkResult
+{
+    uint64_t calls;
+    uint64_t failures;
+    double seconds;
+    double p50Us;
+    double p99Us;
+};
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static BenchmarkResult RunClients(grpc_labview::gRPCid* client, int clientCount, int seconds)
+{
+    lvstub::RegisterMessage(&client, kEchoMessage, {
+        { "id", 1, (int)grpc_labview::LVMessageMetadataType::Int32Value, false, "" }
+    });
+    CompleteMetadataRegistration(&client);
+
+    std::atomic<uint64_t> failures(0);
+    std::atomic<bool> done(false);
+    std::mutex latencyMutex;
+    std::vector<double> latenciesUs;
+
+    std::vector<std::thread> clients;
+    for (int x = 0; x < clientCount; ++x)
+    {
+        clients.emplace_back([&]()
+        {
+            std::vector<double> clientLatenciesUs;
+            grpc_labview::MagicCookie occurrence = 0;
+            EchoCluster request = { 42 };
+            while (!done)
+            {
+                auto start = std::chrono::steady_clock::now();
+                EchoCluster response = { 0 };
+                grpc_labview::gRPCid* context = nullptr;
+                CreateClientContext(&context);
+                grpc_labview::gRPCid* call = nullptr;
+                auto result = ClientUnaryCall(client, &occurrence, kEchoMethod, kEchoMessage, kEchoMessage, (int8_t*)&request, &call, 10000, context);
+                if (result == 0)
+                {
+                    result = CompleteClientUnaryCall2(call, (int8_t*)&response, nullptr, nullptr);
+                }
+                CloseClientContext(context);
+                if (result == 0 && response.id == request.id)
+                {
+                    clientLatenciesUs.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+                }
+                else
+                {
+                    ++failures;
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(latencyMutex);
+            latenciesUs.insert(latenciesUs.end(), clientLatenciesUs.begin(), clientLatenciesUs.end());
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    done = true;
+    for (auto& thread : clients)
+    {
+        thread.join();
+    }
+    CloseClient(client);
+
+    BenchmarkResult result = { latenciesUs.size(), failures, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), 0, 0 };
+    result.p50Us = lvbench::Percentile(latenciesUs, 0.5);
+    result.p99Us = lvbench::Percentile(latenciesUs, 0.99);
+    return result;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void Report(const std::string& transport, const BenchmarkResult& result)
+{
+    std::cout << std::left << std::setw(16) << transport << std::right << std::setw(12) << (uint64_t)(result.calls / result.seconds)
+        << std::fixed << std::setprecision(1) << std::setw(12) << result.p50Us << std::setw(12) << result.p99Us
+        << std::setw(12) << result.failures << std::endl;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    int seconds = argc > 1 ? atoi(argv[1]) : 5;
+    int clientCount = argc > 2 ? atoi(argv[2]) : 1;
+
+    auto echoEvent = lvstub::CreateUserEvent(HandleEcho);
+    lvstub::StartEventLoop(std::max(1, clientCount));
+
+    grpc_labview::gRPCid* server = nullptr;
+    LVCreateServer(&server);
+    lvstub::RegisterMessage(&server, kEchoMessage, {
+        { "id", 1, (int)grpc_labview::LVMessageMetadataType::Int32Value, false, "" }
+    });
+    CompleteMetadataRegistration(&server);
+    RegisterServerEvent(&server, kEchoMethod, &echoEvent, kEchoMessage, kEchoMessage);
+    std::string socketAddress = "unix:in_process_client_benchmark.sock";
+    LVAddServerListeningAddress(&server, socketAddress.c_str());
+
+    auto address = lvbench::StartLocalServer(&server);
+    if (!address.empty())
+    {
+        std::cout << "clients: " << clientCount << ", duration: " << seconds << "s" << std::endl;
+        std::cout << std::left << std::setw(16) << "transport" << std::right << std::setw(12) << "calls/s"
+            << std::setw(12) << "p50 (us)" << std::setw(12) << "p99 (us)" << std::setw(12) << "failures" << std::endl;
+
+        grpc_labview::gRPCid* client = nullptr;
+        CreateClient(address.c_str(), "", &client);
+        Report("tcp", RunClients(client, clientCount, seconds));
+
+        CreateClient(socketAddress.c_str(), "", &client);
+        Report("unix socket", RunClients(client, clientCount, seconds));
+
+        if (CreateInProcessClient(&server, &client) == 0)
+        {
+            Report("in-process", RunClients(client, clientCount, seconds));
+        }
+    }
+    LVStopServer(&server);
+    lvstub::StopEventLoop();
+    return 0;
+}
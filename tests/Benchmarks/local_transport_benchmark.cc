@@ -0,0 +1,101 @@
+//---------------------------------------------------------------------
+// Latency of small unary calls to labview_grpc_server over loopback TCP
+// compared to unix domain sockets.
+//
+// A single server listens on every address, the clients call each address
+// in turn. Addresses are given the way gRPC takes them, for example
+// unix:/tmp/benchmark.sock or unix-abstract:benchmark. The TCP listener on
+// 127.0.0.1 is always measured first.
+//
+// Usage: local_transport_benchmark [seconds] [client threads] [addresses...]
+//---------------------------------------------------------------------
+#include "benchmark_harness.h"
+#include "lv_runtime_stub.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static const char* kEchoMethod = "/benchmark.Benchmark/Echo";
+static const char* kEchoMessage = "benchmark.EchoMessage";
+
+//---------------------------------------------------------------------
+// LabVIEW cluster for benchmark.EchoMessage
+//---------------------------------------------------------------------
+struct EchoCluster
+{
+    int32_t id;
+};
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void HandleEcho(grpc_labview::gRPCid* id)
+{
+    EchoCluster cluster = { 0 };
+    if (GetRequestData(&id, (int8_t*)&cluster) == 0)
+    {
+        SetResponseData(&id, (int8_t*)&cluster);
+    }
+    CloseServerEvent(&id);
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    int seconds = argc > 1 ? atoi(argv[1]) : 5;
+    int clientCount = argc > 2 ? atoi(argv[2]) : 1;
+    std::vector<std::string> localAddresses;
+    for (int x = 3; x < argc; ++x)
+    {
+        localAddresses.push_back(argv[x]);
+    }
+    if (localAddresses.empty())
+    {
+        localAddresses.push_back("unix:local_transport_benchmark.sock");
+#ifdef __linux__
+        localAddresses.push_back("unix-abstract:local_transport_benchmark");
+#endif
+    }
+
+    auto echoEvent = lvstub::CreateUserEvent(HandleEcho);
+    lvstub::StartEventLoop(std::max(1, clientCount));
+
+    grpc_labview::gRPCid* server = nullptr;
+    LVCreateServer(&server);
+    lvstub::RegisterMessage(&server, kEchoMessage, {
+        { "id", 1, (int)grpc_labview::LVMessageMetadataType::Int32Value, false, "" }
+    });
+    CompleteMetadataRegistration(&server);
+    RegisterServerEvent(&server, kEchoMethod, &echoEvent, kEchoMessage, kEchoMessage);
+    for (auto& address : localAddresses)
+    {
+        LVAddServerListeningAddress(&server, address.c_str());
+    }
+
+    auto address = lvbench::StartLocalServer(&server);
+    if (!address.empty())
+    {
+        std::vector<std::string> addresses = { address };
+        addresses.insert(addresses.end(), localAddresses.begin(), localAddresses.end());
+
+        std::cout << "clients: " << clientCount << ", duration: " << seconds << "s" << std::endl;
+        std::cout << std::left << std::setw(44) << "address" << std::right << std::setw(12) << "calls/s"
+            << std::setw(12) << "p50 (us)" << std::setw(12) << "p99 (us)" << std::setw(12) << "failures" << std::endl;
+        auto request = lvbench::CreateByteBuffer({ 0x08, 0x2A });
+        for (auto& target : addresses)
+        {
+            auto result = lvbench::RunClients(target, clientCount, seconds, kEchoMethod, [&request](int, uint64_t) { return request; });
+            std::cout << std::left << std::setw(44) << target << std::right << std::setw(12) << (uint64_t)(result.calls / result.seconds)
+                << std::fixed << std::setprecision(1) << std::setw(12) << result.p50Us << std::setw(12) << result.p99Us
+                << std::setw(12) << result.failures << std::endl;
+        }
+    }
+    LVStopServer(&server);
+    lvstub::StopEventLoop();
+    return 0;
+}
@@ -0,0 +1,351 @@
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+#include "lv_runtime_stub.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    struct PendingEvent
+    {
+        grpc_labview::LVUserEventRef ref;
+        grpc_labview::gRPCid* id;
+    };
+
+    std::mutex gEventMutex;
+    std::condition_variable gEventAvailable;
+    std::deque<PendingEvent> gPendingEvents;
+    std::map<grpc_labview::LVUserEventRef, lvstub::EventHandler> gEventHandlers;
+    std::vector<std::thread> gEventThreads;
+    grpc_labview::LVUserEventRef gNextEventRef = 1;
+    bool gEventLoopRunning = false;
+    std::atomic<int64_t> gLiveHandles(0);
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    size_t ElementSizeForTypeCode(int32_t typeCode)
+    {
+        switch (typeCode)
+        {
+        case 0x01: // iB
+        case 0x05: // uB
+            return 1;
+        case 0x02: // iW
+        case 0x06: // uW
+            return 2;
+        case 0x03: // iL
+        case 0x07: // uL
+        case 0x09: // fS
+            return 4;
+        default:
+            return 8;
+        }
+    }
+
+    //---------------------------------------------------------------------
+    // Same padding rules as grpc_labview::AlignClusterOffset which is not
+    // exported from the library.
+    //---------------------------------------------------------------------
+    size_t AlignOffset(size_t offset, size_t alignment)
+    {
+#ifndef _PS_4
+        auto remainder = offset % alignment;
+        return remainder == 0 ? offset : offset + alignment - remainder;
+#else
+        return offset;
+#endif
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void** AllocateHandle(size_t size)
+    {
+        auto handle = (void**)malloc(sizeof(void*));
+        *handle = calloc(1, size == 0 ? 1 : size);
+        ++gLiveHandles;
+        return handle;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void ResizeHandle(void** handle, size_t size)
+    {
+        *handle = realloc(*handle, size == 0 ? 1 : size);
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void RunEventLoop()
+    {
+        while (true)
+        {
+            PendingEvent event;
+            lvstub::EventHandler handler;
+            {
+                std::unique_lock<std::mutex> lock(gEventMutex);
+                gEventAvailable.wait(lock, [] { return !gPendingEvents.empty() || !gEventLoopRunning; });
+                if (gPendingEvents.empty())
+                {
+                    return;
+                }
+                event = gPendingEvents.front();
+                gPendingEvents.pop_front();
+                handler = gEventHandlers[event.ref];
+            }
+            if (handler)
+            {
+                handler(event.id);
+            }
+        }
+    }
+}
+
+//---------------------------------------------------------------------
+// LabVIEW runtime entry points looked up by lv_interop.cc
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int NumericArrayResize(int32_t typeCode, int32_t numDims, void* handle, size_t size)
+{
+    auto elementSize = ElementSizeForTypeCode(typeCode);
+    auto headerSize = AlignOffset(4 * numDims, elementSize);
+    auto bytes = headerSize + size * elementSize;
+    auto lvHandle = (void***)handle;
+    if (*lvHandle == nullptr)
+    {
+        *lvHandle = AllocateHandle(bytes);
+    }
+    else
+    {
+        ResizeHandle(*lvHandle, bytes);
+    }
+    return 0;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int PostLVUserEvent(grpc_labview::LVUserEventRef ref, void* data)
+{
+    {
+        std::lock_guard<std::mutex> lock(gEventMutex);
+        gPendingEvents.push_back({ ref, *(grpc_labview::gRPCid**)data });
+    }
+    gEventAvailable.notify_one();
+    return 0;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int Occur(grpc_labview::MagicCookie occurrence)
+{
+    return 0;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int32_t RTSetCleanupProc(grpc_labview::CleanupProcPtr cleanUpProc, grpc_labview::gRPCid* id, int32_t mode)
+{
+    return 0;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+LIBRARY_EXPORT unsigned char** DSNewHandle(size_t n)
+{
+    return (unsigned char**)AllocateHandle(n);
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+LIBRARY_EXPORT int DSSetHandleSize(void* h, size_t n)
+{
+    ResizeHandle((void**)h, n);
+    return 0;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+LIBRARY_EXPORT long DSDisposeHandle(void* h)
+{
+    if (h != nullptr)
+    {
+        free(*(void**)h);
+        free(h);
+        --gLiveHandles;
+    }
+    return 0;
+}
+
+namespace lvstub
+{
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void ResizeLVClusterArray(grpc_labview::LV1DArrayHandle* array, int32_t count, int32_t clusterSize, int32_t alignment)
+    {
+        int32_t previousCount = *array == nullptr ? 0 : (**array)->cnt;
+        auto typeCode = alignment == 1 ? 0x01 : alignment == 2 ? 0x02 : alignment == 4 ? 0x03 : 0x04;
+        auto elements = (count * clusterSize + alignment - 1) / alignment;
+        ::NumericArrayResize(typeCode, 1, array, elements);
+        if (previousCount < count)
+        {
+            memset(GetLVClusterArrayElement(*array, previousCount, clusterSize, alignment), 0, (count - previousCount) * clusterSize);
+        }
+        (**array)->cnt = count;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    int8_t* GetLVClusterArrayElement(grpc_labview::LV1DArrayHandle array, int32_t index, int32_t clusterSize, int32_t alignment)
+    {
+        return (*array)->rawBytes + AlignOffset(4, alignment) - 4 + index * clusterSize;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void DisposeLVArray(grpc_labview::LV1DArrayHandle array)
+    {
+        ::DSDisposeHandle(array);
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    grpc_labview::LStrHandle CreateLVString(const std::string& value)
+    {
+        grpc_labview::LStrHandle handle = nullptr;
+        ::NumericArrayResize(0x01, 1, &handle, value.length());
+        (*handle)->cnt = (int32_t)value.length();
+        memcpy((*handle)->str, value.c_str(), value.length());
+        return handle;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    std::string GetLVString(grpc_labview::LStrHandle value)
+    {
+        if (value == nullptr || *value == nullptr)
+        {
+            return std::string();
+        }
+        return std::string((*value)->str, (*value)->cnt);
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void DisposeLVString(grpc_labview::LStrHandle value)
+    {
+        ::DSDisposeHandle(value);
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    int32_t RegisterMessage(grpc_labview::gRPCid** owner, const std::string& messageName, const std::vector<ElementDescription>& elements)
+    {
+        grpc_labview::LV1DArrayHandle lvElements = nullptr;
+        auto dataOffset = AlignOffset(4, alignof(grpc_labview::LVMessageElementMetadata));
+        ::NumericArrayResize(0x01, 1, &lvElements, dataOffset - 4 + sizeof(grpc_labview::LVMessageElementMetadata) * elements.size());
+        (*lvElements)->cnt = (int32_t)elements.size();
+        auto firstElement = (grpc_labview::LVMessageElementMetadata*)((int8_t*)*lvElements + dataOffset);
+        auto lvElement = firstElement;
+        for (auto& element : elements)
+        {
+            lvElement->fieldName = CreateLVString(element.fieldName);
+            lvElement->embeddedMessageName = CreateLVString(element.embeddedMessageName);
+            lvElement->protobufIndex = element.protobufIndex;
+            lvElement->valueType = element.valueType;
+            lvElement->isRepeated = element.isRepeated;
+            lvElement->isInOneof = element.isInOneof;
+            lvElement->oneofContainerName = CreateLVString(element.oneofContainerName);
+            ++lvElement;
+        }
+
+        grpc_labview::LVMessageMetadata2 lvMetadata;
+        lvMetadata.version = 2;
+        lvMetadata.messageName = CreateLVString(messageName);
+        lvMetadata.typeUrl = CreateLVString(messageName);
+        lvMetadata.elements = lvElements;
+        auto result = RegisterMessageMetadata2(owner, &lvMetadata);
+
+        lvElement = firstElement;
+        for (size_t x = 0; x < elements.size(); ++x, ++lvElement)
+        {
+            DisposeLVString(lvElement->fieldName);
+            DisposeLVString(lvElement->embeddedMessageName);
+            DisposeLVString(lvElement->oneofContainerName);
+        }
+        ::DSDisposeHandle(lvElements);
+        DisposeLVString(lvMetadata.messageName);
+        DisposeLVString(lvMetadata.typeUrl);
+        return result;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    int32_t RegisterEnum(grpc_labview::gRPCid** owner, const std::string& enumName, const std::string& elements)
+    {
+        grpc_labview::LVEnumMetadata2 lvMetadata;
+        lvMetadata.version = 2;
+        lvMetadata.messageName = CreateLVString(enumName);
+        lvMetadata.typeUrl = CreateLVString(enumName);
+        lvMetadata.elements = CreateLVString(elements);
+        lvMetadata.allowAlias = false;
+        auto result = RegisterEnumMetadata2(owner, &lvMetadata);
+
+        DisposeLVString(lvMetadata.messageName);
+        DisposeLVString(lvMetadata.typeUrl);
+        DisposeLVString(lvMetadata.elements);
+        return result;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    int64_t LiveHandleCount()
+    {
+        return gLiveHandles;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    grpc_labview::LVUserEventRef CreateUserEvent(EventHandler handler)
+    {
+        std::lock_guard<std::mutex> lock(gEventMutex);
+        auto ref = gNextEventRef++;
+        gEventHandlers[ref] = handler;
+        return ref;
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void StartEventLoop(int threadCount)
+    {
+        {
+            std::lock_guard<std::mutex> lock(gEventMutex);
+            gEventLoopRunning = true;
+        }
+        for (int x = 0; x < threadCount; ++x)
+        {
+            gEventThreads.emplace_back(RunEventLoop);
+        }
+    }
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    void StopEventLoop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(gEventMutex);
+            gEventLoopRunning = false;
+        }
+        gEventAvailable.notify_all();
+        for (auto& thread : gEventThreads)
+        {
+            thread.join();
+        }
+        gEventThreads.clear();
+    }
+}
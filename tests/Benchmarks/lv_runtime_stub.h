@@ -0,0 +1,121 @@
+//---------------------------------------------------------------------
+// Minimal stand-in for the LabVIEW runtime used by the benchmarks.
+//
+// labview_grpc_server resolves its LabVIEW callbacks (NumericArrayResize,
+// PostLVUserEvent, DSNewHandle, ...) from the hosting process at runtime.
+// This file provides those entry points so that the library can be driven
+// from a plain C++ executable. Benchmark executables must be linked with
+// exported symbols (ENABLE_EXPORTS / -rdynamic) for the lookup to succeed.
+//---------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+#include <lv_interop.h>
+#include <message_metadata.h>
+#include <enum_metadata.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+//---------------------------------------------------------------------
+// Exported functions of labview_grpc_server used by the benchmarks.
+//---------------------------------------------------------------------
+extern "C"
+{
+    int32_t LVCreateServer(grpc_labview::gRPCid** id);
+    int32_t LVStartServer(char* address, char* serverCertificatePath, char* serverKeyPath, grpc_labview::gRPCid** id);
+    int32_t LVGetServerListeningPort(grpc_labview::gRPCid** id, int* listeningPort);
+    int32_t LVAddServerListeningAddress(grpc_labview::gRPCid** id, const char* address);
+    int32_t LVSetServerCompletionQueueCount(grpc_labview::gRPCid** id, int32_t completionQueueCount);
+    int32_t LVSetServerPendingCallCount(grpc_labview::gRPCid** id, int32_t pendingCallCount);
+    int32_t LVSetServerWriteQueueDepth(grpc_labview::gRPCid** id, int32_t writeQueueDepth);
+    int32_t LVSetServerReadAheadDepth(grpc_labview::gRPCid** id, int32_t readAheadDepth);
+    int32_t LVGetServerPendingCallStats(grpc_labview::gRPCid** id, int32_t* pendingCalls, uint64_t* acceptedCalls, uint64_t* pendingCallsExhausted);
+    int32_t LVSetServerConcurrencyLimit(grpc_labview::gRPCid** id, int32_t limit);
+    int32_t LVSetServerMethodConcurrencyLimit(grpc_labview::gRPCid** id, const char* methodName, int32_t limit);
+    int32_t LVGetServerConcurrencyStats(grpc_labview::gRPCid** id, int32_t* inFlight, uint64_t* rejected);
+    int32_t LVGetServerMethodConcurrencyStats(grpc_labview::gRPCid** id, const char* methodName, int32_t* inFlight, uint64_t* rejected);
+    int32_t LVSetServerMethodAdaptiveConcurrency(grpc_labview::gRPCid** id, const char* methodName, int32_t minLimit, int32_t maxLimit, double targetDelayMs);
+    int32_t LVGetServerMethodAdaptiveConcurrencyStats(grpc_labview::gRPCid** id, const char* methodName, int32_t* limit, double* minLatencyMs, double* smoothedLatencyMs, uint64_t* samples, uint64_t* decreases);
+    int32_t LVSetServerDispatchLimit(grpc_labview::gRPCid** id, int32_t limit);
+    int32_t LVSetServerMethodPriority(grpc_labview::gRPCid** id, const char* methodName, int32_t priority);
+    int32_t LVSetServerCompression(grpc_labview::gRPCid** id, int32_t algorithm, int32_t minBytes);
+    int32_t LVSetServerMethodCompression(grpc_labview::gRPCid** id, const char* methodName, int32_t algorithm, int32_t minBytes);
+    int32_t LVSetServerMethodResponseCache(grpc_labview::gRPCid** id, const char* methodName, int32_t maxBytes, int32_t timeToLiveMs);
+    int32_t LVGetServerMethodResponseCacheStats(grpc_labview::gRPCid** id, const char* methodName, uint64_t* hits, uint64_t* misses, int32_t* entries, uint64_t* bytes);
+    int32_t LVClearServerMethodResponseCache(grpc_labview::gRPCid** id, const char* methodName);
+    int32_t LVSetServerMethodSingleFlight(grpc_labview::gRPCid** id, const char* methodName, int32_t enabled);
+    int32_t LVGetServerMethodSingleFlightStats(grpc_labview::gRPCid** id, const char* methodName, uint64_t* handledCalls, uint64_t* coalescedCalls);
+    int32_t LVGetServerDispatchStats(grpc_labview::gRPCid** id, int32_t* queuedCalls, uint64_t* expiredCalls);
+    int32_t LVGetServerMethodStats(grpc_labview::gRPCid** id, const char* methodName, int32_t metric, uint64_t* count, double* mean, double* p50, double* p90, double* p99, double* p999, double* max);
+    int32_t LVResetServerMethodStats(grpc_labview::gRPCid** id, const char* methodName);
+    int32_t LVResetServerStats(grpc_labview::gRPCid** id);
+    int32_t LVSetServerStatsServiceEnabled(grpc_labview::gRPCid** id, int32_t enabled);
+    int32_t LVGetServerCallPoolStats(grpc_labview::gRPCid** id, uint64_t* heapAllocations, uint64_t* reusedAllocations);
+    int32_t LVSetServerDrainTimeout(grpc_labview::gRPCid** id, int32_t timeoutMs);
+    int32_t LVSetServerDrainEvent(grpc_labview::gRPCid** id, grpc_labview::LVUserEventRef* item);
+    int32_t LVStopServer(grpc_labview::gRPCid** id);
+    int32_t RegisterMessageMetadata2(grpc_labview::gRPCid** id, grpc_labview::LVMessageMetadata2* lvMetadata);
+    int32_t RegisterEnumMetadata2(grpc_labview::gRPCid** id, grpc_labview::LVEnumMetadata2* lvMetadata);
+    int32_t CompleteMetadataRegistration(grpc_labview::gRPCid** id);
+    int32_t RegisterServerEvent(grpc_labview::gRPCid** id, const char* name, grpc_labview::LVUserEventRef* item, const char* requestMessageName, const char* responseMessageName);
+    int32_t GetRequestData(grpc_labview::gRPCid** id, int8_t* lvRequest);
+    int32_t SetResponseData(grpc_labview::gRPCid** id, int8_t* lvRequest);
+    int32_t GetRequestDataBatch(grpc_labview::gRPCid** id, grpc_labview::LV1DArrayHandle* lvRequests, int32_t maxCount, int32_t* count);
+    int32_t SetResponseDataBatch(grpc_labview::gRPCid** id, grpc_labview::LV1DArrayHandle* lvResponses);
+    int32_t CloseServerEvent(grpc_labview::gRPCid** id);
+    int32_t IsCancelled(grpc_labview::gRPCid** id);
+    int32_t CreateClient(const char* address, const char* certificatePath, grpc_labview::gRPCid** clientId);
+    int32_t CreateInProcessClient(grpc_labview::gRPCid** serverId, grpc_labview::gRPCid** clientId);
+    int32_t CloseClient(grpc_labview::gRPCid* clientId);
+    int32_t CreateClientContext(grpc_labview::gRPCid** contextId);
+    int32_t SetClientContextCompression(grpc_labview::gRPCid* contextId, int32_t algorithm, int32_t minBytes);
+    int32_t CloseClientContext(grpc_labview::gRPCid* contextId);
+    int32_t ClientUnaryCall(grpc_labview::gRPCid* clientId, grpc_labview::MagicCookie* occurrence, const char* methodName, const char* requestMessageName, const char* responseMessageName, int8_t* requestCluster, grpc_labview::gRPCid** callId, int32_t timeoutMs, grpc_labview::gRPCid* contextId);
+    int32_t CompleteClientUnaryCall2(grpc_labview::gRPCid* callId, int8_t* responseCluster, grpc_labview::LStrHandle* errorMessage, grpc_labview::AnyCluster* errorDetailsCluster);
+}
+
+namespace lvstub
+{
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    struct ElementDescription
+    {
+        std::string fieldName;
+        int protobufIndex;
+        int valueType;
+        bool isRepeated;
+        std::string embeddedMessageName;
+        bool isInOneof = false;
+        std::string oneofContainerName;
+    };
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    using EventHandler = std::function<void(grpc_labview::gRPCid* id)>;
+
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    grpc_labview::LStrHandle CreateLVString(const std::string& value);
+    std::string GetLVString(grpc_labview::LStrHandle value);
+    void DisposeLVString(grpc_labview::LStrHandle value);
+
+    // Arrays of clusters laid out the way the library reads and writes them, new clusters are zeroed.
+    void ResizeLVClusterArray(grpc_labview::LV1DArrayHandle* array, int32_t count, int32_t clusterSize, int32_t alignment);
+    int8_t* GetLVClusterArrayElement(grpc_labview::LV1DArrayHandle array, int32_t index, int32_t clusterSize, int32_t alignment);
+    void DisposeLVArray(grpc_labview::LV1DArrayHandle array);
+
+    // Number of handles allocated through the runtime and not yet disposed, to check for leaks.
+    int64_t LiveHandleCount();
+
+    // Registers a message with the given server (or client) the same way Register Message Metadata.vi does.
+    int32_t RegisterMessage(grpc_labview::gRPCid** owner, const std::string& messageName, const std::vector<ElementDescription>& elements);
+    // Registers an enum from its NAME=value;... list, the LabVIEW values are the positions in the list.
+    int32_t RegisterEnum(grpc_labview::gRPCid** owner, const std::string& enumName, const std::string& elements);
+
+    // Creates a user event whose occurrences are dispatched to handler on one of the event loop threads.
+    grpc_labview::LVUserEventRef CreateUserEvent(EventHandler handler);
+    void StartEventLoop(int threadCount);
+    void StopEventLoop();
+}
@@ -0,0 +1,312 @@
+//---------------------------------------------------------------------
+// Heap allocations and time per message of the LVMessage field storage
+// for a wide message: parsing, copying from and to the LabVIEW cluster
+// and serializing. Then for a batch of nested messages with repeated
+// fields, whose values go either to the heap or to an arena owned by the
+// message, as for the request and response of a call.
+//
+// Global operator new is replaced to count every allocation made while a
+// case runs. Each case checks that the LVMessage serializes to the same
+// bytes as the ClusterSerializer writes straight from the cluster.
+//
+// Usage: message_storage_benchmark [iterations per case] [fields] [batch readings]
+//---------------------------------------------------------------------
+#include "benchmark_harness.h"
+#include "lv_runtime_stub.h"
+#include <cluster_copier.h>
+#include <cluster_serializer.h>
+#include <grpc_server.h>
+#include <lv_message.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static std::atomic<uint64_t> gAllocations(0);
+
+void* operator new(size_t size)
+{
+    ++gAllocations;
+    auto block = malloc(size == 0 ? 1 : size);
+    if (block == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return block;
+}
+
+void operator delete(void* block) noexcept
+{
+    free(block);
+}
+
+void operator delete(void* block, size_t size) noexcept
+{
+    free(block);
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+using grpc_labview::LVMessageMetadataType;
+
+//---------------------------------------------------------------------
+// Fills every field of the cluster with a value that depends on the field
+//---------------------------------------------------------------------
+static void FillCluster(const grpc_labview::MessageMetadata& metadata, int8_t* cluster)
+{
+    for (auto& element : metadata._elements)
+    {
+        auto start = cluster + element->clusterOffset;
+        auto index = element->protobufIndex;
+        switch (element->type)
+        {
+        case LVMessageMetadataType::Int32Value:
+        case LVMessageMetadataType::SInt32Value:
+            *(int32_t*)start = index * -1000;
+            break;
+        case LVMessageMetadataType::UInt32Value:
+        case LVMessageMetadataType::Fixed32Value:
+            *(uint32_t*)start = index * 1000;
+            break;
+        case LVMessageMetadataType::Int64Value:
+            *(int64_t*)start = (int64_t)index << 33;
+            break;
+        case LVMessageMetadataType::UInt64Value:
+            *(uint64_t*)start = (uint64_t)index << 40;
+            break;
+        case LVMessageMetadataType::FloatValue:
+            *(float*)start = index * 0.5f;
+            break;
+        case LVMessageMetadataType::DoubleValue:
+            *(double*)start = index * 1.25;
+            break;
+        case LVMessageMetadataType::BoolValue:
+            *(bool*)start = (index % 2) == 0;
+            break;
+        case LVMessageMetadataType::StringValue:
+            *(grpc_labview::LStrHandle*)start = lvstub::CreateLVString("field value " + std::to_string(index));
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+//---------------------------------------------------------------------
+// Wire format of benchmark.Batch with the given number of readings
+//---------------------------------------------------------------------
+static std::string EncodeBatch(int readingCount)
+{
+    std::string encoded;
+    for (int x = 0; x < readingCount; ++x)
+    {
+        std::string reading;
+        lvbench::AppendVarint(reading, 0x08);
+        lvbench::AppendVarint(reading, x);
+        double value = x * 0.25;
+        reading.push_back(0x11);
+        reading.append((const char*)&value, sizeof(value));
+        lvbench::AppendLengthDelimited(reading, 3, "volts");
+        double samples[8];
+        for (int y = 0; y < 8; ++y)
+        {
+            samples[y] = x + y * 0.125;
+        }
+        lvbench::AppendLengthDelimited(reading, 4, std::string((const char*)samples, sizeof(samples)));
+        lvbench::AppendLengthDelimited(encoded, 1, reading);
+    }
+    lvbench::AppendLengthDelimited(encoded, 2, "bench rack 1");
+    return encoded;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+struct CaseResult
+{
+    double allocations;
+    double timeUs;
+};
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static CaseResult Measure(int iterations, const std::function<void()>& operation)
+{
+    auto allocations = gAllocations.load();
+    auto start = std::chrono::steady_clock::now();
+    for (int x = 0; x < iterations; ++x)
+    {
+        operation();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    CaseResult result;
+    result.allocations = (double)(gAllocations.load() - allocations) / iterations;
+    result.timeUs = std::chrono::duration<double, std::micro>(elapsed).count() / iterations;
+    return result;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void PrintResult(const std::string& name, const CaseResult& result, bool identical)
+{
+    std::cout << std::left << std::setw(36) << name
+        << std::right << std::fixed << std::setprecision(1) << std::setw(14) << result.allocations
+        << std::setprecision(2) << std::setw(14) << result.timeUs
+        << (identical ? "" : "  OUTPUT DIFFERS") << std::endl;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 200000;
+    int fieldCount = argc > 2 ? atoi(argv[2]) : 50;
+    int readingCount = argc > 3 ? atoi(argv[3]) : 100;
+
+    grpc_labview::gRPCid* serverId = nullptr;
+    LVCreateServer(&serverId);
+
+    // Nine scalars for every string, the mix of a typical instrument reading
+    const int fieldTypes[] = {
+        (int)LVMessageMetadataType::Int32Value,
+        (int)LVMessageMetadataType::DoubleValue,
+        (int)LVMessageMetadataType::Int64Value,
+        (int)LVMessageMetadataType::BoolValue,
+        (int)LVMessageMetadataType::FloatValue,
+        (int)LVMessageMetadataType::UInt32Value,
+        (int)LVMessageMetadataType::UInt64Value,
+        (int)LVMessageMetadataType::SInt32Value,
+        (int)LVMessageMetadataType::Fixed32Value,
+        (int)LVMessageMetadataType::StringValue };
+    std::vector<lvstub::ElementDescription> elements;
+    for (int x = 0; x < fieldCount; ++x)
+    {
+        elements.push_back({ "field" + std::to_string(x + 1), x + 1, fieldTypes[x % 10], false, "" });
+    }
+    lvstub::RegisterMessage(&serverId, "benchmark.WideMessage", elements);
+    lvstub::RegisterMessage(&serverId, "benchmark.Reading", {
+        { "channel", 1, (int)LVMessageMetadataType::Int32Value, false, "" },
+        { "value", 2, (int)LVMessageMetadataType::DoubleValue, false, "" },
+        { "unit", 3, (int)LVMessageMetadataType::StringValue, false, "" },
+        { "samples", 4, (int)LVMessageMetadataType::DoubleValue, true, "" }
+    });
+    lvstub::RegisterMessage(&serverId, "benchmark.Batch", {
+        { "readings", 1, (int)LVMessageMetadataType::MessageValue, true, "benchmark.Reading" },
+        { "source", 2, (int)LVMessageMetadataType::StringValue, false, "" }
+    });
+    CompleteMetadataRegistration(&serverId);
+    auto metadata = serverId->CastTo<grpc_labview::LabVIEWgRPCServer>()->FindMetadata("benchmark.WideMessage");
+
+    std::vector<uint64_t> storage(metadata->clusterSize / sizeof(uint64_t) + 1, 0);
+    auto cluster = (int8_t*)storage.data();
+    FillCluster(*metadata, cluster);
+    std::vector<uint64_t> targetStorage(metadata->clusterSize / sizeof(uint64_t) + 1, 0);
+    auto target = (int8_t*)targetStorage.data();
+
+    grpc_labview::ClusterSerializer serializer(metadata, cluster);
+    std::string encoded(serializer.ByteSizeLong(), '\0');
+    google::protobuf::io::EpsCopyOutputStream stream((uint8_t*)&encoded[0], (int)encoded.size(), false);
+    serializer.Serialize((uint8_t*)&encoded[0], &stream);
+
+    std::cout << "fields: " << fieldCount << ", message: " << encoded.size() << " bytes, iterations: " << iterations << std::endl;
+    std::cout << std::left << std::setw(36) << "case"
+        << std::right << std::setw(14) << "allocations" << std::setw(14) << "time (us)" << std::endl;
+
+    bool allIdentical = true;
+
+    grpc_labview::LVMessage parsed(metadata);
+    bool identical = parsed.ParseFromString(encoded) && parsed.SerializeAsString() == encoded;
+    allIdentical &= identical;
+    PrintResult("parse", Measure(iterations, [&]()
+        {
+            grpc_labview::LVMessage message(metadata);
+            message.ParseFromString(encoded);
+        }), identical);
+    PrintResult("parse into reused message", Measure(iterations, [&]()
+        {
+            parsed.ParseFromString(encoded);
+        }), identical);
+
+    grpc_labview::LVMessage copied(metadata);
+    grpc_labview::ClusterDataCopier::CopyFromCluster(copied, cluster);
+    identical = copied.SerializeAsString() == encoded;
+    allIdentical &= identical;
+    PrintResult("copy from cluster", Measure(iterations, [&]()
+        {
+            grpc_labview::LVMessage message(metadata);
+            grpc_labview::ClusterDataCopier::CopyFromCluster(message, cluster);
+        }), identical);
+    PrintResult("copy from cluster, reused", Measure(iterations, [&]()
+        {
+            grpc_labview::ClusterDataCopier::CopyFromCluster(copied, cluster);
+        }), identical);
+
+    grpc_labview::ClusterDataCopier::CopyToCluster(parsed, target);
+    grpc_labview::ClusterSerializer targetSerializer(metadata, target);
+    identical = targetSerializer.ByteSizeLong() == encoded.size();
+    allIdentical &= identical;
+    PrintResult("copy to cluster", Measure(iterations, [&]()
+        {
+            grpc_labview::ClusterDataCopier::CopyToCluster(parsed, target);
+        }), identical);
+
+    std::string output;
+    auto serializeResult = Measure(iterations, [&]()
+        {
+            output.clear();
+            parsed.SerializeToString(&output);
+        });
+    identical = output == encoded;
+    allIdentical &= identical;
+    PrintResult("serialize", serializeResult, identical);
+
+    auto batchMetadata = serverId->CastTo<grpc_labview::LabVIEWgRPCServer>()->FindMetadata("benchmark.Batch");
+    auto batch = EncodeBatch(readingCount);
+    // About as long per case as the wide message cases
+    int batchIterations = std::max(1, (int)(iterations * encoded.size() / batch.size()));
+    std::cout << std::endl << "batch readings: " << readingCount << ", message: " << batch.size() << " bytes" << std::endl;
+
+    for (auto ownArena : { false, true })
+    {
+        std::string suffix = ownArena ? ", own arena" : ", heap";
+        grpc_labview::LVMessage reused(batchMetadata);
+        if (ownArena)
+        {
+            reused.UseOwnArena();
+        }
+        identical = reused.ParseFromString(batch) && reused.SerializeAsString() == batch;
+        allIdentical &= identical;
+        PrintResult("parse batch" + suffix, Measure(batchIterations, [&]()
+            {
+                grpc_labview::LVMessage message(batchMetadata);
+                if (ownArena)
+                {
+                    message.UseOwnArena();
+                }
+                message.ParseFromString(batch);
+            }), identical);
+        PrintResult("parse batch, reused" + suffix, Measure(batchIterations, [&]()
+            {
+                reused.ParseFromString(batch);
+            }), identical);
+
+        std::vector<uint64_t> batchStorage(batchMetadata->clusterSize / sizeof(uint64_t) + 1, 0);
+        auto batchCluster = (int8_t*)batchStorage.data();
+        grpc_labview::ClusterDataCopier::CopyToCluster(reused, batchCluster);
+        grpc_labview::ClusterDataCopier::CopyFromCluster(reused, batchCluster);
+        identical = reused.SerializeAsString() == batch;
+        allIdentical &= identical;
+        PrintResult("copy batch from cluster" + suffix, Measure(batchIterations, [&]()
+            {
+                grpc_labview::ClusterDataCopier::CopyFromCluster(reused, batchCluster);
+            }), identical);
+    }
+    return allIdentical ? 0 : 1;
+}
@@ -0,0 +1,141 @@
+//---------------------------------------------------------------------
+// Throughput of a lookup method of labview_grpc_server with and without
+// its response cache.
+//
+// Clients ask for the calibration of one of a fixed set of channels, the
+// handler takes a fixed time to look it up. With the cache only the first
+// request of every channel, and the first after its entry expired, reaches
+// the handler.
+//
+// Usage: response_cache_benchmark [seconds] [client threads] [handling (us)] [channels] [time to live (ms)]
+//---------------------------------------------------------------------
+#include "benchmark_harness.h"
+#include "lv_runtime_stub.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static const char* kLookupMethod = "/benchmark.Benchmark/GetCalibration";
+static const char* kRequestMessage = "benchmark.CalibrationRequest";
+static const char* kResponseMessage = "benchmark.Calibration";
+
+//---------------------------------------------------------------------
+// LabVIEW clusters for benchmark.CalibrationRequest and benchmark.Calibration
+//---------------------------------------------------------------------
+struct RequestCluster
+{
+    int32_t channel;
+};
+
+struct CalibrationCluster
+{
+    int32_t channel;
+    double gain;
+    double offset;
+};
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static int gHandlingUs = 500;
+static std::atomic<uint64_t> gHandled(0);
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void HandleLookup(grpc_labview::gRPCid* id)
+{
+    RequestCluster request = { 0 };
+    if (GetRequestData(&id, (int8_t*)&request) == 0)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(gHandlingUs));
+        CalibrationCluster response = { request.channel, 1.0 + request.channel / 1000.0, -0.002 * request.channel };
+        SetResponseData(&id, (int8_t*)&response);
+        ++gHandled;
+    }
+    CloseServerEvent(&id);
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+struct BenchmarkResult
+{
+    lvbench::LoadResult load;
+    uint64_t handled;
+    uint64_t hits;
+    uint64_t misses;
+};
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static BenchmarkResult RunBenchmark(bool cached, int seconds, int clientCount, int channels, int timeToLiveMs, grpc_labview::LVUserEventRef lookupEvent)
+{
+    grpc_labview::gRPCid* server = nullptr;
+    LVCreateServer(&server);
+    lvstub::RegisterMessage(&server, kRequestMessage, {
+        { "channel", 1, (int)grpc_labview::LVMessageMetadataType::Int32Value, false, "" }
+    });
+    lvstub::RegisterMessage(&server, kResponseMessage, {
+        { "channel", 1, (int)grpc_labview::LVMessageMetadataType::Int32Value, false, "" },
+        { "gain", 2, (int)grpc_labview::LVMessageMetadataType::DoubleValue, false, "" },
+        { "offset", 3, (int)grpc_labview::LVMessageMetadataType::DoubleValue, false, "" }
+    });
+    CompleteMetadataRegistration(&server);
+    RegisterServerEvent(&server, kLookupMethod, &lookupEvent, kRequestMessage, kResponseMessage);
+    if (cached)
+    {
+        LVSetServerMethodResponseCache(&server, kLookupMethod, 1024 * 1024, timeToLiveMs);
+    }
+
+    BenchmarkResult result = { { 0, 0, 1, 0, 0, 0 }, 0, 0, 0 };
+    gHandled = 0;
+    auto address = lvbench::StartLocalServer(&server);
+    if (!address.empty())
+    {
+        result.load = lvbench::RunClients(address, clientCount, seconds, kLookupMethod, [channels](int client, uint64_t call)
+        {
+            auto channelNumber = 1 + (client + call) % channels;
+            return lvbench::CreateByteBuffer({ 0x08, (char)channelNumber });
+        });
+        int32_t entries;
+        uint64_t bytes;
+        LVGetServerMethodResponseCacheStats(&server, kLookupMethod, &result.hits, &result.misses, &entries, &bytes);
+    }
+    LVStopServer(&server);
+    result.handled = gHandled;
+    return result;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    int seconds = argc > 1 ? atoi(argv[1]) : 5;
+    int clientCount = argc > 2 ? atoi(argv[2]) : 4;
+    gHandlingUs = argc > 3 ? atoi(argv[3]) : 500;
+    int channels = argc > 4 ? atoi(argv[4]) : 16;
+    int timeToLiveMs = argc > 5 ? atoi(argv[5]) : 1000;
+
+    auto lookupEvent = lvstub::CreateUserEvent(HandleLookup);
+    lvstub::StartEventLoop(1);
+
+    std::cout << "clients: " << clientCount << ", handling: " << gHandlingUs << "us, channels: " << channels
+        << ", time to live: " << timeToLiveMs << "ms, duration: " << seconds << "s" << std::endl;
+    std::cout << std::left << std::setw(10) << "cache" << std::right << std::setw(12) << "calls/s" << std::setw(12) << "p50 (us)"
+        << std::setw(12) << "p99 (us)" << std::setw(12) << "handled" << std::setw(12) << "hits" << std::setw(12) << "misses"
+        << std::setw(12) << "failures" << std::endl;
+    for (auto cached : { false, true })
+    {
+        auto result = RunBenchmark(cached, seconds, clientCount, channels, timeToLiveMs, lookupEvent);
+        std::cout << std::left << std::setw(10) << (cached ? "on" : "off") << std::right << std::setw(12) << (uint64_t)(result.load.calls / result.load.seconds)
+            << std::fixed << std::setprecision(1) << std::setw(12) << result.load.p50Us << std::setw(12) << result.load.p99Us
+            << std::setw(12) << result.handled << std::setw(12) << result.hits << std::setw(12) << result.misses
+            << std::setw(12) << result.load.failures << std::endl;
+    }
+    lvstub::StopEventLoop();
+    return 0;
+}
@@ -0,0 +1,170 @@
+//---------------------------------------------------------------------
+// What happens to the calls in progress when labview_grpc_server is
+// stopped under load, for different drain timeouts.
+//
+// Clients call the server back to back while every call takes the handler
+// a fixed time. After a second the server is stopped with the given drain
+// timeout. Calls a handler started but whose client did not get the
+// response are the calls lost to the stop.
+//
+// Usage: server_drain_benchmark [client threads] [handler threads] [handling (ms)] [drain timeouts (ms)...]
+//---------------------------------------------------------------------
+#include "benchmark_harness.h"
+#include "lv_runtime_stub.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static const char* kWorkMethod = "/benchmark.Benchmark/Work";
+static const char* kWorkMessage = "benchmark.WorkMessage";
+
+//---------------------------------------------------------------------
+// LabVIEW cluster for benchmark.WorkMessage
+//---------------------------------------------------------------------
+struct WorkCluster
+{
+    int32_t id;
+};
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static int gHandlingMs = 50;
+static std::atomic<uint64_t> gCallsStarted(0);
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void HandleWork(grpc_labview::gRPCid* id)
+{
+    WorkCluster cluster = { 0 };
+    if (GetRequestData(&id, (int8_t*)&cluster) == 0)
+    {
+        ++gCallsStarted;
+        std::this_thread::sleep_for(std::chrono::milliseconds(gHandlingMs));
+        SetResponseData(&id, (int8_t*)&cluster);
+    }
+    CloseServerEvent(&id);
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+struct BenchmarkResult
+{
+    uint64_t callsStarted;
+    uint64_t callsSucceeded;
+    uint64_t callsRefused;
+    int32_t inFlightAtStop;
+    double stopMs;
+};
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void RunClient(const std::string& address, std::atomic<bool>& done, std::atomic<uint64_t>& succeeded, std::atomic<uint64_t>& refused)
+{
+    grpc::GenericStub stub(lvbench::CreateClientChannel(address));
+    grpc::CompletionQueue cq;
+    auto request = lvbench::CreateByteBuffer({ 0x08, 0x01 });
+    while (!done)
+    {
+        auto status = lvbench::UnaryCall(stub, cq, kWorkMethod, request, nullptr, std::chrono::seconds(10));
+        if (status.ok())
+        {
+            ++succeeded;
+        }
+        else if (status.error_code() == grpc::StatusCode::UNAVAILABLE)
+        {
+            ++refused;
+            // Do not spin once the server is gone.
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    lvbench::ShutdownCompletionQueue(cq);
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static BenchmarkResult RunBenchmark(int drainTimeoutMs, int clientCount, int handlerCount, grpc_labview::LVUserEventRef workEvent)
+{
+    grpc_labview::gRPCid* server = nullptr;
+    LVCreateServer(&server);
+    lvstub::RegisterMessage(&server, kWorkMessage, {
+        { "id", 1, (int)grpc_labview::LVMessageMetadataType::Int32Value, false, "" }
+    });
+    CompleteMetadataRegistration(&server);
+    RegisterServerEvent(&server, kWorkMethod, &workEvent, kWorkMessage, kWorkMessage);
+    LVSetServerDrainTimeout(&server, drainTimeoutMs);
+
+    BenchmarkResult result = { 0, 0, 0, 0, 0 };
+    gCallsStarted = 0;
+    lvstub::StartEventLoop(handlerCount);
+    auto address = lvbench::StartLocalServer(&server);
+    if (!address.empty())
+    {
+        std::atomic<bool> done(false);
+        std::atomic<uint64_t> succeeded(0);
+        std::atomic<uint64_t> refused(0);
+        std::vector<std::thread> clients;
+        for (int x = 0; x < clientCount; ++x)
+        {
+            clients.emplace_back(RunClient, address, std::ref(done), std::ref(succeeded), std::ref(refused));
+        }
+
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        uint64_t rejected;
+        LVGetServerConcurrencyStats(&server, &result.inFlightAtStop, &rejected);
+        auto start = std::chrono::steady_clock::now();
+        LVStopServer(&server);
+        result.stopMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        done = true;
+        for (auto& client : clients)
+        {
+            client.join();
+        }
+        result.callsSucceeded = succeeded;
+        result.callsRefused = refused;
+    }
+    else
+    {
+        LVStopServer(&server);
+    }
+    // Lets the handlers close the calls that were cancelled while they held them.
+    lvstub::StopEventLoop();
+    result.callsStarted = gCallsStarted;
+    return result;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    int clientCount = argc > 1 ? atoi(argv[1]) : 16;
+    int handlerCount = argc > 2 ? atoi(argv[2]) : 8;
+    gHandlingMs = argc > 3 ? atoi(argv[3]) : 50;
+    std::vector<int> drainTimeouts;
+    for (int x = 4; x < argc; ++x)
+    {
+        drainTimeouts.push_back(atoi(argv[x]));
+    }
+    if (drainTimeouts.empty())
+    {
+        drainTimeouts = { 0, gHandlingMs / 2, gHandlingMs * 4 };
+    }
+
+    auto workEvent = lvstub::CreateUserEvent(HandleWork);
+
+    std::cout << "clients: " << clientCount << ", handlers: " << handlerCount << ", handling: " << gHandlingMs << "ms" << std::endl;
+    std::cout << "drain timeout (ms)\tin flight at stop\tstop (ms)\tcalls handled\tlost\trefused" << std::endl;
+    for (auto drainTimeout : drainTimeouts)
+    {
+        auto result = RunBenchmark(drainTimeout, clientCount, handlerCount, workEvent);
+        std::cout << drainTimeout << "\t" << result.inFlightAtStop << "\t" << result.stopMs << "\t" << result.callsStarted
+            << "\t" << result.callsStarted - result.callsSucceeded << "\t" << result.callsRefused << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,172 @@
+//---------------------------------------------------------------------
+// Unary throughput of labview_grpc_server for different completion
+// queue counts.
+//
+// The server is driven through the same exported functions LabVIEW uses.
+// Server events are handled by a pool of threads that stand in for the
+// LabVIEW event structures (see lv_runtime_stub.h). The time the server
+// spent in each phase of a call during the last run is listed at the end.
+//
+// Usage: server_throughput_benchmark [seconds] [client threads] [handler threads] [pending calls] [queue counts...]
+//---------------------------------------------------------------------
+#include "benchmark_harness.h"
+#include "lv_runtime_stub.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static const char* kEchoMethod = "/benchmark.Benchmark/Echo";
+static const char* kEchoMessage = "benchmark.EchoMessage";
+
+//---------------------------------------------------------------------
+// LabVIEW cluster for benchmark.EchoMessage
+//---------------------------------------------------------------------
+struct EchoCluster
+{
+    int32_t id;
+    grpc_labview::LStrHandle payload;
+};
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void HandleEcho(grpc_labview::gRPCid* id)
+{
+    EchoCluster cluster = { 0, nullptr };
+    if (GetRequestData(&id, (int8_t*)&cluster) == 0)
+    {
+        SetResponseData(&id, (int8_t*)&cluster);
+    }
+    CloseServerEvent(&id);
+    lvstub::DisposeLVString(cluster.payload);
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static grpc::ByteBuffer CreateEchoRequest(size_t payloadSize)
+{
+    std::string request;
+    lvbench::AppendTag(request, 1, 0);
+    lvbench::AppendVarint(request, 42);
+    lvbench::AppendLengthDelimited(request, 2, std::string(payloadSize, 'x'));
+    return lvbench::CreateByteBuffer(request);
+}
+
+//---------------------------------------------------------------------
+// Metrics of LVGetServerMethodStats, in the order of their numbers.
+//---------------------------------------------------------------------
+static const char* kCallMetrics[] = { "accept to parse (us)", "parse (us)", "post to pickup (us)", "handling (us)", "serialize (us)", "write complete (us)", "request bytes", "response bytes" };
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+struct MetricStats
+{
+    uint64_t count;
+    double mean;
+    double p50;
+    double p90;
+    double p99;
+    double p999;
+    double max;
+};
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+struct BenchmarkResult
+{
+    lvbench::LoadResult load;
+    uint64_t pendingCallsExhausted;
+    std::vector<MetricStats> metrics;
+};
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static BenchmarkResult RunBenchmark(int completionQueueCount, int pendingCallCount, int clientCount, int seconds, grpc_labview::LVUserEventRef echoEvent)
+{
+    grpc_labview::gRPCid* server = nullptr;
+    LVCreateServer(&server);
+    LVSetServerCompletionQueueCount(&server, completionQueueCount);
+    LVSetServerPendingCallCount(&server, pendingCallCount);
+    lvstub::RegisterMessage(&server, kEchoMessage, {
+        { "id", 1, (int)grpc_labview::LVMessageMetadataType::Int32Value, false, "" },
+        { "payload", 2, (int)grpc_labview::LVMessageMetadataType::StringValue, false, "" }
+    });
+    CompleteMetadataRegistration(&server);
+    RegisterServerEvent(&server, kEchoMethod, &echoEvent, kEchoMessage, kEchoMessage);
+
+    BenchmarkResult result = { { 0, 0, 1, 0, 0, 0 }, 0, {} };
+    auto address = lvbench::StartLocalServer(&server);
+    if (!address.empty())
+    {
+        auto request = CreateEchoRequest(64);
+        result.load = lvbench::RunClients(address, clientCount, seconds, kEchoMethod, [&request](int, uint64_t) { return request; });
+
+        int32_t pendingCalls;
+        uint64_t acceptedCalls;
+        LVGetServerPendingCallStats(&server, &pendingCalls, &acceptedCalls, &result.pendingCallsExhausted);
+        for (int metric = 0; metric < (int)(sizeof(kCallMetrics) / sizeof(kCallMetrics[0])); ++metric)
+        {
+            MetricStats stats;
+            LVGetServerMethodStats(&server, kEchoMethod, metric, &stats.count, &stats.mean, &stats.p50, &stats.p90, &stats.p99, &stats.p999, &stats.max);
+            result.metrics.push_back(stats);
+        }
+    }
+    LVStopServer(&server);
+    return result;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    int seconds = argc > 1 ? atoi(argv[1]) : 5;
+    int clientCount = argc > 2 ? atoi(argv[2]) : 32;
+    int handlerCount = argc > 3 ? atoi(argv[3]) : 8;
+    int pendingCallCount = argc > 4 ? atoi(argv[4]) : 1;
+    std::vector<int> queueCounts;
+    for (int x = 5; x < argc; ++x)
+    {
+        queueCounts.push_back(atoi(argv[x]));
+    }
+    if (queueCounts.empty())
+    {
+        auto cores = (int)std::max(1u, std::thread::hardware_concurrency());
+        for (int count = 1; count < cores; count *= 2)
+        {
+            queueCounts.push_back(count);
+        }
+        queueCounts.push_back(cores);
+    }
+
+    auto echoEvent = lvstub::CreateUserEvent(HandleEcho);
+    lvstub::StartEventLoop(handlerCount);
+
+    std::cout << "clients: " << clientCount << ", handlers: " << handlerCount << ", pending calls: " << pendingCallCount << ", duration: " << seconds << "s" << std::endl;
+    std::cout << "queues\tcalls/s\tmean latency (us)\tfailures\tpending calls exhausted" << std::endl;
+    BenchmarkResult result;
+    for (auto queueCount : queueCounts)
+    {
+        result = RunBenchmark(queueCount, pendingCallCount, clientCount, seconds, echoEvent);
+        std::cout << queueCount << "\t" << (uint64_t)(result.load.calls / result.load.seconds) << "\t" << result.load.meanUs << "\t" << result.load.failures << "\t" << result.pendingCallsExhausted << std::endl;
+    }
+
+    std::cout << std::endl << std::left << std::setw(24) << "phase"
+        << std::right << std::setw(10) << "count" << std::setw(10) << "mean" << std::setw(10) << "p50"
+        << std::setw(10) << "p90" << std::setw(10) << "p99" << std::setw(10) << "p99.9" << std::setw(10) << "max" << std::endl;
+    for (size_t x = 0; x < result.metrics.size(); ++x)
+    {
+        auto& stats = result.metrics[x];
+        std::cout << std::left << std::setw(24) << kCallMetrics[x]
+            << std::right << std::setw(10) << stats.count << std::fixed << std::setprecision(1)
+            << std::setw(10) << stats.mean << std::setw(10) << stats.p50 << std::setw(10) << stats.p90
+            << std::setw(10) << stats.p99 << std::setw(10) << stats.p999 << std::setw(10) << stats.max << std::endl;
+    }
+
+    lvstub::StopEventLoop();
+    return 0;
+}
@@ -0,0 +1,128 @@
+//---------------------------------------------------------------------
+// Throughput of a status method of labview_grpc_server polled by many
+// clients at once, with and without coalescing identical calls.
+//
+// Every client asks for the status of the same channel back to back, the
+// handler takes a fixed time to read it. With single flight the calls that
+// arrive while the handler works on the channel wait for it and share its
+// response, so the handler runs about once per handling time whatever the
+// number of clients.
+//
+// Usage: single_flight_benchmark [seconds] [client threads] [handling (us)]
+//---------------------------------------------------------------------
+#include "benchmark_harness.h"
+#include "lv_runtime_stub.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static const char* kStatusMethod = "/benchmark.Benchmark/GetStatus";
+static const char* kRequestMessage = "benchmark.StatusRequest";
+static const char* kResponseMessage = "benchmark.Status";
+
+//---------------------------------------------------------------------
+// LabVIEW clusters for benchmark.StatusRequest and benchmark.Status
+//---------------------------------------------------------------------
+struct RequestCluster
+{
+    int32_t channel;
+};
+
+struct StatusCluster
+{
+    int32_t channel;
+    double temperature;
+    int32_t sequence;
+};
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static int gHandlingUs = 2000;
+static std::atomic<int32_t> gHandled(0);
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void HandleStatus(grpc_labview::gRPCid* id)
+{
+    RequestCluster request = { 0 };
+    if (GetRequestData(&id, (int8_t*)&request) == 0)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(gHandlingUs));
+        StatusCluster response = { request.channel, 23.5, ++gHandled };
+        SetResponseData(&id, (int8_t*)&response);
+    }
+    CloseServerEvent(&id);
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+struct BenchmarkResult
+{
+    lvbench::LoadResult load;
+    uint64_t handled;
+    uint64_t coalesced;
+};
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static BenchmarkResult RunBenchmark(bool singleFlight, int seconds, int clientCount, grpc_labview::LVUserEventRef statusEvent)
+{
+    grpc_labview::gRPCid* server = nullptr;
+    LVCreateServer(&server);
+    lvstub::RegisterMessage(&server, kRequestMessage, {
+        { "channel", 1, (int)grpc_labview::LVMessageMetadataType::Int32Value, false, "" }
+    });
+    lvstub::RegisterMessage(&server, kResponseMessage, {
+        { "channel", 1, (int)grpc_labview::LVMessageMetadataType::Int32Value, false, "" },
+        { "temperature", 2, (int)grpc_labview::LVMessageMetadataType::DoubleValue, false, "" },
+        { "sequence", 3, (int)grpc_labview::LVMessageMetadataType::Int32Value, false, "" }
+    });
+    CompleteMetadataRegistration(&server);
+    RegisterServerEvent(&server, kStatusMethod, &statusEvent, kRequestMessage, kResponseMessage);
+    LVSetServerMethodSingleFlight(&server, kStatusMethod, singleFlight ? 1 : 0);
+
+    BenchmarkResult result = { { 0, 0, 1, 0, 0, 0 }, 0, 0 };
+    gHandled = 0;
+    auto address = lvbench::StartLocalServer(&server);
+    if (!address.empty())
+    {
+        auto request = lvbench::CreateByteBuffer({ 0x08, 0x01 });
+        result.load = lvbench::RunClients(address, clientCount, seconds, kStatusMethod, [&request](int, uint64_t) { return request; });
+        uint64_t handled;
+        LVGetServerMethodSingleFlightStats(&server, kStatusMethod, &handled, &result.coalesced);
+    }
+    LVStopServer(&server);
+    result.handled = gHandled;
+    return result;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    int seconds = argc > 1 ? atoi(argv[1]) : 5;
+    int clientCount = argc > 2 ? atoi(argv[2]) : 16;
+    gHandlingUs = argc > 3 ? atoi(argv[3]) : 2000;
+
+    auto statusEvent = lvstub::CreateUserEvent(HandleStatus);
+    lvstub::StartEventLoop(1);
+
+    std::cout << "clients: " << clientCount << ", handling: " << gHandlingUs << "us, duration: " << seconds << "s" << std::endl;
+    std::cout << std::left << std::setw(16) << "single flight" << std::right << std::setw(12) << "calls/s" << std::setw(12) << "p50 (us)"
+        << std::setw(12) << "p99 (us)" << std::setw(12) << "handled" << std::setw(12) << "coalesced" << std::setw(12) << "failures" << std::endl;
+    for (auto singleFlight : { false, true })
+    {
+        auto result = RunBenchmark(singleFlight, seconds, clientCount, statusEvent);
+        std::cout << std::left << std::setw(16) << (singleFlight ? "on" : "off") << std::right << std::setw(12) << (uint64_t)(result.load.calls / result.load.seconds)
+            << std::fixed << std::setprecision(1) << std::setw(12) << result.load.p50Us << std::setw(12) << result.load.p99Us
+            << std::setw(12) << result.handled << std::setw(12) << result.coalesced << std::setw(12) << result.load.failures << std::endl;
+    }
+    lvstub::StopEventLoop();
+    return 0;
+}
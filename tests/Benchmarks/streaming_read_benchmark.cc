@@ -0,0 +1,213 @@
+//---------------------------------------------------------------------
+// Client streaming message rate of labview_grpc_server for different
+// read ahead depths.
+//
+// The client writes a fixed number of messages to a single client
+// streaming call. The server event handler reads them with GetRequestData,
+// or GetRequestDataBatch when the batch size is larger than one, spending
+// a fixed time on every message to stand in for the work of a LabVIEW VI.
+// It checks that they arrive in order and responds with the number of
+// messages it received.
+//
+// Usage: streaming_read_benchmark [messages per call] [payload bytes] [work per message (us)] [batch size] [depths...]
+//---------------------------------------------------------------------
+#include "benchmark_harness.h"
+#include "lv_runtime_stub.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static const char* kUploadMethod = "/benchmark.Benchmark/Upload";
+static const char* kUploadMessage = "benchmark.UploadMessage";
+
+//---------------------------------------------------------------------
+// LabVIEW cluster for benchmark.UploadMessage
+//---------------------------------------------------------------------
+struct UploadCluster
+{
+    int32_t id;
+    grpc_labview::LStrHandle payload;
+};
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static int gWorkUs;
+static int gBatchSize;
+static std::atomic<bool> gInOrder(true);
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void DoWork()
+{
+    auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(gWorkUs);
+    while (std::chrono::steady_clock::now() < end) {}
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void HandleUploadBatched(grpc_labview::gRPCid* id)
+{
+    grpc_labview::LV1DArrayHandle batch = nullptr;
+    int32_t count = 0;
+    int32_t received = 0;
+    while (GetRequestDataBatch(&id, &batch, gBatchSize, &count) == 0)
+    {
+        for (int32_t x = 0; x < count; ++x)
+        {
+            auto cluster = (UploadCluster*)lvstub::GetLVClusterArrayElement(batch, x, sizeof(UploadCluster), alignof(UploadCluster));
+            if (cluster->id != received)
+            {
+                gInOrder = false;
+            }
+            ++received;
+            DoWork();
+        }
+    }
+    UploadCluster response = { received, nullptr };
+    SetResponseData(&id, (int8_t*)&response);
+    CloseServerEvent(&id);
+    for (int32_t x = 0; batch != nullptr && x < (*batch)->cnt; ++x)
+    {
+        lvstub::DisposeLVString(((UploadCluster*)lvstub::GetLVClusterArrayElement(batch, x, sizeof(UploadCluster), alignof(UploadCluster)))->payload);
+    }
+    lvstub::DisposeLVArray(batch);
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void HandleUpload(grpc_labview::gRPCid* id)
+{
+    UploadCluster cluster = { 0, nullptr };
+    int32_t received = 0;
+    while (GetRequestData(&id, (int8_t*)&cluster) == 0)
+    {
+        if (cluster.id != received)
+        {
+            gInOrder = false;
+        }
+        ++received;
+        DoWork();
+    }
+    cluster.id = received;
+    SetResponseData(&id, (int8_t*)&cluster);
+    CloseServerEvent(&id);
+    lvstub::DisposeLVString(cluster.payload);
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static grpc::ByteBuffer CreateUploadMessage(int32_t id, size_t payloadSize)
+{
+    std::string message;
+    lvbench::AppendTag(message, 1, 0);
+    lvbench::AppendVarint(message, (uint32_t)id);
+    lvbench::AppendLengthDelimited(message, 2, std::string(payloadSize, 'x'));
+    return lvbench::CreateByteBuffer(message);
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+struct BenchmarkResult
+{
+    int32_t received;
+    bool succeeded;
+    double seconds;
+};
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static BenchmarkResult RunClient(const std::string& address, int messageCount, size_t payloadSize)
+{
+    BenchmarkResult result = { 0, false, 0 };
+    std::vector<grpc::ByteBuffer> messages;
+    for (int x = 0; x < messageCount; ++x)
+    {
+        messages.push_back(CreateUploadMessage(x, payloadSize));
+    }
+
+    auto channel = grpc::CreateChannel(address, grpc::InsecureChannelCredentials());
+    grpc::GenericStub stub(channel);
+    grpc::CompletionQueue cq;
+    grpc::ByteBuffer response;
+
+    auto start = std::chrono::steady_clock::now();
+    auto status = lvbench::ClientStreamingCall(stub, cq, kUploadMethod, messages, &response);
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.succeeded = status.ok();
+
+    auto bytes = lvbench::Flatten(response);
+    size_t offset = 1;
+    result.received = !bytes.empty() && bytes[0] == 0x08 ? (int32_t)lvbench::ReadVarint(bytes, offset) : 0;
+
+    lvbench::ShutdownCompletionQueue(cq);
+    return result;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static BenchmarkResult RunBenchmark(int readAheadDepth, int messageCount, size_t payloadSize, grpc_labview::LVUserEventRef uploadEvent)
+{
+    grpc_labview::gRPCid* server = nullptr;
+    LVCreateServer(&server);
+    LVSetServerReadAheadDepth(&server, readAheadDepth);
+    lvstub::RegisterMessage(&server, kUploadMessage, {
+        { "id", 1, (int)grpc_labview::LVMessageMetadataType::Int32Value, false, "" },
+        { "payload", 2, (int)grpc_labview::LVMessageMetadataType::StringValue, false, "" }
+    });
+    CompleteMetadataRegistration(&server);
+    RegisterServerEvent(&server, kUploadMethod, &uploadEvent, kUploadMessage, kUploadMessage);
+
+    BenchmarkResult result = { 0, false, 0 };
+    auto address = lvbench::StartLocalServer(&server);
+    if (!address.empty())
+    {
+        result = RunClient(address, messageCount, payloadSize);
+    }
+    LVStopServer(&server);
+    return result;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    int messageCount = argc > 1 ? atoi(argv[1]) : 50000;
+    size_t payloadSize = argc > 2 ? atoi(argv[2]) : 64;
+    gWorkUs = argc > 3 ? atoi(argv[3]) : 5;
+    gBatchSize = argc > 4 ? std::max(1, atoi(argv[4])) : 1;
+    std::vector<int> depths;
+    for (int x = 5; x < argc; ++x)
+    {
+        depths.push_back(atoi(argv[x]));
+    }
+    if (depths.empty())
+    {
+        depths = { 0, 1, 4, 16, 64 };
+    }
+
+    auto uploadEvent = lvstub::CreateUserEvent(gBatchSize > 1 ? HandleUploadBatched : HandleUpload);
+    lvstub::StartEventLoop(1);
+
+    bool succeeded = true;
+    std::cout << "messages per call: " << messageCount << ", payload: " << payloadSize << " bytes, work per message: " << gWorkUs << "us, batch size: " << gBatchSize << std::endl;
+    std::cout << "depth\tmessages/s\tresult" << std::endl;
+    for (auto depth : depths)
+    {
+        gInOrder = true;
+        auto result = RunBenchmark(depth, messageCount, payloadSize, uploadEvent);
+        auto complete = result.succeeded && gInOrder && result.received == messageCount;
+        succeeded &= complete;
+        std::cout << depth << "\t" << (uint64_t)(messageCount / result.seconds) << "\t"
+            << (complete ? "ok" : "FAILED (" + std::to_string(result.received) + " received)") << std::endl;
+    }
+
+    lvstub::StopEventLoop();
+    return succeeded ? 0 : 1;
+}
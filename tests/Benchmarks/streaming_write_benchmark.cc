@@ -0,0 +1,242 @@
+//---------------------------------------------------------------------
+// Server streaming message rate of labview_grpc_server for different
+// write queue depths.
+//
+// A server event handler writes a fixed number of messages to a single
+// server streaming call with SetResponseData, or SetResponseDataBatch when
+// the batch size is larger than one, retrying whenever the write queue is
+// full. The client checks that every message arrives in order.
+//
+// Usage: streaming_write_benchmark [messages per call] [payload bytes] [batch size] [depths...]
+//---------------------------------------------------------------------
+#include "benchmark_harness.h"
+#include "lv_runtime_stub.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static const char* kStreamMethod = "/benchmark.Benchmark/Stream";
+static const char* kStreamMessage = "benchmark.StreamMessage";
+static const int32_t kQueueFull = -(1000 + grpc::StatusCode::RESOURCE_EXHAUSTED);
+
+//---------------------------------------------------------------------
+// LabVIEW cluster for benchmark.StreamMessage
+//---------------------------------------------------------------------
+struct StreamCluster
+{
+    int32_t id;
+    grpc_labview::LStrHandle payload;
+};
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static int gMessageCount;
+static size_t gPayloadSize;
+static int gBatchSize;
+static std::atomic<uint64_t> gQueueFullCount(0);
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void HandleStreamBatched(grpc_labview::gRPCid* id)
+{
+    StreamCluster request = { 0, nullptr };
+    grpc_labview::LV1DArrayHandle batch = nullptr;
+    if (GetRequestData(&id, (int8_t*)&request) == 0)
+    {
+        for (int x = 0; x < gMessageCount; x += gBatchSize)
+        {
+            auto count = std::min(gBatchSize, gMessageCount - x);
+            lvstub::ResizeLVClusterArray(&batch, count, sizeof(StreamCluster), alignof(StreamCluster));
+            for (int y = 0; y < count; ++y)
+            {
+                auto cluster = (StreamCluster*)lvstub::GetLVClusterArrayElement(batch, y, sizeof(StreamCluster), alignof(StreamCluster));
+                cluster->id = x + y;
+                if (cluster->payload == nullptr)
+                {
+                    cluster->payload = lvstub::CreateLVString(std::string(gPayloadSize, 'x'));
+                }
+            }
+            auto result = SetResponseDataBatch(&id, &batch);
+            while (result == kQueueFull)
+            {
+                ++gQueueFullCount;
+                std::this_thread::yield();
+                result = SetResponseDataBatch(&id, &batch);
+            }
+            if (result != 0)
+            {
+                break;
+            }
+        }
+    }
+    CloseServerEvent(&id);
+    lvstub::DisposeLVString(request.payload);
+    for (int y = 0; batch != nullptr && y < (*batch)->cnt; ++y)
+    {
+        lvstub::DisposeLVString(((StreamCluster*)lvstub::GetLVClusterArrayElement(batch, y, sizeof(StreamCluster), alignof(StreamCluster)))->payload);
+    }
+    lvstub::DisposeLVArray(batch);
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void HandleStream(grpc_labview::gRPCid* id)
+{
+    StreamCluster cluster = { 0, nullptr };
+    if (GetRequestData(&id, (int8_t*)&cluster) == 0)
+    {
+        lvstub::DisposeLVString(cluster.payload);
+        cluster.payload = lvstub::CreateLVString(std::string(gPayloadSize, 'x'));
+        for (int x = 0; x < gMessageCount; ++x)
+        {
+            cluster.id = x;
+            auto result = SetResponseData(&id, (int8_t*)&cluster);
+            while (result == kQueueFull)
+            {
+                ++gQueueFullCount;
+                std::this_thread::yield();
+                result = SetResponseData(&id, (int8_t*)&cluster);
+            }
+            if (result != 0)
+            {
+                break;
+            }
+        }
+    }
+    CloseServerEvent(&id);
+    lvstub::DisposeLVString(cluster.payload);
+}
+
+//---------------------------------------------------------------------
+// Returns the id of a benchmark.StreamMessage, field 1 is omitted when zero.
+//---------------------------------------------------------------------
+static int32_t ReadMessageId(const grpc::ByteBuffer& buffer)
+{
+    auto message = lvbench::Flatten(buffer);
+    if (message.empty() || message[0] != 0x08)
+    {
+        return 0;
+    }
+    size_t offset = 1;
+    return (int32_t)lvbench::ReadVarint(message, offset);
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+struct BenchmarkResult
+{
+    int received;
+    bool inOrder;
+    bool succeeded;
+    double seconds;
+};
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static BenchmarkResult RunClient(const std::string& address)
+{
+    BenchmarkResult result = { 0, true, false, 0 };
+    auto channel = grpc::CreateChannel(address, grpc::InsecureChannelCredentials());
+    grpc::GenericStub stub(channel);
+    grpc::CompletionQueue cq;
+    grpc::ClientContext context;
+    void* tag;
+    bool ok;
+
+    auto start = std::chrono::steady_clock::now();
+    auto call = stub.PrepareCall(&context, kStreamMethod, &cq);
+    call->StartCall((void*)1);
+    cq.Next(&tag, &ok);
+    call->Write(lvbench::CreateByteBuffer(std::string("\x08\x01", 2)), (void*)2);
+    cq.Next(&tag, &ok);
+    call->WritesDone((void*)3);
+    cq.Next(&tag, &ok);
+    while (true)
+    {
+        grpc::ByteBuffer response;
+        call->Read(&response, (void*)4);
+        cq.Next(&tag, &ok);
+        if (!ok)
+        {
+            break;
+        }
+        result.inOrder &= ReadMessageId(response) == result.received;
+        ++result.received;
+    }
+    grpc::Status status;
+    call->Finish(&status, (void*)5);
+    cq.Next(&tag, &ok);
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.succeeded = ok && status.ok();
+
+    lvbench::ShutdownCompletionQueue(cq);
+    return result;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static BenchmarkResult RunBenchmark(int writeQueueDepth, grpc_labview::LVUserEventRef streamEvent)
+{
+    grpc_labview::gRPCid* server = nullptr;
+    LVCreateServer(&server);
+    LVSetServerWriteQueueDepth(&server, writeQueueDepth);
+    lvstub::RegisterMessage(&server, kStreamMessage, {
+        { "id", 1, (int)grpc_labview::LVMessageMetadataType::Int32Value, false, "" },
+        { "payload", 2, (int)grpc_labview::LVMessageMetadataType::StringValue, false, "" }
+    });
+    CompleteMetadataRegistration(&server);
+    RegisterServerEvent(&server, kStreamMethod, &streamEvent, kStreamMessage, kStreamMessage);
+
+    BenchmarkResult result = { 0, false, false, 0 };
+    auto address = lvbench::StartLocalServer(&server);
+    if (!address.empty())
+    {
+        result = RunClient(address);
+    }
+    LVStopServer(&server);
+    return result;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    gMessageCount = argc > 1 ? atoi(argv[1]) : 100000;
+    gPayloadSize = argc > 2 ? atoi(argv[2]) : 64;
+    gBatchSize = argc > 3 ? std::max(1, atoi(argv[3])) : 1;
+    std::vector<int> depths;
+    for (int x = 4; x < argc; ++x)
+    {
+        depths.push_back(atoi(argv[x]));
+    }
+    if (depths.empty())
+    {
+        depths = { 0, 1, 4, 16, 64 };
+    }
+
+    auto streamEvent = lvstub::CreateUserEvent(gBatchSize > 1 ? HandleStreamBatched : HandleStream);
+    lvstub::StartEventLoop(1);
+
+    bool succeeded = true;
+    std::cout << "messages per call: " << gMessageCount << ", payload: " << gPayloadSize << " bytes, batch size: " << gBatchSize << std::endl;
+    std::cout << "depth\tmessages/s\tqueue full\tresult" << std::endl;
+    for (auto depth : depths)
+    {
+        gQueueFullCount = 0;
+        auto result = RunBenchmark(depth, streamEvent);
+        auto complete = result.succeeded && result.inOrder && result.received == gMessageCount;
+        succeeded &= complete;
+        std::cout << depth << "\t" << (uint64_t)(result.received / result.seconds) << "\t" << gQueueFullCount << "\t"
+            << (complete ? "ok" : "FAILED (" + std::to_string(result.received) + " received)") << std::endl;
+    }
+
+    lvstub::StopEventLoop();
+    return succeeded ? 0 : 1;
+}
@@ -0,0 +1,495 @@
+//---------------------------------------------------------------------
+// Tests of LVMessage and of the field parsers compiled with the message
+// metadata.
+//
+// Checks that parsing a message then serializing it gives back the same
+// bytes, in ascending field number whatever the order of the cluster,
+// with its values on the heap, on an arena owned by the message, from and
+// to the slices of a byte buffer and after a round trip through the
+// LabVIEW cluster, copied or parsed straight into it, for messages parsed
+// through the compiled field parsers and through the map of elements,
+// that ClusterSerializer writes the same bytes as a message copied from
+// the cluster, with enums, oneofs, 2D arrays and empty repeated fields,
+// and that packed fields running past the end of the message are
+// rejected. That the compiled parsers of nested messages hold their
+// metadata.
+// Then that the compiled parsers find the same element as the map for
+// dense and sparse field numbers, including numbers used by two elements.
+//
+// Usage: lv_message_test
+//---------------------------------------------------------------------
+#include "benchmark_harness.h"
+#include "lv_runtime_stub.h"
+#include <cluster_copier.h>
+#include <cluster_serializer.h>
+#include <grpc_server.h>
+#include <lv_message.h>
+#include <lv_message_efficient.h>
+#include <message_metadata.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+using grpc_labview::LVMessageMetadataType;
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void AppendFixed(std::string& buffer, int protobufIndex, const void* value, size_t size)
+{
+    lvbench::AppendTag(buffer, protobufIndex, size == 4 ? 5 : 1);
+    buffer.append((const char*)value, size);
+}
+
+//---------------------------------------------------------------------
+// Wire format of test.Reading with a value in every field, in the order
+// LVMessage serializes them. The values depend on seed so that two
+// readings differ in every field.
+//---------------------------------------------------------------------
+static std::string EncodeReading(int seed)
+{
+    std::string encoded;
+    lvbench::AppendTag(encoded, 1, 0);
+    lvbench::AppendVarint(encoded, (uint64_t)(int64_t)(-5 - seed));
+    double doubleValue = 1.25 + seed;
+    AppendFixed(encoded, 2, &doubleValue, sizeof(doubleValue));
+    float floatValue = 0.5f + seed;
+    AppendFixed(encoded, 3, &floatValue, sizeof(floatValue));
+    lvbench::AppendTag(encoded, 4, 0);
+    lvbench::AppendVarint(encoded, ((uint64_t)1 << 40) + seed);
+    lvbench::AppendTag(encoded, 5, 0);
+    lvbench::AppendVarint(encoded, 4000000000u + seed);
+    lvbench::AppendTag(encoded, 6, 0);
+    lvbench::AppendVarint(encoded, ((uint64_t)1 << 63) + seed);
+    lvbench::AppendTag(encoded, 7, 0);
+    lvbench::AppendVarint(encoded, 1);
+    lvbench::AppendLengthDelimited(encoded, 8, "volts " + std::to_string(seed));
+    lvbench::AppendLengthDelimited(encoded, 9, std::string("\x00\x01\xff", 3) + (char)seed);
+    // sint32 -7 and sint64 -9, zigzag encoded
+    lvbench::AppendTag(encoded, 10, 0);
+    lvbench::AppendVarint(encoded, 13 + 2 * seed);
+    lvbench::AppendTag(encoded, 11, 0);
+    lvbench::AppendVarint(encoded, 17 + 2 * seed);
+    uint32_t fixed32 = 0xdeadbeef - seed;
+    AppendFixed(encoded, 12, &fixed32, sizeof(fixed32));
+    uint64_t fixed64 = 0x0123456789abcdefull + seed;
+    AppendFixed(encoded, 13, &fixed64, sizeof(fixed64));
+    int32_t sfixed32 = -3 - seed;
+    AppendFixed(encoded, 14, &sfixed32, sizeof(sfixed32));
+    int64_t sfixed64 = -4 - seed;
+    AppendFixed(encoded, 15, &sfixed64, sizeof(sfixed64));
+
+    double samples[] = { 0.5 + seed, 1.5, 2.5 };
+    lvbench::AppendLengthDelimited(encoded, 16, std::string((const char*)samples, sizeof(samples)));
+    std::string counts;
+    for (uint64_t count : { 1, 300, 70000 + seed })
+    {
+        lvbench::AppendVarint(counts, count);
+    }
+    lvbench::AppendLengthDelimited(encoded, 17, counts);
+    lvbench::AppendLengthDelimited(encoded, 18, "a");
+    lvbench::AppendLengthDelimited(encoded, 18, "bc" + std::to_string(seed));
+    return encoded;
+}
+
+//---------------------------------------------------------------------
+// Wire format of test.Batch
+//---------------------------------------------------------------------
+static std::string EncodeBatch(int readingCount)
+{
+    std::string encoded;
+    for (int x = 0; x < readingCount; ++x)
+    {
+        lvbench::AppendLengthDelimited(encoded, 1, EncodeReading(x));
+    }
+    lvbench::AppendLengthDelimited(encoded, 2, "rack 1");
+    lvbench::AppendLengthDelimited(encoded, 3, EncodeReading(100));
+    return encoded;
+}
+
+//---------------------------------------------------------------------
+// Wire format of test.Reordered, in ascending field number
+//---------------------------------------------------------------------
+static std::string EncodeReordered(int seed)
+{
+    std::string encoded;
+    lvbench::AppendTag(encoded, 1, 0);
+    lvbench::AppendVarint(encoded, 1 + seed);
+    lvbench::AppendLengthDelimited(encoded, 2, "second " + std::to_string(seed));
+    lvbench::AppendLengthDelimited(encoded, 5, EncodeReading(seed));
+    lvbench::AppendTag(encoded, 9, 0);
+    lvbench::AppendVarint(encoded, 9 + seed);
+    return encoded;
+}
+
+//---------------------------------------------------------------------
+// Wire format of test.Variety with the given field of the oneof, 3 or 4,
+// selected. Enum values are the proto values of test.Unit.
+//---------------------------------------------------------------------
+static std::string EncodeVariety(int selected, int seed)
+{
+    std::string encoded;
+    lvbench::AppendTag(encoded, 1, 0);
+    lvbench::AppendVarint(encoded, (uint64_t)(int64_t)-2);
+    std::string units;
+    for (int64_t unit : { 3, 0, -2, 3 })
+    {
+        lvbench::AppendVarint(units, (uint64_t)unit);
+    }
+    lvbench::AppendLengthDelimited(encoded, 2, units);
+    if (selected == 3)
+    {
+        lvbench::AppendTag(encoded, 3, 0);
+        lvbench::AppendVarint(encoded, 30 + seed);
+    }
+    else
+    {
+        lvbench::AppendLengthDelimited(encoded, 4, "chosen " + std::to_string(seed));
+    }
+
+    // Two rows of three doubles, then one row of two strings
+    std::string matrix;
+    lvbench::AppendTag(matrix, 1, 0);
+    lvbench::AppendVarint(matrix, 2);
+    lvbench::AppendTag(matrix, 2, 0);
+    lvbench::AppendVarint(matrix, 3);
+    double values[] = { 1.5, -2.5, 3.5 + seed, 4.5, 5.5, -6.5 };
+    lvbench::AppendLengthDelimited(matrix, 3, std::string((const char*)values, sizeof(values)));
+    lvbench::AppendLengthDelimited(encoded, 5, matrix);
+    std::string table;
+    lvbench::AppendTag(table, 1, 0);
+    lvbench::AppendVarint(table, 1);
+    lvbench::AppendTag(table, 2, 0);
+    lvbench::AppendVarint(table, 2);
+    lvbench::AppendLengthDelimited(table, 3, "left");
+    lvbench::AppendLengthDelimited(table, 3, "right " + std::to_string(seed));
+    lvbench::AppendLengthDelimited(encoded, 6, table);
+
+    lvbench::AppendLengthDelimited(encoded, 7, EncodeReading(seed));
+    lvbench::AppendLengthDelimited(encoded, 7, EncodeReading(seed + 1));
+    return encoded;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void RegisterMessages(grpc_labview::gRPCid** server)
+{
+    lvstub::RegisterMessage(server, "test.Reading", {
+        { "int32", 1, (int)LVMessageMetadataType::Int32Value, false, "" },
+        { "double", 2, (int)LVMessageMetadataType::DoubleValue, false, "" },
+        { "float", 3, (int)LVMessageMetadataType::FloatValue, false, "" },
+        { "int64", 4, (int)LVMessageMetadataType::Int64Value, false, "" },
+        { "uint32", 5, (int)LVMessageMetadataType::UInt32Value, false, "" },
+        { "uint64", 6, (int)LVMessageMetadataType::UInt64Value, false, "" },
+        { "bool", 7, (int)LVMessageMetadataType::BoolValue, false, "" },
+        { "string", 8, (int)LVMessageMetadataType::StringValue, false, "" },
+        { "bytes", 9, (int)LVMessageMetadataType::BytesValue, false, "" },
+        { "sint32", 10, (int)LVMessageMetadataType::SInt32Value, false, "" },
+        { "sint64", 11, (int)LVMessageMetadataType::SInt64Value, false, "" },
+        { "fixed32", 12, (int)LVMessageMetadataType::Fixed32Value, false, "" },
+        { "fixed64", 13, (int)LVMessageMetadataType::Fixed64Value, false, "" },
+        { "sfixed32", 14, (int)LVMessageMetadataType::SFixed32Value, false, "" },
+        { "sfixed64", 15, (int)LVMessageMetadataType::SFixed64Value, false, "" },
+        { "samples", 16, (int)LVMessageMetadataType::DoubleValue, true, "" },
+        { "counts", 17, (int)LVMessageMetadataType::Int32Value, true, "" },
+        { "labels", 18, (int)LVMessageMetadataType::StringValue, true, "" }
+    });
+    lvstub::RegisterMessage(server, "test.Batch", {
+        { "readings", 1, (int)LVMessageMetadataType::MessageValue, true, "test.Reading" },
+        { "source", 2, (int)LVMessageMetadataType::StringValue, false, "" },
+        { "reference", 3, (int)LVMessageMetadataType::MessageValue, false, "test.Reading" }
+    });
+    // The cluster order differs from the field number order
+    lvstub::RegisterMessage(server, "test.Reordered", {
+        { "ninth", 9, (int)LVMessageMetadataType::Int32Value, false, "" },
+        { "reading", 5, (int)LVMessageMetadataType::MessageValue, false, "test.Reading" },
+        { "first", 1, (int)LVMessageMetadataType::Int32Value, false, "" },
+        { "second", 2, (int)LVMessageMetadataType::StringValue, false, "" }
+    });
+    lvstub::RegisterEnum(server, "test.Unit", "VOLTS=0;AMPS=3;OHMS=-2");
+    lvstub::RegisterMessage(server, "test.Variety", {
+        { "unit", 1, (int)LVMessageMetadataType::EnumValue, false, "test.Unit" },
+        { "units", 2, (int)LVMessageMetadataType::EnumValue, true, "test.Unit" },
+        { "count", 3, (int)LVMessageMetadataType::Int32Value, false, "", true, "choice" },
+        { "name", 4, (int)LVMessageMetadataType::StringValue, false, "", true, "choice" },
+        { "choice_index", -1, (int)LVMessageMetadataType::Int32Value, false, "", true, "choice" },
+        { "matrix", 5, (int)LVMessageMetadataType::MessageValue, false, "ni_protobuf_types_Double2DArray" },
+        { "table", 6, (int)LVMessageMetadataType::MessageValue, false, "ni_protobuf_types_String2DArray" },
+        { "readings", 7, (int)LVMessageMetadataType::MessageValue, true, "test.Reading" }
+    });
+}
+
+//---------------------------------------------------------------------
+// Byte buffer of the message cut into slices of the given size, so that
+// fields straddle the slices.
+//---------------------------------------------------------------------
+static grpc::ByteBuffer CreateSlicedBuffer(const std::string& encoded, size_t sliceSize)
+{
+    std::vector<grpc::Slice> slices;
+    for (size_t offset = 0; offset < encoded.size(); offset += sliceSize)
+    {
+        slices.emplace_back(encoded.substr(offset, sliceSize));
+    }
+    return grpc::ByteBuffer(slices.data(), slices.size());
+}
+
+//---------------------------------------------------------------------
+// Parses then serializes the message on the heap and on an arena, reusing
+// each message for a second message, then through the cluster when the
+// metadata was finalized with its cluster layout, copied and parsed into it.
+//---------------------------------------------------------------------
+static void TestRoundTrip(std::shared_ptr<grpc_labview::MessageMetadata> metadata, const std::string& encoded, const std::string& other, bool throughCluster)
+{
+    for (auto ownArena : { false, true })
+    {
+        grpc_labview::LVMessage message(metadata);
+        if (ownArena)
+        {
+            message.UseOwnArena();
+        }
+        LVBENCH_CHECK(message.ParseFromString(encoded));
+        LVBENCH_CHECK(message.SerializeAsString() == encoded);
+
+        // Nothing of the first message is left after parsing the second
+        message.Clear();
+        LVBENCH_CHECK(message.SerializeAsString().empty());
+        LVBENCH_CHECK(message.ParseFromString(other));
+        LVBENCH_CHECK(message.SerializeAsString() == other);
+        message.Clear();
+        LVBENCH_CHECK(message.ParseFromString(encoded));
+        LVBENCH_CHECK(message.SerializeAsString() == encoded);
+        LVBENCH_CHECK(message.FindValue(1) != nullptr && message.FindValue(99) == nullptr);
+
+        // Straight from the slices of a received message and into the slices of a response
+        for (size_t sliceSize : { (size_t)7, encoded.size() })
+        {
+            message.Clear();
+            LVBENCH_CHECK(message.ParseFromByteBuffer(CreateSlicedBuffer(encoded, sliceSize)));
+            grpc::ByteBuffer serialized;
+            message.SerializeToByteBuffer(&serialized);
+            LVBENCH_CHECK(lvbench::Flatten(serialized) == encoded);
+        }
+    }
+    if (!throughCluster)
+    {
+        return;
+    }
+
+    grpc_labview::LVMessage parsed(metadata);
+    LVBENCH_CHECK(parsed.ParseFromString(encoded));
+    auto liveHandles = lvstub::LiveHandleCount();
+    std::vector<uint64_t> storage(metadata->clusterSize / sizeof(uint64_t) + 1, 0);
+    auto cluster = (int8_t*)storage.data();
+    grpc_labview::ClusterDataCopier::CopyToCluster(parsed, cluster);
+    LVBENCH_CHECK(lvstub::LiveHandleCount() > liveHandles);
+
+    grpc_labview::LVMessage copied(metadata);
+    copied.UseOwnArena();
+    grpc_labview::ClusterDataCopier::CopyFromCluster(copied, cluster);
+    LVBENCH_CHECK(copied.SerializeAsString() == encoded);
+
+    grpc_labview::ClusterDataCopier::ReleaseClusterHandles(*metadata, cluster);
+    LVBENCH_CHECK(lvstub::LiveHandleCount() == liveHandles);
+
+    // Parsed straight into the cluster, as for efficient message copy
+    grpc_labview::LVMessageEfficient efficient(metadata, cluster);
+    LVBENCH_CHECK(efficient.ParseFromString(encoded));
+    grpc_labview::LVMessage copiedEfficient(metadata);
+    grpc_labview::ClusterDataCopier::CopyFromCluster(copiedEfficient, cluster);
+    LVBENCH_CHECK(copiedEfficient.SerializeAsString() == encoded);
+
+    grpc_labview::ClusterDataCopier::ReleaseClusterHandles(*metadata, cluster);
+    LVBENCH_CHECK(lvstub::LiveHandleCount() == liveHandles);
+    for (auto& element : metadata->_elements)
+    {
+        if (element->isRepeated || element->type == LVMessageMetadataType::StringValue || element->type == LVMessageMetadataType::BytesValue)
+        {
+            LVBENCH_CHECK(*(void**)(cluster + element->clusterOffset) == nullptr);
+        }
+    }
+}
+
+//---------------------------------------------------------------------
+// ClusterSerializer writes the bytes of the message copied from the cluster.
+//---------------------------------------------------------------------
+static void CheckClusterSerializer(std::shared_ptr<grpc_labview::MessageMetadata> metadata, int8_t* cluster)
+{
+    grpc::ByteBuffer direct;
+    grpc_labview::ClusterSerializer(metadata, cluster).SerializeToByteBuffer(&direct);
+    grpc_labview::LVMessage copied(metadata);
+    grpc_labview::ClusterDataCopier::CopyFromCluster(copied, cluster);
+    grpc::ByteBuffer serialized;
+    copied.SerializeToByteBuffer(&serialized);
+    LVBENCH_CHECK(lvbench::Flatten(direct) == lvbench::Flatten(serialized));
+}
+
+//---------------------------------------------------------------------
+// Serializes the cluster of the message directly and through a message
+// copied from it, with every field set, then with its numeric arrays
+// emptied and with nothing set.
+//---------------------------------------------------------------------
+static void TestClusterSerializer(std::shared_ptr<grpc_labview::MessageMetadata> metadata, const std::string& encoded)
+{
+    grpc_labview::LVMessage parsed(metadata);
+    LVBENCH_CHECK(parsed.ParseFromString(encoded));
+    std::vector<uint64_t> storage(metadata->clusterSize / sizeof(uint64_t) + 1, 0);
+    auto cluster = (int8_t*)storage.data();
+    CheckClusterSerializer(metadata, cluster);
+
+    grpc_labview::ClusterDataCopier::CopyToCluster(parsed, cluster);
+    CheckClusterSerializer(metadata, cluster);
+    grpc::ByteBuffer direct;
+    grpc_labview::ClusterSerializer(metadata, cluster).SerializeToByteBuffer(&direct);
+    LVBENCH_CHECK(lvbench::Flatten(direct) == encoded);
+
+    for (auto& element : metadata->_elements)
+    {
+        auto array = *(grpc_labview::LV1DArrayHandle*)(cluster + element->clusterOffset);
+        if (element->isRepeated && element->type != LVMessageMetadataType::StringValue && element->type != LVMessageMetadataType::MessageValue && array != nullptr)
+        {
+            (*array)->cnt = 0;
+        }
+    }
+    CheckClusterSerializer(metadata, cluster);
+    grpc_labview::ClusterDataCopier::ReleaseClusterHandles(*metadata, cluster);
+}
+
+//---------------------------------------------------------------------
+// A packed field whose size runs past the end of the message is rejected
+// without reserving its elements, also when nested in another message or
+// in a repeated message.
+//---------------------------------------------------------------------
+static void TestPackedSizePastEnd(std::shared_ptr<grpc_labview::MessageMetadata> reading, std::shared_ptr<grpc_labview::MessageMetadata> batch)
+{
+    std::string truncated;
+    lvbench::AppendTag(truncated, 16, 2);
+    lvbench::AppendVarint(truncated, 0x7ffffff0);
+    truncated.append(16, '\0');
+    grpc_labview::LVMessage message(reading);
+    LVBENCH_CHECK(!message.ParseFromString(truncated));
+
+    for (auto protobufIndex : { 1, 3 })
+    {
+        std::string nested;
+        lvbench::AppendLengthDelimited(nested, protobufIndex, truncated);
+        lvbench::AppendLengthDelimited(nested, protobufIndex, truncated);
+        grpc_labview::LVMessage batchMessage(batch);
+        LVBENCH_CHECK(!batchMessage.ParseFromString(nested));
+    }
+}
+
+//---------------------------------------------------------------------
+// Metadata of scalar fields with the given numbers, in order.
+//---------------------------------------------------------------------
+static std::shared_ptr<grpc_labview::MessageMetadata> CreateMetadata(const std::vector<int>& protobufIndexes, bool compile)
+{
+    auto metadata = std::make_shared<grpc_labview::MessageMetadata>();
+    for (auto index : protobufIndexes)
+    {
+        metadata->AddElement(std::make_shared<grpc_labview::MessageElementMetadata>(LVMessageMetadataType::Int32Value, false, index));
+    }
+    if (compile)
+    {
+        metadata->CompileFieldParsers();
+    }
+    return metadata;
+}
+
+//---------------------------------------------------------------------
+// The compiled parsers find the element the map finds for every number,
+// the first of the elements that share a number, and nothing for the
+// numbers of no element.
+//---------------------------------------------------------------------
+static void TestFieldParsers(const std::vector<int>& protobufIndexes, const std::vector<int>& unknownIndexes)
+{
+    auto compiled = CreateMetadata(protobufIndexes, true);
+    auto mapped = CreateMetadata(protobufIndexes, false);
+    LVBENCH_CHECK(compiled->FieldParsersCompiled() && !mapped->FieldParsersCompiled());
+
+    const grpc_labview::FieldParser* previous = nullptr;
+    std::string encoded;
+    for (size_t x = 0; x < protobufIndexes.size(); ++x)
+    {
+        auto index = protobufIndexes[x];
+        auto parser = compiled->FindFieldParser(index);
+        LVBENCH_CHECK(parser != nullptr && parser->protobufIndex == (uint32_t)index);
+        LVBENCH_CHECK(parser != nullptr && parser->field == compiled->_mappedElements[index].get());
+        LVBENCH_CHECK(parser != nullptr && parser->parse == grpc_labview::LVMessage::FieldParserFor(*parser->field));
+        LVBENCH_CHECK(parser != nullptr && parser->parseIntoCluster == grpc_labview::LVMessageEfficient::FieldParserFor(*parser->field));
+        // The first element with the number, whatever its position
+        size_t first = 0;
+        while (protobufIndexes[first] != index) ++first;
+        LVBENCH_CHECK(parser != nullptr && parser->field == compiled->_elements[first].get());
+        // Looking up from the parser of the field before finds the same parser
+        LVBENCH_CHECK(compiled->FindFieldParser(index, previous) == parser);
+        previous = parser;
+
+        lvbench::AppendTag(encoded, index, 0);
+        lvbench::AppendVarint(encoded, 10 + x);
+    }
+    for (auto index : unknownIndexes)
+    {
+        LVBENCH_CHECK(compiled->FindFieldParser(index) == nullptr);
+        LVBENCH_CHECK(compiled->FindFieldParser(index, previous) == nullptr);
+    }
+
+    // Values of a shared number go to the first element, the last value read wins
+    grpc_labview::LVMessage compiledMessage(compiled);
+    grpc_labview::LVMessage mappedMessage(mapped);
+    LVBENCH_CHECK(compiledMessage.ParseFromString(encoded) && mappedMessage.ParseFromString(encoded));
+    LVBENCH_CHECK(!compiledMessage.SerializeAsString().empty());
+    LVBENCH_CHECK(compiledMessage.SerializeAsString() == mappedMessage.SerializeAsString());
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    grpc_labview::gRPCid* mappedServer = nullptr;
+    grpc_labview::gRPCid* compiledServer = nullptr;
+    LVCreateServer(&mappedServer);
+    LVCreateServer(&compiledServer);
+    RegisterMessages(&mappedServer);
+    RegisterMessages(&compiledServer);
+    CompleteMetadataRegistration(&compiledServer);
+
+    for (auto server : { mappedServer, compiledServer })
+    {
+        auto labviewServer = server->CastTo<grpc_labview::LabVIEWgRPCServer>();
+        auto reading = labviewServer->FindMetadata("test.Reading");
+        auto batch = labviewServer->FindMetadata("test.Batch");
+        bool finalized = server == compiledServer;
+        LVBENCH_CHECK(reading->FieldParsersCompiled() == finalized);
+        TestRoundTrip(reading, EncodeReading(0), EncodeReading(1), finalized);
+        TestRoundTrip(batch, EncodeBatch(3), EncodeBatch(1), finalized);
+        TestRoundTrip(labviewServer->FindMetadata("test.Reordered"), EncodeReordered(0), EncodeReordered(1), finalized);
+        TestPackedSizePastEnd(reading, batch);
+        if (finalized)
+        {
+            TestClusterSerializer(reading, EncodeReading(0));
+            TestClusterSerializer(batch, EncodeBatch(3));
+            TestClusterSerializer(labviewServer->FindMetadata("test.Reordered"), EncodeReordered(0));
+            for (auto selected : { 3, 4 })
+            {
+                TestRoundTrip(labviewServer->FindMetadata("test.Variety"), EncodeVariety(selected, 0), EncodeVariety(7 - selected, 1), true);
+                TestClusterSerializer(labviewServer->FindMetadata("test.Variety"), EncodeVariety(selected, 0));
+            }
+
+            // Nested messages are parsed with the metadata resolved when compiled
+            for (auto index : { 1, 3 })
+            {
+                auto parser = batch->FindFieldParser(index);
+                LVBENCH_CHECK(parser != nullptr && parser->nestedMetadata.lock() == reading);
+                LVBENCH_CHECK(parser != nullptr && parser->clusterOffset == parser->field->clusterOffset);
+            }
+            LVBENCH_CHECK(batch->FindFieldParser(2) != nullptr && batch->FindFieldParser(2)->nestedMetadata.expired());
+        }
+    }
+
+    // Dense, with 3 used twice
+    TestFieldParsers({ 1, 2, 3, 5, 3 }, { 0, 4, 6, 64, 1000 });
+    // Sparse, with 1000 used twice
+    TestFieldParsers({ 1, 1000, 100000, 1000, 7 }, { 0, 2, 6, 999, 1001, 200000 });
+    return lvbench::TestResult();
+}
@@ -0,0 +1,150 @@
+//---------------------------------------------------------------------
+// Tests of GetRequestDataBatch in labview_grpc_server.
+//
+// The client streams a fixed number of requests with a string field. The
+// handler reads them in batches whose size depends on how many requests
+// were read ahead: it waits until the read ahead ring holds every request
+// left, takes a full batch, then a single request into the same array so that the batch
+// shrinks. Checks the batch sizes, that the requests arrive in order with
+// their strings and that no handle of a dropped cluster is left behind.
+//
+// Usage: request_batch_test
+//---------------------------------------------------------------------
+#include "benchmark_harness.h"
+#include "lv_runtime_stub.h"
+#include <grpc_server.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static const char* kUploadMethod = "/test.Test/Upload";
+static const char* kUploadMessage = "test.UploadMessage";
+
+//---------------------------------------------------------------------
+// LabVIEW cluster for test.UploadMessage
+//---------------------------------------------------------------------
+struct UploadCluster
+{
+    int32_t id;
+    grpc_labview::LStrHandle payload;
+};
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static const int kMessageCount = 7;
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static std::string Payload(int32_t id)
+{
+    return "payload " + std::to_string(id);
+}
+
+//---------------------------------------------------------------------
+// Waits until the call holds count requests that GetRequestData can take
+// without waiting.
+//---------------------------------------------------------------------
+static bool WaitForBufferedRequests(grpc_labview::gRPCid* id, int32_t count)
+{
+    auto call = id->CastTo<grpc_labview::GenericMethodData>()->_call;
+    auto end = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (call->BufferedRequestCount() < count && std::chrono::steady_clock::now() < end)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return call->BufferedRequestCount() >= count;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void HandleUpload(grpc_labview::gRPCid* id)
+{
+    auto liveHandles = lvstub::LiveHandleCount();
+    grpc_labview::LV1DArrayHandle batch = nullptr;
+    std::vector<int32_t> counts;
+    int32_t received = 0;
+    // The first two start the read ahead, the third takes what it read
+    // meanwhile and the fourth the last request alone.
+    const int32_t maxCounts[] = { 1, 1, 4, 4, 4 };
+    for (auto maxCount : maxCounts)
+    {
+        if (counts.size() == 2)
+        {
+            LVBENCH_CHECK(WaitForBufferedRequests(id, kMessageCount - received));
+        }
+        int32_t count = 0;
+        if (GetRequestDataBatch(&id, &batch, maxCount, &count) != 0)
+        {
+            break;
+        }
+        counts.push_back(count);
+        LVBENCH_CHECK(batch != nullptr && (*batch)->cnt == count);
+        for (int32_t x = 0; x < count; ++x)
+        {
+            auto cluster = (UploadCluster*)lvstub::GetLVClusterArrayElement(batch, x, sizeof(UploadCluster), alignof(UploadCluster));
+            LVBENCH_CHECK(cluster->id == received);
+            LVBENCH_CHECK(lvstub::GetLVString(cluster->payload) == Payload(received));
+            ++received;
+        }
+    }
+    LVBENCH_CHECK((counts == std::vector<int32_t>{ 1, 1, 4, 1 }));
+    LVBENCH_CHECK(received == kMessageCount);
+
+    for (int32_t x = 0; batch != nullptr && x < (*batch)->cnt; ++x)
+    {
+        lvstub::DisposeLVString(((UploadCluster*)lvstub::GetLVClusterArrayElement(batch, x, sizeof(UploadCluster), alignof(UploadCluster)))->payload);
+    }
+    lvstub::DisposeLVArray(batch);
+    LVBENCH_CHECK(lvstub::LiveHandleCount() == liveHandles);
+
+    UploadCluster response = { received, nullptr };
+    SetResponseData(&id, (int8_t*)&response);
+    CloseServerEvent(&id);
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    auto uploadEvent = lvstub::CreateUserEvent(HandleUpload);
+    lvstub::StartEventLoop(1);
+
+    grpc_labview::gRPCid* server = nullptr;
+    LVCreateServer(&server);
+    lvstub::RegisterMessage(&server, kUploadMessage, {
+        { "id", 1, (int)grpc_labview::LVMessageMetadataType::Int32Value, false, "" },
+        { "payload", 2, (int)grpc_labview::LVMessageMetadataType::StringValue, false, "" }
+    });
+    CompleteMetadataRegistration(&server);
+    RegisterServerEvent(&server, kUploadMethod, &uploadEvent, kUploadMessage, kUploadMessage);
+    LVSetServerReadAheadDepth(&server, 8);
+
+    auto address = lvbench::StartLocalServer(&server);
+    LVBENCH_CHECK(!address.empty());
+    if (!address.empty())
+    {
+        std::vector<grpc::ByteBuffer> requests;
+        for (int32_t x = 0; x < kMessageCount; ++x)
+        {
+            std::string request;
+            lvbench::AppendTag(request, 1, 0);
+            lvbench::AppendVarint(request, (uint32_t)x);
+            lvbench::AppendLengthDelimited(request, 2, Payload(x));
+            requests.push_back(lvbench::CreateByteBuffer(request));
+        }
+        grpc::GenericStub stub(lvbench::CreateClientChannel(address));
+        grpc::CompletionQueue cq;
+        grpc::ByteBuffer response;
+        LVBENCH_CHECK(lvbench::ClientStreamingCall(stub, cq, kUploadMethod, requests, &response).ok());
+        auto bytes = lvbench::Flatten(response);
+        size_t offset = 1;
+        LVBENCH_CHECK(!bytes.empty() && bytes[0] == 0x08 && lvbench::ReadVarint(bytes, offset) == kMessageCount);
+        lvbench::ShutdownCompletionQueue(cq);
+    }
+    LVStopServer(&server);
+    lvstub::StopEventLoop();
+    return lvbench::TestResult();
+}
@@ -0,0 +1,300 @@
+//---------------------------------------------------------------------
+// Tests of SetResponseDataBatch in labview_grpc_server.
+//
+// The handler of a server streaming call writes batches of messages. The
+// client reads nothing until the handler has seen a batch rejected
+// because the write queue is full, which the large messages of the first
+// batch keep full as long as the client does not read them. The rejected
+// batch is then set again. Checks that the client receives every message
+// once and in order, that an empty batch sends nothing, that a batch set
+// after the client cancelled the call is rejected as cancelled and that a
+// batch set after the call was closed is rejected.
+//
+// Usage: response_batch_test
+//---------------------------------------------------------------------
+#include "benchmark_harness.h"
+#include "lv_runtime_stub.h"
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static const char* kDownloadMethod = "/test.Test/Download";
+static const char* kDownloadMessage = "test.DownloadMessage";
+static const int32_t kQueueFull = -(1000 + grpc::StatusCode::RESOURCE_EXHAUSTED);
+static const int32_t kCancelled = -(1000 + grpc::StatusCode::CANCELLED);
+
+//---------------------------------------------------------------------
+// LabVIEW cluster for test.DownloadMessage
+//---------------------------------------------------------------------
+struct DownloadCluster
+{
+    int32_t id;
+    grpc_labview::LStrHandle payload;
+};
+
+//---------------------------------------------------------------------
+// Requests of the two calls, and the messages of the first: large ones
+// well past the flow control window of the client, then small ones.
+//---------------------------------------------------------------------
+static const int32_t kOrderedCall = 1;
+static const int32_t kCancelledCall = 2;
+static const int32_t kLargeCount = 3;
+static const size_t kLargePayload = 1024 * 1024;
+static const size_t kSmallPayload = 16;
+static const int32_t kMessageCount = kLargeCount + 2 + 5;
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static std::promise<void> gQueueFullSeen;
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static std::string Payload(int32_t id)
+{
+    return std::string(id < kLargeCount ? kLargePayload : kSmallPayload, (char)('a' + id));
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void DisposePayloads(grpc_labview::LV1DArrayHandle batch)
+{
+    for (int32_t x = 0; batch != nullptr && x < (*batch)->cnt; ++x)
+    {
+        auto cluster = (DownloadCluster*)lvstub::GetLVClusterArrayElement(batch, x, sizeof(DownloadCluster), alignof(DownloadCluster));
+        lvstub::DisposeLVString(cluster->payload);
+        cluster->payload = nullptr;
+    }
+}
+
+//---------------------------------------------------------------------
+// Fills the batch with count messages starting at firstId.
+//---------------------------------------------------------------------
+static void FillBatch(grpc_labview::LV1DArrayHandle* batch, int32_t firstId, int32_t count)
+{
+    DisposePayloads(*batch);
+    lvstub::ResizeLVClusterArray(batch, count, sizeof(DownloadCluster), alignof(DownloadCluster));
+    for (int32_t x = 0; x < count; ++x)
+    {
+        auto cluster = (DownloadCluster*)lvstub::GetLVClusterArrayElement(*batch, x, sizeof(DownloadCluster), alignof(DownloadCluster));
+        cluster->id = firstId + x;
+        cluster->payload = lvstub::CreateLVString(Payload(firstId + x));
+    }
+}
+
+//---------------------------------------------------------------------
+// Sets the batch again for as long as the write queue is full.
+//---------------------------------------------------------------------
+static int32_t SetWhenQueueDrains(grpc_labview::gRPCid* id, grpc_labview::LV1DArrayHandle* batch)
+{
+    auto result = SetResponseDataBatch(&id, batch);
+    while (result == kQueueFull)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        result = SetResponseDataBatch(&id, batch);
+    }
+    return result;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static bool WaitForCancel(grpc_labview::gRPCid* id)
+{
+    auto end = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (IsCancelled(&id) == 0 && std::chrono::steady_clock::now() < end)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return IsCancelled(&id) != 0;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void HandleDownload(grpc_labview::gRPCid* id)
+{
+    DownloadCluster request = { 0, nullptr };
+    LVBENCH_CHECK(GetRequestData(&id, (int8_t*)&request) == 0);
+    lvstub::DisposeLVString(request.payload);
+
+    grpc_labview::LV1DArrayHandle batch = nullptr;
+    if (request.id == kCancelledCall)
+    {
+        FillBatch(&batch, 0, 1);
+        LVBENCH_CHECK(SetResponseDataBatch(&id, &batch) == 0);
+        LVBENCH_CHECK(WaitForCancel(id));
+        FillBatch(&batch, 1, 1);
+        LVBENCH_CHECK(SetResponseDataBatch(&id, &batch) == kCancelled);
+    }
+    else
+    {
+        // A batch is queued whole even when it goes past the write queue depth
+        FillBatch(&batch, 0, kLargeCount);
+        LVBENCH_CHECK(SetResponseDataBatch(&id, &batch) == 0);
+        FillBatch(&batch, kLargeCount, 2);
+        LVBENCH_CHECK(SetResponseDataBatch(&id, &batch) == kQueueFull);
+        gQueueFullSeen.set_value();
+        LVBENCH_CHECK(SetWhenQueueDrains(id, &batch) == 0);
+        // An empty batch sends nothing, whether the queue is full or not
+        FillBatch(&batch, kLargeCount + 2, 0);
+        LVBENCH_CHECK(SetResponseDataBatch(&id, &batch) == 0);
+        FillBatch(&batch, kLargeCount + 2, kMessageCount - kLargeCount - 2);
+        LVBENCH_CHECK(SetWhenQueueDrains(id, &batch) == 0);
+    }
+    DisposePayloads(batch);
+    CloseServerEvent(&id);
+
+    grpc_labview::LV1DArrayHandle empty = nullptr;
+    LVBENCH_CHECK(SetResponseDataBatch(&id, &batch) == -1);
+    LVBENCH_CHECK(SetResponseDataBatch(&id, &empty) == -1);
+    lvstub::DisposeLVArray(batch);
+}
+
+//---------------------------------------------------------------------
+// Reads the id and payload of a test.DownloadMessage, field 1 is omitted
+// when zero.
+//---------------------------------------------------------------------
+static bool ParseDownload(const grpc::ByteBuffer& buffer, int32_t* id, std::string* payload)
+{
+    auto message = lvbench::Flatten(buffer);
+    *id = 0;
+    size_t offset = 0;
+    while (offset < message.size())
+    {
+        auto tag = lvbench::ReadVarint(message, offset);
+        if (tag == 0x08)
+        {
+            *id = (int32_t)lvbench::ReadVarint(message, offset);
+        }
+        else if (tag == 0x12)
+        {
+            auto size = (size_t)lvbench::ReadVarint(message, offset);
+            if (offset + size > message.size())
+            {
+                return false;
+            }
+            *payload = message.substr(offset, size);
+            offset += size;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//---------------------------------------------------------------------
+// Starts a call of the download method with the given request and
+// closes the request stream.
+//---------------------------------------------------------------------
+static std::unique_ptr<grpc::GenericClientAsyncReaderWriter> StartDownload(grpc::GenericStub& stub, grpc::CompletionQueue& cq, grpc::ClientContext& context, int32_t requestId)
+{
+    void* tag;
+    bool ok;
+    auto call = stub.PrepareCall(&context, kDownloadMethod, &cq);
+    call->StartCall((void*)1);
+    cq.Next(&tag, &ok);
+    std::string request;
+    lvbench::AppendTag(request, 1, 0);
+    lvbench::AppendVarint(request, (uint32_t)requestId);
+    call->Write(lvbench::CreateByteBuffer(request), (void*)2);
+    cq.Next(&tag, &ok);
+    call->WritesDone((void*)3);
+    cq.Next(&tag, &ok);
+    return call;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void TestOrderedCall(grpc::GenericStub& stub, grpc::CompletionQueue& cq)
+{
+    grpc::ClientContext context;
+    auto call = StartDownload(stub, cq, context, kOrderedCall);
+    LVBENCH_CHECK(gQueueFullSeen.get_future().wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+
+    void* tag;
+    bool ok;
+    int32_t received = 0;
+    while (true)
+    {
+        grpc::ByteBuffer response;
+        call->Read(&response, (void*)4);
+        cq.Next(&tag, &ok);
+        if (!ok)
+        {
+            break;
+        }
+        int32_t id;
+        std::string payload;
+        LVBENCH_CHECK(ParseDownload(response, &id, &payload));
+        LVBENCH_CHECK(id == received);
+        LVBENCH_CHECK(payload == Payload(received));
+        ++received;
+    }
+    LVBENCH_CHECK(received == kMessageCount);
+    grpc::Status status;
+    call->Finish(&status, (void*)5);
+    cq.Next(&tag, &ok);
+    LVBENCH_CHECK(status.ok());
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void TestCancelledCall(grpc::GenericStub& stub, grpc::CompletionQueue& cq)
+{
+    grpc::ClientContext context;
+    auto call = StartDownload(stub, cq, context, kCancelledCall);
+
+    void* tag;
+    bool ok;
+    grpc::ByteBuffer response;
+    call->Read(&response, (void*)4);
+    cq.Next(&tag, &ok);
+    int32_t id = -1;
+    std::string payload;
+    LVBENCH_CHECK(ok && ParseDownload(response, &id, &payload) && id == 0);
+    context.TryCancel();
+
+    grpc::Status status;
+    call->Finish(&status, (void*)5);
+    cq.Next(&tag, &ok);
+    LVBENCH_CHECK(status.error_code() == grpc::StatusCode::CANCELLED);
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    auto downloadEvent = lvstub::CreateUserEvent(HandleDownload);
+    lvstub::StartEventLoop(1);
+
+    grpc_labview::gRPCid* server = nullptr;
+    LVCreateServer(&server);
+    lvstub::RegisterMessage(&server, kDownloadMessage, {
+        { "id", 1, (int)grpc_labview::LVMessageMetadataType::Int32Value, false, "" },
+        { "payload", 2, (int)grpc_labview::LVMessageMetadataType::StringValue, false, "" }
+    });
+    CompleteMetadataRegistration(&server);
+    RegisterServerEvent(&server, kDownloadMethod, &downloadEvent, kDownloadMessage, kDownloadMessage);
+    LVSetServerWriteQueueDepth(&server, 2);
+
+    auto address = lvbench::StartLocalServer(&server);
+    LVBENCH_CHECK(!address.empty());
+    if (!address.empty())
+    {
+        // Without probing the bandwidth the client keeps its initial flow control window
+        grpc::ChannelArguments args;
+        args.SetInt(GRPC_ARG_HTTP2_BDP_PROBE, 0);
+        grpc::GenericStub stub(grpc::CreateCustomChannel(address, grpc::InsecureChannelCredentials(), args));
+        grpc::CompletionQueue cq;
+        TestOrderedCall(stub, cq);
+        TestCancelledCall(stub, cq);
+        lvbench::ShutdownCompletionQueue(cq);
+    }
+    LVStopServer(&server);
+    lvstub::StopEventLoop();
+    return lvbench::TestResult();
+}
@@ -0,0 +1,262 @@
+//---------------------------------------------------------------------
+// Tests of the response cache of labview_grpc_server.
+//
+// Checks the hits, misses, time to live and least recently used eviction
+// order of ResponseCache on its own, then that a method with a cache
+// answers an identical request without calling its handler and that a
+// client streaming call, whose later requests are not part of the key,
+// is never cached.
+//
+// Usage: response_cache_test
+//---------------------------------------------------------------------
+#include "benchmark_harness.h"
+#include "lv_runtime_stub.h"
+#include <response_cache.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static const char* kLookupMethod = "/test.Test/Lookup";
+static const char* kSumMethod = "/test.Test/Sum";
+static const char* kRequestMessage = "test.Request";
+static const char* kResponseMessage = "test.Response";
+
+//---------------------------------------------------------------------
+// LabVIEW clusters for test.Request and test.Response
+//---------------------------------------------------------------------
+struct RequestCluster
+{
+    int32_t value;
+};
+
+struct ResponseCluster
+{
+    int32_t value;
+    int32_t sequence;
+};
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static std::atomic<int32_t> gHandled(0);
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void HandleLookup(grpc_labview::gRPCid* id)
+{
+    RequestCluster request = { 0 };
+    if (GetRequestData(&id, (int8_t*)&request) == 0)
+    {
+        ResponseCluster response = { request.value * 10, ++gHandled };
+        SetResponseData(&id, (int8_t*)&response);
+    }
+    CloseServerEvent(&id);
+}
+
+//---------------------------------------------------------------------
+// Client streaming, responds with the sum of the values it read.
+//---------------------------------------------------------------------
+static void HandleSum(grpc_labview::gRPCid* id)
+{
+    RequestCluster request = { 0 };
+    int32_t sum = 0;
+    while (GetRequestData(&id, (int8_t*)&request) == 0)
+    {
+        sum += request.value;
+    }
+    ResponseCluster response = { sum, ++gHandled };
+    SetResponseData(&id, (int8_t*)&response);
+    CloseServerEvent(&id);
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static grpc::ByteBuffer CreateRequest(int32_t value)
+{
+    std::string request;
+    lvbench::AppendTag(request, 1, 0);
+    lvbench::AppendVarint(request, (uint32_t)value);
+    return lvbench::CreateByteBuffer(request);
+}
+
+//---------------------------------------------------------------------
+// Value of a varint field of a response, 0 if it has none.
+//---------------------------------------------------------------------
+static int32_t ReadValue(const std::string& response, int protobufIndex)
+{
+    size_t offset = 0;
+    while (offset < response.size())
+    {
+        auto tag = lvbench::ReadVarint(response, offset);
+        auto value = lvbench::ReadVarint(response, offset);
+        if ((int)(tag >> 3) == protobufIndex)
+        {
+            return (int32_t)value;
+        }
+    }
+    return 0;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static size_t EntryBytes(const std::string& request, const std::string& response)
+{
+    // Size the cache accounts for an entry: its request, its response and the bookkeeping of the entry
+    return request.size() + response.size() + 128;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void TestHitsAndMisses()
+{
+    grpc_labview::ResponseCache cache(1024 * 1024, 0);
+    grpc::ByteBuffer response;
+    LVBENCH_CHECK(!cache.Find("a", &response));
+    cache.Insert("a", lvbench::CreateByteBuffer("response a"));
+    LVBENCH_CHECK(cache.Find("a", &response) && lvbench::Flatten(response) == "response a");
+    LVBENCH_CHECK(!cache.Find("b", &response));
+
+    // Inserting a request again replaces its response
+    cache.Insert("a", lvbench::CreateByteBuffer("response a2"));
+    LVBENCH_CHECK(cache.Find("a", &response) && lvbench::Flatten(response) == "response a2");
+
+    uint64_t hits, misses, bytes;
+    int32_t entries;
+    cache.GetStats(&hits, &misses, &entries, &bytes);
+    LVBENCH_CHECK(hits == 2 && misses == 2);
+    LVBENCH_CHECK(entries == 1 && bytes == EntryBytes("a", "response a2"));
+
+    cache.Clear();
+    LVBENCH_CHECK(!cache.Find("a", &response));
+    cache.GetStats(&hits, &misses, &entries, &bytes);
+    LVBENCH_CHECK(entries == 0 && bytes == 0);
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void TestTimeToLive()
+{
+    grpc_labview::ResponseCache cache(1024 * 1024, 50);
+    grpc::ByteBuffer response;
+    cache.Insert("a", lvbench::CreateByteBuffer("response a"));
+    LVBENCH_CHECK(cache.Find("a", &response));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    LVBENCH_CHECK(!cache.Find("a", &response));
+
+    uint64_t hits, misses, bytes;
+    int32_t entries;
+    cache.GetStats(&hits, &misses, &entries, &bytes);
+    LVBENCH_CHECK(hits == 1 && misses == 1 && entries == 0);
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void TestEvictionOrder()
+{
+    // Room for three entries of a one byte request and an eight byte response
+    grpc_labview::ResponseCache cache(3 * EntryBytes("a", "12345678"), 0);
+    grpc::ByteBuffer response;
+    for (auto request : { "a", "b", "c" })
+    {
+        cache.Insert(request, lvbench::CreateByteBuffer("12345678"));
+    }
+    // a becomes the most recently used, so b is the first evicted
+    LVBENCH_CHECK(cache.Find("a", &response));
+    cache.Insert("d", lvbench::CreateByteBuffer("12345678"));
+    LVBENCH_CHECK(!cache.Find("b", &response));
+    LVBENCH_CHECK(cache.Find("c", &response));
+    LVBENCH_CHECK(cache.Find("d", &response));
+    LVBENCH_CHECK(cache.Find("a", &response));
+
+    // c was used before d and a
+    cache.Insert("e", lvbench::CreateByteBuffer("12345678"));
+    LVBENCH_CHECK(!cache.Find("c", &response));
+    LVBENCH_CHECK(cache.Find("d", &response));
+    LVBENCH_CHECK(cache.Find("a", &response));
+    LVBENCH_CHECK(cache.Find("e", &response));
+
+    // An entry larger than the whole cache is not kept and evicts nothing
+    cache.Insert("f", lvbench::CreateByteBuffer(std::string(4 * EntryBytes("a", "12345678"), 'x')));
+    LVBENCH_CHECK(!cache.Find("f", &response));
+    uint64_t hits, misses, bytes;
+    int32_t entries;
+    cache.GetStats(&hits, &misses, &entries, &bytes);
+    LVBENCH_CHECK(entries == 3);
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void TestServerCache(grpc_labview::LVUserEventRef lookupEvent, grpc_labview::LVUserEventRef sumEvent)
+{
+    grpc_labview::gRPCid* server = nullptr;
+    LVCreateServer(&server);
+    lvstub::RegisterMessage(&server, kRequestMessage, {
+        { "value", 1, (int)grpc_labview::LVMessageMetadataType::Int32Value, false, "" }
+    });
+    lvstub::RegisterMessage(&server, kResponseMessage, {
+        { "value", 1, (int)grpc_labview::LVMessageMetadataType::Int32Value, false, "" },
+        { "sequence", 2, (int)grpc_labview::LVMessageMetadataType::Int32Value, false, "" }
+    });
+    CompleteMetadataRegistration(&server);
+    RegisterServerEvent(&server, kLookupMethod, &lookupEvent, kRequestMessage, kResponseMessage);
+    RegisterServerEvent(&server, kSumMethod, &sumEvent, kRequestMessage, kResponseMessage);
+    LVSetServerMethodResponseCache(&server, kLookupMethod, 1024 * 1024, 60000);
+    LVSetServerMethodResponseCache(&server, kSumMethod, 1024 * 1024, 60000);
+
+    auto address = lvbench::StartLocalServer(&server);
+    LVBENCH_CHECK(!address.empty());
+    if (!address.empty())
+    {
+        grpc::GenericStub stub(lvbench::CreateClientChannel(address));
+        grpc::CompletionQueue cq;
+        grpc::ByteBuffer first, second, other;
+        gHandled = 0;
+
+        LVBENCH_CHECK(lvbench::UnaryCall(stub, cq, kLookupMethod, CreateRequest(7), &first).ok());
+        LVBENCH_CHECK(lvbench::UnaryCall(stub, cq, kLookupMethod, CreateRequest(7), &second).ok());
+        LVBENCH_CHECK(ReadValue(lvbench::Flatten(first), 1) == 70);
+        LVBENCH_CHECK(lvbench::Flatten(second) == lvbench::Flatten(first));
+        LVBENCH_CHECK(gHandled == 1);
+
+        LVBENCH_CHECK(lvbench::UnaryCall(stub, cq, kLookupMethod, CreateRequest(8), &other).ok());
+        LVBENCH_CHECK(ReadValue(lvbench::Flatten(other), 1) == 80 && ReadValue(lvbench::Flatten(other), 2) == 2);
+        LVBENCH_CHECK(gHandled == 2);
+
+        uint64_t hits, misses, bytes;
+        int32_t entries;
+        LVGetServerMethodResponseCacheStats(&server, kLookupMethod, &hits, &misses, &entries, &bytes);
+        LVBENCH_CHECK(hits == 1 && misses == 2 && entries == 2);
+
+        // Two streams with the same first request and a different second one
+        grpc::ByteBuffer sum;
+        LVBENCH_CHECK(lvbench::ClientStreamingCall(stub, cq, kSumMethod, { CreateRequest(3), CreateRequest(4) }, &sum).ok());
+        LVBENCH_CHECK(ReadValue(lvbench::Flatten(sum), 1) == 7);
+        LVBENCH_CHECK(lvbench::ClientStreamingCall(stub, cq, kSumMethod, { CreateRequest(3), CreateRequest(5) }, &sum).ok());
+        LVBENCH_CHECK(ReadValue(lvbench::Flatten(sum), 1) == 8);
+        LVGetServerMethodResponseCacheStats(&server, kSumMethod, &hits, &misses, &entries, &bytes);
+        LVBENCH_CHECK(hits == 0 && entries == 0);
+        LVBENCH_CHECK(gHandled == 4);
+
+        lvbench::ShutdownCompletionQueue(cq);
+    }
+    LVStopServer(&server);
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    TestHitsAndMisses();
+    TestTimeToLive();
+    TestEvictionOrder();
+
+    auto lookupEvent = lvstub::CreateUserEvent(HandleLookup);
+    auto sumEvent = lvstub::CreateUserEvent(HandleSum);
+    lvstub::StartEventLoop(2);
+    TestServerCache(lookupEvent, sumEvent);
+    lvstub::StopEventLoop();
+    return lvbench::TestResult();
+}
@@ -0,0 +1,372 @@
+//---------------------------------------------------------------------
+// Tests of single flight in labview_grpc_server.
+//
+// Checks the leaders and waiting calls SingleFlight keeps on its own,
+// then that calls arriving while the handler works on an identical
+// request all get the response of that one handler call, and that the
+// calls waiting for a client streaming call are handled on their own
+// once it reads a second request. Also that the calls waiting for a call
+// whose client cancelled it are handled on their own.
+//
+// The handler holds every call at a gate after reading its first request
+// until the test has seen the other calls wait for it.
+//
+// Usage: single_flight_test
+//---------------------------------------------------------------------
+#include "benchmark_harness.h"
+#include "lv_runtime_stub.h"
+#include <single_flight.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static const char* kStatusMethod = "/test.Test/GetStatus";
+static const char* kSumMethod = "/test.Test/Sum";
+static const char* kRequestMessage = "test.Request";
+static const char* kResponseMessage = "test.Response";
+
+//---------------------------------------------------------------------
+// LabVIEW clusters for test.Request and test.Response
+//---------------------------------------------------------------------
+struct RequestCluster
+{
+    int32_t value;
+};
+
+struct ResponseCluster
+{
+    int32_t value;
+    int32_t sequence;
+};
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static std::atomic<int32_t> gHandled(0);
+static std::mutex gGateMutex;
+static std::condition_variable gGateCondition;
+static bool gGateOpen = false;
+static std::atomic<bool> gCancelFirstCall(false);
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void SetGate(bool open)
+{
+    std::lock_guard<std::mutex> lock(gGateMutex);
+    gGateOpen = open;
+    gGateCondition.notify_all();
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void WaitAtGate()
+{
+    std::unique_lock<std::mutex> lock(gGateMutex);
+    gGateCondition.wait(lock, []() { return gGateOpen; });
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static bool WaitForCancel(grpc_labview::gRPCid* id)
+{
+    auto end = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (IsCancelled(&id) == 0 && std::chrono::steady_clock::now() < end)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return IsCancelled(&id) != 0;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void HandleStatus(grpc_labview::gRPCid* id)
+{
+    RequestCluster request = { 0 };
+    if (GetRequestData(&id, (int8_t*)&request) == 0)
+    {
+        auto sequence = ++gHandled;
+        WaitAtGate();
+        if (sequence == 1 && gCancelFirstCall)
+        {
+            // Answered once its client gave up, so the response is never written
+            LVBENCH_CHECK(WaitForCancel(id));
+        }
+        ResponseCluster response = { request.value * 10, sequence };
+        SetResponseData(&id, (int8_t*)&response);
+    }
+    CloseServerEvent(&id);
+}
+
+//---------------------------------------------------------------------
+// Client streaming, responds with the sum of the values it read.
+//---------------------------------------------------------------------
+static void HandleSum(grpc_labview::gRPCid* id)
+{
+    RequestCluster request = { 0 };
+    int32_t sum = 0;
+    if (GetRequestData(&id, (int8_t*)&request) == 0)
+    {
+        auto sequence = ++gHandled;
+        WaitAtGate();
+        do
+        {
+            sum += request.value;
+        } while (GetRequestData(&id, (int8_t*)&request) == 0);
+        ResponseCluster response = { sum, sequence };
+        SetResponseData(&id, (int8_t*)&response);
+    }
+    CloseServerEvent(&id);
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static grpc::ByteBuffer CreateRequest(int32_t value)
+{
+    std::string request;
+    lvbench::AppendTag(request, 1, 0);
+    lvbench::AppendVarint(request, (uint32_t)value);
+    return lvbench::CreateByteBuffer(request);
+}
+
+//---------------------------------------------------------------------
+// Value of a varint field of a response, 0 if it has none.
+//---------------------------------------------------------------------
+static int32_t ReadValue(const std::string& response, int protobufIndex)
+{
+    size_t offset = 0;
+    while (offset < response.size())
+    {
+        auto tag = lvbench::ReadVarint(response, offset);
+        auto value = lvbench::ReadVarint(response, offset);
+        if ((int)(tag >> 3) == protobufIndex)
+        {
+            return (int32_t)value;
+        }
+    }
+    return 0;
+}
+
+//---------------------------------------------------------------------
+// Waits for the given number of calls of method to wait for a leader.
+//---------------------------------------------------------------------
+static bool WaitForCoalesced(grpc_labview::gRPCid* server, const char* method, uint64_t coalescedCalls)
+{
+    auto end = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    uint64_t handled = 0;
+    uint64_t coalesced = 0;
+    while (std::chrono::steady_clock::now() < end)
+    {
+        LVGetServerMethodSingleFlightStats(&server, method, &handled, &coalesced);
+        if (coalesced >= coalescedCalls)
+        {
+            return coalesced == coalescedCalls;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return false;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static bool WaitForHandled(int32_t handled)
+{
+    auto end = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (gHandled < handled && std::chrono::steady_clock::now() < end)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return gHandled == handled;
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void TestJoinAndLeave()
+{
+    auto call = [](uintptr_t x) { return reinterpret_cast<grpc_labview::CallData*>(x); };
+    grpc_labview::SingleFlight singleFlight;
+    LVBENCH_CHECK(!singleFlight.Join("a", call(1)));
+    LVBENCH_CHECK(singleFlight.Join("a", call(2)));
+    LVBENCH_CHECK(singleFlight.Join("a", call(3)));
+    LVBENCH_CHECK(!singleFlight.Join("b", call(4)));
+
+    auto waiting = singleFlight.Leave("a");
+    LVBENCH_CHECK(waiting.size() == 2 && waiting[0] == call(2) && waiting[1] == call(3));
+    LVBENCH_CHECK(singleFlight.Leave("b").empty());
+
+    // The next call after the leader left leads again
+    LVBENCH_CHECK(!singleFlight.Join("a", call(5)));
+    LVBENCH_CHECK(singleFlight.Leave("a").empty());
+
+    uint64_t handled, coalesced;
+    singleFlight.GetStats(&handled, &coalesced);
+    LVBENCH_CHECK(handled == 3 && coalesced == 2);
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void TestFanOut(grpc_labview::gRPCid* server, const std::string& address, int followerCount)
+{
+    gHandled = 0;
+    SetGate(false);
+    std::vector<std::string> responses(followerCount + 1);
+    std::vector<int> succeeded(followerCount + 1, 0);
+    auto runCall = [&](int x)
+    {
+        grpc::GenericStub stub(lvbench::CreateClientChannel(address));
+        grpc::CompletionQueue cq;
+        grpc::ByteBuffer response;
+        succeeded[x] = lvbench::UnaryCall(stub, cq, kStatusMethod, CreateRequest(4), &response).ok();
+        responses[x] = lvbench::Flatten(response);
+        lvbench::ShutdownCompletionQueue(cq);
+    };
+
+    std::vector<std::thread> calls;
+    calls.emplace_back(runCall, 0);
+    LVBENCH_CHECK(WaitForHandled(1));
+    for (int x = 1; x <= followerCount; ++x)
+    {
+        calls.emplace_back(runCall, x);
+    }
+    LVBENCH_CHECK(WaitForCoalesced(server, kStatusMethod, followerCount));
+    SetGate(true);
+    for (auto& call : calls)
+    {
+        call.join();
+    }
+
+    LVBENCH_CHECK(gHandled == 1);
+    LVBENCH_CHECK(ReadValue(responses[0], 1) == 40 && ReadValue(responses[0], 2) == 1);
+    for (int x = 0; x <= followerCount; ++x)
+    {
+        LVBENCH_CHECK(succeeded[x]);
+        LVBENCH_CHECK(responses[x] == responses[0]);
+    }
+}
+
+//---------------------------------------------------------------------
+// The client of the leader gives up while the calls wait for it, each of
+// them is then handled with its own handler call.
+//---------------------------------------------------------------------
+static void TestCancelledLeader(grpc_labview::gRPCid* server, const std::string& address, int followerCount)
+{
+    gHandled = 0;
+    gCancelFirstCall = true;
+    SetGate(false);
+    uint64_t handled = 0;
+    uint64_t coalesced = 0;
+    LVGetServerMethodSingleFlightStats(&server, kStatusMethod, &handled, &coalesced);
+    std::vector<std::string> responses(followerCount + 1);
+    std::vector<grpc::StatusCode> codes(followerCount + 1, grpc::StatusCode::UNKNOWN);
+    auto runCall = [&](int x, std::chrono::milliseconds timeout)
+    {
+        grpc::GenericStub stub(lvbench::CreateClientChannel(address));
+        grpc::CompletionQueue cq;
+        grpc::ByteBuffer response;
+        codes[x] = lvbench::UnaryCall(stub, cq, kStatusMethod, CreateRequest(5), &response, timeout).error_code();
+        responses[x] = lvbench::Flatten(response);
+        lvbench::ShutdownCompletionQueue(cq);
+    };
+
+    std::vector<std::thread> calls;
+    calls.emplace_back(runCall, 0, std::chrono::milliseconds(200));
+    LVBENCH_CHECK(WaitForHandled(1));
+    for (int x = 1; x <= followerCount; ++x)
+    {
+        calls.emplace_back(runCall, x, std::chrono::milliseconds(0));
+    }
+    LVBENCH_CHECK(WaitForCoalesced(server, kStatusMethod, coalesced + followerCount));
+    SetGate(true);
+    for (auto& call : calls)
+    {
+        call.join();
+    }
+    gCancelFirstCall = false;
+
+    LVBENCH_CHECK(codes[0] == grpc::StatusCode::DEADLINE_EXCEEDED);
+    LVBENCH_CHECK(gHandled == 1 + followerCount);
+    for (int x = 1; x <= followerCount; ++x)
+    {
+        LVBENCH_CHECK(codes[x] == grpc::StatusCode::OK);
+        LVBENCH_CHECK(ReadValue(responses[x], 1) == 50 && ReadValue(responses[x], 2) > 1);
+    }
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+static void TestStreamingLeader(grpc_labview::gRPCid* server, const std::string& address)
+{
+    gHandled = 0;
+    SetGate(false);
+    std::string leaderResponse;
+    std::string followerResponse;
+    bool leaderSucceeded = false;
+    bool followerSucceeded = false;
+    auto runCall = [&](std::vector<grpc::ByteBuffer> requests, std::string* responseBytes, bool* succeeded)
+    {
+        grpc::GenericStub stub(lvbench::CreateClientChannel(address));
+        grpc::CompletionQueue cq;
+        grpc::ByteBuffer response;
+        *succeeded = lvbench::ClientStreamingCall(stub, cq, kSumMethod, requests, &response).ok();
+        *responseBytes = lvbench::Flatten(response);
+        lvbench::ShutdownCompletionQueue(cq);
+    };
+
+    std::thread leader(runCall, std::vector<grpc::ByteBuffer>{ CreateRequest(1), CreateRequest(2) }, &leaderResponse, &leaderSucceeded);
+    LVBENCH_CHECK(WaitForHandled(1));
+    // Same first request, so it waits for the leader
+    std::thread follower(runCall, std::vector<grpc::ByteBuffer>{ CreateRequest(1) }, &followerResponse, &followerSucceeded);
+    LVBENCH_CHECK(WaitForCoalesced(server, kSumMethod, 1));
+    SetGate(true);
+    leader.join();
+    follower.join();
+
+    // The leader read on, so the follower was handled with its own request
+    LVBENCH_CHECK(leaderSucceeded && followerSucceeded);
+    LVBENCH_CHECK(ReadValue(leaderResponse, 1) == 3);
+    LVBENCH_CHECK(ReadValue(followerResponse, 1) == 1);
+    LVBENCH_CHECK(gHandled == 2);
+}
+
+//---------------------------------------------------------------------
+//---------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    TestJoinAndLeave();
+
+    auto statusEvent = lvstub::CreateUserEvent(HandleStatus);
+    auto sumEvent = lvstub::CreateUserEvent(HandleSum);
+    lvstub::StartEventLoop(4);
+
+    grpc_labview::gRPCid* server = nullptr;
+    LVCreateServer(&server);
+    lvstub::RegisterMessage(&server, kRequestMessage, {
+        { "value", 1, (int)grpc_labview::LVMessageMetadataType::Int32Value, false, "" }
+    });
+    lvstub::RegisterMessage(&server, kResponseMessage, {
+        { "value", 1, (int)grpc_labview::LVMessageMetadataType::Int32Value, false, "" },
+        { "sequence", 2, (int)grpc_labview::LVMessageMetadataType::Int32Value, false, "" }
+    });
+    CompleteMetadataRegistration(&server);
+    RegisterServerEvent(&server, kStatusMethod, &statusEvent, kRequestMessage, kResponseMessage);
+    RegisterServerEvent(&server, kSumMethod, &sumEvent, kRequestMessage, kResponseMessage);
+    LVSetServerMethodSingleFlight(&server, kStatusMethod, 1);
+    LVSetServerMethodSingleFlight(&server, kSumMethod, 1);
+
+    auto address = lvbench::StartLocalServer(&server);
+    LVBENCH_CHECK(!address.empty());
+    if (!address.empty())
+    {
+        TestFanOut(server, address, 8);
+        TestCancelledLeader(server, address, 3);
+        TestStreamingLeader(server, address);
+    }
+    SetGate(true);
+    LVStopServer(&server);
+    lvstub::StopEventLoop();
+    return lvbench::TestResult();
+}